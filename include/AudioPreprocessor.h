@@ -2,66 +2,106 @@
 #define AUDIO_PREPROCESSOR_H
 
 #include "DataTypes.h"
+#include <functional>
+#include <memory>
 #include <vector>
 
+class AudioDenoiser;
+class AudioMixer;
+class AudioResampler;
+class VoiceActivityDetector;
+
 /**
  * @brief 音频预处理器
  */
 class AudioPreprocessor {
 public:
-    AudioPreprocessor() = default;
-    ~AudioPreprocessor() = default;
+    AudioPreprocessor();
+    ~AudioPreprocessor();
     
     /**
-     * @brief 重采样
-     * @param audio 输入音频数据
+     * @brief 重采样（流式多相 FIR，连续调用视为同一条音频流，块大小任意）
+     * @param audio 输入音频数据（交错 16 位整数或 32 位浮点）
      * @param targetSampleRate 目标采样率
-     * @return 重采样后的音频数据
+     * @return 重采样后的音频数据（格式与输入相同，采样率相同时共享输入缓冲）
      */
     AudioData resample(const AudioData& audio, int targetSampleRate);
     
     /**
-     * @brief 混音处理
-     * @param audios 多路音频输入
-     * @return 混音后的音频数据
+     * @brief 结束当前重采样流，取出滤波器中剩余的样本
+     * @return 剩余的音频数据（没有时为空）
+     */
+    AudioData flushResampler();
+    
+    /**
+     * @brief 混音处理（内部转为 float 求和并软限幅，各路块大小不同时经抖动缓冲对齐）
+     * @param audios 多路音频输入（第 i 个元素始终对应同一路音源，本次没有数据时可为空）
+     * @return 混音后的音频数据（格式与第一路有效输入相同，尚无对齐的样本时为空）
      */
     AudioData mix(const std::vector<AudioData>& audios);
     
     /**
-     * @brief 降噪处理
-     * @param audio 输入音频数据
-     * @return 降噪后的音频数据
+     * @brief 混音到调用方提供的输出（缓冲容量足够且未被共享时直接复用，否则从缓冲池分配）
+     * @param audios 多路音频输入（同 mix）
+     * @param output 输出音频数据
+     * @return 是否输出了样本
      */
-    AudioData denoise(const AudioData& audio);
+    bool mixInto(const std::vector<AudioData>& audios, AudioData& output);
+    
+    /**
+     * @brief 设置某一路音源的混音增益
+     * @param index 音源序号（对应 audios 中的位置）
+     * @param gain 线性增益（默认 1.0）
+     */
+    void setMixGain(int index, float gain);
     
-private:
     /**
-     * @brief 线性插值重采样
-     * @param data 输入数据
-     * @param srcRate 源采样率
-     * @param dstRate 目标采样率
-     * @param numSamples 样本数量
-     * @return 重采样后的数据
+     * @brief 语音活动检测（能量 + 语音频带占比 + 过零率），结果写入 audio.voiceActive
+     * @param audio 音频数据（交错 16 位整数或 32 位浮点），连续调用视为同一条音频流
+     * @return 本块是否含语音
      */
-    uint8_t* linearResample(const uint8_t* data, int srcRate, int dstRate, size_t numSamples);
+    bool detectVoice(AudioData& audio);
     
     /**
-     * @brief 简单混音算法
-     * @param samples1 第一路音频样本
-     * @param samples2 第二路音频样本
-     * @param numSamples 样本数量
-     * @return 混音后的样本
+     * @brief 设置语音起点回调（在调用 detectVoice 的线程上触发）
+     * @param callback 参数为起点在音频流中的时间（秒，从第一块送检音频开始）
      */
-    int16_t* simpleMix(const int16_t* samples1, const int16_t* samples2, size_t numSamples);
+    void setSpeechOnsetCallback(std::function<void(double)> callback);
     
     /**
-     * @brief 简单降噪算法
-     * @param samples 音频样本
-     * @param numSamples 样本数量
-     * @param threshold 阈值
-     * @return 降噪后的样本
+     * @brief 降噪处理（流式谱门限，连续调用视为同一条音频流，输出有约 10ms 的固定延迟）
+     *        audio.voiceActive 为 false 的块大部分跳过频谱分析，直接按最大衰减处理
+     * @param audio 输入音频数据（交错 16 位整数或 32 位浮点）
+     * @return 降噪后的音频数据（格式、帧数与输入相同）
      */
-    int16_t* simpleDenoise(const int16_t* samples, size_t numSamples, int16_t threshold);
+    AudioData denoise(const AudioData& audio);
+    
+private:
+    // 重采样流状态：输入格式变化时重新配置
+    std::unique_ptr<AudioResampler> resampler;
+    int resampleBitsPerSample = 0;
+    uint64_t resampleTimestamp = 0;
+    
+    // 混音状态：采样率或声道数变化时重建音源
+    std::unique_ptr<AudioMixer> mixer;
+    std::vector<int> mixSources;
+    std::vector<float> mixGains;
+    int mixSampleRate = 0;
+    
+    // 降噪流状态：采样率或声道数变化时重新配置
+    std::unique_ptr<AudioDenoiser> denoiser;
+    
+    // 语音检测状态
+    std::unique_ptr<VoiceActivityDetector> voiceDetector;
+    std::function<void(double)> speechOnsetCallback;
+    
+    // 样本格式转换工作区（稳态下容量不再增长）
+    std::vector<float> resampleInput;
+    std::vector<float> resampleOutput;
+    std::vector<float> mixInput;
+    std::vector<float> mixOutput;
+    std::vector<float> denoiseBuffer;
+    std::vector<float> voiceBuffer;
 };
 
 #endif // AUDIO_PREPROCESSOR_H
\ No newline at end of file
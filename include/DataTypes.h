@@ -2,9 +2,11 @@
 #define DATA_TYPES_H
 
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <memory>
+#include "FrameBufferPool.h"
 
 // 像素格式枚举
 enum class PixelFormat {
@@ -14,7 +16,29 @@ enum class PixelFormat {
     BGRA32,
     YUV420P,
     YUV422P,
-    YUV444P
+    YUV444P,
+    NV12        // Y 平面 + UV 交错平面（4:2:0）
+};
+
+// 像素格式数量（用于按格式建表）
+const int PIXEL_FORMAT_COUNT = static_cast<int>(PixelFormat::NV12) + 1;
+
+// YUV 转换矩阵与取值范围
+enum class YuvMatrix {
+    BT601,
+    BT709
+};
+
+enum class YuvRange {
+    Limited,    // Y 16-235，UV 16-240（视频常用）
+    Full        // 0-255（JPEG 常用）
+};
+
+// 缩放滤波器
+enum class ScaleFilter {
+    Bilinear,   // 三角形滤波，缩小时按比例展宽
+    Box,        // 面积平均，适合大比例缩小
+    Lanczos     // Lanczos3，边缘最锐利，开销最大
 };
 
 // GPU类型枚举
@@ -70,114 +94,466 @@ struct CaptureRect {
     int height;
 };
 
+// 鼠标光标图像（预乘 ARGB，按 uint32 存储时内存字节序与 BGRA32 一致）
+struct CursorImage {
+    int width = 0;
+    int height = 0;
+    int xhot = 0;                // 热点 X
+    int yhot = 0;                // 热点 Y
+    unsigned long serial = 0;    // 光标形状序列号（形状变化时递增）
+    std::vector<uint32_t> pixels;
+};
+
+// 像素格式的平面数（打包格式为 1，平面 YUV 为 3，NV12 为 2）
+inline int pixelFormatPlaneCount(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::YUV420P:
+    case PixelFormat::YUV422P:
+    case PixelFormat::YUV444P:
+        return 3;
+    case PixelFormat::NV12:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+inline bool pixelFormatIsYuv(PixelFormat format) {
+    return pixelFormatPlaneCount(format) > 1;
+}
+
+// 每个样本占用的字节数（平面格式按单个平面计）
+inline int pixelFormatBytesPerPixel(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGB24:
+    case PixelFormat::BGR24:
+        return 3;
+    case PixelFormat::RGBA32:
+    case PixelFormat::BGRA32:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+// 指定平面每个样本占用的字节数（NV12 的 UV 平面每个样本为一对 UV）
+inline int pixelFormatPlaneBytesPerPixel(PixelFormat format, int plane) {
+    if (format == PixelFormat::NV12 && plane == 1) {
+        return 2;
+    }
+    return pixelFormatBytesPerPixel(format);
+}
+
+// 色度平面相对亮度平面的下采样位移（log2）
+inline void pixelFormatChromaShift(PixelFormat format, int& shiftX, int& shiftY) {
+    shiftX = 0;
+    shiftY = 0;
+    if (format == PixelFormat::YUV420P || format == PixelFormat::NV12) {
+        shiftX = 1;
+        shiftY = 1;
+    } else if (format == PixelFormat::YUV422P) {
+        shiftX = 1;
+    }
+}
+
 // 帧数据结构
+// 像素存放在池化的引用计数缓冲中：拷贝只增加引用（零拷贝传递），移动直接转移所有权。
+// 需要修改共享帧的像素时先调用 makeWritable()（写时复制）
 struct FrameData {
-    uint8_t* data = nullptr;     // 帧数据指针
+    uint8_t* data = nullptr;     // 帧数据指针（由 allocate() 分配，指向池化缓冲）
     size_t size = 0;             // 数据大小
     int width = 0;               // 宽度
     int height = 0;              // 高度
     int stride = 0;              // 步长
     PixelFormat format = PixelFormat::RGB24;  // 像素格式
     uint64_t timestamp = 0;      // 时间戳
+    std::vector<CaptureRect> dirtyRects; // 相对上一帧变化的区域（为空表示整帧）
+    // 与上一帧内容相同的标记：抓屏返回的标记帧 data 为空，但裁剪视图（cropView）仍指向父帧像素，
+    // 使用方须先检查此标记，不能以 data 是否为空来判断
+    bool unchanged = false;
+    // 平面 YUV 的 U、V 平面指针与步长；为空时按紧跟 Y 平面的连续布局推算
+    uint8_t* chromaData[2] = {nullptr, nullptr};
+    int chromaStride[2] = {0, 0};
     
     // 构造函数
     FrameData() = default;
     
     // 析构函数
     ~FrameData() {
-        if (data) {
-            delete[] data;
-            data = nullptr;
-        }
+        releaseBuffer();
     }
     
-    // 拷贝构造函数
+    // 拷贝构造函数（共享缓冲）
     FrameData(const FrameData& other) {
         copyFrom(other);
     }
     
-    // 拷贝赋值运算符
+    // 移动构造函数
+    FrameData(FrameData&& other) noexcept {
+        moveFrom(other);
+    }
+    
+    // 拷贝赋值运算符（共享缓冲）
     FrameData& operator=(const FrameData& other) {
         if (this != &other) {
-            // 释放原有资源
-            if (data) {
-                delete[] data;
-            }
+            releaseBuffer();
             copyFrom(other);
         }
         return *this;
     }
     
+    // 移动赋值运算符
+    FrameData& operator=(FrameData&& other) noexcept {
+        if (this != &other) {
+            releaseBuffer();
+            moveFrom(other);
+        }
+        return *this;
+    }
+    
+    // 从缓冲池分配 bytes 字节的独占缓冲（原缓冲被释放），返回数据指针
+    uint8_t* allocate(size_t bytes) {
+        releaseBuffer();
+        buffer = FrameBufferPool::instance().acquire(bytes);
+        data = buffer ? buffer->data() : nullptr;
+        size = buffer ? bytes : 0;
+        return data;
+    }
+    
+    // 按格式分配图像（多平面格式的各平面连续存放），每行步长按 alignment 字节对齐
+    bool allocateImage(int w, int h, PixelFormat fmt, int alignment = 64) {
+        int shiftX = 0, shiftY = 0;
+        pixelFormatChromaShift(fmt, shiftX, shiftY);
+        const int planes = pixelFormatPlaneCount(fmt);
+        const int lumaStride = alignUp(w * pixelFormatBytesPerPixel(fmt), alignment);
+        const int cw = (w + (1 << shiftX) - 1) >> shiftX;
+        const int ch = (h + (1 << shiftY) - 1) >> shiftY;
+        const int cStride = planes > 1 ? alignUp(cw * pixelFormatPlaneBytesPerPixel(fmt, 1), alignment) : 0;
+        const size_t lumaBytes = static_cast<size_t>(lumaStride) * h;
+        const size_t chromaBytes = static_cast<size_t>(cStride) * ch;
+        if (!allocate(lumaBytes + chromaBytes * (planes - 1))) {
+            return false;
+        }
+        width = w;
+        height = h;
+        format = fmt;
+        stride = lumaStride;
+        if (planes > 1) {
+            chromaData[0] = data + lumaBytes;
+            chromaStride[0] = cStride;
+        }
+        if (planes > 2) {
+            chromaData[1] = data + lumaBytes + chromaBytes;
+            chromaStride[1] = cStride;
+        }
+        return true;
+    }
+    
+    // 平面数与各平面访问（index 0 为打包像素或 Y，1/2 为 U/V）
+    int planeCount() const {
+        return pixelFormatPlaneCount(format);
+    }
+    
+    int planeWidth(int index) const {
+        int shiftX = 0, shiftY = 0;
+        pixelFormatChromaShift(format, shiftX, shiftY);
+        return index == 0 ? width : (width + (1 << shiftX) - 1) >> shiftX;
+    }
+    
+    int planeHeight(int index) const {
+        int shiftX = 0, shiftY = 0;
+        pixelFormatChromaShift(format, shiftX, shiftY);
+        return index == 0 ? height : (height + (1 << shiftY) - 1) >> shiftY;
+    }
+    
+    int planeStride(int index) const {
+        if (index == 0) {
+            return stride > 0 ? stride : width * pixelFormatBytesPerPixel(format);
+        }
+        if (chromaData[index - 1]) {
+            return chromaStride[index - 1];
+        }
+        int shiftX = 0, shiftY = 0;
+        pixelFormatChromaShift(format, shiftX, shiftY);
+        return ((planeStride(0) + (1 << shiftX) - 1) >> shiftX) * pixelFormatPlaneBytesPerPixel(format, index);
+    }
+    
+    uint8_t* plane(int index) const {
+        if (index == 0 || !data) {
+            return data;
+        }
+        if (index >= planeCount()) {
+            return nullptr;
+        }
+        if (chromaData[index - 1]) {
+            return chromaData[index - 1];
+        }
+        // 连续布局：U 紧跟 Y，V 紧跟 U
+        uint8_t* p = data + static_cast<size_t>(planeStride(0)) * height;
+        if (index == 2) {
+            p += static_cast<size_t>(planeStride(1)) * planeHeight(1);
+        }
+        return p;
+    }
+    
+    // 零拷贝裁剪：返回与本帧共享缓冲的子区域视图，只调整平面指针和尺寸
+    // 区域会被裁剪到帧内；色度下采样格式的原点向下对齐到色度网格
+    FrameData cropView(const CaptureRect& rect) const {
+        FrameData view;
+        if (!data || width <= 0 || height <= 0) {
+            return view;
+        }
+        int shiftX = 0, shiftY = 0;
+        pixelFormatChromaShift(format, shiftX, shiftY);
+        int x0 = rect.x < 0 ? 0 : (rect.x > width ? width : rect.x);
+        int y0 = rect.y < 0 ? 0 : (rect.y > height ? height : rect.y);
+        int x1 = rect.x + rect.width > width ? width : rect.x + rect.width;
+        int y1 = rect.y + rect.height > height ? height : rect.y + rect.height;
+        x0 &= ~((1 << shiftX) - 1);
+        y0 &= ~((1 << shiftY) - 1);
+        if (x1 <= x0 || y1 <= y0) {
+            return view;
+        }
+        
+        view = *this;
+        view.width = x1 - x0;
+        view.height = y1 - y0;
+        view.stride = planeStride(0);
+        view.data = data + static_cast<size_t>(y0) * view.stride + x0 * pixelFormatBytesPerPixel(format);
+        uint8_t* end = view.data + static_cast<size_t>(view.stride) * (view.height - 1) +
+                       view.width * pixelFormatBytesPerPixel(format);
+        for (int i = 1; i < planeCount(); ++i) {
+            view.chromaStride[i - 1] = planeStride(i);
+            const int planeBytes = pixelFormatPlaneBytesPerPixel(format, i);
+            view.chromaData[i - 1] = plane(i) + static_cast<size_t>(y0 >> shiftY) * planeStride(i) + (x0 >> shiftX) * planeBytes;
+            uint8_t* planeEnd = view.chromaData[i - 1] +
+                                static_cast<size_t>(view.chromaStride[i - 1]) * (view.planeHeight(i) - 1) +
+                                view.planeWidth(i) * planeBytes;
+            if (planeEnd > end) {
+                end = planeEnd;
+            }
+        }
+        view.size = static_cast<size_t>(end - view.data);
+        
+        // 脏矩形换算到视图坐标
+        view.dirtyRects.clear();
+        for (const CaptureRect& dirty : dirtyRects) {
+            int dx0 = dirty.x > x0 ? dirty.x : x0;
+            int dy0 = dirty.y > y0 ? dirty.y : y0;
+            int dx1 = dirty.x + dirty.width < x1 ? dirty.x + dirty.width : x1;
+            int dy1 = dirty.y + dirty.height < y1 ? dirty.y + dirty.height : y1;
+            if (dx1 > dx0 && dy1 > dy0) {
+                view.dirtyRects.push_back({dx0 - x0, dy0 - y0, dx1 - dx0, dy1 - dy0});
+            }
+        }
+        if (!dirtyRects.empty() && view.dirtyRects.empty()) {
+            view.unchanged = true;
+        }
+        return view;
+    }
+    
+    // 写时复制：缓冲被其他帧共享时复制出独占副本（视图只复制其覆盖的区域）
+    void makeWritable() {
+        if (!buffer || buffer->useCount() <= 1) {
+            return;
+        }
+        FrameData copy;
+        if (width > 0 && height > 0 && copy.allocateImage(width, height, format)) {
+            for (int i = 0; i < planeCount(); ++i) {
+                const size_t rowBytes = static_cast<size_t>(planeWidth(i)) * pixelFormatPlaneBytesPerPixel(format, i);
+                const uint8_t* src = plane(i);
+                uint8_t* dst = copy.plane(i);
+                for (int y = 0; y < planeHeight(i); ++y) {
+                    memcpy(dst + static_cast<size_t>(y) * copy.planeStride(i),
+                           src + static_cast<size_t>(y) * planeStride(i), rowBytes);
+                }
+            }
+        } else if (copy.allocate(size)) {
+            memcpy(copy.data, data, size);
+            copy.stride = stride;
+        }
+        releaseBuffer();
+        buffer = copy.buffer;
+        data = copy.data;
+        size = copy.size;
+        stride = copy.stride;
+        chromaData[0] = copy.chromaData[0];
+        chromaData[1] = copy.chromaData[1];
+        chromaStride[0] = copy.chromaStride[0];
+        chromaStride[1] = copy.chromaStride[1];
+        copy.buffer = nullptr;
+        copy.data = nullptr;
+    }
+    
+    // 当前缓冲的引用数（无缓冲时为 0）
+    int bufferUseCount() const {
+        return buffer ? buffer->useCount() : 0;
+    }
+    
 private:
-    void copyFrom(const FrameData& other) {
+    FrameBuffer* buffer = nullptr;
+    
+    static int alignUp(int value, int alignment) {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+    
+    void releaseBuffer() {
+        if (buffer) {
+            buffer->release();
+            buffer = nullptr;
+        }
+        data = nullptr;
+        chromaData[0] = chromaData[1] = nullptr;
+        chromaStride[0] = chromaStride[1] = 0;
+    }
+    
+    void copyMetadata(const FrameData& other) {
         size = other.size;
         width = other.width;
         height = other.height;
         stride = other.stride;
         format = other.format;
         timestamp = other.timestamp;
-        
-        if (other.data && other.size > 0) {
-            data = new uint8_t[other.size];
-            memcpy(data, other.data, other.size);
-        } else {
-            data = nullptr;
+        unchanged = other.unchanged;
+        chromaData[0] = other.chromaData[0];
+        chromaData[1] = other.chromaData[1];
+        chromaStride[0] = other.chromaStride[0];
+        chromaStride[1] = other.chromaStride[1];
+    }
+    
+    void copyFrom(const FrameData& other) {
+        copyMetadata(other);
+        dirtyRects = other.dirtyRects;
+        buffer = other.buffer;
+        data = other.data;
+        if (buffer) {
+            buffer->addRef();
         }
     }
+    
+    void moveFrom(FrameData& other) {
+        copyMetadata(other);
+        dirtyRects = std::move(other.dirtyRects);
+        buffer = other.buffer;
+        data = other.data;
+        other.buffer = nullptr;
+        other.data = nullptr;
+        other.size = 0;
+        other.chromaData[0] = other.chromaData[1] = nullptr;
+    }
 };
 
-// 音频数据结构
+// 音频数据结构（与 FrameData 相同的池化缓冲语义）
 struct AudioData {
-    uint8_t* data = nullptr;     // 音频数据指针
+    uint8_t* data = nullptr;     // 音频数据指针（由 allocate() 分配，指向池化缓冲）
     size_t size = 0;             // 数据大小
     int sampleRate = 0;          // 采样率
     int channels = 0;            // 声道数
     int bitsPerSample = 0;       // 位深度
     uint64_t timestamp = 0;      // 时间戳
+    bool voiceActive = true;     // 语音检测结果（false 表示静音或纯噪声，下游可跳过或降低处理开销）
     
     // 构造函数
     AudioData() = default;
     
     // 析构函数
     ~AudioData() {
-        if (data) {
-            delete[] data;
-            data = nullptr;
-        }
+        releaseBuffer();
     }
     
-    // 拷贝构造函数
+    // 拷贝构造函数（共享缓冲）
     AudioData(const AudioData& other) {
         copyFrom(other);
     }
     
-    // 拷贝赋值运算符
+    // 移动构造函数
+    AudioData(AudioData&& other) noexcept {
+        moveFrom(other);
+    }
+    
+    // 拷贝赋值运算符（共享缓冲）
     AudioData& operator=(const AudioData& other) {
         if (this != &other) {
-            // 释放原有资源
-            if (data) {
-                delete[] data;
-            }
+            releaseBuffer();
             copyFrom(other);
         }
         return *this;
     }
     
+    // 移动赋值运算符
+    AudioData& operator=(AudioData&& other) noexcept {
+        if (this != &other) {
+            releaseBuffer();
+            moveFrom(other);
+        }
+        return *this;
+    }
+    
+    // 从缓冲池分配 bytes 字节的独占缓冲（原缓冲被释放），返回数据指针
+    uint8_t* allocate(size_t bytes) {
+        releaseBuffer();
+        buffer = FrameBufferPool::instance().acquire(bytes);
+        data = buffer ? buffer->data() : nullptr;
+        size = buffer ? bytes : 0;
+        return data;
+    }
+    
+    // 写时复制：缓冲被共享时复制出独占副本
+    void makeWritable() {
+        if (!buffer || buffer->useCount() <= 1) {
+            return;
+        }
+        FrameBuffer* shared = buffer;
+        buffer = FrameBufferPool::instance().acquire(size);
+        if (buffer) {
+            memcpy(buffer->data(), shared->data(), size);
+        }
+        data = buffer ? buffer->data() : nullptr;
+        shared->release();
+    }
+    
+    // 当前缓冲的容量（无缓冲时为 0），复用输出缓冲时据此判断是否需要重新分配
+    size_t bufferCapacity() const {
+        return buffer ? buffer->capacity() : 0;
+    }
+    
 private:
-    void copyFrom(const AudioData& other) {
+    FrameBuffer* buffer = nullptr;
+    
+    void releaseBuffer() {
+        if (buffer) {
+            buffer->release();
+            buffer = nullptr;
+        }
+        data = nullptr;
+    }
+    
+    void copyMetadata(const AudioData& other) {
         size = other.size;
         sampleRate = other.sampleRate;
         channels = other.channels;
         bitsPerSample = other.bitsPerSample;
         timestamp = other.timestamp;
-        
-        if (other.data && other.size > 0) {
-            data = new uint8_t[other.size];
-            memcpy(data, other.data, other.size);
-        } else {
-            data = nullptr;
+        voiceActive = other.voiceActive;
+    }
+    
+    void copyFrom(const AudioData& other) {
+        copyMetadata(other);
+        buffer = other.buffer;
+        data = other.data;
+        if (buffer) {
+            buffer->addRef();
         }
     }
+    
+    void moveFrom(AudioData& other) {
+        copyMetadata(other);
+        buffer = other.buffer;
+        data = other.data;
+        other.buffer = nullptr;
+        other.data = nullptr;
+        other.size = 0;
+    }
 };
 
 // 视频帧结构（简化版）
@@ -199,6 +575,29 @@ struct AudioFrame {
     int64_t timestamp = 0;
 };
 
+// 编码器配置结构
+struct EncoderConfig {
+    int width = 1920;                              // 输入宽度
+    int height = 1080;                             // 输入高度
+    int fps = 30;                                  // 帧率
+    int bitrate = 0;                               // 码率（0 表示使用 CRF）
+    int crf = 23;                                  // 恒定质量因子
+    PixelFormat inputFormat = PixelFormat::BGRA32; // 输入像素格式
+    YuvMatrix colorMatrix = YuvMatrix::BT601;      // 进程内 RGB->YUV 转换使用的矩阵
+    YuvRange colorRange = YuvRange::Limited;       // 进程内 RGB->YUV 转换使用的取值范围
+    std::string codec = "libx264";                 // 编码器名称
+    std::string preset = "veryfast";               // 编码预设
+    std::string outputPath;                        // 输出文件路径
+};
+
+// 编码输出结构
+struct EncodedData {
+    std::vector<uint8_t> data;   // 编码后的码流（由外部进程写文件时为空）
+    uint64_t timestamp = 0;      // 时间戳
+    bool keyFrame = false;       // 是否关键帧
+    bool ok = false;             // 编码是否成功
+};
+
 // 录制配置结构
 struct RecordingConfig {
     int width = 1920;
@@ -0,0 +1,112 @@
+#ifndef FRAME_BUFFER_POOL_H
+#define FRAME_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class FrameBufferPool;
+
+/**
+ * @brief 引用计数的帧缓冲块
+ *
+ * 由 FrameBufferPool 分配，最后一个引用释放时归还缓冲池而不是交还系统。
+ * 大块按页（4096 字节）对齐，小块按缓存行（64 字节）对齐。
+ */
+class FrameBuffer {
+public:
+    uint8_t* data() const { return storage; }
+    size_t capacity() const { return capacityBytes; }
+
+    /**
+     * @brief 增加一个引用
+     */
+    void addRef() { refs.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 释放一个引用，计数归零时归还缓冲池
+     */
+    void release();
+
+    /**
+     * @brief 当前引用数（大于 1 表示被多个帧共享）
+     */
+    int useCount() const { return refs.load(std::memory_order_acquire); }
+
+private:
+    friend class FrameBufferPool;
+    FrameBuffer() = default;
+
+    uint8_t* storage = nullptr;
+    size_t capacityBytes = 0;
+    std::atomic<int> refs{0};
+};
+
+/**
+ * @brief 进程内帧缓冲池
+ *
+ * 按尺寸等级管理空闲缓冲：每个 2 的幂区间再分 8 档，浪费不超过 12.5%。
+ * 录制稳态下帧尺寸固定，每帧都能命中空闲缓冲，不再产生堆分配。
+ */
+class FrameBufferPool {
+public:
+    struct Stats {
+        uint64_t hits = 0;          // 复用空闲缓冲的次数
+        uint64_t misses = 0;        // 新分配的次数
+        size_t bytesInUse = 0;      // 正被帧引用的字节数
+        size_t bytesPooled = 0;     // 空闲待复用的字节数
+        size_t peakBytes = 0;       // 占用 + 空闲的历史峰值
+    };
+
+    static FrameBufferPool& instance();
+
+    /**
+     * @brief 获取至少 size 字节的缓冲，初始引用数为 1
+     * @param size 需要的字节数
+     * @return 缓冲块，分配失败返回 nullptr
+     */
+    FrameBuffer* acquire(size_t size);
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats stats() const;
+
+    /**
+     * @brief 设置空闲缓冲总量上限，超出的归还缓冲直接释放
+     * @param bytes 上限字节数
+     */
+    void setMaxPooledBytes(size_t bytes);
+
+    /**
+     * @brief 释放全部空闲缓冲
+     */
+    void trim();
+
+private:
+    friend class FrameBuffer;
+    FrameBufferPool() = default;
+    ~FrameBufferPool() = default;
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+    void recycle(FrameBuffer* buffer);
+    static size_t sizeClass(size_t size);
+    static void destroy(FrameBuffer* buffer);
+
+    mutable std::mutex mutex;
+    std::unordered_map<size_t, std::vector<FrameBuffer*>> freeLists;
+    size_t maxPooledBytes = 256 * 1024 * 1024;
+    Stats counters;
+};
+
+inline void FrameBuffer::release() {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        FrameBufferPool::instance().recycle(this);
+    }
+}
+
+#endif // FRAME_BUFFER_POOL_H
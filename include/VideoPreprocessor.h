@@ -2,6 +2,7 @@
 #define VIDEO_PREPROCESSOR_H
 
 #include "DataTypes.h"
+#include <vector>
 
 /**
  * @brief 视频预处理器
@@ -12,7 +13,7 @@ public:
     ~VideoPreprocessor() = default;
     
     /**
-     * @brief 色彩空间转换
+     * @brief 色彩空间转换（任意两种 PixelFormat 之间，格式相同时共享源帧）
      * @param frame 输入帧
      * @param targetFormat 目标格式
      * @return 转换后的帧
@@ -20,7 +21,14 @@ public:
     FrameData convertColorSpace(const FrameData& frame, PixelFormat targetFormat);
     
     /**
-     * @brief 分辨率缩放
+     * @brief 设置 RGB 与 YUV 互转使用的矩阵和取值范围
+     * @param matrix 转换矩阵（默认 BT.601）
+     * @param range 取值范围（默认 limited）
+     */
+    void setColorSpec(YuvMatrix matrix, YuvRange range);
+    
+    /**
+     * @brief 分辨率缩放（多线程分条带处理，滤波系数按尺寸组合缓存）
      * @param frame 输入帧
      * @param width 目标宽度
      * @param height 目标高度
@@ -28,43 +36,90 @@ public:
      */
     FrameData scaleFrame(const FrameData& frame, int width, int height);
     
+    /**
+     * @brief 一趟完成裁剪、缩放与格式转换（源帧只读取一次，不产生整帧中间结果）
+     * @param frame 输入帧
+     * @param crop 裁剪区域（宽高为 0 表示整帧）
+     * @param width 目标宽度（0 表示与裁剪区域相同）
+     * @param height 目标高度（0 表示与裁剪区域相同）
+     * @param targetFormat 目标格式
+     * @return 处理后的帧；裁剪区域内无变化时只返回 unchanged 标记
+     */
+    FrameData preprocess(const FrameData& frame, const CaptureRect& crop, int width, int height, PixelFormat targetFormat);
+    
+    /**
+     * @brief 设置缩放滤波器
+     * @param filter 滤波器（默认面积平均，适合录制时的大比例缩小）
+     */
+    void setScaleFilter(ScaleFilter filter);
+    
     /**
      * @brief 叠加鼠标效果
      * @param frame 输入帧
      * @param mousePos 鼠标位置
      * @return 叠加后的帧
      */
-    FrameData overlayMouseEffect(const FrameData& frame, const Point& mousePos);
+    FrameData overlayMouseEffect(const FrameData& frame, const CapturePoint& mousePos);
+    
+    /**
+     * @brief 计算原地叠加鼠标效果将修改的区域（不修改帧），供调用方在叠加前保存被覆盖的像素
+     * @param frame 目标帧（只用到尺寸和格式）
+     * @param mousePos 鼠标热点位置（帧坐标）
+     * @param pressed 鼠标按键是否按下（用于点击高亮）
+     * @return 将被修改的区域（宽高为 0 表示不会修改）
+     */
+    CaptureRect mouseEffectRect(const FrameData& frame, const CapturePoint& mousePos, bool pressed);
     
-private:
     /**
-     * @brief RGB到YUV转换
-     * @param rgbData RGB数据
-     * @param width 宽度
-     * @param height 高度
-     * @return YUV数据
+     * @brief 原地叠加鼠标效果（热路径，不拷贝帧）
+     * 直接写入帧缓冲：缓冲与其他帧共享时由调用方先 makeWritable，或自行保存并恢复 mouseEffectRect 范围内的像素
+     * @param frame 输入帧（BGRA32 或 YUV420P，可为裁剪视图；YUV420P 按 setColorSpec 的色彩规格换算叠加颜色）
+     * @param mousePos 鼠标热点位置（帧坐标）
+     * @param pressed 鼠标按键是否按下（用于点击高亮）
+     * @return 实际被修改的区域（宽高为 0 表示未修改）
      */
-    uint8_t* rgbToYuv(const uint8_t* rgbData, int width, int height);
+    CaptureRect overlayMouseEffectInPlace(FrameData& frame, const CapturePoint& mousePos, bool pressed);
     
     /**
-     * @brief YUV到RGB转换
-     * @param yuvData YUV数据
-     * @param width 宽度
-     * @param height 高度
-     * @return RGB数据
+     * @brief 设置光标图像，序列号不变时不会重建叠加图
+     * @param cursor 光标图像
      */
-    uint8_t* yuvToRgb(const uint8_t* yuvData, int width, int height);
+    void setCursorImage(const CursorImage& cursor);
     
     /**
-     * @brief 双线性插值缩放
-     * @param data 输入数据
-     * @param srcWidth 源宽度
-     * @param srcHeight 源高度
-     * @param dstWidth 目标宽度
-     * @param dstHeight 目标高度
-     * @return 缩放后的数据
+     * @brief 设置点击高亮效果
+     * @param enabled 是否启用
+     * @param color 高亮颜色（非预乘 ARGB）
+     * @param radius 高亮半径（像素）
      */
-    uint8_t* bilinearScale(const uint8_t* data, int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    void setClickHighlight(bool enabled, uint32_t color = 0x80FFC800, int radius = 20);
+    
+private:
+    /**
+     * @brief 重建叠加图（光标 + 点击高亮，预乘 BGRA）
+     * @param pressed 是否绘制点击高亮
+     */
+    void rebuildOverlaySprite(bool pressed);
+    
+    // 色彩空间转换参数
+    YuvMatrix colorMatrix = YuvMatrix::BT601;
+    YuvRange colorRange = YuvRange::Limited;
+    ScaleFilter scaleFilter = ScaleFilter::Box;
+    
+    // 鼠标叠加状态
+    CursorImage cursor;
+    bool highlightEnabled = true;
+    uint32_t highlightColor = 0x80FFC800;
+    int highlightRadius = 20;
+    
+    // 叠加图缓存：光标形状或按下状态变化时才重建
+    std::vector<uint32_t> overlaySprite;
+    int spriteWidth = 0;
+    int spriteHeight = 0;
+    int spriteOriginX = 0;   // 叠加图左上角相对热点的偏移
+    int spriteOriginY = 0;
+    bool spriteValid = false;
+    bool spritePressed = false;
 };
 
 #endif // VIDEO_PREPROCESSOR_H
\ No newline at end of file
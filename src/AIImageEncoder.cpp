@@ -0,0 +1,208 @@
+#include "AIImageEncoder.h"
+#include "EncodedFrame.h"
+#include "FrameScaler.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 最低质量仍超预算时每轮把长边缩小到的比例
+const double SHRINK_STEP = 0.8;
+
+} // namespace
+
+AIImagePolicy AIImageEncoder::policyForProvider(const QString &provider) {
+    AIImagePolicy policy;
+    if (provider == "OpenAI") {
+        // 高细节模式会把短边缩到 768，16:9 画面对应长边约 1366
+        policy.maxLongSide = 1366;
+        policy.targetBytes = 256 * 1024;
+    } else if (provider.contains("SiliconFlow") || provider.contains("硅基流动")) {
+        // Qwen-VL 系列默认最多约 100 万像素
+        policy.maxLongSide = 1344;
+        policy.targetBytes = 200 * 1024;
+    } else if (provider.contains("GLM") || provider.contains("智谱")) {
+        policy.maxLongSide = 1536;
+        policy.targetBytes = 300 * 1024;
+    } else if (provider.contains("Kimi") || provider.contains("月之暗面")) {
+        policy.maxLongSide = 1536;
+        policy.targetBytes = 300 * 1024;
+    }
+    return policy;
+}
+
+QImage AIImageEncoder::downscale(const QImage &image, int maxLongSide) {
+    const int longSide = std::max(image.width(), image.height());
+    if (longSide <= maxLongSide || maxLongSide <= 0) {
+        return image;
+    }
+    const double factor = static_cast<double>(maxLongSide) / longSide;
+    const int width = std::max(1, static_cast<int>(std::lround(image.width() * factor)));
+    const int height = std::max(1, static_cast<int>(std::lround(image.height() * factor)));
+
+    // 直接借用 QImage 的像素作为帧视图交给 FrameScaler（面积平均）
+    const QImage source = image.convertToFormat(QImage::Format_RGB32);
+    QImage scaled(width, height, QImage::Format_RGB32);
+    if (source.isNull() || scaled.isNull()) {
+        return image.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    const FrameData src = EncodedFrame::frameView(source);
+    FrameData dst = EncodedFrame::frameView(scaled);
+    if (!FrameScaler::scale(src, dst, ScaleFilter::Box)) {
+        return image.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    return scaled;
+}
+
+QByteArray AIImageEncoder::encodeJpeg(const QImage &image, int quality) {
+    QByteArray jpegData;
+    QBuffer buffer(&jpegData);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "JPEG", quality)) {
+        jpegData.clear();
+    }
+    return jpegData;
+}
+
+QByteArray AIImageEncoder::encode(const QImage &image, const AIImagePolicy &policy, int *usedQuality) {
+    if (image.isNull()) {
+        return QByteArray();
+    }
+
+    int longSide = std::min(std::max(image.width(), image.height()), policy.maxLongSide);
+    while (true) {
+        const QImage scaled = downscale(image, longSide);
+
+        // 最高质量已满足预算时直接返回，否则在 [minQuality, maxQuality] 内二分查找满足预算的最高质量
+        QByteArray best = encodeJpeg(scaled, policy.maxQuality);
+        int bestQuality = policy.maxQuality;
+        if (best.size() > policy.targetBytes) {
+            best.clear();
+            int low = policy.minQuality;
+            int high = policy.maxQuality - 1;
+            while (low <= high) {
+                const int quality = (low + high) / 2;
+                QByteArray candidate = encodeJpeg(scaled, quality);
+                if (!candidate.isEmpty() && candidate.size() <= policy.targetBytes) {
+                    best = candidate;
+                    bestQuality = quality;
+                    low = quality + 1;
+                } else {
+                    high = quality - 1;
+                }
+            }
+        }
+
+        if (!best.isEmpty()) {
+            if (usedQuality) {
+                *usedQuality = bestQuality;
+            }
+            return best;
+        }
+
+        // 最低质量仍超预算：先缩小尺寸（保持文字笔画完整比继续压质量更重要），到下限后接受超预算
+        const int nextLongSide = static_cast<int>(longSide * SHRINK_STEP);
+        if (nextLongSide < policy.minLongSide || longSide <= policy.minLongSide) {
+            if (usedQuality) {
+                *usedQuality = policy.minQuality;
+            }
+            return encodeJpeg(scaled, policy.minQuality);
+        }
+        longSide = nextLongSide;
+    }
+}
+
+bool AIImageEncoder::fitsPolicy(QImageReader &reader, qint64 byteSize, const AIImagePolicy &policy) {
+    const QSize size = reader.size();
+    const bool isJpeg = reader.format() == "jpeg" || reader.format() == "jpg";
+    return isJpeg && size.isValid()
+        && std::max(size.width(), size.height()) <= policy.maxLongSide
+        && byteSize <= policy.targetBytes;
+}
+
+QByteArray AIImageEncoder::decodeAndEncode(QImageReader &reader, qint64 byteSize, const QString &name,
+                                           const AIImagePolicy &policy) {
+    const QImage image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "读取图片失败:" << name << reader.errorString();
+        return QByteArray();
+    }
+
+    int quality = 0;
+    const QByteArray jpegData = encode(image, policy, &quality);
+    qDebug() << QString("AI 上传图片 %1: %2x%3 %4KB -> %5KB (质量 %6)")
+                .arg(name)
+                .arg(image.width()).arg(image.height())
+                .arg(byteSize / 1024)
+                .arg(jpegData.size() / 1024)
+                .arg(quality);
+    return jpegData;
+}
+
+QByteArray AIImageEncoder::encodeFile(const QString &imagePath, const AIImagePolicy &policy) {
+    QFile file(imagePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "无法打开图片文件:" << imagePath;
+        return QByteArray();
+    }
+
+    QImageReader reader(&file);
+    reader.setAutoTransform(true);
+    if (fitsPolicy(reader, file.size(), policy)) {
+        file.seek(0);
+        return file.readAll();
+    }
+    return decodeAndEncode(reader, file.size(), QFileInfo(imagePath).fileName(), policy);
+}
+
+QByteArray AIImageEncoder::encodeData(const QByteArray &imageData, const AIImagePolicy &policy) {
+    if (imageData.isEmpty()) {
+        return QByteArray();
+    }
+
+    QBuffer buffer;
+    buffer.setData(imageData);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    reader.setAutoTransform(true);
+    if (fitsPolicy(reader, imageData.size(), policy)) {
+        return imageData;
+    }
+    return decodeAndEncode(reader, imageData.size(), QStringLiteral("<内存帧>"), policy);
+}
+
+AIImagePolicy AIImageEncoder::thumbnailPolicy() {
+    AIImagePolicy policy;
+    policy.maxLongSide = 512;
+    policy.targetBytes = 24 * 1024;
+    policy.minQuality = 40;
+    policy.maxQuality = 70;
+    policy.minLongSide = 384;
+    return policy;
+}
+
+AIUploadImages AIImageEncoder::encodeRegion(const QImage &screen, const QRect &region, const AIImagePolicy &policy) {
+    AIUploadImages upload;
+    upload.screenSize = screen.size();
+    upload.region = region.intersected(screen.rect());
+    if (upload.region.isEmpty()) {
+        return upload;
+    }
+
+    int regionQuality = 0;
+    int thumbnailQuality = 0;
+    upload.image = encode(screen.copy(upload.region), policy, &regionQuality);
+    upload.thumbnail = encode(screen, thumbnailPolicy(), &thumbnailQuality);
+    qDebug() << QString("AI 上传变化区域: (%1,%2) %3x%4 / %5x%6, 区域 %7KB (质量 %8) + 缩略图 %9KB (质量 %10)")
+                .arg(upload.region.x()).arg(upload.region.y())
+                .arg(upload.region.width()).arg(upload.region.height())
+                .arg(screen.width()).arg(screen.height())
+                .arg(upload.image.size() / 1024).arg(regionQuality)
+                .arg(upload.thumbnail.size() / 1024).arg(thumbnailQuality);
+    return upload;
+}
@@ -0,0 +1,67 @@
+#ifndef AIIMAGEENCODER_H
+#define AIIMAGEENCODER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QImageReader>
+#include <QRect>
+#include <QString>
+
+/**
+ * 上传给视觉模型的图片策略：长边上限 + JPEG 字节预算
+ * 模型端会把超过其输入分辨率的图片再缩小，上传更大的图只增加带宽和排队时间
+ */
+struct AIImagePolicy {
+    int maxLongSide = 1536;          // 长边上限（像素）
+    int targetBytes = 256 * 1024;    // JPEG 字节预算
+    int minQuality = 60;             // 低于此质量时小字号文字边缘会糊，不再继续降
+    int maxQuality = 90;
+    int minLongSide = 1024;          // 最低质量仍超预算时继续缩小，但长边不小于此值
+};
+
+/**
+ * 一次视觉请求要上传的图片：通常是整屏一张；只有局部变化时为变化区域裁剪 + 整屏缩略图
+ */
+struct AIUploadImages {
+    QByteArray image;        // 主图：整屏，或变化区域的裁剪
+    QByteArray thumbnail;    // 整屏缩略图（仅裁剪上传时非空，只用于提供上下文）
+    QRect region;            // 裁剪区域（整屏像素坐标）
+    QSize screenSize;        // 整屏尺寸
+
+    bool isRegionCrop() const { return !thumbnail.isEmpty(); }
+    qint64 totalBytes() const { return image.size() + thumbnail.size(); }
+};
+
+/**
+ * AI 上传图片编码 - 按策略缩小并搜索满足字节预算的最高 JPEG 质量
+ * 只使用 QImage 与 FrameScaler，可在任意线程调用
+ */
+class AIImageEncoder {
+public:
+    // 各提供商的默认策略（按 AISummaryConfig::provider 匹配，未知提供商用通用策略）
+    static AIImagePolicy policyForProvider(const QString &provider);
+
+    // 缩小并编码；usedQuality 返回最终使用的 JPEG 质量
+    static QByteArray encode(const QImage &image, const AIImagePolicy &policy, int *usedQuality = nullptr);
+
+    // 读取图片文件后编码；原文件已是满足策略的 JPEG 时直接返回原始数据
+    static QByteArray encodeFile(const QString &imagePath, const AIImagePolicy &policy);
+
+    // 内存中的已编码图片；已满足策略时原样返回（共享数据，不复制）
+    static QByteArray encodeData(const QByteArray &imageData, const AIImagePolicy &policy);
+
+    // 变化区域上传：region 按 policy 编码，整屏按 thumbnailPolicy 编码为缩略图
+    static AIUploadImages encodeRegion(const QImage &screen, const QRect &region, const AIImagePolicy &policy);
+
+    // 上下文缩略图策略（与提供商无关，只需看清窗口布局）
+    static AIImagePolicy thumbnailPolicy();
+
+private:
+    static bool fitsPolicy(QImageReader &reader, qint64 byteSize, const AIImagePolicy &policy);
+    static QByteArray decodeAndEncode(QImageReader &reader, qint64 byteSize, const QString &name,
+                                      const AIImagePolicy &policy);
+    static QImage downscale(const QImage &image, int maxLongSide);
+    static QByteArray encodeJpeg(const QImage &image, int quality);
+};
+
+#endif // AIIMAGEENCODER_H
@@ -13,6 +13,55 @@
 #include <QMutexLocker>
 #include <QThread>
 #include <QRegularExpression>
+#include "AIImageEncoder.h"
+#include "TileChangeMap.h"
+#include <algorithm>
+
+namespace {
+
+// 裁剪区域的最小尺寸与外扩边距，避免把一行文字单独裁出来丢掉上下文
+const int MIN_CROP_WIDTH = 480;
+const int MIN_CROP_HEIGHT = 320;
+const int CROP_MARGIN = TileChangeMap::TILE_SIZE / 2;
+
+QRect expandCropRegion(const CaptureRect &bounds, const QSize &screen) {
+    QRect region(bounds.x, bounds.y, bounds.width, bounds.height);
+    region.adjust(-CROP_MARGIN, -CROP_MARGIN, CROP_MARGIN, CROP_MARGIN);
+    const int width = std::min(screen.width(), std::max(region.width(), MIN_CROP_WIDTH));
+    const int height = std::min(screen.height(), std::max(region.height(), MIN_CROP_HEIGHT));
+    const QPoint center = region.center();
+    const int x = std::clamp(center.x() - width / 2, 0, screen.width() - width);
+    const int y = std::clamp(center.y() - height / 2, 0, screen.height() - height);
+    return QRect(x, y, width, height);
+}
+
+// 在编码线程中执行：与上一张分析过的图片比较，变化集中在小区域时裁剪上传，否则整屏上传
+AIUploadImages encodeForUpload(const EncodedFrame &frame, const AIImagePolicy &policy,
+                               TileChangeMap *changeMap, double cropThreshold) {
+    AIUploadImages upload;
+    if (changeMap && cropThreshold > 0.0) {
+        const QImage screen = frame.decodePreview(1);
+        if (!screen.isNull()) {
+            upload.screenSize = screen.size();
+            const TileChangeMap::Result change = changeMap->update(EncodedFrame::frameView(screen));
+            if (change.valid && change.changedTiles > 0 &&
+                change.boundsFraction(screen.width(), screen.height()) <= cropThreshold) {
+                AIUploadImages cropped = AIImageEncoder::encodeRegion(
+                    screen, expandCropRegion(change.bounds, screen.size()), policy);
+                if (!cropped.image.isEmpty()) {
+                    return cropped;
+                }
+            }
+        }
+    }
+    
+    upload.image = frame.jpegData.isEmpty()
+        ? AIImageEncoder::encodeFile(frame.sourcePath, policy)
+        : AIImageEncoder::encodeData(frame.jpegData, policy);
+    return upload;
+}
+
+} // namespace
 
 AIVisionAnalyzer::AIVisionAnalyzer(QObject *parent)
     : QObject(parent)
@@ -22,6 +71,10 @@ AIVisionAnalyzer::AIVisionAnalyzer(QObject *parent)
     , isAnalyzing(false)
     , currentImageIndex(0)
     , totalImages(0)
+    , encodeGeneration(0)
+    , changeMap(std::make_shared<TileChangeMap>())
+    , sharedChangeMap(false)
+    , regionCropThreshold(DEFAULT_REGION_CROP_THRESHOLD)
 {
     timeoutTimer->setSingleShot(true);
     connect(timeoutTimer, &QTimer::timeout, this, &AIVisionAnalyzer::onNetworkTimeout);
@@ -32,13 +85,39 @@ AIVisionAnalyzer::AIVisionAnalyzer(QObject *parent)
 
 AIVisionAnalyzer::~AIVisionAnalyzer() {
     cancelAnalysis();
+    if (encodeWorker.joinable()) {
+        encodeWorker.join();
+    }
 }
 
 void AIVisionAnalyzer::setConfig(const AISummaryConfig &newConfig) {
     config = newConfig;
 }
 
+void AIVisionAnalyzer::setRegionCropThreshold(double maxChangedFraction) {
+    regionCropThreshold = maxChangedFraction;
+}
+
+void AIVisionAnalyzer::setChangeMap(std::shared_ptr<TileChangeMap> map) {
+    sharedChangeMap = static_cast<bool>(map);
+    changeMap = map ? std::move(map) : std::make_shared<TileChangeMap>();
+}
+
 void AIVisionAnalyzer::analyzeImages(const QStringList &imagePaths) {
+    QList<EncodedFrame> frames;
+    for (const QString &path : imagePaths) {
+        if (QFileInfo::exists(path)) {
+            frames.append(EncodedFrame::fromFile(path, frames.size() + 1));
+        }
+    }
+    if (!imagePaths.isEmpty() && frames.isEmpty()) {
+        emit imageAnalysisFinished(false, "没有找到有效的图片文件");
+        return;
+    }
+    analyzeFrames(frames);
+}
+
+void AIVisionAnalyzer::analyzeFrames(const QList<EncodedFrame> &frames) {
     if (isAnalyzing) {
         emit imageAnalysisFinished(false, "已有分析任务在进行中");
         return;
@@ -49,7 +128,7 @@ void AIVisionAnalyzer::analyzeImages(const QStringList &imagePaths) {
         return;
     }
     
-    if (imagePaths.isEmpty()) {
+    if (frames.isEmpty()) {
         emit imageAnalysisFinished(false, "没有图片需要分析");
         return;
     }
@@ -58,15 +137,18 @@ void AIVisionAnalyzer::analyzeImages(const QStringList &imagePaths) {
     imageQueue.clear();
     analysisResults.clear();
     frameDescriptions.clear();
+    if (!sharedChangeMap) {
+        changeMap->reset();
+    }
     
-    for (const QString &path : imagePaths) {
-        if (QFileInfo::exists(path)) {
-            imageQueue.enqueue(path);
+    for (const EncodedFrame &frame : frames) {
+        if (frame.isValid()) {
+            imageQueue.enqueue(frame);
         }
     }
     
     if (imageQueue.isEmpty()) {
-        emit imageAnalysisFinished(false, "没有找到有效的图片文件");
+        emit imageAnalysisFinished(false, "没有有效的图片数据");
         return;
     }
     
@@ -109,16 +191,41 @@ void AIVisionAnalyzer::processNextImage() {
         return;
     }
     
-    QString imagePath = imageQueue.dequeue();
+    EncodedFrame frame = imageQueue.dequeue();
     currentImageIndex++;
     
     emit imageAnalysisProgress(currentImageIndex, totalImages);
     
-    qDebug() << "分析图片:" << imagePath << QString("(%1/%2)").arg(currentImageIndex).arg(totalImages);
+    qDebug() << "分析图片:" << frame.name() << QString("(%1/%2)").arg(currentImageIndex).arg(totalImages);
+    
+    // 缩小并按提供商字节预算重新编码，在后台线程完成后回到 onImageEncoded
+    startImageEncoding(frame);
+}
+
+void AIVisionAnalyzer::startImageEncoding(const EncodedFrame &frame) {
+    if (encodeWorker.joinable()) {
+        encodeWorker.join();
+    }
     
-    // 编码图片为base64
-    QString base64Image = encodeImageToBase64(imagePath);
-    if (base64Image.isEmpty()) {
+    const quint64 generation = encodeGeneration;
+    const AIImagePolicy policy = AIImageEncoder::policyForProvider(config.provider);
+    std::shared_ptr<TileChangeMap> map = changeMap;
+    const double cropThreshold = regionCropThreshold;
+    encodeWorker = std::thread([this, frame, policy, generation, map, cropThreshold]() {
+        const AIUploadImages upload = encodeForUpload(frame, policy, map.get(), cropThreshold);
+        const QString imagePath = frame.sourcePath.isEmpty() ? frame.name() : frame.sourcePath;
+        QMetaObject::invokeMethod(this, [this, imagePath, upload, generation]() {
+            // 编码期间分析已被取消（或开始了新一轮）时丢弃结果
+            if (generation != encodeGeneration || !isAnalyzing) {
+                return;
+            }
+            onImageEncoded(imagePath, upload);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AIVisionAnalyzer::onImageEncoded(const QString &imagePath, const AIUploadImages &upload) {
+    if (upload.image.isEmpty()) {
         FrameAnalysisResult result;
         result.imagePath = imagePath;
         result.success = false;
@@ -136,16 +243,16 @@ void AIVisionAnalyzer::processNextImage() {
     // 创建API请求
     QJsonObject requestBody;
     if (config.provider == "OpenAI") {
-        requestBody = createOpenAIRequest(base64Image);
+        requestBody = createOpenAIRequest(upload);
     } else if (config.provider == "硅基流动 (SiliconFlow)") {
-        requestBody = createSiliconFlowRequest(base64Image);
+        requestBody = createSiliconFlowRequest(upload);
     } else if (config.provider == "智谱AI (GLM)") {
-        requestBody = createGLMRequest(base64Image);
+        requestBody = createGLMRequest(upload);
     } else if (config.provider == "月之暗面 (Kimi)") {
-        requestBody = createKimiRequest(base64Image);
+        requestBody = createKimiRequest(upload);
     } else {
         // 默认使用OpenAI格式
-        requestBody = createOpenAIRequest(base64Image);
+        requestBody = createOpenAIRequest(upload);
     }
     
     // 发送请求
@@ -261,16 +368,6 @@ void AIVisionAnalyzer::onImageAnalysisReply() {
         analysisResults.append(result);
     }
     
-    // 分析完成后删除临时图片文件
-    QFile tempImageFile(imagePath);
-    if (tempImageFile.exists()) {
-        if (tempImageFile.remove()) {
-            qDebug() << QString("已删除临时图片文件: %1").arg(QFileInfo(imagePath).fileName());
-        } else {
-            qWarning() << QString("删除临时图片文件失败: %1").arg(imagePath);
-        }
-    }
-    
     currentReply->deleteLater();
     currentReply = nullptr;
     
@@ -738,16 +835,6 @@ void AIVisionAnalyzer::onNetworkTimeout() {
             analysisResults.append(result);
         }
         
-        // 超时时也删除临时图片文件
-        QFile tempImageFile(imagePath);
-        if (tempImageFile.exists()) {
-            if (tempImageFile.remove()) {
-                qDebug() << QString("已删除超时的临时图片文件: %1").arg(QFileInfo(imagePath).fileName());
-            } else {
-                qWarning() << QString("删除超时的临时图片文件失败: %1").arg(imagePath);
-            }
-        }
-        
         currentReply->deleteLater();
         currentReply = nullptr;
     }
@@ -756,17 +843,37 @@ void AIVisionAnalyzer::onNetworkTimeout() {
     QTimer::singleShot(1000, this, &AIVisionAnalyzer::processNextImage);
 }
 
-QString AIVisionAnalyzer::encodeImageToBase64(const QString &imagePath) const {
-    QFile file(imagePath);
-    if (!file.open(QIODevice::ReadOnly)) {
+QString AIVisionAnalyzer::regionPrompt(const AIUploadImages &upload) const {
+    if (!upload.isRegionCrop()) {
         return QString();
     }
+    return QString("\n注意：第一张图片只是屏幕上自上一次分析以来发生变化的区域"
+                   "（整屏 %1x%2 中位于 (%3,%4)、大小 %5x%6 的部分），第二张是整屏缩略图，"
+                   "仅用于判断该区域属于哪个窗口或应用。请重点描述变化区域中的内容与操作。")
+           .arg(upload.screenSize.width()).arg(upload.screenSize.height())
+           .arg(upload.region.x()).arg(upload.region.y())
+           .arg(upload.region.width()).arg(upload.region.height());
+}
+
+void AIVisionAnalyzer::appendImageContents(QJsonArray &content, const AIUploadImages &upload) const {
+    QList<QByteArray> images;
+    images << upload.image;
+    if (upload.isRegionCrop()) {
+        images << upload.thumbnail;
+    }
     
-    QByteArray imageData = file.readAll();
-    return imageData.toBase64();
+    for (const QByteArray &image : images) {
+        QJsonObject imageContent;
+        imageContent["type"] = "image_url";
+        
+        QJsonObject imageUrl;
+        imageUrl["url"] = QString("data:image/jpeg;base64,%1").arg(QString::fromLatin1(image.toBase64()));
+        imageContent["image_url"] = imageUrl;
+        content.append(imageContent);
+    }
 }
 
-QJsonObject AIVisionAnalyzer::createOpenAIRequest(const QString &base64Image) const {
+QJsonObject AIVisionAnalyzer::createOpenAIRequest(const AIUploadImages &upload) const {
     QJsonObject requestBody;
     QJsonArray messages;
     
@@ -787,17 +894,11 @@ QJsonObject AIVisionAnalyzer::createOpenAIRequest(const QString &base64Image) co
         prompt = "请详细描述这张图片中的内容，包括场景、物体、人物行为和任何重要细节。用中文回答。";
     }
     
-    textContent["text"] = prompt;
+    textContent["text"] = prompt + regionPrompt(upload);
     content.append(textContent);
     
     // 图片内容
-    QJsonObject imageContent;
-    imageContent["type"] = "image_url";
-    
-    QJsonObject imageUrl;
-    imageUrl["url"] = QString("data:image/jpeg;base64,%1").arg(base64Image);
-    imageContent["image_url"] = imageUrl;
-    content.append(imageContent);
+    appendImageContents(content, upload);
     
     message["content"] = content;
     messages.append(message);
@@ -810,12 +911,12 @@ QJsonObject AIVisionAnalyzer::createOpenAIRequest(const QString &base64Image) co
     return requestBody;
 }
 
-QJsonObject AIVisionAnalyzer::createSiliconFlowRequest(const QString &base64Image) const {
+QJsonObject AIVisionAnalyzer::createSiliconFlowRequest(const AIUploadImages &upload) const {
     // 硅基流动使用类似OpenAI的格式
-    return createOpenAIRequest(base64Image);
+    return createOpenAIRequest(upload);
 }
 
-QJsonObject AIVisionAnalyzer::createGLMRequest(const QString &base64Image) const {
+QJsonObject AIVisionAnalyzer::createGLMRequest(const AIUploadImages &upload) const {
     QJsonObject requestBody;
     QJsonArray messages;
     
@@ -827,17 +928,12 @@ QJsonObject AIVisionAnalyzer::createGLMRequest(const QString &base64Image) const
     // 文本内容
     QJsonObject textContent;
     textContent["type"] = "text";
-    textContent["text"] = "请详细描述这张图片中的内容，包括场景、物体、人物行为和任何重要细节。用中文回答。";
+    textContent["text"] = "请详细描述这张图片中的内容，包括场景、物体、人物行为和任何重要细节。用中文回答。"
+                          + regionPrompt(upload);
     content.append(textContent);
     
     // 图片内容
-    QJsonObject imageContent;
-    imageContent["type"] = "image_url";
-    
-    QJsonObject imageUrl;
-    imageUrl["url"] = QString("data:image/jpeg;base64,%1").arg(base64Image);
-    imageContent["image_url"] = imageUrl;
-    content.append(imageContent);
+    appendImageContents(content, upload);
     
     message["content"] = content;
     messages.append(message);
@@ -850,9 +946,9 @@ QJsonObject AIVisionAnalyzer::createGLMRequest(const QString &base64Image) const
     return requestBody;
 }
 
-QJsonObject AIVisionAnalyzer::createKimiRequest(const QString &base64Image) const {
+QJsonObject AIVisionAnalyzer::createKimiRequest(const AIUploadImages &upload) const {
     // Kimi使用类似OpenAI的格式
-    return createOpenAIRequest(base64Image);
+    return createOpenAIRequest(upload);
 }
 
 QNetworkRequest AIVisionAnalyzer::createNetworkRequest(const QString &endpoint) const {
@@ -954,42 +1050,16 @@ QString AIVisionAnalyzer::parseKimiResponse(const QJsonObject &response) const {
 
 void AIVisionAnalyzer::cancelAnalysis() {
     if (currentReply) {
-        // 获取当前正在处理的图片路径
-        QString currentImagePath = currentReply->property("imagePath").toString();
-        
         currentReply->abort();
         currentReply->deleteLater();
         currentReply = nullptr;
-        
-        // 删除当前正在处理的图片文件
-        if (!currentImagePath.isEmpty()) {
-            QFile tempImageFile(currentImagePath);
-            if (tempImageFile.exists()) {
-                if (tempImageFile.remove()) {
-                    qDebug() << QString("已删除取消分析的临时图片文件: %1").arg(QFileInfo(currentImagePath).fileName());
-                } else {
-                    qWarning() << QString("删除取消分析的临时图片文件失败: %1").arg(currentImagePath);
-                }
-            }
-        }
     }
     
     timeoutTimer->stop();
     isAnalyzing = false;
+    ++encodeGeneration;
     
-    // 清理队列中剩余的图片文件
-    while (!imageQueue.isEmpty()) {
-        QString imagePath = imageQueue.dequeue();
-        QFile tempImageFile(imagePath);
-        if (tempImageFile.exists()) {
-            if (tempImageFile.remove()) {
-                qDebug() << QString("已删除队列中的临时图片文件: %1").arg(QFileInfo(imagePath).fileName());
-            } else {
-                qWarning() << QString("删除队列中的临时图片文件失败: %1").arg(imagePath);
-            }
-        }
-    }
-    
+    // 队列中的帧为内存数据，清空即释放
     imageQueue.clear();
 }
 
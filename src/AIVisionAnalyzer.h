@@ -8,7 +8,15 @@
 #include <QQueue>
 #include <QTimer>
 #include <QMutex>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <memory>
+#include <thread>
 #include "AISummaryConfigDialog.h"
+#include "AIImageEncoder.h"
+#include "EncodedFrame.h"
+
+class TileChangeMap;
 
 struct FrameAnalysisResult {
     QString imagePath;
@@ -30,12 +38,22 @@ public:
     // 设置AI配置
     void setConfig(const AISummaryConfig &config);
     
-    // 分析图片列表
+    // 分析图片文件列表
     void analyzeImages(const QStringList &imagePaths);
     
+    // 分析内存中的已编码帧（不经过磁盘）
+    void analyzeFrames(const QList<EncodedFrame> &frames);
+    
     // 获取分析结果
     QList<FrameAnalysisResult> getResults() const;
     
+    // 变化区域裁剪：与上一张分析过的图片逐块比较，变化区域外接矩形占整屏比例不超过阈值时
+    // 只上传该区域和整屏缩略图（阈值 <= 0 关闭）
+    void setRegionCropThreshold(double maxChangedFraction);
+    
+    // 使用外部的变化图（多个分析器依次分析同一画面序列时共享参考帧），传 nullptr 恢复自有变化图
+    void setChangeMap(std::shared_ptr<TileChangeMap> map);
+    
     // 取消当前分析
     void cancelAnalysis();
     
@@ -55,11 +73,15 @@ private slots:
     void onNetworkTimeout();
     
 private:
-    QString encodeImageToBase64(const QString &imagePath) const;
-    QJsonObject createOpenAIRequest(const QString &base64Image) const;
-    QJsonObject createSiliconFlowRequest(const QString &base64Image) const;
-    QJsonObject createGLMRequest(const QString &base64Image) const;
-    QJsonObject createKimiRequest(const QString &base64Image) const;
+    // 在后台线程缩小并编码图片，完成后在 GUI 线程调用 onImageEncoded
+    void startImageEncoding(const EncodedFrame &frame);
+    void onImageEncoded(const QString &imagePath, const AIUploadImages &upload);
+    QJsonObject createOpenAIRequest(const AIUploadImages &upload) const;
+    QJsonObject createSiliconFlowRequest(const AIUploadImages &upload) const;
+    QJsonObject createGLMRequest(const AIUploadImages &upload) const;
+    QJsonObject createKimiRequest(const AIUploadImages &upload) const;
+    QString regionPrompt(const AIUploadImages &upload) const;
+    void appendImageContents(QJsonArray &content, const AIUploadImages &upload) const;
     QNetworkRequest createNetworkRequest(const QString &endpoint) const;
     QString parseOpenAIResponse(const QJsonObject &response) const;
     QString parseSiliconFlowResponse(const QJsonObject &response) const;
@@ -75,7 +97,7 @@ private:
     AISummaryConfig config;
     
     // 图片分析队列
-    QQueue<QString> imageQueue;
+    QQueue<EncodedFrame> imageQueue;
     QList<FrameAnalysisResult> analysisResults;
     QNetworkReply *currentReply;
     QTimer *timeoutTimer;
@@ -94,10 +116,20 @@ private:
     int totalImages;
     QMutex resultsMutex;
     
+    // 图片编码线程；每次取消分析递增代数，使已在途的编码结果作废
+    std::thread encodeWorker;
+    quint64 encodeGeneration;
+    
+    // 变化区域裁剪（变化图只在编码线程中更新）
+    std::shared_ptr<TileChangeMap> changeMap;
+    bool sharedChangeMap;
+    double regionCropThreshold;
+    
     // 请求限制
     static const int MAX_CONCURRENT_REQUESTS = 1; // 避免API限制
     static const int REQUEST_TIMEOUT_MS = 180000; // 180秒超时 (thinking模型需要更长时间)
     static const int RETRY_DELAY_MS = 2000; // 重试延迟
+    static constexpr double DEFAULT_REGION_CROP_THRESHOLD = 0.4; // 变化区域不超过整屏 40% 时裁剪上传
 };
 
 #endif // AIVISIONANALYZER_H
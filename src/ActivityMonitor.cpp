@@ -0,0 +1,179 @@
+#include "ActivityMonitor.h"
+#include <QDateTime>
+#include <QDebug>
+
+#if defined(PLATFORM_LINUX) && defined(HAVE_XSS)
+#include <X11/Xlib.h>
+#include <X11/extensions/scrnsaver.h>
+#elif defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+ActivityMonitor::ActivityMonitor(QObject *parent)
+    : QObject(parent)
+    , pollTimer(new QTimer(this))
+    , idleThresholdMs(120 * 1000)
+    , idle(false)
+    , idleSinceMs(0)
+    , display(nullptr)
+{
+    connect(pollTimer, &QTimer::timeout, this, &ActivityMonitor::poll);
+    pollTimer->setInterval(ACTIVE_POLL_INTERVAL_MS);
+}
+
+ActivityMonitor::~ActivityMonitor() {
+    stop();
+}
+
+void ActivityMonitor::setIdleThresholdSeconds(int seconds) {
+    idleThresholdMs = qMax(1, seconds) * 1000;
+}
+
+void ActivityMonitor::start() {
+    if (pollTimer->isActive()) {
+        return;
+    }
+    openDisplay();
+    if (!isSupported()) {
+        qDebug() << "当前平台不支持空闲检测，录制期间不会自动暂停";
+        return;
+    }
+    idle = false;
+    idleSinceMs = 0;
+    pollTimer->setInterval(ACTIVE_POLL_INTERVAL_MS);
+    pollTimer->start();
+}
+
+void ActivityMonitor::stop() {
+    // 只复位状态、不发信号：停止时仍空闲的区间由调用方在 stop 前按 idleSince 收尾，
+    // 否则补发的恢复信号会在录制结束时重新启动取样
+    pollTimer->stop();
+    idle = false;
+    closeDisplay();
+}
+
+bool ActivityMonitor::isIdle() const {
+    return idle;
+}
+
+qint64 ActivityMonitor::idleSince() const {
+    return idleSinceMs;
+}
+
+bool ActivityMonitor::isSupported() const {
+#if defined(PLATFORM_LINUX) && defined(HAVE_XSS)
+    return display != nullptr;
+#elif defined(PLATFORM_WINDOWS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ActivityMonitor::poll() {
+    const qint64 idleMs = queryIdleMs();
+    if (idleMs < 0) {
+        return;
+    }
+    const bool locked = queryLocked();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if (!idle && (locked || idleMs >= idleThresholdMs)) {
+        idle = true;
+        idleSinceMs = now - idleMs;
+        pollTimer->setInterval(IDLE_POLL_INTERVAL_MS);
+        qDebug() << "检测到用户空闲" << (locked ? "(锁屏)" : "") << "已无输入" << idleMs / 1000 << "秒";
+        emit idleStarted(idleSinceMs, locked);
+    } else if (idle && !locked && idleMs + IDLE_POLL_INTERVAL_MS < now - idleSinceMs) {
+        // 系统空闲时长明显短于自最后一次输入以来的时长，说明期间有了新输入
+        idle = false;
+        pollTimer->setInterval(ACTIVE_POLL_INTERVAL_MS);
+        qDebug() << "用户恢复活动，空闲" << (now - idleSinceMs) / 1000 << "秒";
+        emit activityResumed(idleSinceMs, now);
+    }
+}
+
+qint64 ActivityMonitor::queryIdleMs() {
+#if defined(PLATFORM_LINUX) && defined(HAVE_XSS)
+    if (!display) {
+        return -1;
+    }
+    XScreenSaverInfo *info = XScreenSaverAllocInfo();
+    if (!info) {
+        return -1;
+    }
+    qint64 idleMs = -1;
+    if (XScreenSaverQueryInfo(static_cast<Display *>(display),
+                              DefaultRootWindow(static_cast<Display *>(display)), info)) {
+        idleMs = static_cast<qint64>(info->idle);
+    }
+    XFree(info);
+    return idleMs;
+#elif defined(PLATFORM_WINDOWS)
+    LASTINPUTINFO info;
+    info.cbSize = sizeof(info);
+    if (!GetLastInputInfo(&info)) {
+        return -1;
+    }
+    // 两者都是 32 位毫秒计数，无符号相减可正确处理回绕
+    return static_cast<qint64>(static_cast<DWORD>(GetTickCount() - info.dwTime));
+#else
+    return -1;
+#endif
+}
+
+bool ActivityMonitor::queryLocked() {
+#if defined(PLATFORM_LINUX) && defined(HAVE_XSS)
+    if (!display) {
+        return false;
+    }
+    XScreenSaverInfo *info = XScreenSaverAllocInfo();
+    if (!info) {
+        return false;
+    }
+    bool locked = false;
+    if (XScreenSaverQueryInfo(static_cast<Display *>(display),
+                              DefaultRootWindow(static_cast<Display *>(display)), info)) {
+        // 屏保或锁屏程序激活时服务器状态为 ScreenSaverOn
+        locked = info->state == ScreenSaverOn;
+    }
+    XFree(info);
+    return locked;
+#elif defined(PLATFORM_WINDOWS)
+    // 锁屏时输入桌面切换到安全桌面（Winlogon），普通进程无法打开
+    HDESK desktop = OpenInputDesktop(0, FALSE, DESKTOP_SWITCHDESKTOP);
+    if (!desktop) {
+        return true;
+    }
+    const bool locked = !SwitchDesktop(desktop);
+    CloseDesktop(desktop);
+    return locked;
+#else
+    return false;
+#endif
+}
+
+void ActivityMonitor::openDisplay() {
+#if defined(PLATFORM_LINUX) && defined(HAVE_XSS)
+    if (display) {
+        return;
+    }
+    Display *x11 = XOpenDisplay(nullptr);
+    int eventBase = 0, errorBase = 0;
+    if (x11 && !XScreenSaverQueryExtension(x11, &eventBase, &errorBase)) {
+        qWarning() << "X 服务器不支持 MIT-SCREEN-SAVER 扩展，无法检测空闲";
+        XCloseDisplay(x11);
+        x11 = nullptr;
+    }
+    display = x11;
+#endif
+}
+
+void ActivityMonitor::closeDisplay() {
+#if defined(PLATFORM_LINUX) && defined(HAVE_XSS)
+    if (display) {
+        XCloseDisplay(static_cast<Display *>(display));
+        display = nullptr;
+    }
+#endif
+}
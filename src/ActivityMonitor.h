@@ -0,0 +1,59 @@
+#ifndef ACTIVITYMONITOR_H
+#define ACTIVITYMONITOR_H
+
+#include <QObject>
+#include <QTimer>
+
+/**
+ * 用户活动监视器 - 定期查询系统输入空闲时长和锁屏状态
+ * Linux 使用 XScreenSaver 扩展（屏保/锁屏激活时视为锁定），Windows 使用 GetLastInputInfo
+ * 和输入桌面切换判断锁屏；其他平台不支持，始终视为活动
+ * 空闲期间提高查询频率，用户一有输入即可立即恢复
+ */
+class ActivityMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ActivityMonitor(QObject *parent = nullptr);
+    ~ActivityMonitor();
+
+    // 无输入超过该时长视为空闲（锁屏时立即视为空闲）
+    void setIdleThresholdSeconds(int seconds);
+
+    void start();
+    // 停止查询并复位空闲状态，不发出 activityResumed
+    void stop();
+
+    bool isIdle() const;
+    // 当前空闲区间的起点（最后一次输入的时刻），仅 isIdle() 时有效
+    qint64 idleSince() const;
+    bool isSupported() const;
+
+signals:
+    // 进入空闲：idleSinceMs 为最后一次输入的时刻（毫秒时间戳），locked 表示因锁屏/屏保进入
+    void idleStarted(qint64 idleSinceMs, bool locked);
+
+    // 恢复活动：idleSinceMs 与 idleStarted 中一致，resumedAtMs 为检测到输入的时刻
+    void activityResumed(qint64 idleSinceMs, qint64 resumedAtMs);
+
+private slots:
+    void poll();
+
+private:
+    // 查询系统输入空闲毫秒数，失败返回 -1
+    qint64 queryIdleMs();
+    bool queryLocked();
+    void openDisplay();
+    void closeDisplay();
+
+    QTimer *pollTimer;
+    int idleThresholdMs;
+    bool idle;
+    qint64 idleSinceMs;
+    void *display; // Linux 下为 X Display*，头文件不引入 Xlib
+
+    static const int ACTIVE_POLL_INTERVAL_MS = 1000;
+    static const int IDLE_POLL_INTERVAL_MS = 200;
+};
+
+#endif // ACTIVITYMONITOR_H
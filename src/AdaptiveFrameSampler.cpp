@@ -0,0 +1,184 @@
+#include "AdaptiveFrameSampler.h"
+#include "FrameScaler.h"
+#include "PixelConverter.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 亮度差超过该值的格子才算变化，滤掉 JPEG 噪声与抗锯齿抖动
+const int CELL_NOISE_LEVEL = 10;
+
+// 语音起点超过该时长仍未能采样（受最小间隔/预算限制）时放弃
+const double SPEECH_ONSET_MAX_AGE_SECONDS = 5.0;
+
+} // namespace
+
+AdaptiveFrameSampler::AdaptiveFrameSampler()
+    : AdaptiveFrameSampler(Config())
+{
+}
+
+AdaptiveFrameSampler::AdaptiveFrameSampler(const Config& config)
+    : cfg(config)
+    , lastSampleTime(0.0)
+    , lastRefillTime(0.0)
+    , tokens(0.0)
+    , speechOnsetTime(0.0)
+    , speechOnsetPending(false)
+    , hasReference(false)
+{
+    reset();
+}
+
+void AdaptiveFrameSampler::setConfig(const Config& config) {
+    cfg = config;
+    tokens = std::min(tokens, static_cast<double>(std::max(1, cfg.burstFrames)));
+}
+
+const AdaptiveFrameSampler::Config& AdaptiveFrameSampler::config() const {
+    return cfg;
+}
+
+void AdaptiveFrameSampler::reset() {
+    reference.clear();
+    hasReference = false;
+    lastSampleTime = 0.0;
+    lastRefillTime = 0.0;
+    tokens = std::max(1, cfg.burstFrames);
+    speechOnsetTime = 0.0;
+    speechOnsetPending = false;
+    counters = Stats();
+}
+
+void AdaptiveFrameSampler::markSpeechOnset(double timestamp) {
+    if (!cfg.speechOnsetTrigger) {
+        return;
+    }
+    speechOnsetTime = timestamp;
+    speechOnsetPending = true;
+}
+
+AdaptiveFrameSampler::Stats AdaptiveFrameSampler::stats() const {
+    return counters;
+}
+
+const char* AdaptiveFrameSampler::reasonName(Reason reason) {
+    switch (reason) {
+    case Reason::First: return "first";
+    case Reason::SceneChange: return "scene-change";
+    case Reason::MaxInterval: return "max-interval";
+    case Reason::SpeechOnset: return "speech-onset";
+    default: return "none";
+    }
+}
+
+bool AdaptiveFrameSampler::makeProxy(const FrameData& frame, std::vector<uint8_t>& proxy) const {
+    // 面积平均缩小到固定网格并取亮度；RGB 源缩放与亮度转换融合为一趟
+    static const PixelConverter converter;
+    const PixelFormat proxyFormat = pixelFormatIsYuv(frame.format) ? frame.format : PixelFormat::YUV420P;
+    FrameData grid;
+    if (!grid.allocateImage(PROXY_WIDTH, PROXY_HEIGHT, proxyFormat) ||
+        !FrameScaler::scaleConvert(frame, grid, ScaleFilter::Box, converter)) {
+        return false;
+    }
+
+    proxy.resize(static_cast<size_t>(PROXY_WIDTH) * PROXY_HEIGHT);
+    for (int y = 0; y < PROXY_HEIGHT; ++y) {
+        std::copy_n(grid.plane(0) + static_cast<size_t>(y) * grid.planeStride(0), PROXY_WIDTH,
+                    proxy.begin() + static_cast<size_t>(y) * PROXY_WIDTH);
+    }
+    return true;
+}
+
+double AdaptiveFrameSampler::changeRatio(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    const size_t count = std::min(a.size(), b.size());
+    if (count == 0) {
+        return 1.0;
+    }
+    size_t changed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        changed += std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])) > CELL_NOISE_LEVEL;
+    }
+    return static_cast<double>(changed) / count;
+}
+
+void AdaptiveFrameSampler::refillTokens(double timestamp) {
+    const double capacity = std::max(1, cfg.burstFrames);
+    if (timestamp > lastRefillTime) {
+        tokens = std::min(capacity, tokens + (timestamp - lastRefillTime) * cfg.maxFramesPerMinute / 60.0);
+    }
+    lastRefillTime = std::max(lastRefillTime, timestamp);
+}
+
+bool AdaptiveFrameSampler::budgetAvailable(double timestamp) const {
+    if (cfg.totalFrameBudget <= 0) {
+        return true;
+    }
+    const uint64_t spent = counters.samples - counters.forcedSamples;
+    double allowance = cfg.totalFrameBudget;
+    if (cfg.durationSeconds > 0.0) {
+        // 到 timestamp 为止只放开按时长比例的份额，另加突发余量
+        const double elapsed = std::min(1.0, std::max(0.0, timestamp / cfg.durationSeconds));
+        allowance = std::min(allowance, cfg.totalFrameBudget * elapsed + std::max(1, cfg.burstFrames));
+    }
+    return static_cast<double>(spent) < allowance;
+}
+
+AdaptiveFrameSampler::Decision AdaptiveFrameSampler::offer(const FrameData& frame, double timestamp) {
+    Decision decision;
+    if (!makeProxy(frame, current)) {
+        return decision;
+    }
+    counters.probes++;
+    refillTokens(timestamp);
+
+    const bool budgetLeft = budgetAvailable(timestamp);
+    if (speechOnsetPending && timestamp - speechOnsetTime > SPEECH_ONSET_MAX_AGE_SECONDS) {
+        speechOnsetPending = false;
+    }
+    const bool speechOnset = speechOnsetPending && timestamp >= speechOnsetTime;
+    if (!hasReference) {
+        decision.change = 1.0;
+        decision.reason = Reason::First;
+    } else {
+        decision.change = changeRatio(current, reference);
+        const double sinceLast = timestamp - lastSampleTime;
+        const bool allowed = budgetLeft && sinceLast >= cfg.minIntervalSeconds && tokens >= 1.0;
+        if (sinceLast >= cfg.maxIntervalSeconds) {
+            // 长时间无变化时仍需定期采样，时间线上不能留下大段空白；不受预算限制
+            decision.reason = Reason::MaxInterval;
+        } else if (decision.change >= cfg.changeThreshold) {
+            if (allowed) {
+                decision.reason = Reason::SceneChange;
+            } else {
+                counters.budgetLimited++;
+            }
+        } else if (speechOnset && allowed) {
+            decision.reason = Reason::SpeechOnset;
+        }
+    }
+
+    if (decision.reason == Reason::None) {
+        return decision;
+    }
+
+    // 任何原因的采样都覆盖了此前的语音起点
+    if (speechOnset) {
+        speechOnsetPending = false;
+    }
+    decision.sample = true;
+    reference.swap(current);
+    hasReference = true;
+    lastSampleTime = timestamp;
+    tokens = std::max(0.0, tokens - 1.0);
+    counters.samples++;
+    if (decision.reason == Reason::SceneChange) {
+        counters.sceneChanges++;
+    } else if (decision.reason == Reason::MaxInterval) {
+        counters.forcedSamples++;
+    } else if (decision.reason == Reason::SpeechOnset) {
+        counters.speechSamples++;
+    }
+    return decision;
+}
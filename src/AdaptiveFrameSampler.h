@@ -0,0 +1,95 @@
+#ifndef ADAPTIVEFRAMESAMPLER_H
+#define ADAPTIVEFRAMESAMPLER_H
+
+#include "DataTypes.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * 自适应帧采样器 - 按画面变化决定是否把探测帧交给 AI 分析
+ * 每个探测帧缩小为低分辨率亮度代理图，与上一个采样帧逐格比较，变化格子比例超过阈值视为场景变化；
+ * 采样间隔限制在 [minInterval, maxInterval] 内，频率再由令牌桶（每分钟帧数 + 突发上限）和整段帧数预算约束
+ * 帧预算只约束变化驱动的采样，最大间隔的定期采样不占预算；已知素材时长时预算按时间均摊，
+ * 开头的密集变化不会把预算用完、让后面整段没有采样
+ * 语音起点（markSpeechOnset）是额外的采样触发：画面没有明显变化时，起点之后的下一个探测帧也会被采样，
+ * 但与场景变化共用最小间隔、令牌桶与预算，不会提高基础采样频率
+ * 实时提取与录制后提取共用同一个采样器，只是探测帧的来源不同
+ */
+class AdaptiveFrameSampler {
+public:
+    struct Config {
+        double probeIntervalSeconds = 2.0;  // 探测帧间隔（由调用方按此间隔送入帧）
+        double minIntervalSeconds = 2.0;    // 两次采样之间的最小间隔
+        double maxIntervalSeconds = 30.0;   // 画面不变时也至少按此间隔采样一次
+        double changeThreshold = 0.06;      // 变化格子比例阈值（0~1）
+        double maxFramesPerMinute = 6.0;    // 令牌桶补充速率
+        int burstFrames = 4;                // 令牌桶容量（连续场景变化时允许的突发帧数）
+        int totalFrameBudget = 0;           // 整段变化驱动采样的帧数上限（0 不限，不含最大间隔采样）
+        double durationSeconds = 0.0;       // 素材总时长（>0 时预算按已过时长比例逐步放开）
+        bool speechOnsetTrigger = true;     // 语音起点是否触发采样
+    };
+
+    enum class Reason {
+        None,           // 未采样
+        First,          // 第一帧
+        SceneChange,    // 画面变化超过阈值
+        MaxInterval,    // 距上次采样已达最大间隔
+        SpeechOnset     // 语音起点
+    };
+
+    struct Decision {
+        bool sample = false;
+        Reason reason = Reason::None;
+        double change = 0.0;    // 与上一采样帧相比的变化格子比例
+    };
+
+    struct Stats {
+        uint64_t probes = 0;            // 送入的探测帧数
+        uint64_t samples = 0;           // 采样帧数
+        uint64_t sceneChanges = 0;      // 因场景变化采样的帧数
+        uint64_t forcedSamples = 0;     // 因最大间隔采样的帧数
+        uint64_t speechSamples = 0;     // 因语音起点采样的帧数
+        uint64_t budgetLimited = 0;     // 画面变化但受预算/最小间隔限制而未采样的次数
+    };
+
+    AdaptiveFrameSampler();
+    explicit AdaptiveFrameSampler(const Config& config);
+
+    void setConfig(const Config& config);
+    const Config& config() const;
+
+    // 清空参考帧与统计，下一帧视为第一帧
+    void reset();
+
+    // 送入一帧探测帧（timestamp 为秒，单调递增），返回是否采样
+    Decision offer(const FrameData& frame, double timestamp);
+
+    // 记录一次语音起点（timestamp 与 offer 同一时间轴），在之后的探测帧上尝试采样
+    void markSpeechOnset(double timestamp);
+
+    Stats stats() const;
+
+    static const char* reasonName(Reason reason);
+
+private:
+    static const int PROXY_WIDTH = 64;
+    static const int PROXY_HEIGHT = 36;
+
+    bool makeProxy(const FrameData& frame, std::vector<uint8_t>& proxy) const;
+    static double changeRatio(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b);
+    void refillTokens(double timestamp);
+    bool budgetAvailable(double timestamp) const;
+
+    Config cfg;
+    std::vector<uint8_t> reference;     // 上一采样帧的亮度代理图
+    std::vector<uint8_t> current;
+    double lastSampleTime;
+    double lastRefillTime;
+    double tokens;
+    double speechOnsetTime;
+    bool speechOnsetPending;
+    bool hasReference;
+    Stats counters;
+};
+
+#endif // ADAPTIVEFRAMESAMPLER_H
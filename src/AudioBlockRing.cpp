@@ -0,0 +1,87 @@
+#include "AudioBlockRing.h"
+#include <algorithm>
+#include <iostream>
+
+AudioBlockRing::AudioBlockRing()
+    : framesPerBlock(0)
+    , channels(0)
+    , writeIndex(0)
+    , readIndex(0)
+    , overrunCount(0)
+    , underrunCount(0)
+{
+}
+
+bool AudioBlockRing::configure(int blockCount, int blockFrames, int channelCount) {
+    if (blockCount < 2 || blockFrames <= 0 || channelCount <= 0) {
+        std::cerr << "音频块队列参数无效: " << blockCount << " 块 x " << blockFrames
+                  << " 帧, 声道数 " << channelCount << std::endl;
+        return false;
+    }
+    framesPerBlock = blockFrames;
+    channels = channelCount;
+    const size_t blockSamples = static_cast<size_t>(blockFrames) * channelCount;
+    storage.assign(blockSamples * blockCount, 0);
+    blocks.assign(blockCount, Block());
+    for (int i = 0; i < blockCount; ++i) {
+        blocks[i].samples = storage.data() + blockSamples * i;
+    }
+    clear();
+    return true;
+}
+
+AudioBlockRing::Block* AudioBlockRing::beginWrite() {
+    if (blocks.empty()) {
+        return nullptr;
+    }
+    // 只有生产者写 writeIndex，读自己的下标无需同步；acquire 读对方下标，保证消费者已用完该槽位
+    const uint64_t write = writeIndex.load(std::memory_order_relaxed);
+    if (write - readIndex.load(std::memory_order_acquire) >= blocks.size()) {
+        overrunCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &blocks[write % blocks.size()];
+}
+
+void AudioBlockRing::commitWrite() {
+    // release 保证块内容先于下标对消费者可见
+    writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+const AudioBlockRing::Block* AudioBlockRing::beginRead() {
+    if (blocks.empty()) {
+        return nullptr;
+    }
+    const uint64_t read = readIndex.load(std::memory_order_relaxed);
+    if (read == writeIndex.load(std::memory_order_acquire)) {
+        underrunCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &blocks[read % blocks.size()];
+}
+
+void AudioBlockRing::endRead() {
+    readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+int AudioBlockRing::readableBlocks() const {
+    const uint64_t read = readIndex.load(std::memory_order_acquire);
+    const uint64_t write = writeIndex.load(std::memory_order_acquire);
+    return write > read ? static_cast<int>(std::min<uint64_t>(write - read, blocks.size())) : 0;
+}
+
+void AudioBlockRing::clear() {
+    writeIndex.store(0, std::memory_order_relaxed);
+    readIndex.store(0, std::memory_order_relaxed);
+    overrunCount.store(0, std::memory_order_relaxed);
+    underrunCount.store(0, std::memory_order_relaxed);
+}
+
+AudioBlockRing::Stats AudioBlockRing::stats() const {
+    Stats result;
+    result.writtenBlocks = writeIndex.load(std::memory_order_relaxed);
+    result.readBlocks = readIndex.load(std::memory_order_relaxed);
+    result.overruns = overrunCount.load(std::memory_order_relaxed);
+    result.underruns = underrunCount.load(std::memory_order_relaxed);
+    return result;
+}
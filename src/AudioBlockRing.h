@@ -0,0 +1,68 @@
+#ifndef AUDIOBLOCKRING_H
+#define AUDIOBLOCKRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 音频块环形队列 - 单生产者/单消费者，块在 configure 时一次性预分配
+ * 生产者（采集线程）与消费者各自只推进自己的下标，读写都是若干次原子读写，无锁、无等待、不分配内存
+ * 队列满时生产者拿不到空块（记一次溢出，由调用方丢弃该块），队列空时消费者拿不到数据（记一次欠载）
+ * 样本为交错 16 位整数，每块容量固定为 blockFrames 帧
+ */
+class AudioBlockRing {
+public:
+    struct Block {
+        int16_t* samples = nullptr;
+        int frames = 0;             // 有效帧数（不超过 blockFrames）
+        uint64_t timestamp = 0;     // 第一帧的采集时刻（微秒，单调时钟）
+    };
+
+    struct Stats {
+        uint64_t writtenBlocks = 0; // 生产者提交的块数
+        uint64_t readBlocks = 0;    // 消费者取走的块数
+        uint64_t overruns = 0;      // 队列满、生产者丢弃的块数
+        uint64_t underruns = 0;     // 队列空、消费者未取到数据的次数
+    };
+
+    AudioBlockRing();
+
+    // 分配 blockCount 个块并清空队列；不是线程安全的，须在生产者与消费者都停止时调用
+    bool configure(int blockCount, int blockFrames, int channels);
+
+    int blockFrames() const { return framesPerBlock; }
+    int channelCount() const { return channels; }
+    int capacity() const { return static_cast<int>(blocks.size()); }
+
+    // 生产者：取得下一个空块（满时返回 nullptr 并计入溢出），填好后 commitWrite 发布
+    Block* beginWrite();
+    void commitWrite();
+
+    // 消费者：取得最早的一块（空时返回 nullptr 并计入欠载），用完后 endRead 归还
+    const Block* beginRead();
+    void endRead();
+
+    // 当前可读的块数（另一侧并发推进时只是近似值）
+    int readableBlocks() const;
+
+    // 丢弃未读数据；与 configure 一样须在两侧都停止时调用
+    void clear();
+
+    Stats stats() const;
+
+private:
+    std::vector<int16_t> storage;
+    std::vector<Block> blocks;
+    int framesPerBlock;
+    int channels;
+
+    // 读写下标单调递增，取模得到槽位；分别由消费者与生产者独占写入，放在不同缓存行避免伪共享
+    alignas(64) std::atomic<uint64_t> writeIndex;
+    alignas(64) std::atomic<uint64_t> readIndex;
+    alignas(64) std::atomic<uint64_t> overrunCount;
+    std::atomic<uint64_t> underrunCount;
+};
+
+#endif // AUDIOBLOCKRING_H
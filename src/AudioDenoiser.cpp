@@ -0,0 +1,446 @@
+#include "AudioDenoiser.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// FFT 尺寸范围（10ms 分析窗在 8k~192k 采样率下均落在其中）
+const int MIN_FFT_SIZE = 64;
+const int MAX_FFT_SIZE = 4096;
+
+// 默认分析窗长度（秒），取不小于该长度的 2 的幂
+const double DEFAULT_WINDOW_SECONDS = 0.01;
+
+// FFT 表缓存上限（尺寸数），超过后整体清空重建
+const size_t MAX_CACHED_PLANS = 8;
+
+// 防止静音频点除零
+const float POWER_EPSILON = 1e-12f;
+
+struct GateParams {
+    float powerSmoothing;
+    float noiseRise;
+    float overSubtraction;
+    float gainFloor;
+    float gainSmoothing;
+};
+
+// 每个频点：功率平滑 -> 噪声底最小值跟踪（缓慢上升）-> 谱减增益 -> 增益平滑
+void gateBinsScalar(const float *re, const float *im, float *power, float *noise, float *gain,
+                    int count, const GateParams &p) {
+    for (int k = 0; k < count; ++k) {
+        const float instant = re[k] * re[k] + im[k] * im[k];
+        const float smoothed = p.powerSmoothing * power[k] + (1.0f - p.powerSmoothing) * instant;
+        const float floorLevel = std::min(smoothed, noise[k] * p.noiseRise);
+        const float target = std::max(p.gainFloor,
+                                      1.0f - p.overSubtraction * floorLevel / std::max(smoothed, POWER_EPSILON));
+        power[k] = smoothed;
+        noise[k] = floorLevel;
+        gain[k] = p.gainSmoothing * gain[k] + (1.0f - p.gainSmoothing) * target;
+    }
+}
+
+void applyGainScalar(float *re, float *im, const float *gain, int count) {
+    for (int k = 0; k < count; ++k) {
+        re[k] *= gain[k];
+        im[k] *= gain[k];
+    }
+}
+
+#if defined(AICP_X86)
+void gateBinsSSE(const float *re, const float *im, float *power, float *noise, float *gain,
+                 int count, const GateParams &p) {
+    const __m128 a = _mm_set1_ps(p.powerSmoothing);
+    const __m128 oneMinusA = _mm_set1_ps(1.0f - p.powerSmoothing);
+    const __m128 rise = _mm_set1_ps(p.noiseRise);
+    const __m128 over = _mm_set1_ps(p.overSubtraction);
+    const __m128 floorGain = _mm_set1_ps(p.gainFloor);
+    const __m128 b = _mm_set1_ps(p.gainSmoothing);
+    const __m128 oneMinusB = _mm_set1_ps(1.0f - p.gainSmoothing);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 eps = _mm_set1_ps(POWER_EPSILON);
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        const __m128 r = _mm_loadu_ps(re + k);
+        const __m128 i = _mm_loadu_ps(im + k);
+        const __m128 instant = _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(i, i));
+        const __m128 smoothed = _mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(power + k)), _mm_mul_ps(oneMinusA, instant));
+        const __m128 floorLevel = _mm_min_ps(smoothed, _mm_mul_ps(_mm_loadu_ps(noise + k), rise));
+        const __m128 ratio = _mm_div_ps(_mm_mul_ps(over, floorLevel), _mm_max_ps(smoothed, eps));
+        const __m128 target = _mm_max_ps(floorGain, _mm_sub_ps(one, ratio));
+        _mm_storeu_ps(power + k, smoothed);
+        _mm_storeu_ps(noise + k, floorLevel);
+        _mm_storeu_ps(gain + k, _mm_add_ps(_mm_mul_ps(b, _mm_loadu_ps(gain + k)), _mm_mul_ps(oneMinusB, target)));
+    }
+    gateBinsScalar(re + k, im + k, power + k, noise + k, gain + k, count - k, p);
+}
+
+void applyGainSSE(float *re, float *im, const float *gain, int count) {
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        const __m128 g = _mm_loadu_ps(gain + k);
+        _mm_storeu_ps(re + k, _mm_mul_ps(_mm_loadu_ps(re + k), g));
+        _mm_storeu_ps(im + k, _mm_mul_ps(_mm_loadu_ps(im + k), g));
+    }
+    applyGainScalar(re + k, im + k, gain + k, count - k);
+}
+
+AICP_TARGET_AVX2
+void gateBinsAVX2(const float *re, const float *im, float *power, float *noise, float *gain,
+                  int count, const GateParams &p) {
+    const __m256 a = _mm256_set1_ps(p.powerSmoothing);
+    const __m256 oneMinusA = _mm256_set1_ps(1.0f - p.powerSmoothing);
+    const __m256 rise = _mm256_set1_ps(p.noiseRise);
+    const __m256 over = _mm256_set1_ps(p.overSubtraction);
+    const __m256 floorGain = _mm256_set1_ps(p.gainFloor);
+    const __m256 b = _mm256_set1_ps(p.gainSmoothing);
+    const __m256 oneMinusB = _mm256_set1_ps(1.0f - p.gainSmoothing);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 eps = _mm256_set1_ps(POWER_EPSILON);
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        const __m256 r = _mm256_loadu_ps(re + k);
+        const __m256 i = _mm256_loadu_ps(im + k);
+        const __m256 instant = _mm256_add_ps(_mm256_mul_ps(r, r), _mm256_mul_ps(i, i));
+        const __m256 smoothed = _mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(power + k)),
+                                              _mm256_mul_ps(oneMinusA, instant));
+        const __m256 floorLevel = _mm256_min_ps(smoothed, _mm256_mul_ps(_mm256_loadu_ps(noise + k), rise));
+        const __m256 ratio = _mm256_div_ps(_mm256_mul_ps(over, floorLevel), _mm256_max_ps(smoothed, eps));
+        const __m256 target = _mm256_max_ps(floorGain, _mm256_sub_ps(one, ratio));
+        _mm256_storeu_ps(power + k, smoothed);
+        _mm256_storeu_ps(noise + k, floorLevel);
+        _mm256_storeu_ps(gain + k, _mm256_add_ps(_mm256_mul_ps(b, _mm256_loadu_ps(gain + k)),
+                                                 _mm256_mul_ps(oneMinusB, target)));
+    }
+    gateBinsSSE(re + k, im + k, power + k, noise + k, gain + k, count - k, p);
+}
+
+AICP_TARGET_AVX2
+void applyGainAVX2(float *re, float *im, const float *gain, int count) {
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        const __m256 g = _mm256_loadu_ps(gain + k);
+        _mm256_storeu_ps(re + k, _mm256_mul_ps(_mm256_loadu_ps(re + k), g));
+        _mm256_storeu_ps(im + k, _mm256_mul_ps(_mm256_loadu_ps(im + k), g));
+    }
+    applyGainSSE(re + k, im + k, gain + k, count - k);
+}
+#endif
+
+using GateBinsFn = void (*)(const float *, const float *, float *, float *, float *, int, const GateParams &);
+using ApplyGainFn = void (*)(float *, float *, const float *, int);
+
+GateBinsFn selectGateBins() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return gateBinsAVX2;
+    }
+    return gateBinsSSE;
+#else
+    return gateBinsScalar;
+#endif
+}
+
+ApplyGainFn selectApplyGain() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return applyGainAVX2;
+    }
+    return applyGainSSE;
+#else
+    return applyGainScalar;
+#endif
+}
+
+const GateBinsFn gateBins = selectGateBins();
+const ApplyGainFn applyGain = selectApplyGain();
+
+int defaultFftSize(int sampleRate) {
+    const int minimum = static_cast<int>(std::ceil(sampleRate * DEFAULT_WINDOW_SECONDS));
+    int size = MIN_FFT_SIZE;
+    while (size < minimum && size < MAX_FFT_SIZE) {
+        size *= 2;
+    }
+    return size;
+}
+
+} // namespace
+
+// 基 2 FFT 表：位反转下标与 N/2 个旋转因子
+struct AudioDenoiser::FftPlan {
+    int size = 0;
+    std::vector<int> bitReverse;
+    std::vector<float> cosTable;
+    std::vector<float> sinTable;
+
+    // 原地正变换（re/im 分离存储）；逆变换交换 re/im 调用即可（未归一化）
+    void forward(float* re, float* im) const {
+        for (int i = 0; i < size; ++i) {
+            const int j = bitReverse[i];
+            if (i < j) {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+        for (int length = 2; length <= size; length *= 2) {
+            const int half = length / 2;
+            const int stride = size / length;
+            for (int start = 0; start < size; start += length) {
+                for (int j = 0; j < half; ++j) {
+                    const float wr = cosTable[j * stride];
+                    const float wi = -sinTable[j * stride];
+                    const int a = start + j;
+                    const int b = a + half;
+                    const float tr = re[b] * wr - im[b] * wi;
+                    const float ti = re[b] * wi + im[b] * wr;
+                    re[b] = re[a] - tr;
+                    im[b] = im[a] - ti;
+                    re[a] += tr;
+                    im[a] += ti;
+                }
+            }
+        }
+    }
+};
+
+std::shared_ptr<const AudioDenoiser::FftPlan> AudioDenoiser::cachedPlan(int fftSize) {
+    static std::mutex cacheMutex;
+    static std::map<int, std::shared_ptr<const FftPlan>> cache;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(fftSize);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= MAX_CACHED_PLANS) {
+        cache.clear();
+    }
+    auto plan = std::make_shared<FftPlan>();
+    plan->size = fftSize;
+    plan->bitReverse.resize(fftSize);
+    int bits = 0;
+    while ((1 << bits) < fftSize) {
+        ++bits;
+    }
+    for (int i = 0; i < fftSize; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        plan->bitReverse[i] = reversed;
+    }
+    plan->cosTable.resize(fftSize / 2);
+    plan->sinTable.resize(fftSize / 2);
+    for (int k = 0; k < fftSize / 2; ++k) {
+        plan->cosTable[k] = static_cast<float>(std::cos(2.0 * PI * k / fftSize));
+        plan->sinTable[k] = static_cast<float>(std::sin(2.0 * PI * k / fftSize));
+    }
+    cache.emplace(fftSize, plan);
+    return plan;
+}
+
+AudioDenoiser::AudioDenoiser()
+    : pendingInput(0)
+    , size(0)
+    , hop(0)
+    , rate(0)
+    , channels(0)
+    , noiseRise(1.0f)
+    , gainFloor(1.0f)
+    , silentHops(0)
+    , voiceActive(true)
+    , configured(false)
+{
+}
+
+AudioDenoiser::~AudioDenoiser() = default;
+
+bool AudioDenoiser::configure(int sampleRate, int channelCount) {
+    return configure(sampleRate, channelCount, Config());
+}
+
+bool AudioDenoiser::configure(int sampleRate, int channelCount, const Config& config) {
+    configured = false;
+    const int fftSize = config.fftSize > 0 ? config.fftSize : defaultFftSize(sampleRate);
+    if (sampleRate <= 0 || channelCount <= 0 || channelCount > MAX_CHANNELS ||
+        fftSize < MIN_FFT_SIZE || fftSize > MAX_FFT_SIZE || (fftSize & (fftSize - 1)) != 0) {
+        std::cerr << "降噪参数无效: " << sampleRate << "Hz, 声道数 " << channelCount
+                  << ", FFT " << fftSize << std::endl;
+        return false;
+    }
+
+    cfg = config;
+    rate = sampleRate;
+    channels = channelCount;
+    size = fftSize;
+    hop = size / 2;
+    plan = cachedPlan(size);
+    noiseRise = std::pow(10.0f, cfg.noiseRiseDbPerSecond / 10.0f * hop / rate);
+    gainFloor = std::pow(10.0f, -std::max(0.0f, cfg.reductionDb) / 20.0f);
+
+    // 周期 Hann 窗在 50% 重叠下平方和恒为 1，分析与合成各乘一次 sqrt 即可完全重建
+    window.resize(size);
+    for (int i = 0; i < size; ++i) {
+        window[i] = static_cast<float>(std::sqrt(0.5 * (1.0 - std::cos(2.0 * PI * i / size))));
+    }
+    re.assign(size, 0.0f);
+    im.assign(size, 0.0f);
+    fullGain.assign(size, 1.0f);
+
+    const int bins = size / 2 + 1;
+    states.assign(channels, ChannelState());
+    for (ChannelState& state : states) {
+        state.analysis.resize(size);
+        state.overlap.resize(size);
+        state.outputFifo.resize(static_cast<size_t>(hop) * 2);
+        state.power.resize(bins);
+        state.noise.resize(bins);
+        state.gain.resize(bins);
+    }
+    configured = true;
+    reset();
+    return true;
+}
+
+void AudioDenoiser::reset() {
+    if (!configured) {
+        return;
+    }
+    // 输出先垫 hop 个零样本，保证任意块大小下每次都能取出与输入等量的输出
+    for (ChannelState& state : states) {
+        std::fill(state.analysis.begin(), state.analysis.end(), 0.0f);
+        std::fill(state.overlap.begin(), state.overlap.end(), 0.0f);
+        std::fill(state.outputFifo.begin(), state.outputFifo.end(), 0.0f);
+        std::fill(state.power.begin(), state.power.end(), 0.0f);
+        std::fill(state.noise.begin(), state.noise.end(), 0.0f);
+        std::fill(state.gain.begin(), state.gain.end(), 1.0f);
+        state.broadbandGain = 1.0f;
+        state.outputRead = 0;
+        state.outputCount = hop;
+        state.noiseInitialized = false;
+    }
+    pendingInput = 0;
+    silentHops = 0;
+}
+
+void AudioDenoiser::setVoiceActive(bool active) {
+    voiceActive = active;
+}
+
+void AudioDenoiser::processHop(ChannelState& state) {
+    for (int i = 0; i < size; ++i) {
+        re[i] = state.analysis[i] * window[i];
+    }
+    std::fill(im.begin(), im.end(), 0.0f);
+    plan->forward(re.data(), im.data());
+
+    const int bins = size / 2 + 1;
+    if (!state.noiseInitialized) {
+        // 第一帧直接作为功率与噪声底的初值
+        for (int k = 0; k < bins; ++k) {
+            state.power[k] = re[k] * re[k] + im[k] * im[k];
+            state.noise[k] = state.power[k];
+        }
+        state.noiseInitialized = true;
+    }
+    const GateParams params = {cfg.powerSmoothing, noiseRise, cfg.overSubtraction, gainFloor, cfg.gainSmoothing};
+    gateBins(re.data(), im.data(), state.power.data(), state.noise.data(), state.gain.data(), bins, params);
+
+    // 等效宽带增益：输出能量 / 输入能量（按平滑功率加权），跳过 FFT 的帧按它缩放，电平与本帧衔接
+    double inputEnergy = 0.0;
+    double outputEnergy = 0.0;
+    for (int k = 0; k < bins; ++k) {
+        inputEnergy += state.power[k];
+        outputEnergy += static_cast<double>(state.power[k]) * state.gain[k] * state.gain[k];
+    }
+    state.broadbandGain = inputEnergy > 0.0
+        ? std::max(gainFloor, std::min(1.0f, static_cast<float>(std::sqrt(outputEnergy / inputEnergy))))
+        : gainFloor;
+
+    // 实信号频谱共轭对称，增益镜像到负频率后整段相乘
+    std::copy(state.gain.begin(), state.gain.end(), fullGain.begin());
+    for (int k = 1; k < size / 2; ++k) {
+        fullGain[size - k] = state.gain[k];
+    }
+    applyGain(re.data(), im.data(), fullGain.data(), size);
+    plan->forward(im.data(), re.data());
+
+    const float scale = 1.0f / size;
+    for (int i = 0; i < size; ++i) {
+        state.overlap[i] += re[i] * window[i] * scale;
+    }
+    finishHop(state);
+}
+
+void AudioDenoiser::attenuateHop(ChannelState& state) {
+    // 窗平方在 50% 重叠下和为 1，与相邻分析帧的输出自然交叉淡化
+    const float g = state.broadbandGain;
+    for (int i = 0; i < size; ++i) {
+        state.overlap[i] += state.analysis[i] * window[i] * window[i] * g;
+    }
+    finishHop(state);
+}
+
+void AudioDenoiser::finishHop(ChannelState& state) {
+    // 前 hop 个样本已叠加完整，移入输出队列
+    const int fifoSize = static_cast<int>(state.outputFifo.size());
+    int write = (state.outputRead + state.outputCount) % fifoSize;
+    for (int i = 0; i < hop; ++i) {
+        state.outputFifo[write] = state.overlap[i];
+        write = write + 1 == fifoSize ? 0 : write + 1;
+    }
+    state.outputCount += hop;
+    std::memmove(state.overlap.data(), state.overlap.data() + hop, static_cast<size_t>(size - hop) * sizeof(float));
+    std::fill(state.overlap.begin() + (size - hop), state.overlap.end(), 0.0f);
+    std::memmove(state.analysis.data(), state.analysis.data() + hop, static_cast<size_t>(size - hop) * sizeof(float));
+}
+
+bool AudioDenoiser::process(const float* in, float* out, int frames) {
+    if (!configured || !in || !out || frames < 0) {
+        return false;
+    }
+    // 每次推进到下一个 hop 边界：写入输入 -> 凑满 hop 时处理一帧 -> 取出等量输出
+    // 输出队列在每轮开始时恰有 hop - pendingInput 个样本，因此取出前总是足够
+    int done = 0;
+    while (done < frames) {
+        const int count = std::min(frames - done, hop - pendingInput);
+        const size_t base = static_cast<size_t>(done) * channels;
+        for (int c = 0; c < channels; ++c) {
+            float* tail = states[c].analysis.data() + (size - hop) + pendingInput;
+            for (int i = 0; i < count; ++i) {
+                tail[i] = in[base + static_cast<size_t>(i) * channels + c];
+            }
+        }
+        pendingInput += count;
+        if (pendingInput == hop) {
+            const bool analyze = voiceActive || silentHops % SILENT_ANALYSIS_INTERVAL == 0;
+            silentHops = voiceActive ? 0 : silentHops + 1;
+            for (ChannelState& state : states) {
+                if (analyze) {
+                    processHop(state);
+                } else {
+                    attenuateHop(state);
+                }
+            }
+            pendingInput = 0;
+        }
+        for (int c = 0; c < channels; ++c) {
+            ChannelState& state = states[c];
+            const int fifoSize = static_cast<int>(state.outputFifo.size());
+            for (int i = 0; i < count; ++i) {
+                out[base + static_cast<size_t>(i) * channels + c] = state.outputFifo[state.outputRead];
+                state.outputRead = state.outputRead + 1 == fifoSize ? 0 : state.outputRead + 1;
+            }
+            state.outputCount -= count;
+        }
+        done += count;
+    }
+    return true;
+}
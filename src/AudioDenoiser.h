@@ -0,0 +1,97 @@
+#ifndef AUDIODENOISER_H
+#define AUDIODENOISER_H
+
+#include <memory>
+#include <vector>
+
+/**
+ * 流式谱门限降噪 - 50% 重叠的 sqrt-Hann 窗 FFT 分析/合成（重叠相加可完全重建）
+ * 每个频点跟踪平滑功率的最小值作为噪声底（下降立即跟随，上升按 noiseRiseDbPerSecond 缓慢回升），
+ * 增益 max(floor, 1 - overSubtraction * 噪声 / 功率) 再做帧间平滑以抑制音乐噪声
+ * FFT 表按尺寸在进程内缓存，工作区在 configure 时预分配，谱运算有 SSE/AVX2 实现
+ * 输入输出为交错 float，process 输出帧数与输入相同，固定延迟 latencyFrames() 帧
+ * 语音检测判定无语音时（setVoiceActive(false)）大部分帧跳过 FFT，在时域按最近一次分析的等效宽带增益衰减，
+ * 与相邻分析帧的输出电平一致，不会因分析帧与跳过帧交替而产生幅度调制
+ */
+class AudioDenoiser {
+public:
+    static const int MAX_CHANNELS = 8;
+
+    struct Config {
+        int fftSize = 0;                    // 0 表示按采样率取不小于 10ms 的 2 的幂
+        float reductionDb = 18.0f;          // 最大衰减（增益下限）
+        float overSubtraction = 4.0f;       // 噪声过减系数（最小值跟踪会低估平均噪声功率，同时补偿该偏差）
+        float noiseRiseDbPerSecond = 3.0f;  // 噪声底上升速度
+        float powerSmoothing = 0.7f;        // 频点功率帧间平滑系数
+        float gainSmoothing = 0.5f;         // 增益帧间平滑系数
+    };
+
+    AudioDenoiser();
+    ~AudioDenoiser();
+
+    // 配置并清空状态；参数无效时返回 false
+    bool configure(int sampleRate, int channels);
+    bool configure(int sampleRate, int channels, const Config& config);
+
+    bool isConfigured() const { return configured; }
+    int sampleRate() const { return rate; }
+    int channelCount() const { return channels; }
+    int fftSize() const { return size; }
+
+    // 输出相对输入的延迟（帧）
+    int latencyFrames() const { return size; }
+
+    // 清空缓冲与噪声估计
+    void reset();
+
+    // 处理一块交错样本（in 与 out 可以相同），输出与输入帧数相同
+    bool process(const float* in, float* out, int frames);
+
+    // 设置后续输入是否含语音（默认 true）；无语音时每 SILENT_ANALYSIS_INTERVAL 帧仍做一次完整分析以跟踪噪声底
+    void setVoiceActive(bool active);
+
+private:
+    struct FftPlan;
+    struct ChannelState {
+        std::vector<float> analysis;    // 最近 size 个输入样本
+        std::vector<float> overlap;     // 重叠相加累加区
+        std::vector<float> outputFifo;  // 已完成的输出样本（环形）
+        std::vector<float> power;       // 平滑功率（size/2 + 1 个频点）
+        std::vector<float> noise;       // 噪声底估计
+        std::vector<float> gain;        // 平滑后的增益
+        float broadbandGain = 1.0f;     // 按功率加权的等效宽带增益（跳过 FFT 的帧使用）
+        int outputRead = 0;
+        int outputCount = 0;
+        bool noiseInitialized = false;
+    };
+
+    // 无语音时两次完整分析之间跳过的帧数 + 1
+    static const int SILENT_ANALYSIS_INTERVAL = 4;
+
+    static std::shared_ptr<const FftPlan> cachedPlan(int size);
+
+    void processHop(ChannelState& state);
+    // 跳过 FFT 的帧：按上一次分析的等效宽带增益在时域缩放，频谱增益继续向该值平滑
+    void attenuateHop(ChannelState& state);
+    void finishHop(ChannelState& state);
+
+    std::shared_ptr<const FftPlan> plan;
+    Config cfg;
+    std::vector<ChannelState> states;
+    std::vector<float> window;          // sqrt-Hann，分析与合成共用
+    std::vector<float> re;
+    std::vector<float> im;
+    std::vector<float> fullGain;        // 镜像到全部 size 个频点的增益
+    int pendingInput;                   // 已写入 analysis 尾部、尚未处理的样本数
+    int size;
+    int hop;
+    int rate;
+    int channels;
+    float noiseRise;                    // 每帧噪声底上升倍数
+    float gainFloor;
+    int silentHops;                     // 连续无语音的帧数
+    bool voiceActive;
+    bool configured;
+};
+
+#endif // AUDIODENOISER_H
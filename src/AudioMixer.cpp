@@ -0,0 +1,306 @@
+#include "AudioMixer.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 软限幅拐点的取值范围：过低会压缩正常音量，过高拐点后几乎没有余量
+const float MIN_LIMITER_THRESHOLD = 0.1f;
+const float MAX_LIMITER_THRESHOLD = 0.99f;
+
+void accumulateScalar(float *dst, const float *src, float gain, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] += gain * src[i];
+    }
+}
+
+void softLimitScalar(float *samples, size_t count, float threshold) {
+    const float knee = 1.0f - threshold;
+    const float invKnee = 1.0f / knee;
+    for (size_t i = 0; i < count; ++i) {
+        const float magnitude = std::fabs(samples[i]);
+        const float excess = std::max(magnitude - threshold, 0.0f) * invKnee;
+        const float limited = std::min(magnitude, threshold) + knee * excess / (1.0f + excess);
+        samples[i] = std::copysign(limited, samples[i]);
+    }
+}
+
+#if defined(AICP_X86)
+void accumulateSSE(float *dst, const float *src, float gain, size_t count) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(g, _mm_loadu_ps(src + i))));
+    }
+    accumulateScalar(dst + i, src + i, gain, count - i);
+}
+
+// 与标量实现同一公式：符号位单独保留，幅度分为拐点以下的线性部分与拐点以上的压缩部分
+void softLimitSSE(float *samples, size_t count, float threshold) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 t = _mm_set1_ps(threshold);
+    const __m128 knee = _mm_set1_ps(1.0f - threshold);
+    const __m128 invKnee = _mm_set1_ps(1.0f / (1.0f - threshold));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_loadu_ps(samples + i);
+        const __m128 sign = _mm_and_ps(x, signMask);
+        const __m128 magnitude = _mm_andnot_ps(signMask, x);
+        const __m128 excess = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(magnitude, t), zero), invKnee);
+        const __m128 limited = _mm_add_ps(_mm_min_ps(magnitude, t),
+                                          _mm_mul_ps(knee, _mm_div_ps(excess, _mm_add_ps(one, excess))));
+        _mm_storeu_ps(samples + i, _mm_or_ps(limited, sign));
+    }
+    softLimitScalar(samples + i, count - i, threshold);
+}
+
+AICP_TARGET_AVX2
+void accumulateAVX2(float *dst, const float *src, float gain, size_t count) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(g, _mm256_loadu_ps(src + i))));
+    }
+    accumulateSSE(dst + i, src + i, gain, count - i);
+}
+
+AICP_TARGET_AVX2
+void softLimitAVX2(float *samples, size_t count, float threshold) {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 t = _mm256_set1_ps(threshold);
+    const __m256 knee = _mm256_set1_ps(1.0f - threshold);
+    const __m256 invKnee = _mm256_set1_ps(1.0f / (1.0f - threshold));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(samples + i);
+        const __m256 sign = _mm256_and_ps(x, signMask);
+        const __m256 magnitude = _mm256_andnot_ps(signMask, x);
+        const __m256 excess = _mm256_mul_ps(_mm256_max_ps(_mm256_sub_ps(magnitude, t), zero), invKnee);
+        const __m256 limited = _mm256_add_ps(_mm256_min_ps(magnitude, t),
+                                             _mm256_mul_ps(knee, _mm256_div_ps(excess, _mm256_add_ps(one, excess))));
+        _mm256_storeu_ps(samples + i, _mm256_or_ps(limited, sign));
+    }
+    softLimitSSE(samples + i, count - i, threshold);
+}
+#endif
+
+using AccumulateFn = void (*)(float *, const float *, float, size_t);
+using SoftLimitFn = void (*)(float *, size_t, float);
+
+AccumulateFn selectAccumulate() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return accumulateAVX2;
+    }
+    return accumulateSSE;
+#else
+    return accumulateScalar;
+#endif
+}
+
+SoftLimitFn selectSoftLimit() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return softLimitAVX2;
+    }
+    return softLimitSSE;
+#else
+    return softLimitScalar;
+#endif
+}
+
+const AccumulateFn accumulate = selectAccumulate();
+const SoftLimitFn softLimitKernel = selectSoftLimit();
+
+} // namespace
+
+AudioMixer::AudioMixer()
+    : AudioMixer(Config())
+{
+}
+
+AudioMixer::AudioMixer(const Config& config)
+    : cfg(config)
+{
+    setConfig(config);
+}
+
+void AudioMixer::setConfig(const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cfg = config;
+    cfg.channels = std::max(1, cfg.channels);
+    cfg.maxBufferedFrames = std::max(1, cfg.maxBufferedFrames);
+    cfg.maxWaitFrames = std::min(std::max(1, cfg.maxWaitFrames), cfg.maxBufferedFrames);
+    cfg.limiterThreshold = std::min(MAX_LIMITER_THRESHOLD, std::max(MIN_LIMITER_THRESHOLD, cfg.limiterThreshold));
+    sources.clear();
+    counters = Stats();
+}
+
+AudioMixer::Config AudioMixer::config() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cfg;
+}
+
+int AudioMixer::addSource(float gain) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // 优先复用已移除音源的槽位（缓冲已按当前配置分配）
+    size_t id = 0;
+    while (id < sources.size() && sources[id].active) {
+        ++id;
+    }
+    if (id == sources.size()) {
+        sources.emplace_back();
+    }
+    Source &source = sources[id];
+    source.active = true;
+    source.stalled = false;
+    source.gain = gain;
+    source.ring.assign(static_cast<size_t>(cfg.maxBufferedFrames) * cfg.channels, 0.0f);
+    source.readFrame = 0;
+    source.bufferedFrames = 0;
+    return static_cast<int>(id);
+}
+
+void AudioMixer::removeSource(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id >= 0 && id < static_cast<int>(sources.size())) {
+        sources[id].active = false;
+        sources[id].bufferedFrames = 0;
+    }
+}
+
+void AudioMixer::setGain(int id, float gain) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id >= 0 && id < static_cast<int>(sources.size())) {
+        sources[id].gain = gain;
+    }
+}
+
+int AudioMixer::sourceCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(std::count_if(sources.begin(), sources.end(),
+                                          [](const Source &source) { return source.active; }));
+}
+
+void AudioMixer::push(int id, const float* samples, int frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id < 0 || id >= static_cast<int>(sources.size()) || !sources[id].active || !samples || frames <= 0) {
+        return;
+    }
+    Source &source = sources[id];
+    const int capacity = cfg.maxBufferedFrames;
+    const int channels = cfg.channels;
+
+    // 单块超过容量时只保留最新的部分
+    if (frames > capacity) {
+        counters.overflowFrames += frames - capacity;
+        samples += static_cast<size_t>(frames - capacity) * channels;
+        frames = capacity;
+    }
+    const int overflow = source.bufferedFrames + frames - capacity;
+    if (overflow > 0) {
+        counters.overflowFrames += overflow;
+        source.readFrame = (source.readFrame + overflow) % capacity;
+        source.bufferedFrames -= overflow;
+    }
+
+    int writeFrame = (source.readFrame + source.bufferedFrames) % capacity;
+    int remaining = frames;
+    while (remaining > 0) {
+        const int count = std::min(remaining, capacity - writeFrame);
+        std::memcpy(source.ring.data() + static_cast<size_t>(writeFrame) * channels, samples,
+                    static_cast<size_t>(count) * channels * sizeof(float));
+        samples += static_cast<size_t>(count) * channels;
+        remaining -= count;
+        writeFrame = (writeFrame + count) % capacity;
+    }
+    source.bufferedFrames += frames;
+    source.stalled = false;
+}
+
+int AudioMixer::readyFramesLocked() const {
+    int minBuffered = -1;
+    int maxBuffered = 0;
+    for (const Source &source : sources) {
+        if (!source.active || source.stalled) {
+            continue;
+        }
+        minBuffered = minBuffered < 0 ? source.bufferedFrames : std::min(minBuffered, source.bufferedFrames);
+        maxBuffered = std::max(maxBuffered, source.bufferedFrames);
+    }
+    if (minBuffered < 0) {
+        return 0;
+    }
+    // 领先最多的一路积压超过等待上限时，不再等待落后的音源
+    return maxBuffered >= cfg.maxWaitFrames ? maxBuffered : minBuffered;
+}
+
+int AudioMixer::readyFrames() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return readyFramesLocked();
+}
+
+int AudioMixer::mix(float* out, int frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    frames = std::min(frames, readyFramesLocked());
+    if (!out || frames <= 0) {
+        return 0;
+    }
+    const int capacity = cfg.maxBufferedFrames;
+    const int channels = cfg.channels;
+    std::fill(out, out + static_cast<size_t>(frames) * channels, 0.0f);
+
+    for (Source &source : sources) {
+        if (!source.active) {
+            continue;
+        }
+        const int available = std::min(frames, source.bufferedFrames);
+        counters.underrunFrames += frames - available;
+        source.stalled = available < frames;
+        int done = 0;
+        while (done < available) {
+            const int count = std::min(available - done, capacity - source.readFrame);
+            if (source.gain != 0.0f) {
+                accumulate(out + static_cast<size_t>(done) * channels,
+                           source.ring.data() + static_cast<size_t>(source.readFrame) * channels,
+                           source.gain, static_cast<size_t>(count) * channels);
+            }
+            done += count;
+            source.readFrame = (source.readFrame + count) % capacity;
+        }
+        source.bufferedFrames -= available;
+    }
+
+    softLimitKernel(out, static_cast<size_t>(frames) * channels, cfg.limiterThreshold);
+    counters.mixedFrames += frames;
+    return frames;
+}
+
+void AudioMixer::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Source &source : sources) {
+        source.readFrame = 0;
+        source.bufferedFrames = 0;
+        source.stalled = false;
+    }
+    counters = Stats();
+}
+
+AudioMixer::Stats AudioMixer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void AudioMixer::softLimit(float* samples, size_t count, float threshold) {
+    if (!samples || count == 0) {
+        return;
+    }
+    threshold = std::min(MAX_LIMITER_THRESHOLD, std::max(MIN_LIMITER_THRESHOLD, threshold));
+    softLimitKernel(samples, count, threshold);
+}
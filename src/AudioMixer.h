@@ -0,0 +1,81 @@
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * N 路混音引擎 - 各路音源以交错 float 样本写入各自的抖动缓冲，按输出块对齐后加权求和
+ * 各路交付的块大小与节奏可以不同：mix 只取各路都已到达的部分；某一路停顿时，
+ * 其他路领先超过 maxWaitFrames 后不再等待，停顿的一路按静音补齐（计入欠载），
+ * 并在它再次写入数据之前不再参与对齐
+ * 求和后经软限幅（阈值以下线性，以上平滑趋近满幅）代替硬削波；累加与限幅均有 SSE/AVX2 实现
+ * 配置完成后 push/mix 不分配内存；push 与 mix 可在不同线程调用
+ */
+class AudioMixer {
+public:
+    struct Config {
+        int channels = 2;
+        int maxBufferedFrames = 9600;   // 每路抖动缓冲容量（48kHz 下 200ms），写满时丢弃最旧的样本
+        int maxWaitFrames = 2400;       // 最快的一路领先多少帧后不再等待停顿的音源（48kHz 下 50ms）
+        float limiterThreshold = 0.8f;  // 软限幅拐点（满幅为 1.0）
+    };
+
+    struct Stats {
+        uint64_t mixedFrames = 0;       // 已输出的帧数
+        uint64_t underrunFrames = 0;    // 音源数据不足、按静音补齐的帧数（各路累加）
+        uint64_t overflowFrames = 0;    // 抖动缓冲写满而丢弃的帧数（各路累加）
+    };
+
+    AudioMixer();
+    explicit AudioMixer(const Config& config);
+
+    // 更换配置会移除全部音源
+    void setConfig(const Config& config);
+    Config config() const;
+
+    // 添加一路音源，返回音源编号
+    int addSource(float gain = 1.0f);
+    void removeSource(int id);
+    void setGain(int id, float gain);
+    int sourceCount() const;
+
+    // 写入一块交错样本；缓冲放不下时丢弃最旧的样本
+    void push(int id, const float* samples, int frames);
+
+    // 当前可以输出的帧数
+    int readyFrames() const;
+
+    // 混合至多 frames 帧写入 out（调用方提供的缓冲，至少 frames * channels 个样本），
+    // 返回实际输出的帧数（不超过 readyFrames）
+    int mix(float* out, int frames);
+
+    // 清空各路缓冲与统计（保留音源与增益）
+    void reset();
+
+    Stats stats() const;
+
+    // 原地软限幅：|x| <= threshold 不变，超出部分按 e / (1 + e) 压缩，输出幅度不超过 1
+    static void softLimit(float* samples, size_t count, float threshold);
+
+private:
+    struct Source {
+        bool active = false;
+        bool stalled = false;       // 欠载后尚未恢复写入，不参与对齐
+        float gain = 1.0f;
+        std::vector<float> ring;    // maxBufferedFrames * channels 个样本
+        int readFrame = 0;
+        int bufferedFrames = 0;
+    };
+
+    int readyFramesLocked() const;
+
+    mutable std::mutex mutex;
+    Config cfg;
+    std::vector<Source> sources;
+    Stats counters;
+};
+
+#endif // AUDIOMIXER_H
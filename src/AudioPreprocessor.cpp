@@ -0,0 +1,301 @@
+// AudioPreprocessor.cpp
+// 音频预处理实现：重采样、混音、降噪、语音检测
+#include "AudioPreprocessor.h"
+#include "AudioDenoiser.h"
+#include "AudioMixer.h"
+#include "AudioResampler.h"
+#include "VoiceActivityDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+const float INT16_SCALE = 1.0f / 32768.0f;
+
+// 混音抖动缓冲容量与等待上限（秒）
+const double MIX_BUFFER_SECONDS = 0.2;
+const double MIX_MAX_WAIT_SECONDS = 0.05;
+
+bool isSupportedFormat(const AudioData& audio) {
+    return audio.data && audio.size > 0 && audio.sampleRate > 0 && audio.channels > 0 &&
+           (audio.bitsPerSample == 16 || audio.bitsPerSample == 32);
+}
+
+size_t frameBytes(const AudioData& audio) {
+    return static_cast<size_t>(audio.channels) * (audio.bitsPerSample / 8);
+}
+
+void int16ToFloat(const int16_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = src[i] * INT16_SCALE;
+    }
+}
+
+void floatToInt16(const float* src, int16_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float v = std::min(32767.0f, std::max(-32768.0f, src[i] * 32768.0f));
+        dst[i] = static_cast<int16_t>(std::lrint(v));
+    }
+}
+
+// 把 frames 帧 float 样本按 bitsPerSample 写入新分配的池化缓冲
+AudioData packOutput(const float* samples, int frames, int sampleRate, int channels, int bitsPerSample,
+                     uint64_t timestamp) {
+    AudioData result;
+    if (frames <= 0) {
+        return result;
+    }
+    const size_t count = static_cast<size_t>(frames) * channels;
+    if (!result.allocate(count * (bitsPerSample / 8))) {
+        return result;
+    }
+    if (bitsPerSample == 16) {
+        floatToInt16(samples, reinterpret_cast<int16_t*>(result.data), count);
+    } else {
+        std::memcpy(result.data, samples, count * sizeof(float));
+    }
+    result.sampleRate = sampleRate;
+    result.channels = channels;
+    result.bitsPerSample = bitsPerSample;
+    result.timestamp = timestamp;
+    return result;
+}
+
+} // namespace
+
+AudioPreprocessor::AudioPreprocessor()
+    : resampler(std::make_unique<AudioResampler>())
+    , mixer(std::make_unique<AudioMixer>())
+    , denoiser(std::make_unique<AudioDenoiser>())
+    , voiceDetector(std::make_unique<VoiceActivityDetector>())
+{
+}
+
+AudioPreprocessor::~AudioPreprocessor() = default;
+
+AudioData AudioPreprocessor::resample(const AudioData& audio, int targetSampleRate) {
+    if (!isSupportedFormat(audio) || targetSampleRate <= 0) {
+        std::cerr << "重采样输入格式不支持: " << audio.bitsPerSample << " 位, "
+                  << audio.channels << " 声道" << std::endl;
+        return AudioData();
+    }
+    if (audio.sampleRate == targetSampleRate) {
+        return audio;
+    }
+
+    // 流参数变化时重新配置（滤波器组按采样率组合缓存，不会重复计算）
+    if (!resampler->isConfigured() || resampler->inputRate() != audio.sampleRate ||
+        resampler->outputRate() != targetSampleRate || resampler->channelCount() != audio.channels ||
+        resampleBitsPerSample != audio.bitsPerSample) {
+        if (!resampler->configure(audio.sampleRate, targetSampleRate, audio.channels)) {
+            return AudioData();
+        }
+        resampleBitsPerSample = audio.bitsPerSample;
+    }
+
+    const int frames = static_cast<int>(audio.size / frameBytes(audio));
+    const size_t inputCount = static_cast<size_t>(frames) * audio.channels;
+    const float* input = reinterpret_cast<const float*>(audio.data);
+    if (audio.bitsPerSample == 16) {
+        if (resampleInput.size() < inputCount) {
+            resampleInput.resize(inputCount);
+        }
+        int16ToFloat(reinterpret_cast<const int16_t*>(audio.data), resampleInput.data(), inputCount);
+        input = resampleInput.data();
+    }
+
+    const int capacity = resampler->maxOutputFrames(frames);
+    const size_t outputCount = static_cast<size_t>(capacity) * audio.channels;
+    if (resampleOutput.size() < outputCount) {
+        resampleOutput.resize(outputCount);
+    }
+    const int produced = resampler->process(input, frames, resampleOutput.data(), capacity);
+    resampleTimestamp = audio.timestamp;
+    return packOutput(resampleOutput.data(), produced, targetSampleRate, audio.channels,
+                      audio.bitsPerSample, audio.timestamp);
+}
+
+AudioData AudioPreprocessor::flushResampler() {
+    if (!resampler->isConfigured()) {
+        return AudioData();
+    }
+    const int capacity = resampler->maxOutputFrames(0);
+    const size_t outputCount = static_cast<size_t>(capacity) * resampler->channelCount();
+    if (resampleOutput.size() < outputCount) {
+        resampleOutput.resize(outputCount);
+    }
+    const int produced = resampler->flush(resampleOutput.data(), capacity);
+    return packOutput(resampleOutput.data(), produced, resampler->outputRate(), resampler->channelCount(),
+                      resampleBitsPerSample, resampleTimestamp);
+}
+
+AudioData AudioPreprocessor::mix(const std::vector<AudioData>& audios) {
+    AudioData output;
+    mixInto(audios, output);
+    return output;
+}
+
+bool AudioPreprocessor::mixInto(const std::vector<AudioData>& audios, AudioData& output) {
+    // 以第一路有效输入确定输出格式
+    const AudioData* reference = nullptr;
+    for (const AudioData& audio : audios) {
+        if (isSupportedFormat(audio)) {
+            reference = &audio;
+            break;
+        }
+    }
+    if (!reference) {
+        return false;
+    }
+
+    if (mixSampleRate != reference->sampleRate || mixer->config().channels != reference->channels) {
+        AudioMixer::Config config = mixer->config();
+        config.channels = reference->channels;
+        config.maxBufferedFrames = static_cast<int>(reference->sampleRate * MIX_BUFFER_SECONDS);
+        config.maxWaitFrames = static_cast<int>(reference->sampleRate * MIX_MAX_WAIT_SECONDS);
+        mixer->setConfig(config);
+        mixSources.clear();
+        mixSampleRate = reference->sampleRate;
+    }
+    while (mixSources.size() < audios.size()) {
+        const size_t index = mixSources.size();
+        mixSources.push_back(mixer->addSource(index < mixGains.size() ? mixGains[index] : 1.0f));
+    }
+
+    for (size_t i = 0; i < audios.size(); ++i) {
+        const AudioData& audio = audios[i];
+        if (!audio.data || audio.size == 0) {
+            continue;
+        }
+        if (!isSupportedFormat(audio) || audio.sampleRate != mixSampleRate || audio.channels != reference->channels) {
+            std::cerr << "混音输入 " << i << " 格式不一致，已跳过: " << audio.sampleRate << "Hz, "
+                      << audio.channels << " 声道, " << audio.bitsPerSample << " 位" << std::endl;
+            continue;
+        }
+        const int frames = static_cast<int>(audio.size / frameBytes(audio));
+        const float* samples = reinterpret_cast<const float*>(audio.data);
+        if (audio.bitsPerSample == 16) {
+            const size_t count = static_cast<size_t>(frames) * audio.channels;
+            if (mixInput.size() < count) {
+                mixInput.resize(count);
+            }
+            int16ToFloat(reinterpret_cast<const int16_t*>(audio.data), mixInput.data(), count);
+            samples = mixInput.data();
+        }
+        mixer->push(mixSources[i], samples, frames);
+    }
+
+    const int ready = mixer->readyFrames();
+    if (ready <= 0) {
+        return false;
+    }
+    const size_t count = static_cast<size_t>(ready) * reference->channels;
+    const size_t bytes = count * (reference->bitsPerSample / 8);
+    if (output.bufferCapacity() < bytes) {
+        if (!output.allocate(bytes)) {
+            return false;
+        }
+    } else {
+        output.makeWritable();
+        output.size = bytes;
+    }
+
+    int mixed = 0;
+    if (reference->bitsPerSample == 32) {
+        mixed = mixer->mix(reinterpret_cast<float*>(output.data), ready);
+    } else {
+        if (mixOutput.size() < count) {
+            mixOutput.resize(count);
+        }
+        mixed = mixer->mix(mixOutput.data(), ready);
+        floatToInt16(mixOutput.data(), reinterpret_cast<int16_t*>(output.data),
+                     static_cast<size_t>(mixed) * reference->channels);
+    }
+    output.size = static_cast<size_t>(mixed) * frameBytes(*reference);
+    output.sampleRate = reference->sampleRate;
+    output.channels = reference->channels;
+    output.bitsPerSample = reference->bitsPerSample;
+    output.timestamp = reference->timestamp;
+    return mixed > 0;
+}
+
+void AudioPreprocessor::setMixGain(int index, float gain) {
+    if (index < 0) {
+        return;
+    }
+    if (static_cast<size_t>(index) >= mixGains.size()) {
+        mixGains.resize(index + 1, 1.0f);
+    }
+    mixGains[index] = gain;
+    if (static_cast<size_t>(index) < mixSources.size()) {
+        mixer->setGain(mixSources[index], gain);
+    }
+}
+
+AudioData AudioPreprocessor::denoise(const AudioData& audio) {
+    if (!isSupportedFormat(audio)) {
+        std::cerr << "降噪输入格式不支持: " << audio.bitsPerSample << " 位, "
+                  << audio.channels << " 声道" << std::endl;
+        return AudioData();
+    }
+    if (!denoiser->isConfigured() || denoiser->sampleRate() != audio.sampleRate ||
+        denoiser->channelCount() != audio.channels) {
+        if (!denoiser->configure(audio.sampleRate, audio.channels)) {
+            return AudioData();
+        }
+    }
+
+    const int frames = static_cast<int>(audio.size / frameBytes(audio));
+    const size_t count = static_cast<size_t>(frames) * audio.channels;
+    if (denoiseBuffer.size() < count) {
+        denoiseBuffer.resize(count);
+    }
+    if (audio.bitsPerSample == 16) {
+        int16ToFloat(reinterpret_cast<const int16_t*>(audio.data), denoiseBuffer.data(), count);
+    } else {
+        std::memcpy(denoiseBuffer.data(), audio.data, count * sizeof(float));
+    }
+    denoiser->setVoiceActive(audio.voiceActive);
+    denoiser->process(denoiseBuffer.data(), denoiseBuffer.data(), frames);
+    AudioData result = packOutput(denoiseBuffer.data(), frames, audio.sampleRate, audio.channels,
+                                  audio.bitsPerSample, audio.timestamp);
+    result.voiceActive = audio.voiceActive;
+    return result;
+}
+
+bool AudioPreprocessor::detectVoice(AudioData& audio) {
+    if (!isSupportedFormat(audio)) {
+        return audio.voiceActive;
+    }
+    if (!voiceDetector->isConfigured() || voiceDetector->sampleRate() != audio.sampleRate ||
+        voiceDetector->channelCount() != audio.channels) {
+        if (!voiceDetector->configure(audio.sampleRate, audio.channels)) {
+            return audio.voiceActive;
+        }
+    }
+
+    const int frames = static_cast<int>(audio.size / frameBytes(audio));
+    const float* samples = reinterpret_cast<const float*>(audio.data);
+    if (audio.bitsPerSample == 16) {
+        const size_t count = static_cast<size_t>(frames) * audio.channels;
+        if (voiceBuffer.size() < count) {
+            voiceBuffer.resize(count);
+        }
+        int16ToFloat(reinterpret_cast<const int16_t*>(audio.data), voiceBuffer.data(), count);
+        samples = voiceBuffer.data();
+    }
+
+    const VoiceActivityDetector::Result result = voiceDetector->process(samples, frames);
+    if (result.onset && speechOnsetCallback) {
+        speechOnsetCallback(result.onsetTime);
+    }
+    audio.voiceActive = result.speech;
+    return result.speech;
+}
+
+void AudioPreprocessor::setSpeechOnsetCallback(std::function<void(double)> callback) {
+    speechOnsetCallback = std::move(callback);
+}
@@ -0,0 +1,318 @@
+#include "AudioResampler.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// 上采样时每个相位的抽头数；下采样时按 M/L 展宽，保证截止频率处的过渡带宽度不变
+const int BASE_TAPS = 64;
+
+// Kaiser 窗参数：beta = 8.6 时阻带衰减约 86 dB，64 抽头过渡带约 0.085 倍输入采样率
+const double KAISER_BETA = 8.6;
+
+// 截止频率相对奈奎斯特频率的比例，使阻带恰好从奈奎斯特频率附近开始
+const double CUTOFF_RATIO = 0.91;
+
+// 约分后的相位数上限（44.1k <-> 48k 为 147/160），超过时滤波器组过大
+const int MAX_PHASES = 1024;
+
+// 滤波器组缓存上限（采样率组合数），超过后整体清空重建
+const size_t MAX_CACHED_BANKS = 16;
+
+// 第一类零阶修正贝塞尔函数（级数展开）
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfSquared = x * x / 4.0;
+    for (int k = 1; k < 64 && term > sum * 1e-12; ++k) {
+        term *= halfSquared / (static_cast<double>(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+#if !defined(AICP_X86)
+float dotScalar(const float *a, const float *b, int count) {
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+#else
+// 抽头数总是 8 的倍数，无需处理尾部
+float dotSSE(const float *a, const float *b, int count) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (int i = 0; i < count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 sum = _mm_add_ps(acc0, acc1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+AICP_TARGET_AVX2
+float dotAVX2(const float *a, const float *b, int count) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    if (i < count) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    const __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+using DotFn = float (*)(const float *, const float *, int);
+
+DotFn selectDot() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return dotAVX2;
+    }
+    return dotSSE;
+#else
+    return dotScalar;
+#endif
+}
+
+const DotFn dotProduct = selectDot();
+
+} // namespace
+
+// 多相滤波器组：coefficients[phase * taps + i] 作用于输入窗口 [readPos, readPos + taps) 的第 i 个样本
+struct AudioResampler::FilterBank {
+    int phases = 1;     // L
+    int step = 1;       // M
+    int taps = 0;       // 8 的倍数
+    std::vector<float> coefficients;
+};
+
+std::shared_ptr<const AudioResampler::FilterBank> AudioResampler::buildBank(int phases, int step) {
+    auto bank = std::make_shared<FilterBank>();
+    bank->phases = phases;
+    bank->step = step;
+    const double ratio = static_cast<double>(phases) / step;
+    const double stretch = std::max(1.0, 1.0 / ratio);
+    bank->taps = (static_cast<int>(std::ceil(BASE_TAPS * stretch)) + 7) / 8 * 8;
+    bank->coefficients.resize(static_cast<size_t>(phases) * bank->taps);
+
+    // 原型为 Kaiser 窗 sinc，t 以输入样本为单位；窗口第 taps/2 - 1 个样本对准相位 0 的输出时刻
+    const double cutoff = 0.5 * std::min(1.0, ratio) * CUTOFF_RATIO;
+    const double halfWidth = bank->taps / 2.0;
+    const double windowNorm = besselI0(KAISER_BETA);
+    for (int p = 0; p < phases; ++p) {
+        float *c = &bank->coefficients[static_cast<size_t>(p) * bank->taps];
+        double sum = 0.0;
+        for (int i = 0; i < bank->taps; ++i) {
+            const double t = halfWidth - 1 - i + static_cast<double>(p) / phases;
+            const double r = t / halfWidth;
+            double value = 0.0;
+            if (std::fabs(r) < 1.0) {
+                const double x = 2.0 * cutoff * t;
+                const double sinc = std::fabs(x) < 1e-12 ? 1.0 : std::sin(PI * x) / (PI * x);
+                value = 2.0 * cutoff * sinc * besselI0(KAISER_BETA * std::sqrt(1.0 - r * r)) / windowNorm;
+            }
+            c[i] = static_cast<float>(value);
+            sum += value;
+        }
+        // 各相位直流增益归一，避免相位间增益差异调制出纹波
+        for (int i = 0; i < bank->taps; ++i) {
+            c[i] = static_cast<float>(c[i] / sum);
+        }
+    }
+    return bank;
+}
+
+std::shared_ptr<const AudioResampler::FilterBank> AudioResampler::cachedBank(int phases, int step) {
+    static std::mutex cacheMutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const FilterBank>> cache;
+    const auto key = std::make_pair(phases, step);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= MAX_CACHED_BANKS) {
+        cache.clear();
+    }
+    auto bank = buildBank(phases, step);
+    cache.emplace(key, bank);
+    return bank;
+}
+
+AudioResampler::AudioResampler()
+    : historyStride(0)
+    , filled(0)
+    , readPos(0)
+    , phase(0)
+    , srcRate(0)
+    , dstRate(0)
+    , channels(0)
+    , configured(false)
+{
+}
+
+AudioResampler::~AudioResampler() = default;
+
+bool AudioResampler::configure(int inputRate, int outputRate, int channelCount) {
+    configured = false;
+    bank.reset();
+    if (inputRate <= 0 || outputRate <= 0 || channelCount <= 0 || channelCount > MAX_CHANNELS) {
+        std::cerr << "重采样参数无效: " << inputRate << " -> " << outputRate
+                  << ", 声道数 " << channelCount << std::endl;
+        return false;
+    }
+
+    srcRate = inputRate;
+    dstRate = outputRate;
+    channels = channelCount;
+    if (srcRate != dstRate) {
+        const int divisor = std::gcd(srcRate, dstRate);
+        const int phases = dstRate / divisor;
+        const int step = srcRate / divisor;
+        if (phases > MAX_PHASES) {
+            std::cerr << "不支持的采样率组合: " << srcRate << " -> " << dstRate << std::endl;
+            return false;
+        }
+        bank = cachedBank(phases, step);
+        historyStride = bank->taps + CHUNK_FRAMES;
+        history.assign(static_cast<size_t>(historyStride) * channels, 0.0f);
+    }
+    configured = true;
+    reset();
+    return true;
+}
+
+void AudioResampler::reset() {
+    if (!bank) {
+        return;
+    }
+    // 预置 taps/2 - 1 个零样本，使第一个输出窗口的中心对准第一个输入样本
+    std::fill(history.begin(), history.end(), 0.0f);
+    filled = bank->taps / 2 - 1;
+    readPos = 0;
+    phase = 0;
+}
+
+int AudioResampler::maxOutputFrames(int inputFrames) const {
+    if (!configured) {
+        return 0;
+    }
+    if (!bank) {
+        return inputFrames;
+    }
+    // 上一块留下的样本不足一个窗口，本块最多产生 inputFrames * L / M + 1 个输出；
+    // 额外计入 taps/2 帧使同一容量也够 flush 使用
+    const int64_t frames = static_cast<int64_t>(inputFrames) + bank->taps / 2;
+    return static_cast<int>(frames * bank->phases / bank->step + 2);
+}
+
+void AudioResampler::appendInput(const float* in, int frames) {
+    for (int c = 0; c < channels; ++c) {
+        float *dst = history.data() + static_cast<size_t>(c) * historyStride + filled;
+        if (!in) {
+            std::fill(dst, dst + frames, 0.0f);
+            continue;
+        }
+        const float *src = in + c;
+        for (int i = 0; i < frames; ++i) {
+            dst[i] = src[static_cast<size_t>(i) * channels];
+        }
+    }
+    filled += frames;
+}
+
+int AudioResampler::drainOutput(float* out) {
+    const FilterBank &b = *bank;
+    const int stepWhole = b.step / b.phases;
+    const int stepFraction = b.step % b.phases;
+    int count = 0;
+    while (readPos + b.taps <= filled) {
+        const float *coeff = &b.coefficients[static_cast<size_t>(phase) * b.taps];
+        for (int c = 0; c < channels; ++c) {
+            const float *window = history.data() + static_cast<size_t>(c) * historyStride + readPos;
+            out[static_cast<size_t>(count) * channels + c] = dotProduct(coeff, window, b.taps);
+        }
+        ++count;
+        readPos += stepWhole;
+        phase += stepFraction;
+        if (phase >= b.phases) {
+            phase -= b.phases;
+            ++readPos;
+        }
+    }
+    return count;
+}
+
+void AudioResampler::compactHistory() {
+    const int drop = std::min(readPos, filled);
+    if (drop <= 0) {
+        return;
+    }
+    const int keep = filled - drop;
+    for (int c = 0; c < channels; ++c) {
+        float *base = history.data() + static_cast<size_t>(c) * historyStride;
+        std::memmove(base, base + drop, static_cast<size_t>(keep) * sizeof(float));
+    }
+    filled = keep;
+    readPos -= drop;
+}
+
+int AudioResampler::run(const float* in, int frames, float* out) {
+    // 按工作区剩余空间分块搬入；压缩后剩余样本不足 taps 个，每轮至少能搬入 CHUNK_FRAMES 帧
+    int produced = 0;
+    int offset = 0;
+    while (offset < frames) {
+        const int count = std::min(frames - offset, historyStride - filled);
+        appendInput(in ? in + static_cast<size_t>(offset) * channels : nullptr, count);
+        offset += count;
+        produced += drainOutput(out + static_cast<size_t>(produced) * channels);
+        compactHistory();
+    }
+    return produced;
+}
+
+int AudioResampler::process(const float* in, int frames, float* out, int outCapacity) {
+    if (!configured || frames < 0 || outCapacity < maxOutputFrames(frames)) {
+        return -1;
+    }
+    if (!bank) {
+        if (in && frames > 0) {
+            std::memcpy(out, in, static_cast<size_t>(frames) * channels * sizeof(float));
+        }
+        return frames;
+    }
+    return run(in, frames, out);
+}
+
+int AudioResampler::flush(float* out, int outCapacity) {
+    if (!bank || outCapacity < maxOutputFrames(0)) {
+        return bank ? -1 : 0;
+    }
+    // 补 taps/2 个零样本后，最后一个输入样本所在时刻之前的输出全部可以算出
+    const int produced = run(nullptr, bank->taps / 2, out);
+    reset();
+    return produced;
+}
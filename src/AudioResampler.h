@@ -0,0 +1,68 @@
+#ifndef AUDIORESAMPLER_H
+#define AUDIORESAMPLER_H
+
+#include <memory>
+#include <vector>
+
+/**
+ * 流式多相 FIR 重采样器 - 交错 float 输入输出，可按任意块大小连续处理同一条音频流
+ * 采样率比约分为 L/M 后按 Kaiser 窗 sinc 原型生成 L 个相位的滤波器组，按 (L, M) 在进程内缓存共享；
+ * 点积内核有 SSE/AVX2 实现，运行时选择
+ * 历史样本按声道分开保存在预分配的工作区中，配置完成后 process 不再分配内存
+ * 输出与输入在时间上对齐（滤波器居中，不引入群延迟），流结束时用 flush 取出末尾样本
+ */
+class AudioResampler {
+public:
+    static const int MAX_CHANNELS = 8;
+
+    AudioResampler();
+    ~AudioResampler();
+
+    // 配置采样率与声道数并清空历史；采样率比约分后相位数过多时返回 false
+    bool configure(int inputRate, int outputRate, int channels);
+
+    bool isConfigured() const { return configured; }
+    int inputRate() const { return srcRate; }
+    int outputRate() const { return dstRate; }
+    int channelCount() const { return channels; }
+
+    // 清空历史，下一块视为流的开头
+    void reset();
+
+    // 处理 frames 帧输入所需的最大输出帧数（out 的容量不能小于该值）
+    int maxOutputFrames(int inputFrames) const;
+
+    // 处理一块交错输入，返回写入 out 的帧数；out 容量不足时返回 -1 且不消耗输入
+    int process(const float* in, int frames, float* out, int outCapacity);
+
+    // 流结束时送入零样本取出滤波器中剩余的输出并清空历史，返回写入的帧数（out 容量不能小于 maxOutputFrames(0)）
+    int flush(float* out, int outCapacity);
+
+private:
+    struct FilterBank;
+
+    // 每次搬入历史工作区的最大输入帧数
+    static const int CHUNK_FRAMES = 1024;
+
+    // 按约分后的 L/M 生成多相滤波器组；cachedBank 在进程内按 (L, M) 共享
+    static std::shared_ptr<const FilterBank> buildBank(int phases, int step);
+    static std::shared_ptr<const FilterBank> cachedBank(int phases, int step);
+
+    int run(const float* in, int frames, float* out);
+    void appendInput(const float* in, int frames);
+    int drainOutput(float* out);
+    void compactHistory();
+
+    std::shared_ptr<const FilterBank> bank;
+    std::vector<float> history;     // 每声道一段：[taps + CHUNK_FRAMES]
+    int historyStride;
+    int filled;                     // 每声道已有的样本数
+    int readPos;                    // 下一个输出窗口的起点
+    int phase;                      // 下一个输出的相位（0..L-1）
+    int srcRate;
+    int dstRate;
+    int channels;
+    bool configured;
+};
+
+#endif // AUDIORESAMPLER_H
@@ -0,0 +1,86 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+/**
+ * 运行时 CPU 特性检测 - 供各 SIMD 内核在运行时选择实现
+ * x86 上 SSE2 为基线；AVX2/SSE4.1 内核通过函数级 target 属性单独编译，
+ * 因此整个程序无需提高编译基线也能在新 CPU 上走宽向量路径
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AICP_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(AICP_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AICP_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define AICP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AICP_TARGET_SSE41
+#define AICP_TARGET_AVX2
+#endif
+
+namespace CpuFeatures {
+
+#if defined(AICP_X86) && defined(_MSC_VER) && !defined(__clang__)
+inline bool msvcHasAvx2() {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+
+inline bool msvcHasSse41() {
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+}
+#endif
+
+inline bool hasSSE2() {
+#if defined(AICP_X86)
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline bool hasSSE41() {
+#if defined(AICP_X86) && (defined(__GNUC__) || defined(__clang__))
+    static const bool supported = __builtin_cpu_supports("sse4.1");
+    return supported;
+#elif defined(AICP_X86) && defined(_MSC_VER)
+    static const bool supported = msvcHasSse41();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool hasAVX2() {
+#if defined(AICP_X86) && (defined(__GNUC__) || defined(__clang__))
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#elif defined(AICP_X86) && defined(_MSC_VER)
+    static const bool supported = msvcHasAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+} // namespace CpuFeatures
+
+#endif // CPUFEATURES_H
@@ -0,0 +1,78 @@
+#include "EncodedFrame.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <algorithm>
+
+QString EncodedFrame::name() const {
+    if (!sourcePath.isEmpty()) {
+        return QFileInfo(sourcePath).fileName();
+    }
+    return QString("frame_%1@%2s").arg(index, 4, 10, QChar('0')).arg(timestamp, 0, 'f', 1);
+}
+
+QImage EncodedFrame::decodePreview(int denominator) const {
+    QBuffer buffer;
+    QImageReader reader;
+    if (!jpegData.isEmpty()) {
+        buffer.setData(jpegData);
+        buffer.open(QIODevice::ReadOnly);
+        reader.setDevice(&buffer);
+    } else {
+        reader.setFileName(sourcePath);
+    }
+
+    const QSize size = reader.size();
+    if (size.isValid() && denominator > 1) {
+        reader.setScaledSize(QSize(std::max(1, size.width() / denominator),
+                                   std::max(1, size.height() / denominator)));
+    }
+    return reader.read().convertToFormat(QImage::Format_RGB32);
+}
+
+bool EncodedFrame::dumpTo(const QString &directory, const QString &prefix) {
+    if (directory.isEmpty() || jpegData.isEmpty()) {
+        return false;
+    }
+    if (!QDir().mkpath(directory)) {
+        qWarning() << "无法创建帧转储目录:" << directory;
+        return false;
+    }
+
+    const QString path = QString("%1/%2_%3_%4.jpg")
+                         .arg(directory, prefix)
+                         .arg(index, 4, 10, QChar('0'))
+                         .arg(qint64(timestamp * 1000));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(jpegData) != jpegData.size()) {
+        qWarning() << "无法写入帧转储文件:" << path;
+        return false;
+    }
+    sourcePath = path;
+    return true;
+}
+
+EncodedFrame EncodedFrame::fromFile(const QString &path, int index, double timestamp) {
+    EncodedFrame frame;
+    frame.sourcePath = path;
+    frame.index = index;
+    frame.timestamp = timestamp;
+    return frame;
+}
+
+FrameData EncodedFrame::frameView(const QImage &image) {
+    FrameData view;
+    if (image.format() != QImage::Format_RGB32 && image.format() != QImage::Format_ARGB32) {
+        return view;
+    }
+    view.data = const_cast<uint8_t *>(image.constBits());
+    view.size = static_cast<size_t>(image.sizeInBytes());
+    view.width = image.width();
+    view.height = image.height();
+    view.stride = static_cast<int>(image.bytesPerLine());
+    view.format = PixelFormat::BGRA32;
+    return view;
+}
@@ -0,0 +1,42 @@
+#ifndef ENCODEDFRAME_H
+#define ENCODEDFRAME_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include "DataTypes.h"
+
+/**
+ * 已编码帧 - 帧提取器与 AI 分析器之间传递的内存 JPEG
+ * jpegData 为隐式共享的 QByteArray：复制、入队、跨线程传递只增加引用计数，最后一个持有者释放时回收
+ * 默认不落盘；sourcePath 仅在帧来自已有图片文件或开启了调试转储时非空
+ */
+struct EncodedFrame {
+    QByteArray jpegData;     // JPEG 数据（为空时从 sourcePath 读取）
+    double timestamp = 0.0;  // 相对录制/视频开始的秒数
+    int index = 0;           // 提取序号（从 1 开始）
+    QString sourcePath;      // 来源图片或调试转储文件路径
+
+    bool isValid() const { return !jpegData.isEmpty() || !sourcePath.isEmpty(); }
+
+    // 日志与结果中使用的名称
+    QString name() const;
+
+    // 按约 1/denominator 尺寸解码为 RGB32（JPEG 在 DCT 域缩小，远快于完整解码），用于指纹、变化检测等粗略分析
+    QImage decodePreview(int denominator = 8) const;
+
+    // 调试用：把 JPEG 写入 directory/<prefix>_<序号>_<毫秒>.jpg，成功时记录到 sourcePath
+    bool dumpTo(const QString &directory, const QString &prefix);
+
+    // 由已有图片文件构造（数据延迟到编码时读取）
+    static EncodedFrame fromFile(const QString &path, int index = 0, double timestamp = 0.0);
+
+    // 把 RGB32 图像包装为不拥有数据的 BGRA32 帧视图（小端内存布局相同），视图使用期间 image 须保持有效
+    static FrameData frameView(const QImage &image);
+};
+
+Q_DECLARE_METATYPE(EncodedFrame)
+
+#endif // ENCODEDFRAME_H
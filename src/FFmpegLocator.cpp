@@ -0,0 +1,338 @@
+#include "FFmpegLocator.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStandardPaths>
+#include <chrono>
+
+namespace {
+
+// 单次探测命令的超时
+const int PROBE_TIMEOUT_MS = 5000;
+
+// 缓存格式版本，解析逻辑变化时递增以作废旧缓存
+const int CACHE_VERSION = 1;
+
+QString runTool(const QString &program, const QStringList &arguments) {
+    QProcess process;
+    process.start(program, arguments);
+    if (!process.waitForFinished(PROBE_TIMEOUT_MS)) {
+        process.kill();
+        process.waitForFinished(1000);
+        return QString();
+    }
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        return QString();
+    }
+    return QString::fromLocal8Bit(process.readAllStandardOutput());
+}
+
+// 解析 "-encoders"/"-devices" 的表格输出：分隔线之后每行为 "<标志> <名称> <描述>"
+QStringList parseFlagTable(const QString &output, const QString &separator, QChar requiredFlag) {
+    QStringList names;
+    bool inTable = false;
+    const QStringList lines = output.split('\n');
+    for (const QString &line : lines) {
+        const QString trimmed = line.trimmed();
+        if (!inTable) {
+            inTable = trimmed.startsWith(separator);
+            continue;
+        }
+        const QStringList fields = trimmed.split(' ', Qt::SkipEmptyParts);
+        if (fields.size() < 2) {
+            continue;
+        }
+        if (requiredFlag.isNull() || fields[0].contains(requiredFlag)) {
+            names << fields[1];
+        }
+    }
+    return names;
+}
+
+QStringList toStringList(const QJsonValue &value) {
+    QStringList list;
+    const QJsonArray array = value.toArray();
+    for (const QJsonValue &item : array) {
+        list << item.toString();
+    }
+    return list;
+}
+
+qint64 fileStamp(const QString &path) {
+    QFileInfo info(path);
+    return info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+} // namespace
+
+FFmpegLocator &FFmpegLocator::instance() {
+    static FFmpegLocator locator;
+    return locator;
+}
+
+FFmpegLocator::FFmpegLocator()
+    : started(false)
+    , ready(false)
+    , capsKnown(false)
+{
+}
+
+FFmpegLocator::~FFmpegLocator() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void FFmpegLocator::resolveAsync() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (started) {
+        return;
+    }
+    started = true;
+    worker = std::thread(&FFmpegLocator::resolveWorker, this);
+}
+
+bool FFmpegLocator::isReady() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ready;
+}
+
+bool FFmpegLocator::waitReady(int timeoutMs) {
+    resolveAsync();
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!readyCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return ready; })) {
+        qWarning() << "等待 FFmpeg 定位超时";
+        return false;
+    }
+    return true;
+}
+
+QString FFmpegLocator::ffmpegPath(int timeoutMs) {
+    if (!waitReady(timeoutMs)) {
+        return QString();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return resolvedFFmpeg;
+}
+
+QString FFmpegLocator::ffprobePath(int timeoutMs) {
+    if (!waitReady(timeoutMs)) {
+        return QString();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return resolvedFFprobe;
+}
+
+FFmpegLocator::Capabilities FFmpegLocator::capabilities(int timeoutMs) {
+    if (!waitReady(timeoutMs)) {
+        return Capabilities();
+    }
+    std::lock_guard<std::mutex> probeLock(probeMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (capsKnown || resolvedFFmpeg.isEmpty()) {
+            return caps;
+        }
+    }
+    if (probeCapabilities()) {
+        saveCache();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    qDebug() << "FFmpeg 能力探测完成:" << caps.version << "编码器" << caps.encoders.size()
+             << "个, 输入设备" << caps.inputDevices.size() << "个, 硬件加速" << caps.hwaccels.join(",");
+    return caps;
+}
+
+QString FFmpegLocator::executableName(const QString &baseName) {
+#ifdef Q_OS_WIN
+    return baseName + ".exe";
+#else
+    return baseName;
+#endif
+}
+
+QStringList FFmpegLocator::candidatePaths(const QString &baseName) {
+    const QString exe = executableName(baseName);
+    const QString appDir = QCoreApplication::applicationDirPath();
+    QStringList paths;
+    // 程序目录随应用分发，优先级最高
+    paths << appDir + "/" + exe
+          << appDir + "/bin/" + exe
+          << appDir + "/tools/" + exe;
+
+    const QString inPath = QStandardPaths::findExecutable(baseName);
+    if (!inPath.isEmpty()) {
+        paths << inPath;
+    }
+
+#ifdef Q_OS_WIN
+    paths << "C:/ffmpeg/bin/" + exe
+          << "C:/Program Files/ffmpeg/bin/" + exe
+          << "C:/Program Files (x86)/ffmpeg/bin/" + exe;
+#else
+    paths << "/usr/bin/" + exe
+          << "/usr/local/bin/" + exe
+          << "/opt/homebrew/bin/" + exe;
+#endif
+    return paths;
+}
+
+QString FFmpegLocator::locateExecutable(const QString &baseName, const QString &preferredDir) {
+    // 只检查文件系统，不启动进程
+    if (!preferredDir.isEmpty()) {
+        QFileInfo sibling(QDir(preferredDir).filePath(executableName(baseName)));
+        if (sibling.exists() && sibling.isExecutable()) {
+            return sibling.absoluteFilePath();
+        }
+    }
+    const QStringList paths = candidatePaths(baseName);
+    for (const QString &path : paths) {
+        QFileInfo info(path);
+        if (info.exists() && info.isFile() && info.isExecutable()) {
+            return info.absoluteFilePath();
+        }
+    }
+    return QString();
+}
+
+QString FFmpegLocator::cacheFilePath() {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) {
+        return QString();
+    }
+    QDir().mkpath(dir);
+    return dir + "/ffmpeg_locator.json";
+}
+
+void FFmpegLocator::resolveWorker() {
+    // 只查文件系统；能否运行与具备哪些能力留到第一次 capabilities() 时探测
+    const QString ffmpeg = locateExecutable("ffmpeg", QString());
+    bool fromCache = false;
+    if (!ffmpeg.isEmpty()) {
+        fromCache = loadCache(ffmpeg);
+    }
+
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!fromCache) {
+            resolvedFFmpeg = ffmpeg;
+            resolvedFFprobe = ffmpeg.isEmpty() ? QString()
+                                               : locateExecutable("ffprobe", QFileInfo(ffmpeg).absolutePath());
+            caps = Capabilities();
+            capsKnown = false;
+        }
+        found = !resolvedFFmpeg.isEmpty();
+        ready = true;
+        qDebug() << "FFmpeg 定位完成:" << (found ? resolvedFFmpeg : QString("未找到"))
+                 << (fromCache ? "(缓存)" : "(能力待探测)");
+    }
+    readyCondition.notify_all();
+
+    QMetaObject::invokeMethod(this, [this, found]() {
+        emit resolved(found);
+    }, Qt::QueuedConnection);
+}
+
+bool FFmpegLocator::probeCapabilities() {
+    QString ffmpeg;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ffmpeg = resolvedFFmpeg;
+    }
+    const QString versionOutput = runTool(ffmpeg, {"-hide_banner", "-version"});
+    if (versionOutput.isEmpty()) {
+        // 无法运行时不写缓存，保留空能力表（调用方按“未知”处理），下次启动重新探测
+        qWarning() << "FFmpeg 无法运行:" << ffmpeg;
+        std::lock_guard<std::mutex> lock(mutex);
+        capsKnown = true;
+        return false;
+    }
+    const QStringList encoders = parseFlagTable(runTool(ffmpeg, {"-hide_banner", "-encoders"}), "------", QChar());
+    const QStringList devices = parseFlagTable(runTool(ffmpeg, {"-hide_banner", "-devices"}), "--", QChar('D'));
+
+    QStringList hwaccels;
+    const QStringList hwLines = runTool(ffmpeg, {"-hide_banner", "-hwaccels"}).split('\n');
+    for (const QString &line : hwLines) {
+        const QString name = line.trimmed();
+        if (!name.isEmpty() && !name.endsWith(':')) {
+            hwaccels << name;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    caps.version = versionOutput.section('\n', 0, 0).trimmed();
+    caps.encoders = encoders;
+    caps.inputDevices = devices;
+    caps.hwaccels = hwaccels;
+    capsKnown = true;
+    return true;
+}
+
+bool FFmpegLocator::loadCache(const QString &ffmpeg) {
+    const QString cachePath = cacheFilePath();
+    QFile file(cachePath);
+    if (cachePath.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != CACHE_VERSION ||
+        root.value("ffmpegPath").toString() != ffmpeg ||
+        root.value("ffmpegMtime").toVariant().toLongLong() != fileStamp(ffmpeg) ||
+        root.value("ffmpegSize").toVariant().toLongLong() != QFileInfo(ffmpeg).size()) {
+        return false;
+    }
+
+    // ffprobe 也需与缓存时一致（包括“当时不存在”）
+    const QString ffprobe = locateExecutable("ffprobe", QFileInfo(ffmpeg).absolutePath());
+    if (root.value("ffprobePath").toString() != ffprobe ||
+        (!ffprobe.isEmpty() && root.value("ffprobeMtime").toVariant().toLongLong() != fileStamp(ffprobe))) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    resolvedFFmpeg = ffmpeg;
+    resolvedFFprobe = ffprobe;
+    caps.version = root.value("ffmpegVersion").toString();
+    caps.encoders = toStringList(root.value("encoders"));
+    caps.inputDevices = toStringList(root.value("inputDevices"));
+    caps.hwaccels = toStringList(root.value("hwaccels"));
+    capsKnown = true;
+    return true;
+}
+
+void FFmpegLocator::saveCache() const {
+    const QString cachePath = cacheFilePath();
+    if (cachePath.isEmpty()) {
+        return;
+    }
+
+    QJsonObject root;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        root["version"] = CACHE_VERSION;
+        root["ffmpegPath"] = resolvedFFmpeg;
+        root["ffmpegMtime"] = QString::number(fileStamp(resolvedFFmpeg));
+        root["ffmpegSize"] = QString::number(QFileInfo(resolvedFFmpeg).size());
+        root["ffprobePath"] = resolvedFFprobe;
+        root["ffprobeMtime"] = QString::number(fileStamp(resolvedFFprobe));
+        root["ffmpegVersion"] = caps.version;
+        root["encoders"] = QJsonArray::fromStringList(caps.encoders);
+        root["inputDevices"] = QJsonArray::fromStringList(caps.inputDevices);
+        root["hwaccels"] = QJsonArray::fromStringList(caps.hwaccels);
+    }
+
+    QFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入 FFmpeg 缓存:" << cachePath;
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+}
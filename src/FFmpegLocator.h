@@ -0,0 +1,81 @@
+#ifndef FFMPEGLOCATOR_H
+#define FFMPEGLOCATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * FFmpeg 定位服务 - 进程内唯一实例，统一查找 ffmpeg/ffprobe 并探测能力
+ * 路径解析在后台线程进行且只检查文件系统，不启动任何进程；
+ * 能力探测（-version/-encoders/-devices/-hwaccels）推迟到第一次调用 capabilities() 时才做，
+ * 结果按可执行文件的修改时间缓存到磁盘，文件未变化时下次直接复用缓存，不再启动 ffmpeg 进程
+ */
+class FFmpegLocator : public QObject {
+    Q_OBJECT
+
+public:
+    struct Capabilities {
+        QString version;          // ffmpeg -version 第一行
+        QStringList encoders;     // 可用编码器名（libx264、h264_nvenc 等）
+        QStringList inputDevices; // 可用输入设备（x11grab、gdigrab、avfoundation 等）
+        QStringList hwaccels;     // 可用硬件加速方式（vaapi、cuda、videotoolbox 等）
+
+        bool hasEncoder(const QString &name) const { return encoders.contains(name); }
+        bool hasInputDevice(const QString &name) const { return inputDevices.contains(name); }
+        bool hasHwaccel(const QString &name) const { return hwaccels.contains(name); }
+    };
+
+    static FFmpegLocator &instance();
+
+    // 开始后台解析（可重复调用，只会执行一次）
+    void resolveAsync();
+
+    // 解析是否已完成（无论是否找到）
+    bool isReady() const;
+
+    // 获取路径；尚未解析完成时最多等待 timeoutMs 毫秒。未找到返回空字符串
+    QString ffmpegPath(int timeoutMs = 15000);
+    QString ffprobePath(int timeoutMs = 15000);
+
+    // 获取能力；缓存未命中时在调用线程上运行探测命令（每个进程只探测一次），不要在启动路径上调用
+    Capabilities capabilities(int timeoutMs = 15000);
+
+signals:
+    // 解析完成（在 FFmpegLocator 所在线程发出）
+    void resolved(bool found);
+
+private:
+    FFmpegLocator();
+    ~FFmpegLocator();
+    FFmpegLocator(const FFmpegLocator &) = delete;
+    FFmpegLocator &operator=(const FFmpegLocator &) = delete;
+
+    void resolveWorker();
+    bool waitReady(int timeoutMs);
+
+    static QString executableName(const QString &baseName);
+    static QStringList candidatePaths(const QString &baseName);
+    static QString locateExecutable(const QString &baseName, const QString &preferredDir);
+    static QString cacheFilePath();
+    bool loadCache(const QString &ffmpeg);
+    void saveCache() const;
+    bool probeCapabilities();
+
+    mutable std::mutex mutex;
+    std::mutex probeMutex;          // 串行化能力探测，避免并发调用重复启动进程
+    std::condition_variable readyCondition;
+    std::thread worker;
+    bool started;
+    bool ready;
+    bool capsKnown;                 // 能力已从缓存读入或探测过
+
+    QString resolvedFFmpeg;
+    QString resolvedFFprobe;
+    Capabilities caps;
+};
+
+#endif // FFMPEGLOCATOR_H
@@ -0,0 +1,448 @@
+// FFmpegPipeEncoder.cpp
+// 原始帧 -> ffmpeg stdin 管道编码实现（POSIX）
+#include "FFmpegPipeEncoder.h"
+#include <iostream>
+#include <vector>
+#include <csignal>
+#include <cerrno>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+namespace {
+
+// NUT 容器（ffmpeg 原生格式）的最小写出，只用到单路原始视频：文件头 + 主头 + 流头，之后每帧一个同步点加帧头。
+// 包的校验和为 CRC-32（多项式 0x04C11DB7，初值 0，高位在前），按大端追加在包尾
+const char NUT_FILE_ID[] = "nut/multimedia container";   // 含结尾的 '\0'
+const uint64_t NUT_MAIN_STARTCODE = 0x7A561F5F04ADULL + ((static_cast<uint64_t>('N' << 8) + 'M') << 48);
+const uint64_t NUT_STREAM_STARTCODE = 0x11405BF2F9DBULL + ((static_cast<uint64_t>('N' << 8) + 'S') << 48);
+const uint64_t NUT_SYNCPOINT_STARTCODE = 0xE4ADEECA4569ULL + ((static_cast<uint64_t>('N' << 8) + 'K') << 48);
+
+// 帧标志：帧头里显式给出标志、pts、数据长度和帧头校验和（原始帧远大于同步点间距，必须带校验和）
+const uint64_t NUT_FLAG_KEY = 1;
+const uint64_t NUT_FLAG_CODED_PTS = 8;
+const uint64_t NUT_FLAG_SIZE_MSB = 32;
+const uint64_t NUT_FLAG_CHECKSUM = 64;
+const uint64_t NUT_FLAG_CODED = 4096;
+const uint64_t NUT_FRAME_FLAGS = NUT_FLAG_KEY | NUT_FLAG_CODED_PTS | NUT_FLAG_SIZE_MSB | NUT_FLAG_CHECKSUM;
+
+const int NUT_MSB_PTS_SHIFT = 14;
+const int NUT_MAX_DISTANCE = 65536;
+
+// ffmpeg 原始视频的 fourcc，决定解码端的像素格式
+const char *nutFourcc(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGB24:   return "RGB\x18";
+    case PixelFormat::BGR24:   return "BGR\x18";
+    case PixelFormat::RGBA32:  return "RGBA";
+    case PixelFormat::BGRA32:  return "BGRA";
+    case PixelFormat::YUV420P: return "I420";
+    case PixelFormat::YUV422P: return "Y42B";
+    case PixelFormat::YUV444P: return "444P";
+    case PixelFormat::NV12:    return "NV12";
+    }
+    return "BGRA";
+}
+
+uint32_t nutChecksum(const uint8_t *data, size_t size) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint32_t>(data[i]) << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+        }
+    }
+    return crc;
+}
+
+void putBigEndian(std::vector<uint8_t> &out, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+// 变长整数：每字节 7 位，高位组在前，最高位为 1 表示后面还有字节
+void putVarint(std::vector<uint8_t> &out, uint64_t value) {
+    int groups = 1;
+    while (groups < 10 && (value >> (7 * groups)) != 0) {
+        ++groups;
+    }
+    for (int i = groups - 1; i > 0; --i) {
+        out.push_back(static_cast<uint8_t>(0x80 | ((value >> (7 * i)) & 0x7F)));
+    }
+    out.push_back(static_cast<uint8_t>(value & 0x7F));
+}
+
+// 包 = 起始码 + 长度 + 内容 + 校验和（内容不超过 4096 字节，长度字段本身不需要校验和）
+void putNutPacket(std::vector<uint8_t> &out, uint64_t startcode, const std::vector<uint8_t> &body) {
+    putBigEndian(out, startcode, 8);
+    putVarint(out, body.size() + 4);
+    out.insert(out.end(), body.begin(), body.end());
+    putBigEndian(out, nutChecksum(body.data(), body.size()), 4);
+}
+
+// 文件头、主头（时间基 1/fps，256 个帧码全部为“标志显式编码”）与单路视频流头
+std::vector<uint8_t> nutStreamHeader(int width, int height, int fps, PixelFormat format) {
+    std::vector<uint8_t> out(NUT_FILE_ID, NUT_FILE_ID + sizeof(NUT_FILE_ID));
+
+    std::vector<uint8_t> main;
+    putVarint(main, 3);                     // 版本
+    putVarint(main, 1);                     // 流数
+    putVarint(main, NUT_MAX_DISTANCE);
+    putVarint(main, 1);                     // 时间基数
+    putVarint(main, 1);
+    putVarint(main, static_cast<uint64_t>(fps));
+    putVarint(main, NUT_FLAG_CODED);        // 帧码表：除保留的 'N' 外 255 个帧码共用一组
+    putVarint(main, 6);                     // 本组给出 pts 增量、长度乘数、流号、长度低位、保留数、个数
+    putVarint(main, 0);
+    putVarint(main, 1);
+    putVarint(main, 0);
+    putVarint(main, 0);
+    putVarint(main, 0);
+    putVarint(main, 255);
+    putVarint(main, 0);                     // 无额外的帧头模板
+    putNutPacket(out, NUT_MAIN_STARTCODE, main);
+
+    std::vector<uint8_t> stream;
+    putVarint(stream, 0);                   // 流号
+    putVarint(stream, 0);                   // 视频
+    putVarint(stream, 4);
+    const char *fourcc = nutFourcc(format);
+    stream.insert(stream.end(), fourcc, fourcc + 4);
+    putVarint(stream, 0);                   // 时间基序号
+    putVarint(stream, NUT_MSB_PTS_SHIFT);
+    putVarint(stream, static_cast<uint64_t>(fps) * 3600);   // pts 最大跨度（帧都带校验和，实际不受限）
+    putVarint(stream, 0);                   // 解码延迟
+    putVarint(stream, 0);                   // 流标志
+    putVarint(stream, 0);                   // 无编解码器私有数据
+    putVarint(stream, static_cast<uint64_t>(width));
+    putVarint(stream, static_cast<uint64_t>(height));
+    putVarint(stream, 1);                   // 方形像素
+    putVarint(stream, 1);
+    putVarint(stream, 0);                   // 色彩空间类型（未指定）
+    putNutPacket(out, NUT_STREAM_STARTCODE, stream);
+    return out;
+}
+
+// 原始帧紧凑排列后的字节数
+size_t packedFrameBytes(const FrameData &frame) {
+    size_t bytes = 0;
+    for (int p = 0; p < frame.planeCount(); ++p) {
+        bytes += static_cast<size_t>(frame.planeWidth(p)) * pixelFormatPlaneBytesPerPixel(frame.format, p) *
+                 frame.planeHeight(p);
+    }
+    return bytes;
+}
+
+} // namespace
+
+FFmpegPipeEncoder::FFmpegPipeEncoder(const std::string &path)
+    : ffmpegPath(path)
+    , pid(-1)
+    , stdinFd(-1)
+    , frameCount(0)
+    , skipCount(0)
+    , baseTimestamp(0)
+    , nextSlot(-1)
+    , streamBytes(0)
+    , lastSyncpoint(0)
+{
+}
+
+FFmpegPipeEncoder::~FFmpegPipeEncoder() {
+    if (isRunning()) {
+        finalize(config.outputPath);
+    }
+}
+
+bool FFmpegPipeEncoder::setup(const EncoderConfig &newConfig) {
+    if (isRunning()) {
+        std::cerr << "编码器已在运行" << std::endl;
+        return false;
+    }
+    if (newConfig.width <= 0 || newConfig.height <= 0 || newConfig.outputPath.empty()) {
+        std::cerr << "编码器配置无效" << std::endl;
+        return false;
+    }
+    config = newConfig;
+    frameCount = 0;
+    skipCount = 0;
+    baseTimestamp = 0;
+    nextSlot = -1;
+    streamBytes = 0;
+    lastSyncpoint = 0;
+    converter.setColorSpec(config.colorMatrix, config.colorRange);
+    convertedFrame = FrameData();
+
+    // ffmpeg 异常退出时写管道会触发 SIGPIPE，改为由 write 返回 EPIPE 处理
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const int fps = config.fps > 0 ? config.fps : 30;
+    const std::string videoSize = std::to_string(config.width) + "x" + std::to_string(config.height);
+
+    std::vector<std::string> args = {
+        ffmpegPath, "-hide_banner", "-loglevel", "warning", "-nostats", "-y",
+        // NUT 输入携带每帧 pts（时间基 1/fps，即帧位序号）；格式、尺寸在流头里
+        "-f", "nut",
+        "-i", "pipe:0",
+    };
+    // fps 滤镜把每个输出帧位填为 pts 不晚于它的最近一帧，没有写入的帧位即复制上一帧；
+    // pts 已是整数帧位，映射是精确的（-r 的输出同步按浮点阈值取舍，间隙后的帧会提前一个帧位）
+    std::string filters = "fps=" + std::to_string(fps);
+    // yuv420p 要求宽高为偶数，奇数尺寸补一像素边而不是裁掉已捕获的内容
+    if ((config.width | config.height) & 1) {
+        filters += ",pad=ceil(iw/2)*2:ceil(ih/2)*2";
+    }
+    args.push_back("-vf");
+    args.push_back(filters);
+    args.push_back("-pix_fmt");
+    args.push_back("yuv420p");
+    // 进程内转换得到的 YUV 标注实际使用的矩阵和范围，播放器据此还原颜色
+    if (pixelFormatIsYuv(config.inputFormat)) {
+        args.push_back("-colorspace");
+        args.push_back(config.colorMatrix == YuvMatrix::BT709 ? "bt709" : "smpte170m");
+        args.push_back("-color_range");
+        args.push_back(config.colorRange == YuvRange::Full ? "pc" : "tv");
+    }
+    args.push_back("-c:v");
+    args.push_back(config.codec);
+    args.push_back("-preset");
+    args.push_back(config.preset);
+    if (config.bitrate > 0) {
+        args.push_back("-b:v");
+        args.push_back(std::to_string(config.bitrate));
+    } else {
+        args.push_back("-crf");
+        args.push_back(std::to_string(config.crf));
+    }
+    args.push_back(config.outputPath);
+
+    int pipeFds[2];
+    if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+        std::cerr << "创建编码管道失败" << std::endl;
+        return false;
+    }
+    // 扩大管道缓冲，减少捕获线程在写入时被编码进程阻塞
+    fcntl(pipeFds[1], F_SETPIPE_SZ, 1 << 20);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipeFds[0], STDIN_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+    std::vector<char *> argv;
+    for (std::string &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    int rc = posix_spawnp(&pid, ffmpegPath.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(pipeFds[0]);
+
+    if (rc != 0) {
+        std::cerr << "启动 ffmpeg 编码进程失败: " << rc << std::endl;
+        close(pipeFds[1]);
+        pid = -1;
+        return false;
+    }
+
+    stdinFd = pipeFds[1];
+    const std::vector<uint8_t> header = nutStreamHeader(config.width, config.height, fps, config.inputFormat);
+    if (!writeAll(header.data(), header.size())) {
+        close(stdinFd);
+        stdinFd = -1;
+        killEncoder();
+        return false;
+    }
+    std::cout << "FFmpeg 编码进程已启动: " << videoSize << " @ " << fps << "fps -> "
+              << config.outputPath << std::endl;
+    return true;
+}
+
+EncodedData FFmpegPipeEncoder::encode(const FrameData &frame) {
+    EncodedData result;
+    result.timestamp = frame.timestamp;
+
+    if (stdinFd < 0 || !frame.data) {
+        return result;
+    }
+    if (frame.width != config.width || frame.height != config.height) {
+        std::cerr << "帧尺寸与编码器配置不一致: " << frame.width << "x" << frame.height << std::endl;
+        return result;
+    }
+
+    // 帧位 = 相对第一帧的时间戳按帧率四舍五入
+    const int fps = config.fps > 0 ? config.fps : 30;
+    int64_t slot = 0;
+    if (nextSlot < 0) {
+        baseTimestamp = frame.timestamp;
+    } else {
+        const int64_t elapsedUs = static_cast<int64_t>(frame.timestamp) - static_cast<int64_t>(baseTimestamp);
+        slot = (elapsedUs * fps + 500000) / 1000000;
+        if (slot < nextSlot) {
+            // 该帧位已经写过（或时间戳回退），保持每个帧位一帧
+            result.ok = true;
+            return result;
+        }
+    }
+
+    // 格式与管道输入格式不同时先转换到复用缓冲，源帧保持不变（旁路等仍可使用原格式）
+    const FrameData *input = &frame;
+    if (frame.format != config.inputFormat) {
+        if (!convertedFrame.data && !convertedFrame.allocateImage(config.width, config.height, config.inputFormat)) {
+            std::cerr << "分配格式转换缓冲失败" << std::endl;
+            result.ok = false;
+            return result;
+        }
+        converter.convert(frame, convertedFrame);
+        input = &convertedFrame;
+    }
+
+    // 空缺的帧位不写数据，由 ffmpeg 按 pts 补齐
+    result.ok = writeFrame(*input, slot);
+    if (result.ok) {
+        if (nextSlot >= 0) {
+            skipCount += static_cast<uint64_t>(slot - nextSlot);
+        }
+        nextSlot = slot + 1;
+        ++frameCount;
+    }
+    return result;
+}
+
+bool FFmpegPipeEncoder::writeFrame(const FrameData &input, int64_t pts) {
+    if (!input.data) {
+        return false;
+    }
+    // 每帧前放一个同步点：NUT 要求帧头距上一个同步点不超过 max_distance，而原始帧本身就远大于它
+    headerBuffer.clear();
+    std::vector<uint8_t> syncpoint;
+    putVarint(syncpoint, static_cast<uint64_t>(pts));
+    putVarint(syncpoint, frameCount > 0 ? (streamBytes - lastSyncpoint) >> 4 : 0);
+    lastSyncpoint = streamBytes;
+    putNutPacket(headerBuffer, NUT_SYNCPOINT_STARTCODE, syncpoint);
+
+    const size_t frameHeaderStart = headerBuffer.size();
+    headerBuffer.push_back(0);   // 帧码 0：标志在帧头里显式给出
+    putVarint(headerBuffer, NUT_FRAME_FLAGS ^ NUT_FLAG_CODED);
+    putVarint(headerBuffer, static_cast<uint64_t>(pts) + (1ULL << NUT_MSB_PTS_SHIFT));
+    putVarint(headerBuffer, packedFrameBytes(input));
+    putBigEndian(headerBuffer, nutChecksum(headerBuffer.data() + frameHeaderStart,
+                                           headerBuffer.size() - frameHeaderStart), 4);
+    return writeAll(headerBuffer.data(), headerBuffer.size()) && writePlanes(input);
+}
+
+bool FFmpegPipeEncoder::writePlanes(const FrameData &input) {
+    if (!input.data) {
+        return false;
+    }
+    // 逐平面写出；紧凑平面整块写，带行填充或裁剪视图逐行写
+    bool ok = true;
+    for (int p = 0; p < input.planeCount() && ok; ++p) {
+        const uint8_t *plane = input.plane(p);
+        const int planeStride = input.planeStride(p);
+        const int planeHeight = input.planeHeight(p);
+        const size_t rowBytes = static_cast<size_t>(input.planeWidth(p)) * pixelFormatPlaneBytesPerPixel(input.format, p);
+        if (static_cast<size_t>(planeStride) == rowBytes) {
+            ok = writeAll(plane, rowBytes * planeHeight);
+        } else {
+            for (int y = 0; y < planeHeight && ok; ++y) {
+                ok = writeAll(plane + static_cast<size_t>(y) * planeStride, rowBytes);
+            }
+        }
+    }
+    return ok;
+}
+
+bool FFmpegPipeEncoder::finalize(const std::string &outputPath) {
+    if (pid <= 0) {
+        return false;
+    }
+
+    // 关闭 stdin 即通知 ffmpeg 输入结束，等待其写完文件尾
+    if (stdinFd >= 0) {
+        close(stdinFd);
+        stdinFd = -1;
+    }
+
+    bool exited = waitForExit(5000);
+    if (!exited) {
+        std::cerr << "ffmpeg 未在超时内退出，强制结束" << std::endl;
+        killEncoder();
+    }
+
+    if (exited && !outputPath.empty() && outputPath != config.outputPath) {
+        if (std::rename(config.outputPath.c_str(), outputPath.c_str()) != 0) {
+            std::cerr << "移动输出文件失败: " << outputPath << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "FFmpeg 编码完成，共写入 " << frameCount << " 帧（跳过 " << skipCount << " 个帧位，由 ffmpeg 补齐）" << std::endl;
+    return exited;
+}
+
+bool FFmpegPipeEncoder::isRunning() const {
+    return pid > 0;
+}
+
+uint64_t FFmpegPipeEncoder::framesWritten() const {
+    return frameCount;
+}
+
+uint64_t FFmpegPipeEncoder::framesSkipped() const {
+    return skipCount;
+}
+
+bool FFmpegPipeEncoder::writeAll(const uint8_t *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(stdinFd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "写入编码管道失败，errno=" << errno << std::endl;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        streamBytes += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool FFmpegPipeEncoder::waitForExit(int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        int status = 0;
+        pid_t r = waitpid(pid, &status, WNOHANG);
+        if (r == pid || (r < 0 && errno != EINTR)) {
+            pid = -1;
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+void FFmpegPipeEncoder::killEncoder() {
+    if (pid <= 0) {
+        return;
+    }
+    kill(pid, SIGTERM);
+    if (!waitForExit(2000)) {
+        kill(pid, SIGKILL);
+        waitForExit(1000);
+    }
+    pid = -1;
+}
@@ -0,0 +1,58 @@
+#ifndef FFMPEGPIPEENCODER_H
+#define FFMPEGPIPEENCODER_H
+
+#include "ILocalEncoder.h"
+#include "DataTypes.h"
+#include "PixelConverter.h"
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/**
+ * FFmpeg 管道编码器 - 把进程内捕获的原始帧通过 stdin 管道送入 ffmpeg 编码
+ * 每次录制只启动一个 ffmpeg 编码进程，只负责编码和封装，不负责抓屏
+ * 送入的帧格式与 config.inputFormat 不同时先在进程内转换（如 BGRA -> YUV420P，管道数据量减少 62.5%）
+ * 管道使用 NUT 容器，每帧带显式 pts：pts 为帧时间戳（FramePacer 的理想时刻）相对第一帧换算出的帧位，
+ * 同一帧位的后续帧丢弃；空缺的帧位不写任何数据，由 ffmpeg 按输出帧率在编码前复制上一帧补齐，
+ * 静止或空闲期间既不转换也不写管道，视频时间轴不受管道到达时刻抖动影响
+ */
+class FFmpegPipeEncoder : public ILocalEncoder {
+public:
+    explicit FFmpegPipeEncoder(const std::string &ffmpegPath);
+    ~FFmpegPipeEncoder() override;
+
+    bool setup(const EncoderConfig &config) override;
+    EncodedData encode(const FrameData &frame) override;
+    bool finalize(const std::string &outputPath) override;
+
+    bool isRunning() const;
+
+    // 已写入管道的帧数（不含 ffmpeg 补齐空缺帧位的重复帧）
+    uint64_t framesWritten() const;
+
+    // 因跳过而由 ffmpeg 补齐的帧位数
+    uint64_t framesSkipped() const;
+
+private:
+    bool writeAll(const uint8_t *data, size_t size);
+    bool writeFrame(const FrameData &input, int64_t pts);
+    bool writePlanes(const FrameData &input);
+    bool waitForExit(int timeoutMs);
+    void killEncoder();
+
+    std::string ffmpegPath;
+    EncoderConfig config;
+    PixelConverter converter;
+    FrameData convertedFrame;   // 进程内格式转换的复用缓冲
+    std::vector<uint8_t> headerBuffer; // 每帧的 NUT 同步点与帧头
+    pid_t pid;
+    int stdinFd;
+    uint64_t frameCount;
+    uint64_t skipCount;
+    uint64_t baseTimestamp;     // 第 0 帧位的时间戳（第一帧）
+    int64_t nextSlot;           // 下一个待写的帧位，-1 表示尚未写入任何帧
+    uint64_t streamBytes;       // 已写入管道的字节数（NUT 同步点回指用）
+    uint64_t lastSyncpoint;     // 上一个同步点在流中的位置
+};
+
+#endif // FFMPEGPIPEENCODER_H
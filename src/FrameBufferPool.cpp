@@ -0,0 +1,152 @@
+// FrameBufferPool.cpp
+// 帧缓冲池实现：尺寸分级的空闲链表 + 对齐分配
+#include "FrameBufferPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace {
+
+const size_t CACHE_LINE = 64;
+const size_t PAGE_SIZE = 4096;
+// 达到该大小的缓冲按页对齐（整帧图像），更小的按缓存行对齐
+const size_t PAGE_ALIGN_THRESHOLD = 64 * 1024;
+
+void *alignedAlloc(size_t alignment, size_t size) {
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, alignment);
+#else
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, size) != 0) {
+        return nullptr;
+    }
+    return ptr;
+#endif
+}
+
+void alignedFree(void *ptr) {
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+} // namespace
+
+FrameBufferPool& FrameBufferPool::instance() {
+    // 有意不析构：静态对象析构顺序不确定，退出时仍可能有帧在归还缓冲
+    static FrameBufferPool *pool = new FrameBufferPool();
+    return *pool;
+}
+
+size_t FrameBufferPool::sizeClass(size_t size) {
+    if (size <= CACHE_LINE) {
+        return CACHE_LINE;
+    }
+    // 取不超过 size 的最大 2 的幂，再按其 1/8 向上取整
+    size_t power = 1;
+    while (power <= size / 2) {
+        power <<= 1;
+    }
+    size_t step = std::max(CACHE_LINE, power / 8);
+    size_t bytes = (size + step - 1) / step * step;
+    const size_t alignment = bytes >= PAGE_ALIGN_THRESHOLD ? PAGE_SIZE : CACHE_LINE;
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+FrameBuffer* FrameBufferPool::acquire(size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+    const size_t bytes = sizeClass(size);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = freeLists.find(bytes);
+        if (it != freeLists.end() && !it->second.empty()) {
+            FrameBuffer *buffer = it->second.back();
+            it->second.pop_back();
+            counters.hits++;
+            counters.bytesPooled -= bytes;
+            counters.bytesInUse += bytes;
+            buffer->refs.store(1, std::memory_order_relaxed);
+            return buffer;
+        }
+    }
+
+    const size_t alignment = bytes >= PAGE_ALIGN_THRESHOLD ? PAGE_SIZE : CACHE_LINE;
+    uint8_t *storage = static_cast<uint8_t *>(alignedAlloc(alignment, bytes));
+    if (!storage) {
+        std::cerr << "帧缓冲分配失败: " << bytes << " 字节" << std::endl;
+        return nullptr;
+    }
+    FrameBuffer *buffer = new (std::nothrow) FrameBuffer();
+    if (!buffer) {
+        alignedFree(storage);
+        return nullptr;
+    }
+    buffer->storage = storage;
+    buffer->capacityBytes = bytes;
+    buffer->refs.store(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.misses++;
+    counters.bytesInUse += bytes;
+    counters.peakBytes = std::max(counters.peakBytes, counters.bytesInUse + counters.bytesPooled);
+    return buffer;
+}
+
+void FrameBufferPool::recycle(FrameBuffer* buffer) {
+    const size_t bytes = buffer->capacityBytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.bytesInUse -= bytes;
+        if (counters.bytesPooled + bytes <= maxPooledBytes) {
+            freeLists[bytes].push_back(buffer);
+            counters.bytesPooled += bytes;
+            return;
+        }
+    }
+    destroy(buffer);
+}
+
+void FrameBufferPool::destroy(FrameBuffer* buffer) {
+    alignedFree(buffer->storage);
+    delete buffer;
+}
+
+FrameBufferPool::Stats FrameBufferPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void FrameBufferPool::setMaxPooledBytes(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxPooledBytes = bytes;
+        if (counters.bytesPooled <= maxPooledBytes) {
+            return;
+        }
+    }
+    trim();
+}
+
+void FrameBufferPool::trim() {
+    std::unordered_map<size_t, std::vector<FrameBuffer*>> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.swap(freeLists);
+        counters.bytesPooled = 0;
+    }
+    for (auto &entry : released) {
+        for (FrameBuffer *buffer : entry.second) {
+            destroy(buffer);
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#include "FrameFingerprint.h"
+#include "FrameScaler.h"
+#include "PixelConverter.h"
+#include <bitset>
+
+FrameFingerprint FrameFingerprint::compute(const FrameData& frame) {
+    FrameFingerprint fingerprint;
+    if (!frame.data || frame.width <= 0 || frame.height <= 0) {
+        return fingerprint;
+    }
+
+    // YUV 源直接缩放（只用 Y 平面），RGB 源缩放时顺带转换为 YUV420P 取亮度
+    static const PixelConverter converter;
+    const PixelFormat gridFormat = pixelFormatIsYuv(frame.format) ? frame.format : PixelFormat::YUV420P;
+    FrameData grid;
+    if (!grid.allocateImage(GRID + 1, GRID, gridFormat) ||
+        !FrameScaler::scaleConvert(frame, grid, ScaleFilter::Box, converter)) {
+        return fingerprint;
+    }
+
+    const uint8_t* luma = grid.plane(0);
+    const int stride = grid.planeStride(0);
+    int bit = 0;
+    for (int y = 0; y < GRID; ++y) {
+        const uint8_t* row = luma + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < GRID; ++x, ++bit) {
+            if (row[x] < row[x + 1]) {
+                fingerprint.words[bit >> 6] |= uint64_t(1) << (bit & 63);
+            }
+        }
+    }
+    fingerprint.valid = true;
+    return fingerprint;
+}
+
+int FrameFingerprint::distance(const FrameFingerprint& other) const {
+    if (!valid || !other.valid) {
+        return BITS;
+    }
+    int bits = 0;
+    for (int i = 0; i < BITS / 64; ++i) {
+        bits += static_cast<int>(std::bitset<64>(words[i] ^ other.words[i]).count());
+    }
+    return bits;
+}
@@ -0,0 +1,27 @@
+#ifndef FRAMEFINGERPRINT_H
+#define FRAMEFINGERPRINT_H
+
+#include "DataTypes.h"
+#include <cstdint>
+
+/**
+ * 帧感知指纹 - 差分哈希（dHash）
+ * 把帧面积平均缩小到 (GRID+1) x GRID 的亮度网格，逐行比较相邻格子的明暗得到 GRID*GRID 位指纹
+ * 缩小走 FrameScaler 的 SIMD 路径（RGB 源与亮度转换融合为一趟），比较用汉明距离
+ * 光标闪烁、时钟跳动等局部小变化只翻转少量位，切换窗口、翻页则翻转大量位
+ */
+struct FrameFingerprint {
+    static const int GRID = 16;
+    static const int BITS = GRID * GRID;
+
+    uint64_t words[BITS / 64] = {};
+    bool valid = false;
+
+    // 支持所有 PixelFormat；帧无效时返回 valid == false 的指纹
+    static FrameFingerprint compute(const FrameData& frame);
+
+    // 汉明距离（0 ~ BITS），任一指纹无效时返回 BITS
+    int distance(const FrameFingerprint& other) const;
+};
+
+#endif // FRAMEFINGERPRINT_H
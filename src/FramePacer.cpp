@@ -0,0 +1,115 @@
+// FramePacer.cpp
+// 帧节拍调度实现：单调时钟绝对时间睡眠 + 丢帧/迟到统计
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <time.h>
+#endif
+
+namespace {
+const int64_t NANOS_PER_SECOND = 1000000000LL;
+}
+
+FramePacer::FramePacer(int fps)
+    : fps(fps > 0 ? fps : 30)
+    , startNs(0)
+    , nextSlot(0)
+{
+}
+
+void FramePacer::setFrameRate(int newFps) {
+    fps = newFps > 0 ? newFps : 30;
+}
+
+int FramePacer::frameRate() const {
+    return fps;
+}
+
+uint64_t FramePacer::start() {
+    startNs = nowNanos();
+    // 第 0 帧位即当前时刻，调用方立即处理；之后的等待从第 1 帧位开始
+    nextSlot = 1;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    counters = Stats();
+    counters.frames = 1;
+    counters.targetFps = fps;
+    return static_cast<uint64_t>(startNs / 1000);
+}
+
+int64_t FramePacer::slotDeadline(int64_t slot) const {
+    // 用 slot*1e9/fps 直接计算，避免非整除周期（如 1e9/60）的舍入误差累积
+    return startNs + slot * NANOS_PER_SECOND / fps;
+}
+
+uint64_t FramePacer::waitNextFrame() {
+    int64_t deadline = slotDeadline(nextSlot);
+    int64_t now = nowNanos();
+    uint64_t skipped = 0;
+
+    if (now < deadline) {
+        sleepUntil(deadline);
+        now = nowNanos();
+    } else {
+        // 已错过后续帧位：跳到当前时刻所在的帧位，被越过的帧位计为丢帧
+        const int64_t currentSlot = (now - startNs) * fps / NANOS_PER_SECOND;
+        if (currentSlot > nextSlot) {
+            skipped = static_cast<uint64_t>(currentSlot - nextSlot);
+            nextSlot = currentSlot;
+            deadline = slotDeadline(nextSlot);
+        }
+    }
+
+    const int64_t latenessNs = now - deadline;
+    const int64_t periodNs = NANOS_PER_SECOND / fps;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        counters.frames++;
+        counters.droppedFrames += skipped;
+        if (latenessNs > periodNs / 2) {
+            counters.lateFrames++;
+        }
+        counters.maxLatenessUs = std::max<int64_t>(counters.maxLatenessUs, latenessNs / 1000);
+        const double elapsed = static_cast<double>(now - startNs) / NANOS_PER_SECOND;
+        counters.achievedFps = elapsed > 0.0 ? counters.frames / elapsed : 0.0;
+    }
+
+    ++nextSlot;
+    return static_cast<uint64_t>(deadline / 1000);
+}
+
+FramePacer::Stats FramePacer::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return counters;
+}
+
+uint64_t FramePacer::nowMicros() {
+    return static_cast<uint64_t>(nowNanos() / 1000);
+}
+
+int64_t FramePacer::nowNanos() {
+#ifdef __linux__
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * NANOS_PER_SECOND + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void FramePacer::sleepUntil(int64_t deadlineNs) {
+#ifdef __linux__
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadlineNs / NANOS_PER_SECOND);
+    ts.tv_nsec = static_cast<long>(deadlineNs % NANOS_PER_SECOND);
+    // 绝对时间睡眠：被信号打断后用同一截止时间重试，不会因重算相对时长而漂移
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadlineNs)));
+#endif
+}
@@ -0,0 +1,53 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <cstdint>
+#include <mutex>
+
+/**
+ * 帧节拍调度器 - 按固定帧率在单调时钟上安排每帧截止时间
+ * 截止时间始终由 起点 + n*周期 计算，不会累积漂移；Linux 上使用
+ * clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME) 绝对时间睡眠
+ * 醒来过晚的帧计为 late，整个帧位都被错过的计为 dropped
+ */
+class FramePacer {
+public:
+    struct Stats {
+        uint64_t frames = 0;          // 已调度的帧数
+        uint64_t lateFrames = 0;      // 醒来时已超过截止时间半个周期的帧数
+        uint64_t droppedFrames = 0;   // 被整个跳过的帧位数
+        int64_t maxLatenessUs = 0;    // 最大醒来延迟
+        double targetFps = 0.0;
+        double achievedFps = 0.0;     // 实际调度帧率（帧数 / 已运行时长）
+    };
+
+    explicit FramePacer(int fps = 30);
+
+    void setFrameRate(int fps);
+    int frameRate() const;
+
+    // 以当前时刻为第 0 帧位重新开始计时并清空统计，返回第 0 帧位的时间戳（微秒）
+    uint64_t start();
+
+    // 等待下一帧的截止时间，返回该帧位的理想时间戳（单调时钟，微秒）
+    // 落后超过一个周期时跳过已错过的帧位，后续帧仍对齐原始时间轴
+    uint64_t waitNextFrame();
+
+    Stats stats() const;
+
+    // 单调时钟当前时间（与 FrameData::timestamp 同一时基）
+    static uint64_t nowMicros();
+
+private:
+    static int64_t nowNanos();
+    static void sleepUntil(int64_t deadlineNs);
+    int64_t slotDeadline(int64_t slot) const;
+
+    int fps;
+    int64_t startNs;
+    int64_t nextSlot;
+    mutable std::mutex statsMutex;
+    Stats counters;
+};
+
+#endif // FRAMEPACER_H
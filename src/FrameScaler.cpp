@@ -0,0 +1,751 @@
+// FrameScaler.cpp
+// 帧缩放实现：缓存的定点滤波系数 + 水平/垂直两趟 SIMD 滤波 + 按行条带并行
+#include "FrameScaler.h"
+#include "CpuFeatures.h"
+#include "PixelConverter.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// 系数为 Q14；水平趟输出保留 6 位小数（Q6，16 位），垂直趟累加后为 Q20
+const int WEIGHT_BITS = 14;
+const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+const int INTERMEDIATE_SHIFT = 8;
+const int OUTPUT_SHIFT = 20;
+
+const double PI = 3.14159265358979323846;
+
+// 每个条带至少处理的输出行数，过小的条带调度开销大于收益
+const int MIN_ROWS_PER_SLICE = 32;
+
+// 系数缓存上限（尺寸组合数），超过后整体清空重建
+const size_t MAX_CACHED_FILTERS = 32;
+
+// 一维滤波表：每个输出位置从 offsets[i] 开始取 taps 个源样本，权重之和恰为 WEIGHT_ONE
+// 越界的源样本已折叠到边缘样本上，因此窗口总在 [0, 源尺寸) 内
+struct FilterTable {
+    int taps = 0;
+    std::vector<int> offsets;
+    std::vector<int16_t> weights;
+};
+
+double kernelSupport(ScaleFilter filter) {
+    switch (filter) {
+    case ScaleFilter::Box:     return 0.5;
+    case ScaleFilter::Lanczos: return 3.0;
+    case ScaleFilter::Bilinear:
+    default:                   return 1.0;
+    }
+}
+
+double kernelWeight(ScaleFilter filter, double x) {
+    x = std::fabs(x);
+    if (filter == ScaleFilter::Lanczos) {
+        if (x < 1e-8) {
+            return 1.0;
+        }
+        if (x >= 3.0) {
+            return 0.0;
+        }
+        const double px = PI * x;
+        return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+    }
+    return std::max(0.0, 1.0 - x);
+}
+
+std::shared_ptr<const FilterTable> buildFilter(int srcSize, int dstSize, ScaleFilter filter) {
+    auto table = std::make_shared<FilterTable>();
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    // 缩小时滤波核按比例展宽，保证每个输出样本覆盖全部对应的源样本
+    const double stretch = std::max(1.0, scale);
+    const double radius = kernelSupport(filter) * stretch;
+    const int rawTaps = filter == ScaleFilter::Box ? static_cast<int>(std::ceil(stretch)) + 1
+                                                   : static_cast<int>(std::ceil(2.0 * radius)) + 1;
+    const int taps = std::min(rawTaps, srcSize);
+    table->taps = taps;
+    table->offsets.resize(dstSize);
+    table->weights.resize(static_cast<size_t>(dstSize) * taps);
+
+    std::vector<double> weights(taps);
+    for (int x = 0; x < dstSize; ++x) {
+        std::fill(weights.begin(), weights.end(), 0.0);
+        const double begin = x * scale;
+        const double end = begin + scale;
+        const double center = begin + scale * 0.5 - 0.5;
+        const int left = filter == ScaleFilter::Box ? static_cast<int>(std::floor(begin))
+                                                    : static_cast<int>(std::floor(center - radius));
+        const int windowStart = std::max(0, std::min(left, srcSize - taps));
+        for (int k = 0; k < rawTaps; ++k) {
+            const int i = left + k;
+            double w;
+            if (filter == ScaleFilter::Box) {
+                // 面积平均：源像素 [i, i+1) 与输出像素覆盖区间的重叠长度
+                w = std::max(0.0, std::min<double>(i + 1, end) - std::max<double>(i, begin));
+            } else {
+                w = kernelWeight(filter, (i - center) / stretch);
+            }
+            const int clamped = std::max(0, std::min(i, srcSize - 1));
+            weights[clamped - windowStart] += w;
+        }
+
+        double sum = 0.0;
+        for (double w : weights) {
+            sum += w;
+        }
+        int16_t *q = &table->weights[static_cast<size_t>(x) * taps];
+        int qSum = 0;
+        int peak = 0;
+        for (int k = 0; k < taps; ++k) {
+            q[k] = static_cast<int16_t>(std::lround(weights[k] / sum * WEIGHT_ONE));
+            qSum += q[k];
+            if (q[k] > q[peak]) {
+                peak = k;
+            }
+        }
+        // 舍入误差补到最大的权重上，保证纯色区域缩放后不变
+        q[peak] = static_cast<int16_t>(q[peak] + WEIGHT_ONE - qSum);
+        table->offsets[x] = windowStart;
+    }
+    return table;
+}
+
+std::shared_ptr<const FilterTable> cachedFilter(int srcSize, int dstSize, ScaleFilter filter) {
+    static std::mutex cacheMutex;
+    static std::map<std::tuple<int, int, int>, std::shared_ptr<const FilterTable>> cache;
+    const auto key = std::make_tuple(srcSize, dstSize, static_cast<int>(filter));
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= MAX_CACHED_FILTERS) {
+        cache.clear();
+    }
+    auto table = buildFilter(srcSize, dstSize, filter);
+    cache.emplace(key, table);
+    return table;
+}
+
+inline uint8_t clampByte(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// 水平趟：一行源样本 -> 一行 Q6 中间结果
+void horizontalRowScalar(const uint8_t *src, int16_t *dst, int dstWidth, int channels, const FilterTable &t) {
+    for (int x = 0; x < dstWidth; ++x) {
+        const uint8_t *s = src + static_cast<size_t>(t.offsets[x]) * channels;
+        const int16_t *w = &t.weights[static_cast<size_t>(x) * t.taps];
+        for (int c = 0; c < channels; ++c) {
+            int acc = 0;
+            for (int k = 0; k < t.taps; ++k) {
+                acc += w[k] * s[k * channels + c];
+            }
+            dst[x * channels + c] = static_cast<int16_t>((acc + (1 << (INTERMEDIATE_SHIFT - 1))) >> INTERMEDIATE_SHIFT);
+        }
+    }
+}
+
+// 垂直趟：taps 行中间结果 -> 一行输出
+void verticalRowScalar(const int16_t *const *rows, const int16_t *w, int taps, uint8_t *dst, int begin, int count) {
+    for (int i = begin; i < count; ++i) {
+        int acc = 0;
+        for (int k = 0; k < taps; ++k) {
+            acc += w[k] * rows[k][i];
+        }
+        dst[i] = clampByte((acc + (1 << (OUTPUT_SHIFT - 1))) >> OUTPUT_SHIFT);
+    }
+}
+
+// 先垂直的顺序（融合路径纵向缩小时使用）：taps 行源样本 -> 一行 Q6 中间结果
+void verticalRowU8Scalar(const uint8_t *const *rows, const int16_t *w, int taps, int16_t *dst, int begin, int count) {
+    for (int i = begin; i < count; ++i) {
+        int acc = 0;
+        for (int k = 0; k < taps; ++k) {
+            acc += w[k] * rows[k][i];
+        }
+        dst[i] = static_cast<int16_t>((acc + (1 << (INTERMEDIATE_SHIFT - 1))) >> INTERMEDIATE_SHIFT);
+    }
+}
+
+// 先垂直的顺序：一行 Q6 中间结果 -> 一行输出
+void horizontalRowQ6Scalar(const int16_t *src, uint8_t *dst, int dstWidth, int channels, const FilterTable &t) {
+    for (int x = 0; x < dstWidth; ++x) {
+        const int16_t *s = src + static_cast<size_t>(t.offsets[x]) * channels;
+        const int16_t *w = &t.weights[static_cast<size_t>(x) * t.taps];
+        for (int c = 0; c < channels; ++c) {
+            int acc = 0;
+            for (int k = 0; k < t.taps; ++k) {
+                acc += w[k] * s[k * channels + c];
+            }
+            dst[x * channels + c] = clampByte((acc + (1 << (OUTPUT_SHIFT - 1))) >> OUTPUT_SHIFT);
+        }
+    }
+}
+
+#if defined(AICP_X86)
+inline __m128i weightPair(const int16_t *w, int k, int taps) {
+    const int second = k + 1 < taps ? w[k + 1] : 0;
+    return _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(second) << 16) | static_cast<uint16_t>(w[k])));
+}
+
+// 4 字节像素：相邻两个抽头的同一通道交错后用 madd 一次完成乘加
+void horizontalRow4SSE2(const uint8_t *src, int16_t *dst, int dstWidth, const FilterTable &t) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (INTERMEDIATE_SHIFT - 1));
+    for (int x = 0; x < dstWidth; ++x) {
+        const uint8_t *s = src + static_cast<size_t>(t.offsets[x]) * 4;
+        const int16_t *w = &t.weights[static_cast<size_t>(x) * t.taps];
+        __m128i acc = zero;
+        int k = 0;
+        for (; k + 2 <= t.taps; k += 2) {
+            const __m128i px = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(s + k * 4)), zero);
+            const __m128i pairs = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(pairs, weightPair(w, k, t.taps)));
+        }
+        if (k < t.taps) {
+            int32_t last;
+            memcpy(&last, s + k * 4, 4);
+            const __m128i px = _mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(px, zero), weightPair(w, k, t.taps)));
+        }
+        acc = _mm_srai_epi32(_mm_add_epi32(acc, round), INTERMEDIATE_SHIFT);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x * 4), _mm_packs_epi32(acc, acc));
+    }
+}
+
+void verticalRowSSE2(const int16_t *const *rows, const int16_t *w, int taps, uint8_t *dst, int begin, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (OUTPUT_SHIFT - 1));
+    int i = begin;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = zero;
+        __m128i hi = zero;
+        for (int k = 0; k < taps; k += 2) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k] + i));
+            const __m128i b = k + 1 < taps ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k + 1] + i)) : zero;
+            const __m128i weights = weightPair(w, k, taps);
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights));
+        }
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), OUTPUT_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), OUTPUT_SHIFT);
+        const __m128i packed = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(packed, packed));
+    }
+    verticalRowScalar(rows, w, taps, dst, i, count);
+}
+
+AICP_TARGET_AVX2
+void verticalRowAVX2(const int16_t *const *rows, const int16_t *w, int taps, uint8_t *dst, int begin, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi32(1 << (OUTPUT_SHIFT - 1));
+    int i = begin;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = zero;
+        __m256i hi = zero;
+        for (int k = 0; k < taps; k += 2) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[k] + i));
+            const __m256i b = k + 1 < taps ? _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[k + 1] + i)) : zero;
+            const int second = k + 1 < taps ? w[k + 1] : 0;
+            const __m256i weights = _mm256_set1_epi32(
+                static_cast<int>((static_cast<uint32_t>(second) << 16) | static_cast<uint16_t>(w[k])));
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights));
+        }
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), OUTPUT_SHIFT);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), OUTPUT_SHIFT);
+        // unpack 与 pack 都在 128 位通道内进行，顺序互相抵消；最后取两个通道的低 8 字节
+        __m256i packed = _mm256_packs_epi32(lo, hi);
+        packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, packed), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm256_castsi256_si128(packed));
+    }
+    verticalRowSSE2(rows, w, taps, dst, i, count);
+}
+
+void verticalRowU8SSE2(const uint8_t *const *rows, const int16_t *w, int taps, int16_t *dst, int begin, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (INTERMEDIATE_SHIFT - 1));
+    int i = begin;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = zero;
+        __m128i hi = zero;
+        for (int k = 0; k < taps; k += 2) {
+            const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows[k] + i)), zero);
+            const __m128i b = k + 1 < taps
+                ? _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows[k + 1] + i)), zero)
+                : zero;
+            const __m128i weights = weightPair(w, k, taps);
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights));
+        }
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), INTERMEDIATE_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), INTERMEDIATE_SHIFT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(lo, hi));
+    }
+    verticalRowU8Scalar(rows, w, taps, dst, i, count);
+}
+
+AICP_TARGET_AVX2
+void verticalRowU8AVX2(const uint8_t *const *rows, const int16_t *w, int taps, int16_t *dst, int begin, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi32(1 << (INTERMEDIATE_SHIFT - 1));
+    int i = begin;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = zero;
+        __m256i hi = zero;
+        for (int k = 0; k < taps; k += 2) {
+            const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k] + i)));
+            const __m256i b = k + 1 < taps
+                ? _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k + 1] + i)))
+                : zero;
+            const int second = k + 1 < taps ? w[k + 1] : 0;
+            const __m256i weights = _mm256_set1_epi32(
+                static_cast<int>((static_cast<uint32_t>(second) << 16) | static_cast<uint16_t>(w[k])));
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights));
+        }
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), INTERMEDIATE_SHIFT);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), INTERMEDIATE_SHIFT);
+        // unpack 与 pack 都在 128 位通道内进行，顺序互相抵消
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_packs_epi32(lo, hi));
+    }
+    verticalRowU8SSE2(rows, w, taps, dst, i, count);
+}
+
+// 4 通道 Q6 中间结果：一次载入相邻两个抽头（8 个 16 位样本），交错后 madd
+void horizontalRowQ6x4SSE2(const int16_t *src, uint8_t *dst, int dstWidth, const FilterTable &t) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (OUTPUT_SHIFT - 1));
+    for (int x = 0; x < dstWidth; ++x) {
+        const int16_t *s = src + static_cast<size_t>(t.offsets[x]) * 4;
+        const int16_t *w = &t.weights[static_cast<size_t>(x) * t.taps];
+        __m128i acc = zero;
+        int k = 0;
+        for (; k + 2 <= t.taps; k += 2) {
+            const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + k * 4));
+            const __m128i pairs = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(pairs, weightPair(w, k, t.taps)));
+        }
+        if (k < t.taps) {
+            const __m128i px = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(s + k * 4));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(px, zero), weightPair(w, k, t.taps)));
+        }
+        acc = _mm_srai_epi32(_mm_add_epi32(acc, round), OUTPUT_SHIFT);
+        const __m128i packed = _mm_packs_epi32(acc, acc);
+        const int32_t pixel = _mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+        memcpy(dst + x * 4, &pixel, 4);
+    }
+}
+#endif
+
+void horizontalRow(const uint8_t *src, int16_t *dst, int dstWidth, int channels, const FilterTable &t) {
+#if defined(AICP_X86)
+    if (channels == 4) {
+        horizontalRow4SSE2(src, dst, dstWidth, t);
+        return;
+    }
+#endif
+    horizontalRowScalar(src, dst, dstWidth, channels, t);
+}
+
+using VerticalRowFn = void (*)(const int16_t *const *, const int16_t *, int, uint8_t *, int, int);
+
+VerticalRowFn selectVerticalRow() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return verticalRowAVX2;
+    }
+    return verticalRowSSE2;
+#else
+    return verticalRowScalar;
+#endif
+}
+
+const VerticalRowFn verticalRow = selectVerticalRow();
+
+void horizontalRowQ6(const int16_t *src, uint8_t *dst, int dstWidth, int channels, const FilterTable &t) {
+#if defined(AICP_X86)
+    if (channels == 4) {
+        horizontalRowQ6x4SSE2(src, dst, dstWidth, t);
+        return;
+    }
+#endif
+    horizontalRowQ6Scalar(src, dst, dstWidth, channels, t);
+}
+
+using VerticalRowU8Fn = void (*)(const uint8_t *const *, const int16_t *, int, int16_t *, int, int);
+
+VerticalRowU8Fn selectVerticalRowU8() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return verticalRowU8AVX2;
+    }
+    return verticalRowU8SSE2;
+#else
+    return verticalRowU8Scalar;
+#endif
+}
+
+const VerticalRowU8Fn verticalRowU8 = selectVerticalRowU8();
+
+// 常驻条带线程池：调用线程也参与执行；池正被其他线程使用时直接在调用线程上串行执行，
+// 避免录制线程与界面线程的缩放互相等待
+class SlicePool {
+public:
+    static SlicePool &instance() {
+        static SlicePool pool;
+        return pool;
+    }
+
+    int threadCount() const {
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    void run(int count, const std::function<void(int)> &fn) {
+        std::unique_lock<std::mutex> dispatch(dispatchMutex, std::try_to_lock);
+        if (!dispatch.owns_lock() || workers.empty() || count <= 1) {
+            for (int i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobCount = count;
+            nextIndex = 0;
+            activeWorkers = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        drain(fn, count);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return activeWorkers == 0; });
+        job = nullptr;
+    }
+
+private:
+    SlicePool() {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        const unsigned extra = hardware > 1 ? std::min(hardware - 1, 7u) : 0u;
+        for (unsigned i = 0; i < extra; ++i) {
+            workers.emplace_back(&SlicePool::workerLoop, this);
+        }
+    }
+
+    ~SlicePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void drain(const std::function<void(int)> &fn, int count) {
+        for (int i = nextIndex++; i < count; i = nextIndex++) {
+            fn(i);
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seenGeneration = 0;
+        while (true) {
+            const std::function<void(int)> *current = nullptr;
+            int count = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping) {
+                    return;
+                }
+                seenGeneration = generation;
+                current = job;
+                count = jobCount;
+            }
+            drain(*current, count);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --activeWorkers;
+            }
+            done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex dispatchMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)> *job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextIndex{0};
+    size_t activeWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+struct PlaneJob {
+    const uint8_t *src = nullptr;
+    int srcWidth = 0;
+    int srcStride = 0;
+    uint8_t *dst = nullptr;
+    int dstStride = 0;
+    int dstWidth = 0;
+    int channels = 1;
+    std::shared_ptr<const FilterTable> horizontal;
+    std::shared_ptr<const FilterTable> vertical;
+};
+
+// 逐行产生输出：水平结果放在 taps 行的环形缓冲里，相邻输出行共用的源行只水平滤波一次
+// 缓冲为线程局部，同一线程上同时只能有一个 RowScaler
+class RowScaler {
+public:
+    explicit RowScaler(const PlaneJob &job)
+        : job(job)
+        , v(*job.vertical)
+        , rowValues(job.dstWidth * job.channels)
+    {
+        ring.resize(static_cast<size_t>(v.taps) * rowValues);
+        ringSource.assign(v.taps, -1);
+        rows.resize(v.taps);
+    }
+
+    void scaleRow(int y, uint8_t *out) {
+        const int first = v.offsets[y];
+        for (int k = 0; k < v.taps; ++k) {
+            const int sourceRow = first + k;
+            const int slot = sourceRow % v.taps;
+            int16_t *slotData = &ring[static_cast<size_t>(slot) * rowValues];
+            if (ringSource[slot] != sourceRow) {
+                horizontalRow(job.src + static_cast<size_t>(sourceRow) * job.srcStride, slotData,
+                              job.dstWidth, job.channels, *job.horizontal);
+                ringSource[slot] = sourceRow;
+            }
+            rows[k] = slotData;
+        }
+        verticalRow(rows.data(), &v.weights[static_cast<size_t>(y) * v.taps], v.taps, out, 0, rowValues);
+    }
+
+private:
+    const PlaneJob &job;
+    const FilterTable &v;
+    const int rowValues;
+    static thread_local std::vector<int16_t> ring;
+    static thread_local std::vector<int> ringSource;
+    static thread_local std::vector<const int16_t *> rows;
+};
+
+thread_local std::vector<int16_t> RowScaler::ring;
+thread_local std::vector<int> RowScaler::ringSource;
+thread_local std::vector<const int16_t *> RowScaler::rows;
+
+// 输出行 [y0, y1) 直接写入目标平面
+void scaleRows(const PlaneJob &job, int y0, int y1) {
+    RowScaler scaler(job);
+    for (int y = y0; y < y1; ++y) {
+        scaler.scaleRow(y, job.dst + static_cast<size_t>(y) * job.dstStride);
+    }
+}
+
+// 先垂直后水平地逐行产生输出：每个输出行先把 taps 行源样本垂直滤波成一行 Q6（源宽，L1 内），再水平滤波。
+// 纵向缩小时开销最大的水平趟只对输出行做一次，而不是对每个源行都做；
+// 与 RowScaler 只有中间结果的舍入位置不同（逐字节差不超过 1）
+// 缓冲为线程局部，同一线程上同时只能有一个 VerticalFirstRowScaler
+class VerticalFirstRowScaler {
+public:
+    explicit VerticalFirstRowScaler(const PlaneJob &job)
+        : job(job)
+        , v(*job.vertical)
+        , sourceValues(job.srcWidth * job.channels)
+    {
+        column.resize(sourceValues);
+        rows.resize(v.taps);
+    }
+
+    void scaleRow(int y, uint8_t *out) {
+        const int first = v.offsets[y];
+        for (int k = 0; k < v.taps; ++k) {
+            rows[k] = job.src + static_cast<size_t>(first + k) * job.srcStride;
+        }
+        verticalRowU8(rows.data(), &v.weights[static_cast<size_t>(y) * v.taps], v.taps, column.data(), 0, sourceValues);
+        horizontalRowQ6(column.data(), out, job.dstWidth, job.channels, *job.horizontal);
+    }
+
+private:
+    const PlaneJob &job;
+    const FilterTable &v;
+    const int sourceValues;
+    static thread_local std::vector<int16_t> column;
+    static thread_local std::vector<const uint8_t *> rows;
+};
+
+thread_local std::vector<int16_t> VerticalFirstRowScaler::column;
+thread_local std::vector<const uint8_t *> VerticalFirstRowScaler::rows;
+
+// 融合路径：输出行 [y0, y1) 按色度行带（4:2:0 为两行）缩放到线程局部的小缓冲，
+// 随即转换写入目标帧对应行；整帧只读一次源、写一次目标，中间结果始终在缓存里
+template <typename Scaler>
+void scaleConvertRows(const PlaneJob &job, PixelFormat stripFormat, FrameData &dst, int band,
+                      const PixelConverter &converter, int y0, int y1) {
+    thread_local std::vector<uint8_t> stripBuffer;
+    const int stripStride = job.dstWidth * job.channels;
+    stripBuffer.resize(static_cast<size_t>(band) * stripStride);
+
+    Scaler scaler(job);
+    for (int y = y0; y < y1; y += band) {
+        const int rows = std::min(band, y1 - y);
+        for (int r = 0; r < rows; ++r) {
+            scaler.scaleRow(y + r, stripBuffer.data() + static_cast<size_t>(r) * stripStride);
+        }
+        // 不持有缓冲的视图：只借用行带缓冲的指针
+        FrameData strip;
+        strip.data = stripBuffer.data();
+        strip.size = stripBuffer.size();
+        strip.width = job.dstWidth;
+        strip.height = rows;
+        strip.stride = stripStride;
+        strip.format = stripFormat;
+        FrameData target = dst.cropView({0, y, dst.width, rows});
+        converter.convert(strip, target);
+    }
+}
+
+} // namespace
+
+namespace FrameScaler {
+
+bool scale(const FrameData& src, FrameData& dst, ScaleFilter filter) {
+    if (!src.data || !dst.data || src.format != dst.format ||
+        src.width <= 0 || src.height <= 0 || dst.width <= 0 || dst.height <= 0) {
+        return false;
+    }
+
+    const int planes = src.planeCount();
+    if (src.width == dst.width && src.height == dst.height) {
+        for (int p = 0; p < planes; ++p) {
+            const size_t rowBytes = static_cast<size_t>(src.planeWidth(p)) * pixelFormatPlaneBytesPerPixel(src.format, p);
+            for (int y = 0; y < src.planeHeight(p); ++y) {
+                memcpy(dst.plane(p) + static_cast<size_t>(y) * dst.planeStride(p),
+                       src.plane(p) + static_cast<size_t>(y) * src.planeStride(p), rowBytes);
+            }
+        }
+        return true;
+    }
+
+    std::vector<PlaneJob> jobs(planes);
+    struct Slice {
+        int plane;
+        int y0;
+        int y1;
+    };
+    std::vector<Slice> slices;
+    const int threads = SlicePool::instance().threadCount();
+    for (int p = 0; p < planes; ++p) {
+        PlaneJob &job = jobs[p];
+        job.src = src.plane(p);
+        job.srcWidth = src.planeWidth(p);
+        job.srcStride = src.planeStride(p);
+        job.dst = dst.plane(p);
+        job.dstStride = dst.planeStride(p);
+        job.dstWidth = dst.planeWidth(p);
+        job.channels = pixelFormatPlaneBytesPerPixel(src.format, p);
+        job.horizontal = cachedFilter(src.planeWidth(p), dst.planeWidth(p), filter);
+        job.vertical = cachedFilter(src.planeHeight(p), dst.planeHeight(p), filter);
+
+        const int rows = dst.planeHeight(p);
+        const int count = std::max(1, std::min(threads, rows / MIN_ROWS_PER_SLICE));
+        for (int i = 0; i < count; ++i) {
+            slices.push_back({p, rows * i / count, rows * (i + 1) / count});
+        }
+    }
+
+    SlicePool::instance().run(static_cast<int>(slices.size()), [&](int i) {
+        scaleRows(jobs[slices[i].plane], slices[i].y0, slices[i].y1);
+    });
+    return true;
+}
+
+bool scaleConvert(const FrameData& src, FrameData& dst, ScaleFilter filter, const PixelConverter& converter) {
+    if (!src.data || !dst.data || src.width <= 0 || src.height <= 0 || dst.width <= 0 || dst.height <= 0) {
+        return false;
+    }
+    if (src.format == dst.format) {
+        return scale(src, dst, filter);
+    }
+    if (src.width == dst.width && src.height == dst.height) {
+        return converter.convert(src, dst);
+    }
+    if (src.planeCount() > 1) {
+        // 平面源需要先得到完整的各平面缩放结果，退化为两步
+        FrameData scaled = scale(src, dst.width, dst.height, filter);
+        return scaled.data && converter.convert(scaled, dst);
+    }
+
+    PlaneJob job;
+    job.src = src.plane(0);
+    job.srcWidth = src.width;
+    job.srcStride = src.planeStride(0);
+    job.dstWidth = dst.width;
+    job.channels = pixelFormatBytesPerPixel(src.format);
+    job.horizontal = cachedFilter(src.width, dst.width, filter);
+    job.vertical = cachedFilter(src.height, dst.height, filter);
+
+    // 条带边界对齐到色度行带，保证每个行带的色度样本由同一线程一次写完
+    int shiftX = 0, shiftY = 0;
+    pixelFormatChromaShift(dst.format, shiftX, shiftY);
+    const int band = 1 << shiftY;
+    const int bands = (dst.height + band - 1) / band;
+    const int count = std::max(1, std::min(SlicePool::instance().threadCount(), dst.height / MIN_ROWS_PER_SLICE));
+    // 纵向缩小时先垂直滤波，水平趟只处理输出行；纵向放大时先水平，相邻输出行复用环形缓冲里的水平结果
+    const bool verticalFirst = dst.height < src.height;
+    SlicePool::instance().run(count, [&](int i) {
+        const int y0 = bands * i / count * band;
+        const int y1 = std::min(dst.height, bands * (i + 1) / count * band);
+        if (verticalFirst) {
+            scaleConvertRows<VerticalFirstRowScaler>(job, src.format, dst, band, converter, y0, y1);
+        } else {
+            scaleConvertRows<RowScaler>(job, src.format, dst, band, converter, y0, y1);
+        }
+    });
+    return true;
+}
+
+FrameData scale(const FrameData& src, int width, int height, ScaleFilter filter) {
+    if (src.width == width && src.height == height) {
+        return src;
+    }
+    FrameData result;
+    result.timestamp = src.timestamp;
+    if (!src.data || width <= 0 || height <= 0 || !result.allocateImage(width, height, src.format)) {
+        return result;
+    }
+    scale(src, result, filter);
+    return result;
+}
+
+FrameData fitWithin(const FrameData& src, int maxWidth, int maxHeight, ScaleFilter filter) {
+    if (src.width <= maxWidth && src.height <= maxHeight) {
+        return src;
+    }
+    const double factor = std::min(static_cast<double>(maxWidth) / src.width,
+                                   static_cast<double>(maxHeight) / src.height);
+    const int width = std::max(1, static_cast<int>(std::lround(src.width * factor)));
+    const int height = std::max(1, static_cast<int>(std::lround(src.height * factor)));
+    return scale(src, width, height, filter);
+}
+
+} // namespace FrameScaler
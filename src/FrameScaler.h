@@ -0,0 +1,32 @@
+#ifndef FRAMESCALER_H
+#define FRAMESCALER_H
+
+#include "DataTypes.h"
+
+class PixelConverter;
+
+/**
+ * 帧缩放 - 可分离的两趟滤波（scale 先水平后垂直），输出行按条带分给常驻线程池并行处理
+ * 滤波系数为 Q14 定点，按 (源尺寸, 目标尺寸, 滤波器) 缓存，同一尺寸组合只计算一次；
+ * 4 字节像素的水平趟与所有格式的垂直趟有 SSE2/AVX2 实现，与标量实现逐字节一致
+ * 多平面格式各平面独立缩放；scale 要求源帧与目标帧格式相同，scaleConvert 可同时转换格式
+ */
+namespace FrameScaler {
+
+// 缩放到已分配的目标帧（可为裁剪视图）
+bool scale(const FrameData& src, FrameData& dst, ScaleFilter filter);
+
+// 缩放并转换到已分配的目标帧（格式可与源不同），裁剪由调用方传入 cropView 完成
+// 打包 RGB 源按输出行带缩放后立即转换写入目标平面，不产生整帧中间结果；纵向缩小时先垂直后水平，
+// 水平趟只处理输出行（与 scale + convert 的结果逐字节差不超过 1）；平面 YUV 源退化为先缩放再转换
+bool scaleConvert(const FrameData& src, FrameData& dst, ScaleFilter filter, const PixelConverter& converter);
+
+// 从缓冲池分配新帧并缩放，保留时间戳；尺寸相同时直接共享源帧
+FrameData scale(const FrameData& src, int width, int height, ScaleFilter filter);
+
+// 等比缩小到不超过 maxWidth x maxHeight（不放大），常用于生成缩略图
+FrameData fitWithin(const FrameData& src, int maxWidth, int maxHeight, ScaleFilter filter);
+
+} // namespace FrameScaler
+
+#endif // FRAMESCALER_H
@@ -0,0 +1,366 @@
+// LinuxAudioCapture.cpp
+// Linux 音频捕获实现：ALSA 录音 / WAV 文件回放，经无锁块队列交给消费者
+#include "LinuxAudioCapture.h"
+#include "AudioBlockRing.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+namespace {
+
+// ALSA 设备缓冲时长（微秒）：采集线程偶尔被抢占时由设备缓冲兜住，不至于立即 xrun
+const unsigned int ALSA_BUFFER_MICROS = 100000;
+
+// 非实时回放时队列已满的轮询间隔
+const std::chrono::milliseconds REPLAY_FULL_POLL(1);
+
+// WAV 格式码
+const uint16_t WAV_FORMAT_PCM = 1;
+const uint16_t WAV_FORMAT_FLOAT = 3;
+const uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+uint64_t monotonicMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint16_t readU16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readU32(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// 读入整个 WAV 文件并转换为交错 16 位整数（支持 16 位 PCM 与 32 位浮点）
+bool loadWavFile(const std::string &path, std::vector<int16_t> &samples, int &sampleRate, int &channels) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "无法打开 WAV 文件: " << path << std::endl;
+        return false;
+    }
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        std::cerr << "不是有效的 WAV 文件: " << path << std::endl;
+        return false;
+    }
+
+    uint16_t format = 0;
+    uint16_t bits = 0;
+    sampleRate = 0;
+    channels = 0;
+    const uint8_t *data = nullptr;
+    size_t dataSize = 0;
+    size_t offset = 12;
+    while (offset + 8 <= bytes.size()) {
+        const uint8_t *chunk = bytes.data() + offset;
+        const size_t chunkSize = std::min<size_t>(readU32(chunk + 4), bytes.size() - offset - 8);
+        const uint8_t *body = chunk + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16) {
+            format = readU16(body);
+            channels = readU16(body + 2);
+            sampleRate = static_cast<int>(readU32(body + 4));
+            bits = readU16(body + 14);
+            // 扩展格式的真实格式码在子格式 GUID 的前两个字节
+            if (format == WAV_FORMAT_EXTENSIBLE && chunkSize >= 26) {
+                format = readU16(body + 24);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = body;
+            dataSize = chunkSize;
+        }
+        // 块按偶数字节对齐
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    const bool pcm16 = format == WAV_FORMAT_PCM && bits == 16;
+    const bool float32 = format == WAV_FORMAT_FLOAT && bits == 32;
+    if (!data || channels <= 0 || sampleRate <= 0 || (!pcm16 && !float32)) {
+        std::cerr << "不支持的 WAV 格式: " << path << " (格式 " << format << ", " << bits << " 位, 声道数 "
+                  << channels << ")" << std::endl;
+        return false;
+    }
+
+    const size_t frameBytes = static_cast<size_t>(channels) * (bits / 8);
+    const size_t count = dataSize / frameBytes * channels;
+    if (count == 0) {
+        std::cerr << "WAV 文件没有音频数据: " << path << std::endl;
+        return false;
+    }
+    samples.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (pcm16) {
+            samples[i] = static_cast<int16_t>(readU16(data + i * 2));
+        } else {
+            float value;
+            const uint32_t raw = readU32(data + i * 4);
+            std::memcpy(&value, &raw, sizeof(value));
+            const float clamped = std::max(-1.0f, std::min(1.0f, value));
+            samples[i] = static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+struct LinuxAudioCapture::Impl {
+    Config cfg;
+    AudioBlockRing ring;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> finished{false};
+    std::atomic<uint64_t> deviceOverruns{0};
+    int rate = 0;
+    int channelCount = 0;
+
+    // 回放模式：init 时整段读入
+    std::vector<int16_t> replaySamples;
+
+#ifdef HAVE_ALSA
+    snd_pcm_t *pcm = nullptr;
+    // 队列满时设备数据仍需读走，读进这个丢弃块
+    std::vector<int16_t> discardBlock;
+
+    bool openAlsa() {
+        int err = snd_pcm_open(&pcm, cfg.device.c_str(), SND_PCM_STREAM_CAPTURE, 0);
+        if (err < 0) {
+            std::cerr << "无法打开 ALSA 录音设备 " << cfg.device << ": " << snd_strerror(err) << std::endl;
+            pcm = nullptr;
+            return false;
+        }
+        // 允许 ALSA 插件层做格式与采样率转换，保证拿到请求的格式
+        err = snd_pcm_set_params(pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                 static_cast<unsigned int>(cfg.channels), static_cast<unsigned int>(cfg.sampleRate),
+                                 1, ALSA_BUFFER_MICROS);
+        if (err < 0) {
+            std::cerr << "ALSA 录音参数设置失败 (" << cfg.sampleRate << "Hz, " << cfg.channels << " 声道): "
+                      << snd_strerror(err) << std::endl;
+            closeAlsa();
+            return false;
+        }
+        rate = cfg.sampleRate;
+        channelCount = cfg.channels;
+        discardBlock.assign(static_cast<size_t>(cfg.blockFrames) * channelCount, 0);
+        return true;
+    }
+
+    void closeAlsa() {
+        if (pcm) {
+            snd_pcm_close(pcm);
+            pcm = nullptr;
+        }
+    }
+
+    void alsaLoop() {
+        const uint64_t blockMicros = static_cast<uint64_t>(cfg.blockFrames) * 1000000 / rate;
+        while (running.load(std::memory_order_relaxed)) {
+            AudioBlockRing::Block *block = ring.beginWrite();
+            int16_t *dst = block ? block->samples : discardBlock.data();
+            int filled = 0;
+            while (filled < cfg.blockFrames && running.load(std::memory_order_relaxed)) {
+                const snd_pcm_sframes_t n = snd_pcm_readi(pcm, dst + static_cast<size_t>(filled) * channelCount,
+                                                          static_cast<snd_pcm_uframes_t>(cfg.blockFrames - filled));
+                if (n < 0) {
+                    if (n == -EPIPE) {
+                        deviceOverruns.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (snd_pcm_recover(pcm, static_cast<int>(n), 1) < 0) {
+                        std::cerr << "ALSA 录音失败: " << snd_strerror(static_cast<int>(n)) << std::endl;
+                        running.store(false, std::memory_order_relaxed);
+                    }
+                    continue;
+                }
+                filled += static_cast<int>(n);
+            }
+            if (block && filled == cfg.blockFrames) {
+                block->frames = filled;
+                block->timestamp = monotonicMicros() - blockMicros;
+                ring.commitWrite();
+            }
+        }
+    }
+#endif
+
+    void replayLoop() {
+        const size_t totalFrames = replaySamples.size() / channelCount;
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t startMicros = monotonicMicros();
+        size_t position = 0;
+        uint64_t sentFrames = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            if (position == totalFrames) {
+                if (!cfg.replayLoop) {
+                    finished.store(true, std::memory_order_release);
+                    return;
+                }
+                position = 0;
+            }
+            const int frames = static_cast<int>(std::min<size_t>(cfg.blockFrames, totalFrames - position));
+
+            AudioBlockRing::Block *block = nullptr;
+            if (cfg.replayRealtime) {
+                // 块内最后一帧“采到”时才发布，与真实设备的节奏一致；按累计帧数计算时刻，不会累积漂移
+                std::this_thread::sleep_until(start + std::chrono::microseconds((sentFrames + frames) * 1000000 / rate));
+                block = ring.beginWrite();
+            } else {
+                if (ring.readableBlocks() >= ring.capacity()) {
+                    std::this_thread::sleep_for(REPLAY_FULL_POLL);
+                    continue;
+                }
+                block = ring.beginWrite();
+            }
+
+            if (block) {
+                std::memcpy(block->samples, replaySamples.data() + position * channelCount,
+                            static_cast<size_t>(frames) * channelCount * sizeof(int16_t));
+                block->frames = frames;
+                block->timestamp = startMicros + sentFrames * 1000000 / rate;
+                ring.commitWrite();
+            }
+            position += frames;
+            sentFrames += frames;
+        }
+    }
+
+    void stop() {
+        running.store(false, std::memory_order_relaxed);
+        if (thread.joinable()) {
+            thread.join();
+        }
+#ifdef HAVE_ALSA
+        closeAlsa();
+#endif
+    }
+};
+
+LinuxAudioCapture::LinuxAudioCapture()
+    : d(std::make_unique<Impl>())
+{
+}
+
+LinuxAudioCapture::LinuxAudioCapture(const Config& config)
+    : d(std::make_unique<Impl>())
+{
+    d->cfg = config;
+}
+
+LinuxAudioCapture::~LinuxAudioCapture() {
+    release();
+}
+
+void LinuxAudioCapture::setConfig(const Config& config) {
+    d->cfg = config;
+}
+
+bool LinuxAudioCapture::init() {
+    release();
+    Config &cfg = d->cfg;
+    if (cfg.blockFrames <= 0 || cfg.ringBlocks < 2) {
+        std::cerr << "音频捕获参数无效: 每块 " << cfg.blockFrames << " 帧, " << cfg.ringBlocks << " 块" << std::endl;
+        return false;
+    }
+
+    if (cfg.source == Source::WavReplay) {
+        if (!loadWavFile(cfg.wavPath, d->replaySamples, d->rate, d->channelCount)) {
+            return false;
+        }
+    } else {
+#ifdef HAVE_ALSA
+        if (cfg.sampleRate <= 0 || cfg.channels <= 0 || !d->openAlsa()) {
+            return false;
+        }
+#else
+        std::cerr << "未启用 ALSA 支持，只能使用 WAV 回放音源" << std::endl;
+        return false;
+#endif
+    }
+
+    if (!d->ring.configure(cfg.ringBlocks, cfg.blockFrames, d->channelCount)) {
+        d->stop();
+        return false;
+    }
+    d->deviceOverruns.store(0, std::memory_order_relaxed);
+    d->finished.store(false, std::memory_order_relaxed);
+    d->running.store(true, std::memory_order_relaxed);
+    if (cfg.source == Source::WavReplay) {
+        d->thread = std::thread(&Impl::replayLoop, d.get());
+        std::cout << "开始回放 WAV 音频: " << cfg.wavPath << " (" << d->rate << "Hz, " << d->channelCount
+                  << " 声道)" << std::endl;
+    } else {
+#ifdef HAVE_ALSA
+        d->thread = std::thread(&Impl::alsaLoop, d.get());
+        std::cout << "开始 ALSA 音频捕获: " << cfg.device << " (" << d->rate << "Hz, " << d->channelCount
+                  << " 声道)" << std::endl;
+#endif
+    }
+    return true;
+}
+
+AudioData LinuxAudioCapture::captureAudio() {
+    AudioData audio;
+    const AudioBlockRing::Block *block = d->ring.beginRead();
+    if (!block) {
+        return audio;
+    }
+    const size_t bytes = static_cast<size_t>(block->frames) * d->channelCount * sizeof(int16_t);
+    if (audio.allocate(bytes)) {
+        std::memcpy(audio.data, block->samples, bytes);
+        audio.sampleRate = d->rate;
+        audio.channels = d->channelCount;
+        audio.bitsPerSample = 16;
+        audio.timestamp = block->timestamp;
+    }
+    d->ring.endRead();
+    return audio;
+}
+
+void LinuxAudioCapture::release() {
+    if (!d->thread.joinable()) {
+        return;
+    }
+    d->stop();
+    const Stats summary = stats();
+    std::cout << "停止音频捕获: 采集 " << summary.capturedBlocks << " 块, 溢出 " << summary.overruns
+              << " 块, 欠载 " << summary.underruns << " 次, 设备溢出 " << summary.deviceOverruns << " 次" << std::endl;
+}
+
+bool LinuxAudioCapture::isRunning() const {
+    return d->running.load(std::memory_order_relaxed) && !d->finished.load(std::memory_order_acquire);
+}
+
+bool LinuxAudioCapture::replayFinished() const {
+    return d->finished.load(std::memory_order_acquire);
+}
+
+int LinuxAudioCapture::sampleRate() const {
+    return d->rate;
+}
+
+int LinuxAudioCapture::channels() const {
+    return d->channelCount;
+}
+
+LinuxAudioCapture::Stats LinuxAudioCapture::stats() const {
+    const AudioBlockRing::Stats ring = d->ring.stats();
+    Stats result;
+    result.capturedBlocks = ring.writtenBlocks;
+    result.deliveredBlocks = ring.readBlocks;
+    result.overruns = ring.overruns;
+    result.underruns = ring.underruns;
+    result.deviceOverruns = d->deviceOverruns.load(std::memory_order_relaxed);
+    return result;
+}
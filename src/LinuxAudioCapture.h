@@ -0,0 +1,74 @@
+#ifndef LINUXAUDIOCAPTURE_H
+#define LINUXAUDIOCAPTURE_H
+
+#include "IAudioCapture.h"
+#include "DataTypes.h"
+#include <memory>
+#include <string>
+
+/**
+ * Linux 音频捕获器 - ALSA 录音设备（需编译时找到 ALSA，定义 HAVE_ALSA），或回放 WAV 文件（无声卡环境测试用）
+ * init 后由常驻采集线程按固定大小的块写入 AudioBlockRing，采集线程不加锁、不分配内存；
+ * 队列满时丢弃新块计入溢出，captureAudio 无数据时返回空 AudioData 并计入欠载
+ * 输出为交错 16 位整数；时间戳为块内第一帧的采集时刻（微秒，单调时钟）
+ */
+class LinuxAudioCapture : public IAudioCapture {
+public:
+    enum class Source {
+        Alsa,
+        WavReplay
+    };
+
+    struct Config {
+        Source source = Source::Alsa;
+        std::string device = "default";     // ALSA 设备名
+        std::string wavPath;                // 回放的 WAV 文件（16 位 PCM 或 32 位浮点）
+        bool replayRealtime = true;         // 按采样率节奏回放；false 时尽快写入，队列满则等待而不丢块
+        bool replayLoop = false;            // 回放到结尾后从头开始
+        int sampleRate = 48000;             // ALSA 采样率（回放时以文件为准）
+        int channels = 2;                   // ALSA 声道数（回放时以文件为准）
+        int blockFrames = 480;              // 每块帧数（48kHz 下 10ms）
+        int ringBlocks = 50;                // 队列块数
+    };
+
+    struct Stats {
+        uint64_t capturedBlocks = 0;        // 写入队列的块数
+        uint64_t deliveredBlocks = 0;       // captureAudio 取走的块数
+        uint64_t overruns = 0;              // 队列满丢弃的块数
+        uint64_t underruns = 0;             // captureAudio 无数据可取的次数
+        uint64_t deviceOverruns = 0;        // 设备缓冲溢出（ALSA xrun）次数
+    };
+
+    LinuxAudioCapture();
+    explicit LinuxAudioCapture(const Config& config);
+    ~LinuxAudioCapture() override;
+
+    // 需在 init 前设置
+    void setConfig(const Config& config);
+
+    // 打开设备或读入 WAV 文件并启动采集线程
+    bool init() override;
+
+    // 非阻塞取出最早的一块；无数据时返回空 AudioData
+    AudioData captureAudio() override;
+
+    // 停止采集线程并关闭设备
+    void release() override;
+
+    bool isRunning() const;
+
+    // 回放模式下已送完全部样本（非循环）
+    bool replayFinished() const;
+
+    // init 成功后的实际格式
+    int sampleRate() const;
+    int channels() const;
+
+    Stats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
+
+#endif // LINUXAUDIOCAPTURE_H
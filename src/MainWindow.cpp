@@ -32,6 +32,7 @@ MainWindow::MainWindow(QWidget *parent)
     , recordStartTime(0)
     , recordEndTime(0)
     , recordingDurationMs(0)
+    , frameRateWarningShown(false)
 {
     setWindowTitle("AICP");
     setMinimumSize(650, 450);
@@ -175,7 +176,17 @@ void MainWindow::setupUI() {
         
         screenCombo->addItem(QString("%1 (%2×%3, 缩放: %4x)").arg(name).arg(physicalWidth).arg(physicalHeight).arg(devicePixelRatio), i);
     }
-    settingsLayout->addWidget(screenCombo, 3, 1, 1, 2);
+    if (screens.size() > 1) {
+        // 所有屏幕并行捕获，拼接为一张画布
+        screenCombo->addItem(QString("全部屏幕 (%1 块)").arg(screens.size()), AllScreensIndex);
+    }
+    settingsLayout->addWidget(screenCombo, 3, 1);
+
+    // 支持窗口捕获的平台在屏幕之后列出顶层窗口，窗口列表随时变化，提供手动刷新
+    refreshWindowsButton = new QPushButton("刷新窗口");
+    connect(refreshWindowsButton, &QPushButton::clicked, this, &MainWindow::refreshCaptureWindows);
+    settingsLayout->addWidget(refreshWindowsButton, 3, 2);
+    refreshCaptureWindows();
 
     // 定时录制组
     QGroupBox *timerGroup = new QGroupBox("定时录制");
@@ -393,6 +404,11 @@ void MainWindow::setupUI() {
     recordingTimer->setSingleShot(true);
     connect(recordingTimer, &QTimer::timeout, this, &MainWindow::onTimedRecordingFinished);
     
+    // 用户离开时降低录制开销并暂停 AI 取样
+    activityMonitor = new ActivityMonitor(this);
+    connect(activityMonitor, &ActivityMonitor::idleStarted, this, &MainWindow::onUserIdle);
+    connect(activityMonitor, &ActivityMonitor::activityResumed, this, &MainWindow::onUserActive);
+    
     restoreWindowTimer = new QTimer(this);
     restoreWindowTimer->setSingleShot(true);
     connect(restoreWindowTimer, &QTimer::timeout, this, [this]() {
@@ -477,10 +493,45 @@ void MainWindow::onStartRecording() {
     int fps = fpsCombo->currentText().split(" ")[0].toInt();
     videoCapture->setFrameRate(fps);
 
-    // 使用所选屏幕的区域作为捕获区域
+    // 录屏多为长时间静止的桌面，开启脏矩形捕获（平台不支持时自动退回整帧）
+    videoCapture->setDirtyRegionCapture(true);
+
+    // 使用所选屏幕的区域作为捕获区域；选中窗口时改为窗口捕获
     int idx = screenCombo->currentData().toInt();
     const auto screens = QGuiApplication::screens();
-    if (idx >= 0 && idx < screens.size()) {
+    const quint64 windowId = screenCombo->currentData(CaptureWindowRole).toULongLong();
+    videoCapture->setCaptureWindow(0);
+    videoCapture->setCaptureScreens({});
+    if (idx == AllScreensIndex) {
+        std::vector<CaptureRect> screenRects;
+        QRect bounds;
+        for (QScreen *screen : screens) {
+            const QRect g = screen->geometry();
+            const qreal devicePixelRatio = screen->devicePixelRatio();
+            const QRect physical(g.x() * devicePixelRatio, g.y() * devicePixelRatio,
+                                 g.width() * devicePixelRatio, g.height() * devicePixelRatio);
+            screenRects.push_back({physical.x(), physical.y(), physical.width(), physical.height()});
+            bounds = bounds.united(physical);
+        }
+        // 不支持多屏并行捕获的平台退回按外接矩形整体捕获
+        if (!videoCapture->setCaptureScreens(screenRects)) {
+            videoCapture->setCaptureRegion(bounds.x(), bounds.y(), bounds.width(), bounds.height());
+        }
+        realTimeVideoSummaryManager->setCaptureRegion(bounds.x(), bounds.y(), bounds.width(), bounds.height());
+        std::cout << "设置录制区域: 全部 " << screens.size() << " 块屏幕, 画布 "
+                  << bounds.width() << "x" << bounds.height() << std::endl;
+    } else if (windowId != 0 && videoCapture->setCaptureWindow(windowId)) {
+        // 实时总结的备用抓屏路径只支持屏幕区域，取窗口当前位置
+        for (const CaptureWindowInfo &window : videoCapture->listCaptureWindows()) {
+            if (window.id == windowId) {
+                realTimeVideoSummaryManager->setCaptureRegion(window.geometry.x, window.geometry.y,
+                                                              window.geometry.width, window.geometry.height);
+                std::cout << "设置录制窗口: " << window.title << " ("
+                          << window.geometry.width << "x" << window.geometry.height << ")" << std::endl;
+                break;
+            }
+        }
+    } else if (idx >= 0 && idx < screens.size()) {
         QRect g = screens[idx]->geometry();
         qreal devicePixelRatio = screens[idx]->devicePixelRatio();
         
@@ -577,6 +628,8 @@ void MainWindow::onStopRecording() {
         restoreWindowTimer->stop();
     }
     
+    // 先结束空闲检测，未结束的空闲区间在停止前记入时间线
+    stopActivityMonitor();
     videoCapture->stopCapture();
     
     isRecording = false;
@@ -630,10 +683,15 @@ void MainWindow::onStopRecording() {
 }
 
 void MainWindow::startRecordingInternal(const QString& outputPath, const QString& outputDir) {
+    // 启用实时总结时，AI 取样直接复用录制管线的帧，屏幕只抓一次
+    const bool realTimeSummary = videoSummaryEnabledCheckBox->isChecked() && aiSummaryConfig.isValid();
+    realTimeVideoSummaryManager->setRecordingTapSource(realTimeSummary ? videoCapture.get() : nullptr);
+    
     // 开始录制
     if (videoCapture->startCapture(outputPath.toStdString())) {
         isRecording = true;
         recordStartTime = QDateTime::currentMSecsSinceEpoch();
+        frameRateWarningShown = false;
         
         // 如果启用了定时录制，现在才启动定时器
         if (timerEnabledCheckBox->isChecked() && recordingDurationMs > 0) {
@@ -649,10 +707,11 @@ void MainWindow::startRecordingInternal(const QString& outputPath, const QString
         updateTimer->start(1000);
         
         // 如果启用了视频内容总结，开始实时分析
-        if (videoSummaryEnabledCheckBox->isChecked() && aiSummaryConfig.isValid()) {
+        if (realTimeSummary) {
             realTimeVideoSummaryManager->startRecording(outputPath);
             videoSummaryTextEdit->setMarkdown("### 🔄 实时总结中...\n\n正在录制并分析屏幕内容，录制完成后将生成完整总结。");
         }
+        activityMonitor->start();
     } else {
         // 如果录制失败，恢复窗口和按钮状态
         startButton->setEnabled(true);
@@ -700,6 +759,63 @@ void MainWindow::onTimerEnabledChanged(bool enabled) {
     }
 }
 
+void MainWindow::refreshCaptureWindows() {
+    // 保留屏幕项，重建窗口项并尽量保持当前选择
+    const quint64 selectedWindow = screenCombo->currentData(CaptureWindowRole).toULongLong();
+    for (int i = screenCombo->count() - 1; i >= 0; --i) {
+        if (screenCombo->itemData(i, CaptureWindowRole).toULongLong() != 0) {
+            screenCombo->removeItem(i);
+        }
+    }
+
+    const std::vector<CaptureWindowInfo> windows = videoCapture->listCaptureWindows();
+    refreshWindowsButton->setVisible(!windows.empty());
+    const WId ownWindow = internalWinId();
+    for (const CaptureWindowInfo &window : windows) {
+        if (window.id == static_cast<quint64>(ownWindow)) {
+            continue;
+        }
+        QString title = QString::fromStdString(window.title);
+        if (title.length() > 40) {
+            title = title.left(40) + "…";
+        }
+        screenCombo->addItem(QString("窗口: %1 (%2×%3)").arg(title).arg(window.geometry.width).arg(window.geometry.height), -1);
+        const int index = screenCombo->count() - 1;
+        screenCombo->setItemData(index, QVariant::fromValue<quint64>(window.id), CaptureWindowRole);
+        if (window.id == selectedWindow) {
+            screenCombo->setCurrentIndex(index);
+        }
+    }
+}
+
+void MainWindow::onUserIdle(qint64 idleSinceMs, bool locked) {
+    if (!isRecording) return;
+    
+    const bool lowPower = videoCapture->setIdleMode(true);
+    realTimeVideoSummaryManager->setUserIdle(true, idleSinceMs, QDateTime::currentMSecsSinceEpoch(), locked);
+    setStatusText(QString("%1：%2暂停 AI 取样")
+                      .arg(locked ? "已锁屏" : "用户空闲")
+                      .arg(lowPower ? "已降低录制帧率，" : ""),
+                  "#e2e3e5", "#6c757d", "#383d41");
+}
+
+void MainWindow::onUserActive(qint64 idleSinceMs, qint64 resumedAtMs) {
+    videoCapture->setIdleMode(false);
+    realTimeVideoSummaryManager->setUserIdle(false, idleSinceMs, resumedAtMs);
+    if (isRecording) {
+        frameRateWarningShown = false;
+        setStatusText("录制中...", "#f8d7da", "#dc3545", "#721c24");
+    }
+}
+
+void MainWindow::stopActivityMonitor() {
+    // 录制结束时仍空闲：只把空闲区间记入时间线，不恢复取样与录制帧率（随后即停止）
+    if (activityMonitor->isIdle()) {
+        realTimeVideoSummaryManager->closeIdleGap(activityMonitor->idleSince(), recordEndTime);
+    }
+    activityMonitor->stop();
+}
+
 void MainWindow::updateRecordingTime() {
     if (isRecording) {
         qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
@@ -720,6 +836,26 @@ void MainWindow::updateRecordingTime() {
                 timerRemainingLabel->setText("00:00:00");
             }
         }
+
+        // 实际帧率持续低于目标 90% 时在状态栏提示（前 3 秒启动抖动不计，空闲降帧期间不提示）
+        const CaptureStats stats = videoCapture->captureStats();
+        if (duration >= 3000 && stats.achievedFps > 0.0 && !activityMonitor->isIdle()) {
+            const bool belowTarget = stats.achievedFps < stats.targetFps * 0.9;
+            if (belowTarget) {
+                setStatusText(QString("录制中... 实际 %1/%2 fps，丢帧 %3")
+                                  .arg(stats.achievedFps, 0, 'f', 1)
+                                  .arg(stats.targetFps, 0, 'f', 0)
+                                  .arg(stats.framesDropped),
+                              "#fff3cd", "#ffc107", "#856404");
+                if (!frameRateWarningShown) {
+                    qWarning() << "录制帧率不足: 实际" << stats.achievedFps << "fps, 目标" << stats.targetFps
+                               << "fps, 丢帧" << stats.framesDropped << ", 迟到" << stats.framesLate;
+                }
+            } else if (frameRateWarningShown) {
+                setStatusText("录制中...", "#f8d7da", "#dc3545", "#721c24");
+            }
+            frameRateWarningShown = belowTarget;
+        }
     }
 }
 
@@ -730,6 +866,7 @@ void MainWindow::onTimedRecordingFinished() {
     recordEndTime = QDateTime::currentMSecsSinceEpoch();
     
     // 停止录制
+    stopActivityMonitor();
     videoCapture->stopCapture();
     isRecording = false;
     
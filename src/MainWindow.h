@@ -16,6 +16,7 @@
 #include "AISummaryConfigDialog.h"
 #include "VideoSummaryManager.h"
 #include "RealTimeVideoSummaryManager.h"
+#include "ActivityMonitor.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -36,10 +37,14 @@ private slots:
     void onVideoSummaryProgress(const QString &status, int percentage);
     void onVideoSummaryCompleted(bool success, const QString &summary, const QString &message);
     void onRealTimeFrameAnalyzed(const QString &analysis, double timestamp);
+    void refreshCaptureWindows();
+    void onUserIdle(qint64 idleSinceMs, bool locked);
+    void onUserActive(qint64 idleSinceMs, qint64 resumedAtMs);
 
 private:
     void setupUI();
     void startRecordingInternal(const QString& outputPath, const QString& outputDir);
+    void stopActivityMonitor();
     QString formatDuration(qint64 ms);
     void setStatusText(const QString& text, const QString& color = "#fff3cd", const QString& borderColor = "#ffc107", const QString& textColor = "#856404");
     void loadAISettings();
@@ -52,7 +57,10 @@ private:
     QLineEdit *outputPathEdit;
     QLineEdit *outputNameEdit; // 输出文件名
     QComboBox *fpsCombo;
-    QComboBox *screenCombo; // 选择录制屏幕
+    QComboBox *screenCombo; // 选择录制屏幕或窗口
+    QPushButton *refreshWindowsButton; // 刷新可录制的窗口列表
+    static const int CaptureWindowRole = Qt::UserRole + 1; // 窗口项在 screenCombo 中保存窗口 ID 的数据角色
+    static const int AllScreensIndex = -2; // screenCombo 中“全部屏幕”项的数据值
     QCheckBox *autoMinimizeCheckBox; // 自动最小化选项
     QSpinBox *delaySecondsSpinBox; // 延时时间（秒）
     QCheckBox *timerEnabledCheckBox; // 定时录制开关
@@ -65,6 +73,7 @@ private:
     QTimer *updateTimer;
     QTimer *recordingTimer; // 定时录制计时器
     QTimer *restoreWindowTimer; // 窗口恢复计时器
+    ActivityMonitor *activityMonitor; // 录制期间检测用户空闲/锁屏
     
     // 视频内容总结相关UI组件
     QCheckBox *videoSummaryEnabledCheckBox; // 启用视频内容总结
@@ -76,6 +85,7 @@ private:
     qint64 recordStartTime;
     qint64 recordEndTime; // 记录录制结束时间
     qint64 recordingDurationMs; // 预设录制时长(毫秒)
+    bool frameRateWarningShown; // 状态栏是否正在提示实际帧率不足
     
     // AI视频总结配置
     AISummaryConfig aiSummaryConfig;
@@ -0,0 +1,606 @@
+// PixelConverter.cpp
+// 像素格式转换实现：编译期生成的 (源, 目标) 转换表 + RGB->YUV 4:2:0 的 SIMD 内核
+#include "PixelConverter.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+using Coefficients = PixelConverter::Coefficients;
+
+const int Q15_ROUND = 1 << 14;
+const int Q13_ROUND = 1 << 12;
+
+// 各平面的起始指针与步长（打包格式只用第 0 个）
+struct Planes {
+    uint8_t *data[3] = {nullptr, nullptr, nullptr};
+    int stride[3] = {0, 0, 0};
+};
+
+using ConvertFn = void (*)(const Planes &, const Planes &, int, int, const Coefficients &);
+
+// 编译期格式描述：打包 RGB 给出字节数与各通道偏移（无 alpha 为 -1），YUV 给出色度下采样位移
+template <int Bpp, int R, int G, int B, int A>
+struct RgbTraits {
+    static constexpr bool isYuv = false;
+    static constexpr int bpp = Bpp;
+    static constexpr int r = R;
+    static constexpr int g = G;
+    static constexpr int b = B;
+    static constexpr int a = A;
+};
+
+template <int ShiftX, int ShiftY, bool Interleaved>
+struct YuvTraits {
+    static constexpr bool isYuv = true;
+    static constexpr int shiftX = ShiftX;
+    static constexpr int shiftY = ShiftY;
+    static constexpr bool interleaved = Interleaved;   // U/V 交错存放在第 1 个平面（NV12）
+};
+
+template <PixelFormat F> struct FormatTraits;
+template <> struct FormatTraits<PixelFormat::RGB24> : RgbTraits<3, 0, 1, 2, -1> {};
+template <> struct FormatTraits<PixelFormat::BGR24> : RgbTraits<3, 2, 1, 0, -1> {};
+template <> struct FormatTraits<PixelFormat::RGBA32> : RgbTraits<4, 0, 1, 2, 3> {};
+template <> struct FormatTraits<PixelFormat::BGRA32> : RgbTraits<4, 2, 1, 0, 3> {};
+template <> struct FormatTraits<PixelFormat::YUV420P> : YuvTraits<1, 1, false> {};
+template <> struct FormatTraits<PixelFormat::YUV422P> : YuvTraits<1, 0, false> {};
+template <> struct FormatTraits<PixelFormat::YUV444P> : YuvTraits<0, 0, false> {};
+template <> struct FormatTraits<PixelFormat::NV12> : YuvTraits<1, 1, true> {};
+
+PixelConverter::Coefficients computeCoefficients(YuvMatrix matrix, YuvRange range) {
+    const double kr = matrix == YuvMatrix::BT709 ? 0.2126 : 0.299;
+    const double kb = matrix == YuvMatrix::BT709 ? 0.0722 : 0.114;
+    const double kg = 1.0 - kr - kb;
+    const bool limited = range == YuvRange::Limited;
+    const double lumaScale = limited ? 219.0 / 255.0 : 1.0;
+    const double chromaScale = limited ? 224.0 / 255.0 : 1.0;
+    auto q15 = [](double v) { return static_cast<int>(std::lround(v * 32768.0)); };
+    auto q13 = [](double v) { return static_cast<int>(std::lround(v * 8192.0)); };
+
+    // 每组系数之和取整后保持精确（Y 为 lumaScale，U/V 为 0），白色和灰色不会因舍入偏色
+    Coefficients c;
+    c.yr = q15(kr * lumaScale);
+    c.yb = q15(kb * lumaScale);
+    c.yg = q15(lumaScale) - c.yr - c.yb;
+    c.ub = q15(0.5 * chromaScale);
+    c.ur = q15(-0.5 * chromaScale * kr / (1.0 - kb));
+    c.ug = -c.ub - c.ur;
+    c.vr = q15(0.5 * chromaScale);
+    c.vb = q15(-0.5 * chromaScale * kb / (1.0 - kr));
+    c.vg = -c.vr - c.vb;
+    c.yOffset = limited ? 16 : 0;
+
+    c.yScale = q13(1.0 / lumaScale);
+    c.rv = q13(2.0 * (1.0 - kr) / chromaScale);
+    c.bu = q13(2.0 * (1.0 - kb) / chromaScale);
+    c.gu = q13(-2.0 * (1.0 - kb) * kb / kg / chromaScale);
+    c.gv = q13(-2.0 * (1.0 - kr) * kr / kg / chromaScale);
+    return c;
+}
+
+inline uint8_t clampByte(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+inline uint8_t lumaOf(int r, int g, int b, const Coefficients &c) {
+    return clampByte((c.yr * r + c.yg * g + c.yb * b + (c.yOffset << 15) + Q15_ROUND) >> 15);
+}
+
+inline uint8_t chromaOf(int r, int g, int b, int kr, int kg, int kb) {
+    return clampByte((kr * r + kg * g + kb * b + (128 << 15) + Q15_ROUND) >> 15);
+}
+
+inline int chromaSize(int size, int shift) {
+    return (size + (1 << shift) - 1) >> shift;
+}
+
+inline uint8_t *planeRow(const Planes &p, int plane, int y) {
+    return p.data[plane] + static_cast<size_t>(y) * p.stride[plane];
+}
+
+template <typename T>
+inline uint8_t *chromaU(const Planes &p, int cx, int cy) {
+    return planeRow(p, 1, cy) + cx * (T::interleaved ? 2 : 1);
+}
+
+template <typename T>
+inline uint8_t *chromaV(const Planes &p, int cx, int cy) {
+    if constexpr (T::interleaved) {
+        return chromaU<T>(p, cx, cy) + 1;
+    } else {
+        return planeRow(p, 2, cy) + cx;
+    }
+}
+
+void copyPlane(const Planes &s, const Planes &d, int plane, int rowBytes, int rows) {
+    for (int y = 0; y < rows; ++y) {
+        memcpy(planeRow(d, plane, y), planeRow(s, plane, y), rowBytes);
+    }
+}
+
+template <PixelFormat F>
+void copyImage(const Planes &s, const Planes &d, int w, int h, const Coefficients &) {
+    using T = FormatTraits<F>;
+    if constexpr (T::isYuv) {
+        const int cw = chromaSize(w, T::shiftX);
+        const int ch = chromaSize(h, T::shiftY);
+        copyPlane(s, d, 0, w, h);
+        if constexpr (T::interleaved) {
+            copyPlane(s, d, 1, cw * 2, ch);
+        } else {
+            copyPlane(s, d, 1, cw, ch);
+            copyPlane(s, d, 2, cw, ch);
+        }
+    } else {
+        copyPlane(s, d, 0, w * T::bpp, h);
+    }
+}
+
+template <PixelFormat S, PixelFormat D>
+void rgbToRgb(const Planes &s, const Planes &d, int w, int h, const Coefficients &) {
+    using ST = FormatTraits<S>;
+    using DT = FormatTraits<D>;
+    for (int y = 0; y < h; ++y) {
+        const uint8_t *src = planeRow(s, 0, y);
+        uint8_t *dst = planeRow(d, 0, y);
+        for (int x = 0; x < w; ++x, src += ST::bpp, dst += DT::bpp) {
+            dst[DT::r] = src[ST::r];
+            dst[DT::g] = src[ST::g];
+            dst[DT::b] = src[ST::b];
+            if constexpr (DT::a >= 0 && ST::a >= 0) {
+                dst[DT::a] = src[ST::a];
+            } else if constexpr (DT::a >= 0) {
+                dst[DT::a] = 255;
+            }
+        }
+    }
+}
+
+template <PixelFormat S>
+void rgbLumaRow(const uint8_t *src, uint8_t *dst, int x0, int x1, const Coefficients &c) {
+    using T = FormatTraits<S>;
+    for (int x = x0; x < x1; ++x) {
+        const uint8_t *px = src + x * T::bpp;
+        dst[x] = lumaOf(px[T::r], px[T::g], px[T::b], c);
+    }
+}
+
+// 一行色度样本：取色度块内 RGB 的均值再变换；row1 为块的第二行（越界时传入最后一行），
+// 越过右边界的列复制最后一列
+template <PixelFormat S, PixelFormat D>
+void rgbChromaRow(const uint8_t *row0, const uint8_t *row1, int width, int cx0, int cx1,
+                  const Planes &d, int cy, const Coefficients &c) {
+    using ST = FormatTraits<S>;
+    using DT = FormatTraits<D>;
+    constexpr int shift = DT::shiftX + DT::shiftY;
+    constexpr int half = (1 << shift) >> 1;
+    for (int cx = cx0; cx < cx1; ++cx) {
+        int r = 0, g = 0, b = 0;
+        for (int k = 0; k < (1 << DT::shiftX); ++k) {
+            const int x = std::min((cx << DT::shiftX) + k, width - 1);
+            const uint8_t *p0 = row0 + x * ST::bpp;
+            r += p0[ST::r];
+            g += p0[ST::g];
+            b += p0[ST::b];
+            if constexpr (DT::shiftY > 0) {
+                const uint8_t *p1 = row1 + x * ST::bpp;
+                r += p1[ST::r];
+                g += p1[ST::g];
+                b += p1[ST::b];
+            }
+        }
+        r = (r + half) >> shift;
+        g = (g + half) >> shift;
+        b = (b + half) >> shift;
+        *chromaU<DT>(d, cx, cy) = chromaOf(r, g, b, c.ur, c.ug, c.ub);
+        *chromaV<DT>(d, cx, cy) = chromaOf(r, g, b, c.vr, c.vg, c.vb);
+    }
+}
+
+template <PixelFormat S, PixelFormat D>
+void rgbToYuv(const Planes &s, const Planes &d, int w, int h, const Coefficients &c) {
+    using DT = FormatTraits<D>;
+    for (int y = 0; y < h; ++y) {
+        rgbLumaRow<S>(planeRow(s, 0, y), planeRow(d, 0, y), 0, w, c);
+    }
+    const int cw = chromaSize(w, DT::shiftX);
+    const int ch = chromaSize(h, DT::shiftY);
+    for (int cy = 0; cy < ch; ++cy) {
+        const int y0 = cy << DT::shiftY;
+        const int y1 = std::min(y0 + (1 << DT::shiftY) - 1, h - 1);
+        rgbChromaRow<S, D>(planeRow(s, 0, y0), planeRow(s, 0, y1), w, 0, cw, d, cy, c);
+    }
+}
+
+template <PixelFormat S, PixelFormat D>
+void yuvToRgb(const Planes &s, const Planes &d, int w, int h, const Coefficients &c) {
+    using ST = FormatTraits<S>;
+    using DT = FormatTraits<D>;
+    for (int y = 0; y < h; ++y) {
+        const int cy = y >> ST::shiftY;
+        const uint8_t *luma = planeRow(s, 0, y);
+        uint8_t *dst = planeRow(d, 0, y);
+        for (int x = 0; x < w; ++x, dst += DT::bpp) {
+            const int cx = x >> ST::shiftX;
+            const int yy = (luma[x] - c.yOffset) * c.yScale + Q13_ROUND;
+            const int u = *chromaU<ST>(s, cx, cy) - 128;
+            const int v = *chromaV<ST>(s, cx, cy) - 128;
+            dst[DT::r] = clampByte((yy + c.rv * v) >> 13);
+            dst[DT::g] = clampByte((yy + c.gu * u + c.gv * v) >> 13);
+            dst[DT::b] = clampByte((yy + c.bu * u) >> 13);
+            if constexpr (DT::a >= 0) {
+                dst[DT::a] = 255;
+            }
+        }
+    }
+}
+
+// YUV 之间只重采样色度：目标更粗的方向取均值，更细的方向复制最近样本
+template <PixelFormat S, PixelFormat D>
+void yuvToYuv(const Planes &s, const Planes &d, int w, int h, const Coefficients &) {
+    using ST = FormatTraits<S>;
+    using DT = FormatTraits<D>;
+    constexpr int kx = DT::shiftX > ST::shiftX ? DT::shiftX - ST::shiftX : 0;
+    constexpr int ky = DT::shiftY > ST::shiftY ? DT::shiftY - ST::shiftY : 0;
+    constexpr int half = (1 << (kx + ky)) >> 1;
+    copyPlane(s, d, 0, w, h);
+    const int srcCw = chromaSize(w, ST::shiftX);
+    const int srcCh = chromaSize(h, ST::shiftY);
+    const int dstCw = chromaSize(w, DT::shiftX);
+    const int dstCh = chromaSize(h, DT::shiftY);
+    for (int cy = 0; cy < dstCh; ++cy) {
+        for (int cx = 0; cx < dstCw; ++cx) {
+            int u = 0, v = 0;
+            for (int j = 0; j < (1 << ky); ++j) {
+                const int sy = ky > 0 ? std::min((cy << ky) + j, srcCh - 1) : (cy << DT::shiftY) >> ST::shiftY;
+                for (int i = 0; i < (1 << kx); ++i) {
+                    const int sx = kx > 0 ? std::min((cx << kx) + i, srcCw - 1) : (cx << DT::shiftX) >> ST::shiftX;
+                    u += *chromaU<ST>(s, sx, sy);
+                    v += *chromaV<ST>(s, sx, sy);
+                }
+            }
+            *chromaU<DT>(d, cx, cy) = static_cast<uint8_t>((u + half) >> (kx + ky));
+            *chromaV<DT>(d, cx, cy) = static_cast<uint8_t>((v + half) >> (kx + ky));
+        }
+    }
+}
+
+template <PixelFormat S, PixelFormat D>
+void convertPair(const Planes &s, const Planes &d, int w, int h, const Coefficients &c) {
+    if constexpr (S == D) {
+        copyImage<S>(s, d, w, h, c);
+    } else if constexpr (!FormatTraits<S>::isYuv && !FormatTraits<D>::isYuv) {
+        rgbToRgb<S, D>(s, d, w, h, c);
+    } else if constexpr (!FormatTraits<S>::isYuv) {
+        rgbToYuv<S, D>(s, d, w, h, c);
+    } else if constexpr (!FormatTraits<D>::isYuv) {
+        yuvToRgb<S, D>(s, d, w, h, c);
+    } else {
+        yuvToYuv<S, D>(s, d, w, h, c);
+    }
+}
+
+using ConvertTable = std::array<ConvertFn, PIXEL_FORMAT_COUNT * PIXEL_FORMAT_COUNT>;
+
+template <size_t... I>
+constexpr ConvertTable makeScalarTable(std::index_sequence<I...>) {
+    return {{&convertPair<static_cast<PixelFormat>(I / PIXEL_FORMAT_COUNT),
+                          static_cast<PixelFormat>(I % PIXEL_FORMAT_COUNT)>...}};
+}
+
+// 按 源格式 * PIXEL_FORMAT_COUNT + 目标格式 索引
+constexpr ConvertTable scalarTable = makeScalarTable(std::make_index_sequence<PIXEL_FORMAT_COUNT * PIXEL_FORMAT_COUNT>());
+
+constexpr size_t tableIndex(PixelFormat src, PixelFormat dst) {
+    return static_cast<size_t>(src) * PIXEL_FORMAT_COUNT + static_cast<size_t>(dst);
+}
+
+#if defined(AICP_X86)
+// 4 字节 RGB 的 16 位系数向量，按像素内通道顺序排列，alpha 位置为 0
+template <PixelFormat S>
+inline void channelCoefficients(int16_t out[8], int r, int g, int b) {
+    using T = FormatTraits<S>;
+    for (int i = 0; i < 8; i += 4) {
+        out[i + T::r] = static_cast<int16_t>(r);
+        out[i + T::g] = static_cast<int16_t>(g);
+        out[i + T::b] = static_cast<int16_t>(b);
+        out[i + T::a] = 0;
+    }
+}
+
+// 4 个像素的 Q15 加权和
+AICP_TARGET_SSE41
+inline __m128i weightedSums4(__m128i px, __m128i coef, __m128i zero) {
+    const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), coef);
+    const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), coef);
+    return _mm_hadd_epi32(lo, hi);
+}
+
+// 两行 4 列像素 -> 两个 2x2 块的通道均值（16 位，每块 4 个通道）
+AICP_TARGET_SSE41
+inline __m128i blockAverages2(__m128i row0, __m128i row1, __m128i zero) {
+    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+    lo = _mm_add_epi16(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+    hi = _mm_add_epi16(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_set1_epi16(2)), 2);
+}
+
+// 两行一组转换到 4:2:0，每次 8 个像素；返回已处理的像素数，剩余部分由标量实现补齐
+template <PixelFormat S, bool Interleaved>
+AICP_TARGET_SSE41
+int rowPairToYuv420SSE41(const uint8_t *row0, const uint8_t *row1, uint8_t *y0, uint8_t *y1,
+                         uint8_t *u, uint8_t *v, int width, const Coefficients &c) {
+    alignas(16) int16_t ky[8], ku[8], kv[8];
+    channelCoefficients<S>(ky, c.yr, c.yg, c.yb);
+    channelCoefficients<S>(ku, c.ur, c.ug, c.ub);
+    channelCoefficients<S>(kv, c.vr, c.vg, c.vb);
+    const __m128i coefY = _mm_load_si128(reinterpret_cast<const __m128i *>(ky));
+    const __m128i coefU = _mm_load_si128(reinterpret_cast<const __m128i *>(ku));
+    const __m128i coefV = _mm_load_si128(reinterpret_cast<const __m128i *>(kv));
+    const __m128i biasY = _mm_set1_epi32((c.yOffset << 15) + Q15_ROUND);
+    const __m128i biasC = _mm_set1_epi32((128 << 15) + Q15_ROUND);
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 4));
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 4 + 16));
+        const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 4));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 4 + 16));
+
+        __m128i lumaA = _mm_srai_epi32(_mm_add_epi32(weightedSums4(a0, coefY, zero), biasY), 15);
+        __m128i lumaB = _mm_srai_epi32(_mm_add_epi32(weightedSums4(b0, coefY, zero), biasY), 15);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(y0 + x), _mm_packus_epi16(_mm_packs_epi32(lumaA, lumaB), zero));
+        lumaA = _mm_srai_epi32(_mm_add_epi32(weightedSums4(a1, coefY, zero), biasY), 15);
+        lumaB = _mm_srai_epi32(_mm_add_epi32(weightedSums4(b1, coefY, zero), biasY), 15);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(y1 + x), _mm_packus_epi16(_mm_packs_epi32(lumaA, lumaB), zero));
+
+        const __m128i avgA = blockAverages2(a0, a1, zero);
+        const __m128i avgB = blockAverages2(b0, b1, zero);
+        __m128i cu = _mm_hadd_epi32(_mm_madd_epi16(avgA, coefU), _mm_madd_epi16(avgB, coefU));
+        __m128i cv = _mm_hadd_epi32(_mm_madd_epi16(avgA, coefV), _mm_madd_epi16(avgB, coefV));
+        cu = _mm_srai_epi32(_mm_add_epi32(cu, biasC), 15);
+        cv = _mm_srai_epi32(_mm_add_epi32(cv, biasC), 15);
+        // 低 4 字节为 U，随后 4 字节为 V
+        const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(cu, cv), zero);
+        if constexpr (Interleaved) {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(u + x), _mm_unpacklo_epi8(packed, _mm_srli_si128(packed, 4)));
+        } else {
+            const int uBits = _mm_cvtsi128_si32(packed);
+            const int vBits = _mm_cvtsi128_si32(_mm_srli_si128(packed, 4));
+            memcpy(u + x / 2, &uBits, 4);
+            memcpy(v + x / 2, &vBits, 4);
+        }
+    }
+    return x;
+}
+
+AICP_TARGET_AVX2
+inline __m256i weightedSums8(__m256i px, __m256i coef, __m256i zero) {
+    const __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(px, zero), coef);
+    const __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(px, zero), coef);
+    return _mm256_hadd_epi32(lo, hi);
+}
+
+// 两行 8 列像素 -> 四个 2x2 块的通道均值，块按顺序排列
+AICP_TARGET_AVX2
+inline __m256i blockAverages4(__m256i row0, __m256i row1, __m256i zero) {
+    __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(row0, zero), _mm256_unpacklo_epi8(row1, zero));
+    __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(row0, zero), _mm256_unpackhi_epi8(row1, zero));
+    lo = _mm256_add_epi16(lo, _mm256_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+    hi = _mm256_add_epi16(hi, _mm256_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_set1_epi16(2)), 2);
+}
+
+// 与 SSE4.1 版本相同的算法，每次 16 个像素；hadd/pack 按 128 位通道进行，需要重排回像素顺序
+template <PixelFormat S, bool Interleaved>
+AICP_TARGET_AVX2
+int rowPairToYuv420AVX2(const uint8_t *row0, const uint8_t *row1, uint8_t *y0, uint8_t *y1,
+                        uint8_t *u, uint8_t *v, int width, const Coefficients &c) {
+    alignas(16) int16_t ky[8], ku[8], kv[8];
+    channelCoefficients<S>(ky, c.yr, c.yg, c.yb);
+    channelCoefficients<S>(ku, c.ur, c.ug, c.ub);
+    channelCoefficients<S>(kv, c.vr, c.vg, c.vb);
+    const __m256i coefY = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(ky)));
+    const __m256i coefU = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(ku)));
+    const __m256i coefV = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(kv)));
+    const __m256i biasY = _mm256_set1_epi32((c.yOffset << 15) + Q15_ROUND);
+    const __m256i biasC = _mm256_set1_epi32((128 << 15) + Q15_ROUND);
+    const __m256i chromaOrder = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    const __m256i zero = _mm256_setzero_si256();
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + x * 4));
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + x * 4 + 32));
+        const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + x * 4));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + x * 4 + 32));
+
+        for (int r = 0; r < 2; ++r) {
+            const __m256i lumaA = _mm256_srai_epi32(_mm256_add_epi32(weightedSums8(r ? a1 : a0, coefY, zero), biasY), 15);
+            const __m256i lumaB = _mm256_srai_epi32(_mm256_add_epi32(weightedSums8(r ? b1 : b0, coefY, zero), biasY), 15);
+            const __m256i luma16 = _mm256_permute4x64_epi64(_mm256_packs_epi32(lumaA, lumaB), _MM_SHUFFLE(3, 1, 2, 0));
+            const __m128i luma8 = _mm_packus_epi16(_mm256_castsi256_si128(luma16), _mm256_extracti128_si256(luma16, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>((r ? y1 : y0) + x), luma8);
+        }
+
+        const __m256i avgA = blockAverages4(a0, a1, zero);
+        const __m256i avgB = blockAverages4(b0, b1, zero);
+        __m256i cu = _mm256_hadd_epi32(_mm256_madd_epi16(avgA, coefU), _mm256_madd_epi16(avgB, coefU));
+        __m256i cv = _mm256_hadd_epi32(_mm256_madd_epi16(avgA, coefV), _mm256_madd_epi16(avgB, coefV));
+        cu = _mm256_permutevar8x32_epi32(_mm256_srai_epi32(_mm256_add_epi32(cu, biasC), 15), chromaOrder);
+        cv = _mm256_permutevar8x32_epi32(_mm256_srai_epi32(_mm256_add_epi32(cv, biasC), 15), chromaOrder);
+        const __m128i u16 = _mm_packs_epi32(_mm256_castsi256_si128(cu), _mm256_extracti128_si256(cu, 1));
+        const __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(cv), _mm256_extracti128_si256(cv, 1));
+        // 低 8 字节为 U，高 8 字节为 V
+        const __m128i packed = _mm_packus_epi16(u16, v16);
+        if constexpr (Interleaved) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(u + x), _mm_unpacklo_epi8(packed, _mm_srli_si128(packed, 8)));
+        } else {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(u + x / 2), packed);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(v + x / 2), _mm_srli_si128(packed, 8));
+        }
+    }
+    // 不足 16 像素的尾部先交给 SSE4.1 内核
+    const int chromaOffset = Interleaved ? x : x / 2;
+    return x + rowPairToYuv420SSE41<S, Interleaved>(row0 + x * 4, row1 + x * 4, y0 + x, y1 + x,
+                                                    u + chromaOffset, Interleaved ? v : v + x / 2, width - x, c);
+}
+
+// 4 字节 RGB -> YUV420P/NV12：按行对调用 SIMD 内核，右侧余量与奇数尾行由标量实现处理
+template <PixelFormat S, PixelFormat D, bool UseAvx2>
+void rgbToYuv420Fast(const Planes &s, const Planes &d, int w, int h, const Coefficients &c) {
+    using DT = FormatTraits<D>;
+    const int cw = chromaSize(w, 1);
+    const int ch = chromaSize(h, 1);
+    for (int cy = 0; cy < ch; ++cy) {
+        const int ya = cy * 2;
+        const int yb = std::min(ya + 1, h - 1);
+        const uint8_t *row0 = planeRow(s, 0, ya);
+        const uint8_t *row1 = planeRow(s, 0, yb);
+        uint8_t *luma0 = planeRow(d, 0, ya);
+        uint8_t *luma1 = planeRow(d, 0, yb);
+        uint8_t *u = chromaU<DT>(d, 0, cy);
+        uint8_t *v = DT::interleaved ? nullptr : chromaV<DT>(d, 0, cy);
+        const int done = UseAvx2 ? rowPairToYuv420AVX2<S, DT::interleaved>(row0, row1, luma0, luma1, u, v, w, c)
+                                 : rowPairToYuv420SSE41<S, DT::interleaved>(row0, row1, luma0, luma1, u, v, w, c);
+        rgbLumaRow<S>(row0, luma0, done, w, c);
+        if (yb != ya) {
+            rgbLumaRow<S>(row1, luma1, done, w, c);
+        }
+        rgbChromaRow<S, D>(row0, row1, w, done / 2, cw, d, cy, c);
+    }
+}
+
+template <bool UseAvx2>
+void installFastKernels(ConvertTable &table) {
+    table[tableIndex(PixelFormat::BGRA32, PixelFormat::YUV420P)] =
+        &rgbToYuv420Fast<PixelFormat::BGRA32, PixelFormat::YUV420P, UseAvx2>;
+    table[tableIndex(PixelFormat::BGRA32, PixelFormat::NV12)] =
+        &rgbToYuv420Fast<PixelFormat::BGRA32, PixelFormat::NV12, UseAvx2>;
+    table[tableIndex(PixelFormat::RGBA32, PixelFormat::YUV420P)] =
+        &rgbToYuv420Fast<PixelFormat::RGBA32, PixelFormat::YUV420P, UseAvx2>;
+    table[tableIndex(PixelFormat::RGBA32, PixelFormat::NV12)] =
+        &rgbToYuv420Fast<PixelFormat::RGBA32, PixelFormat::NV12, UseAvx2>;
+}
+
+template <bool UseAvx2>
+ConvertTable makeFastTable() {
+    ConvertTable table = scalarTable;
+    installFastKernels<UseAvx2>(table);
+    return table;
+}
+
+// 各级内核表都在启动时建好（只是函数指针数组），运行哪一级由 CPU 检测决定
+const ConvertTable sse41Table = makeFastTable<false>();
+const ConvertTable avx2Table = makeFastTable<true>();
+#endif
+
+const ConvertTable &tableFor(PixelConverter::KernelSet kernels) {
+    switch (kernels) {
+    case PixelConverter::KernelSet::Scalar:
+        return scalarTable;
+#if defined(AICP_X86)
+    case PixelConverter::KernelSet::SSE41:
+        return sse41Table;
+    case PixelConverter::KernelSet::AVX2:
+        return avx2Table;
+    case PixelConverter::KernelSet::Auto:
+        return CpuFeatures::hasAVX2() ? avx2Table : (CpuFeatures::hasSSE41() ? sse41Table : scalarTable);
+#endif
+    default:
+        return scalarTable;
+    }
+}
+
+Planes planesOf(const FrameData &frame) {
+    Planes planes;
+    for (int i = 0; i < frame.planeCount(); ++i) {
+        planes.data[i] = frame.plane(i);
+        planes.stride[i] = frame.planeStride(i);
+    }
+    return planes;
+}
+
+} // namespace
+
+PixelConverter::PixelConverter(YuvMatrix matrix, YuvRange range)
+    : yuvMatrix(matrix)
+    , yuvRange(range)
+    , coefficients(computeCoefficients(matrix, range))
+{
+}
+
+void PixelConverter::setColorSpec(YuvMatrix matrix, YuvRange range) {
+    yuvMatrix = matrix;
+    yuvRange = range;
+    coefficients = computeCoefficients(matrix, range);
+}
+
+YuvMatrix PixelConverter::matrix() const {
+    return yuvMatrix;
+}
+
+YuvRange PixelConverter::range() const {
+    return yuvRange;
+}
+
+bool PixelConverter::convert(const FrameData& src, FrameData& dst) const {
+    return convertWithKernels(src, dst, KernelSet::Auto);
+}
+
+void PixelConverter::convertPixel(int r, int g, int b, int& y, int& u, int& v) const {
+    const Coefficients &c = coefficients;
+    y = lumaOf(r, g, b, c);
+    u = chromaOf(r, g, b, c.ur, c.ug, c.ub);
+    v = chromaOf(r, g, b, c.vr, c.vg, c.vb);
+}
+
+bool PixelConverter::convertReference(const FrameData& src, FrameData& dst) const {
+    return convertWithKernels(src, dst, KernelSet::Scalar);
+}
+
+bool PixelConverter::kernelSetSupported(KernelSet kernels) {
+    switch (kernels) {
+    case KernelSet::SSE41:
+        return CpuFeatures::hasSSE41();
+    case KernelSet::AVX2:
+        return CpuFeatures::hasAVX2();
+    default:
+        return true;
+    }
+}
+
+FrameData PixelConverter::convert(const FrameData& src, PixelFormat targetFormat) const {
+    if (src.format == targetFormat) {
+        return src;
+    }
+    FrameData result;
+    result.timestamp = src.timestamp;
+    result.unchanged = src.unchanged;
+    if (src.unchanged || !src.data || src.width <= 0 || src.height <= 0) {
+        return result;
+    }
+    if (!result.allocateImage(src.width, src.height, targetFormat)) {
+        return result;
+    }
+    convertWithKernels(src, result, KernelSet::Auto);
+    result.dirtyRects = src.dirtyRects;
+    return result;
+}
+
+bool PixelConverter::convertWithKernels(const FrameData& src, FrameData& dst, KernelSet kernels) const {
+    if (!src.data || !dst.data || src.width <= 0 || src.height <= 0 ||
+        src.width != dst.width || src.height != dst.height || !kernelSetSupported(kernels)) {
+        return false;
+    }
+    const ConvertFn fn = tableFor(kernels)[tableIndex(src.format, dst.format)];
+    fn(planesOf(src), planesOf(dst), src.width, src.height, coefficients);
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef PIXELCONVERTER_H
+#define PIXELCONVERTER_H
+
+#include "DataTypes.h"
+
+/**
+ * 像素格式转换器 - 任意两种 PixelFormat 之间的转换
+ * 每个 (源, 目标) 组合在编译期生成一个专用的标量实现，组成按格式索引的函数表；
+ * 录制热路径（BGRA/RGBA -> YUV420P/NV12）另有 SSE4.1/AVX2 内核，运行时按 CPU 选择。
+ * 所有实现使用同一套定点公式，SIMD 与标量结果逐字节一致
+ *
+ * RGB -> YUV 的色度取色度块内 RGB 的均值（边缘按最后一行/列复制）再做矩阵变换；
+ * YUV -> RGB 的色度取所在色度块的样本（最近邻）
+ */
+class PixelConverter {
+public:
+    // 定点系数：正变换 Q15，逆变换 Q13
+    struct Coefficients {
+        int yr = 0, yg = 0, yb = 0;   // RGB -> Y
+        int ur = 0, ug = 0, ub = 0;   // RGB -> U（结果加 128）
+        int vr = 0, vg = 0, vb = 0;   // RGB -> V（结果加 128）
+        int yOffset = 0;              // Y 的黑电平（limited 为 16，full 为 0）
+        int yScale = 0;               // YUV -> RGB：(Y - yOffset) 的系数
+        int rv = 0, gu = 0, gv = 0, bu = 0;
+    };
+
+    // 转换内核集：Auto 为运行时按 CPU 选出的最快实现
+    enum class KernelSet {
+        Auto,
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    explicit PixelConverter(YuvMatrix matrix = YuvMatrix::BT601, YuvRange range = YuvRange::Limited);
+
+    void setColorSpec(YuvMatrix matrix, YuvRange range);
+    YuvMatrix matrix() const;
+    YuvRange range() const;
+
+    // 转换到已分配的目标帧（可为裁剪视图），两帧尺寸必须一致；时间戳等元数据不复制
+    bool convert(const FrameData& src, FrameData& dst) const;
+
+    // 从缓冲池分配新帧并转换，保留时间戳与脏区域；格式相同时直接共享源帧
+    FrameData convert(const FrameData& src, PixelFormat targetFormat) const;
+
+    // 单个非预乘 RGB 像素转 YUV，与整帧转换逐字节一致（光标叠加等零星像素用）
+    void convertPixel(int r, int g, int b, int& y, int& u, int& v) const;
+
+    // 始终走标量实现的转换，用于校验 SIMD 内核
+    bool convertReference(const FrameData& src, FrameData& dst) const;
+
+    // 指定内核集转换（当前 CPU 不支持该内核集时返回 false），用于逐级校验 SIMD 内核
+    bool convertWithKernels(const FrameData& src, FrameData& dst, KernelSet kernels) const;
+    static bool kernelSetSupported(KernelSet kernels);
+
+private:
+    YuvMatrix yuvMatrix;
+    YuvRange yuvRange;
+    Coefficients coefficients;
+};
+
+#endif // PIXELCONVERTER_H
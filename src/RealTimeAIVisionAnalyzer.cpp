@@ -1,11 +1,24 @@
 #include "RealTimeAIVisionAnalyzer.h"
 #include "AIVisionAnalyzer.h"
+#include "TileChangeMap.h"
 #include <QDebug>
 #include <QMutexLocker>
-#include <QFile>
-#include <QFileInfo>
 #include <QThread>
 #include <QCoreApplication>
+#include <algorithm>
+
+namespace {
+
+// 计算帧的感知指纹；指纹只需要粗略亮度，按 1/8 尺寸解码即可
+FrameFingerprint fingerprintOf(const EncodedFrame &frame) {
+    const QImage preview = frame.decodePreview(8);
+    if (preview.isNull()) {
+        return FrameFingerprint();
+    }
+    return FrameFingerprint::compute(EncodedFrame::frameView(preview));
+}
+
+} // namespace
 
 RealTimeAIVisionAnalyzer::RealTimeAIVisionAnalyzer(QObject *parent)
     : QObject(parent)
@@ -13,6 +26,12 @@ RealTimeAIVisionAnalyzer::RealTimeAIVisionAnalyzer(QObject *parent)
     , realTimeAnalyzing(false)
     , processingQueue(false)
     , summaryAnalyzer(nullptr)
+    , changeMap(std::make_shared<TileChangeMap>())
+    , dedupMaxDistance(DEFAULT_DEDUP_DISTANCE)
+    , lastQueuedFrameIndex(-1)
+    , lastQueuedEndTimestamp(0.0)
+    , dedupChecked(0)
+    , dedupSkipped(0)
 {
     // 连接处理定时器
     connect(processTimer, &QTimer::timeout, this, &RealTimeAIVisionAnalyzer::processNextFrame);
@@ -33,23 +52,29 @@ void RealTimeAIVisionAnalyzer::setConfig(const AISummaryConfig &newConfig) {
     config = newConfig;
 }
 
-void RealTimeAIVisionAnalyzer::addFrameForAnalysis(const QString &framePath, double timestamp) {
+void RealTimeAIVisionAnalyzer::addFrameForAnalysis(const EncodedFrame &frame) {
     if (!realTimeAnalyzing || !isConfigValid()) {
         return;
     }
     
+    if (mergeIfDuplicate(frame)) {
+        return;
+    }
+    
     QMutexLocker locker(&queueMutex);
     
     FrameAnalysisTask task;
-    task.framePath = framePath;
-    task.timestamp = timestamp;
+    task.frame = frame;
+    task.frameIndex = frame.index;
+    task.timestamp = frame.timestamp;
+    task.endTimestamp = frame.timestamp;
     task.processed = false;
     
     frameQueue.enqueue(task);
     
     qDebug() << QString("添加帧到分析队列: %1 (时间戳: %2s, 队列长度: %3)")
-                .arg(QFileInfo(framePath).fileName())
-                .arg(timestamp, 0, 'f', 1)
+                .arg(frame.name())
+                .arg(frame.timestamp, 0, 'f', 1)
                 .arg(frameQueue.size());
 }
 
@@ -75,6 +100,9 @@ void RealTimeAIVisionAnalyzer::startRealTimeAnalysis() {
         frameQueue.clear();
         completedAnalyses.clear();
     }
+    resetDedup();
+    dedupChecked = 0;
+    dedupSkipped = 0;
     
     // 启动处理定时器
     processTimer->start();
@@ -114,20 +142,6 @@ void RealTimeAIVisionAnalyzer::cancelAnalysis() {
         processTimer->stop();
         
         QMutexLocker locker(&queueMutex);
-        
-        // 清理队列中剩余的图片文件
-        while (!frameQueue.isEmpty()) {
-            FrameAnalysisTask task = frameQueue.dequeue();
-            QFile tempImageFile(task.framePath);
-            if (tempImageFile.exists()) {
-                if (tempImageFile.remove()) {
-                    qDebug() << QString("已删除队列中的临时图片文件: %1").arg(QFileInfo(task.framePath).fileName());
-                } else {
-                    qWarning() << QString("删除队列中的临时图片文件失败: %1").arg(task.framePath);
-                }
-            }
-        }
-        
         frameQueue.clear();
         completedAnalyses.clear();
     }
@@ -140,6 +154,104 @@ void RealTimeAIVisionAnalyzer::cancelAnalysis() {
     }
 }
 
+void RealTimeAIVisionAnalyzer::pauseAnalysis() {
+    if (!realTimeAnalyzing || !processTimer->isActive()) {
+        return;
+    }
+    processTimer->stop();
+    qDebug() << QString("暂停实时AI分析 (队列中 %1 帧)").arg(frameQueue.size());
+}
+
+void RealTimeAIVisionAnalyzer::resumeAnalysis() {
+    if (!realTimeAnalyzing || processTimer->isActive()) {
+        return;
+    }
+    processTimer->start();
+    qDebug() << "恢复实时AI分析";
+}
+
+void RealTimeAIVisionAnalyzer::markIdleGap(double startTimestamp, double endTimestamp, bool locked) {
+    if (!realTimeAnalyzing) {
+        return;
+    }
+    
+    // 空闲前后的画面即使相同也不能跨越空闲区间合并
+    resetDedup();
+    
+    FrameAnalysisTask gap;
+    gap.frameIndex = -1;
+    gap.timestamp = startTimestamp;
+    gap.endTimestamp = endTimestamp;
+    gap.analysis = QString("%1s - %2s 用户%3，期间暂停取样与分析，画面无有效操作")
+                   .arg(startTimestamp, 0, 'f', 1)
+                   .arg(endTimestamp, 0, 'f', 1)
+                   .arg(locked ? "锁屏离开" : "空闲");
+    gap.processed = true;
+    
+    // 空闲前入队的帧可能在之后才完成分析，按时间戳插入以保持时间线有序
+    int index = completedAnalyses.size();
+    while (index > 0 && completedAnalyses[index - 1].timestamp > startTimestamp) {
+        --index;
+    }
+    completedAnalyses.insert(index, gap);
+    
+    emit realTimeFrameAnalyzed(QString(), gap.analysis, startTimestamp);
+}
+
+void RealTimeAIVisionAnalyzer::setDedupThreshold(int maxDistance) {
+    dedupMaxDistance = maxDistance;
+}
+
+int RealTimeAIVisionAnalyzer::dedupCheckedCount() const {
+    return dedupChecked;
+}
+
+int RealTimeAIVisionAnalyzer::dedupSkippedCount() const {
+    return dedupSkipped;
+}
+
+void RealTimeAIVisionAnalyzer::resetDedup() {
+    lastFingerprint = FrameFingerprint();
+    lastQueuedFrameIndex = -1;
+    changeMap->reset();
+    lastQueuedEndTimestamp = 0.0;
+}
+
+bool RealTimeAIVisionAnalyzer::mergeIfDuplicate(const EncodedFrame &frame) {
+    if (dedupMaxDistance < 0) {
+        return false;
+    }
+    
+    const FrameFingerprint fingerprint = fingerprintOf(frame);
+    dedupChecked++;
+    const int distance = fingerprint.distance(lastFingerprint);
+    if (distance > dedupMaxDistance) {
+        // 画面有变化：作为新的比较基准。只和上一入队帧比较，缓慢累积的变化最终也会触发新的分析
+        lastFingerprint = fingerprint;
+        lastQueuedFrameIndex = frame.index;
+        lastQueuedEndTimestamp = frame.timestamp;
+        return false;
+    }
+    
+    // 延长上一入队帧的时间跨度：尚未分析完成时在写入 completedAnalyses 时应用，已完成则直接更新
+    lastQueuedEndTimestamp = std::max(lastQueuedEndTimestamp, frame.timestamp);
+    for (int i = completedAnalyses.size() - 1; i >= 0; --i) {
+        if (completedAnalyses[i].frameIndex == lastQueuedFrameIndex) {
+            completedAnalyses[i].endTimestamp = lastQueuedEndTimestamp;
+            break;
+        }
+    }
+    
+    dedupSkipped++;
+    qDebug() << QString("跳过重复帧: %1 (指纹距离 %2, 去重命中 %3/%4 = %5%)")
+                .arg(frame.name())
+                .arg(distance)
+                .arg(dedupSkipped)
+                .arg(dedupChecked)
+                .arg(100.0 * dedupSkipped / dedupChecked, 0, 'f', 1);
+    return true;
+}
+
 void RealTimeAIVisionAnalyzer::processNextFrame() {
     if (!processingQueue) {
         return;
@@ -161,58 +273,51 @@ void RealTimeAIVisionAnalyzer::processNextFrame() {
         return; // 队列为空
     }
     
-    // 检查文件是否存在
-    if (!QFileInfo::exists(task.framePath)) {
-        qWarning() << "帧文件不存在:" << task.framePath;
+    if (!task.frame.isValid()) {
+        qWarning() << "帧数据为空:" << task.frame.name();
         return;
     }
     
+    const QString frameName = task.frame.name();
     qDebug() << QString("开始分析帧: %1 (时间戳: %2s)")
-                .arg(QFileInfo(task.framePath).fileName())
+                .arg(frameName)
                 .arg(task.timestamp, 0, 'f', 1);
     
-    // 进行AI分析
-    QString analysis = analyzeImageWithAI(task.framePath);
+    // 进行AI分析，之后只保留文字结果，图片数据随 task.frame 释放
+    QString analysis = analyzeImageWithAI(task.frame);
+    task.frame = EncodedFrame();
     
     if (!analysis.isEmpty()) {
         task.analysis = analysis;
         task.processed = true;
+        if (task.frameIndex == lastQueuedFrameIndex) {
+            task.endTimestamp = std::max(task.endTimestamp, lastQueuedEndTimestamp);
+        }
         
-        // 保存到已完成列表
-        completedAnalyses.append(task);
+        // 保存到已完成列表（按时间戳有序，空闲区间标记可能先于较早的帧写入）
+        int index = completedAnalyses.size();
+        while (index > 0 && completedAnalyses[index - 1].timestamp > task.timestamp) {
+            --index;
+        }
+        completedAnalyses.insert(index, task);
         
         qDebug() << QString("帧分析完成: %1 -> %2")
-                    .arg(QFileInfo(task.framePath).fileName())
+                    .arg(frameName)
                     .arg(analysis.left(50) + (analysis.length() > 50 ? "..." : ""));
         
         // 发出实时分析信号
-        emit realTimeFrameAnalyzed(task.framePath, analysis, task.timestamp);
-        
-        // 分析完成后删除临时图片文件
-        QFile tempImageFile(task.framePath);
-        if (tempImageFile.exists()) {
-            if (tempImageFile.remove()) {
-                qDebug() << QString("已删除临时图片文件: %1").arg(QFileInfo(task.framePath).fileName());
-            } else {
-                qWarning() << QString("删除临时图片文件失败: %1").arg(task.framePath);
-            }
-        }
+        emit realTimeFrameAnalyzed(frameName, analysis, task.timestamp);
     } else {
-        qWarning() << "帧分析失败:" << task.framePath;
-        
-        // 即使分析失败，也尝试删除临时文件
-        QFile tempImageFile(task.framePath);
-        if (tempImageFile.exists()) {
-            if (tempImageFile.remove()) {
-                qDebug() << QString("已删除分析失败的临时图片文件: %1").arg(QFileInfo(task.framePath).fileName());
-            } else {
-                qWarning() << QString("删除分析失败的临时图片文件失败: %1").arg(task.framePath);
-            }
+        qWarning() << "帧分析失败:" << frameName;
+        // 失败的帧不会进入 completedAnalyses，合并到它的重复帧无处记录；
+        // 它仍是去重基准时重新开始比较，下一帧即使相似也重新入队分析
+        if (task.frameIndex == lastQueuedFrameIndex) {
+            resetDedup();
         }
     }
 }
 
-QString RealTimeAIVisionAnalyzer::analyzeImageWithAI(const QString &imagePath) {
+QString RealTimeAIVisionAnalyzer::analyzeImageWithAI(const EncodedFrame &frame) {
     if (!isConfigValid()) {
         return QString();
     }
@@ -220,10 +325,11 @@ QString RealTimeAIVisionAnalyzer::analyzeImageWithAI(const QString &imagePath) {
     // 创建临时的AIVisionAnalyzer进行单张图片分析
     AIVisionAnalyzer analyzer;
     analyzer.setConfig(config);
+    analyzer.setChangeMap(changeMap);
     
     // 使用同步方式分析单张图片
-    QStringList singleImageList;
-    singleImageList << imagePath;
+    QList<EncodedFrame> singleFrameList;
+    singleFrameList << frame;
     
     QString result;
     
@@ -251,7 +357,7 @@ QString RealTimeAIVisionAnalyzer::analyzeImageWithAI(const QString &imagePath) {
     });
     
     // 启动分析
-    analyzer.analyzeImages(singleImageList);
+    analyzer.analyzeFrames(singleFrameList);
     
     // 等待分析完成（设置超时）
     int timeoutMs = 30000; // 30秒超时
@@ -264,13 +370,10 @@ QString RealTimeAIVisionAnalyzer::analyzeImageWithAI(const QString &imagePath) {
         elapsedMs += checkIntervalMs;
     }
     
+    // 超时或失败返回空字符串，由调用方按失败处理（不把错误提示当作分析结果写入总结）
     if (!analysisCompleted) {
-        qWarning() << "AI分析超时:" << imagePath;
-        return QString("分析超时");
-    }
-    
-    if (result.isEmpty()) {
-        return QString("分析失败");
+        qWarning() << "AI分析超时:" << frame.name();
+        return QString();
     }
     
     return result;
@@ -291,10 +394,21 @@ void RealTimeAIVisionAnalyzer::generateFinalSummary() {
     for (const FrameAnalysisTask &task : completedAnalyses) {
         if (task.processed && !task.analysis.isEmpty()) {
             analysisTexts << task.analysis;
-            timestamps << QString::number(task.timestamp, 'f', 1) + "s";
+            if (task.frameIndex >= 0 && task.endTimestamp > task.timestamp) {
+                // 合并了重复帧：画面在这段时间内基本不变
+                timestamps << QString("%1s - %2s").arg(task.timestamp, 0, 'f', 1).arg(task.endTimestamp, 0, 'f', 1);
+            } else {
+                timestamps << QString::number(task.timestamp, 'f', 1) + "s";
+            }
         }
     }
     
+    if (dedupChecked > 0) {
+        qDebug() << QString("重复帧去重: 检查 %1 帧，跳过 %2 帧 (命中率 %3%)")
+                    .arg(dedupChecked).arg(dedupSkipped)
+                    .arg(100.0 * dedupSkipped / dedupChecked, 0, 'f', 1);
+    }
+    
     if (analysisTexts.isEmpty()) {
         emit finalSummaryGenerated(false, "", "没有有效的分析结果");
         return;
@@ -329,8 +443,9 @@ void RealTimeAIVisionAnalyzer::generateFinalSummary() {
     qDebug() << "准备调用AI模型生成最终总结";
     
     // 使用AIVisionAnalyzer进行总结生成
+    const int skippedFrames = dedupSkipped;
     connect(summaryAnalyzer, &AIVisionAnalyzer::finalSummaryGenerated,
-            this, [this, analysisTexts, timestamps](bool success, const QString &summary, const QString &message) {
+            this, [this, analysisTexts, timestamps, skippedFrames](bool success, const QString &summary, const QString &message) {
         qDebug() << "AI总结生成完成:" << (success ? "成功" : "失败");
         qDebug() << "总结内容长度:" << summary.length();
         qDebug() << "消息:" << message;
@@ -357,8 +472,11 @@ void RealTimeAIVisionAnalyzer::generateFinalSummary() {
         }
         
         emit postRecordingProgress(100, 100);
-        emit finalSummaryGenerated(true, finalSummary, 
-                                 QString("成功分析了 %1 帧并生成总结").arg(analysisTexts.size()));
+        QString resultMessage = QString("成功分析了 %1 帧并生成总结").arg(analysisTexts.size());
+        if (skippedFrames > 0) {
+            resultMessage += QString("（跳过 %1 个重复帧）").arg(skippedFrames);
+        }
+        emit finalSummaryGenerated(true, finalSummary, resultMessage);
                                  
         // 清理总结分析器
         if (summaryAnalyzer) {
@@ -6,12 +6,15 @@
 #include <QTimer>
 #include <QMutex>
 #include <QStringList>
+#include <memory>
 #include "AISummaryConfigDialog.h"
 #include "AIVisionAnalyzer.h"
+#include "FrameFingerprint.h"
 
 /**
  * 实时AI视觉分析器 - 处理实时提取的帧图片
- * 支持队列处理，避免阻塞实时帧提取
+ * 支持队列处理，避免阻塞实时帧提取；帧以内存 JPEG 入队，分析完成后即释放图片数据
+ * 入队前用感知指纹与上一个入队帧比较，画面几乎不变时不再调用 API，只延长上一条描述的时间跨度
  */
 class RealTimeAIVisionAnalyzer : public QObject {
     Q_OBJECT
@@ -24,7 +27,7 @@ public:
     void setConfig(const AISummaryConfig &config);
     
     // 添加新帧进行分析
-    void addFrameForAnalysis(const QString &framePath, double timestamp);
+    void addFrameForAnalysis(const EncodedFrame &frame);
     
     // 开始实时分析
     void startRealTimeAnalysis();
@@ -37,10 +40,24 @@ public:
     
     // 取消所有分析
     void cancelAnalysis();
+    
+    // 暂停/恢复队列处理（用户空闲期间不调用 API，已入队的帧保留到恢复后处理）
+    void pauseAnalysis();
+    void resumeAnalysis();
+    
+    // 在时间线上记录一段用户空闲区间（秒），最终总结中按时间顺序出现
+    void markIdleGap(double startTimestamp, double endTimestamp, bool locked);
+    
+    // 重复帧判定阈值：与上一入队帧指纹的汉明距离不超过该值时跳过（共 256 位，负数关闭去重）
+    void setDedupThreshold(int maxDistance);
+    
+    // 本轮去重统计
+    int dedupCheckedCount() const;
+    int dedupSkippedCount() const;
 
 signals:
-    // 实时帧分析完成
-    void realTimeFrameAnalyzed(const QString &framePath, const QString &analysis, double timestamp);
+    // 实时帧分析完成（frameName 为帧名称，空闲区间标记为空）
+    void realTimeFrameAnalyzed(const QString &frameName, const QString &analysis, double timestamp);
     
     // 录制后处理进度（用于最终总结生成）
     void postRecordingProgress(int current, int total);
@@ -53,16 +70,23 @@ private slots:
     void processNextFrame();
 
 private:
-    QString analyzeImageWithAI(const QString &imagePath);
+    QString analyzeImageWithAI(const EncodedFrame &frame);
     void generateFinalSummary();
     bool isConfigValid() const;
     
+    // 与上一入队帧相似时把它的时间跨度延长到该帧时间并返回 true；
+    // 作为基准的帧分析失败时调用 resetDedup，之后的帧不再合并到这个没有结果的帧上
+    bool mergeIfDuplicate(const EncodedFrame &frame);
+    void resetDedup();
+    
     AISummaryConfig config;
     
     // 实时分析队列
     struct FrameAnalysisTask {
-        QString framePath;
+        EncodedFrame frame; // 待分析的图片（完成后清空以释放内存）
+        int frameIndex;
         double timestamp;
+        double endTimestamp; // 画面持续到的时间（合并了重复帧时大于 timestamp）
         QString analysis; // 分析结果（完成后填写）
         bool processed;
     };
@@ -79,6 +103,19 @@ private:
     
     // 用于最终总结生成的AI分析器
     AIVisionAnalyzer *summaryAnalyzer;
+    
+    // 每帧新建的分析器共享同一个变化图，参考帧始终是上一个分析过的帧
+    std::shared_ptr<TileChangeMap> changeMap;
+    
+    // 重复帧去重
+    int dedupMaxDistance;
+    FrameFingerprint lastFingerprint; // 上一个入队帧的指纹
+    int lastQueuedFrameIndex;
+    double lastQueuedEndTimestamp; // 上一入队帧合并重复帧后持续到的时间
+    int dedupChecked;
+    int dedupSkipped;
+    
+    static const int DEFAULT_DEDUP_DISTANCE = 12;
 };
 
 #endif // REALTIMEAIVISIONANALYZER_H
@@ -2,74 +2,67 @@
 #include <QStandardPaths>
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QDateTime>
 #include <QDebug>
-#include <QDir>
-
-const double RealTimeFrameExtractor::SHORT_INTERVAL_SECONDS = 2.0;
 
 RealTimeFrameExtractor::RealTimeFrameExtractor(QObject *parent)
     : QObject(parent)
     , extractionTimer(new QTimer(this))
-    , tempDir(nullptr)
+    , grabberSession(new ScreenGrabberSession(this))
     , extracting(false)
+    , paused(false)
     , frameCounter(0)
+    , skippedTicks(0)
     , recordingStartTime(0)
     , captureRegionSet(false)
     , regionX(0), regionY(0), regionWidth(0), regionHeight(0)
 {
-    setupTempDirectory();
-    
     // 连接定时器
     connect(extractionTimer, &QTimer::timeout, this, &RealTimeFrameExtractor::extractCurrentFrame);
+    connect(grabberSession, &ScreenGrabberSession::frameGrabbed,
+            this, &RealTimeFrameExtractor::onFrameGrabbed);
+    connect(grabberSession, &ScreenGrabberSession::grabFailed,
+            this, &RealTimeFrameExtractor::onGrabFailed);
+    grabberSession->setFrameFilter([this](const FrameData &frame, qint64 captureTimeMs) {
+        return sampleRawFrame(frame, captureTimeMs);
+    });
     
-    // 设置初始间隔为短间隔（2.0秒）
-    extractionTimer->setInterval(SHORT_INTERVAL_SECONDS * 1000);
+    extractionTimer->setInterval(qRound(sampler.config().probeIntervalSeconds * 1000));
 }
 
 RealTimeFrameExtractor::~RealTimeFrameExtractor() {
     stopExtraction();
-    if (tempDir) {
-        delete tempDir;
-    }
-}
-
-void RealTimeFrameExtractor::setupTempDirectory() {
-    if (tempDir) {
-        delete tempDir;
-    }
-    
-    tempDir = new QTemporaryDir();
-    if (!tempDir->isValid()) {
-        qWarning() << "Failed to create temporary directory for real-time frame extraction";
-    }
 }
 
-void RealTimeFrameExtractor::startExtraction(const QString &outputDir) {
+void RealTimeFrameExtractor::startExtraction() {
     if (extracting) {
         qWarning() << "Real-time frame extraction already in progress";
         return;
     }
     
-    if (!tempDir || !tempDir->isValid()) {
-        setupTempDirectory();
-        if (!tempDir || !tempDir->isValid()) {
-            emit extractionError("无法创建临时目录");
-            return;
-        }
+    // 启动常驻抓取会话，整个录制期间复用；旁路与进程内模式不需要 FFmpeg，
+    // 只有退回 ffmpeg 流模式时会话才查找 FFmpeg，找不到时在那里失败
+    if (captureRegionSet) {
+        grabberSession->setCaptureRegion(regionX, regionY, regionWidth, regionHeight);
     }
-    
-    // 检查FFmpeg是否可用
-    QString ffmpegPath = findFFmpegPath();
-    if (ffmpegPath.isEmpty()) {
-        emit extractionError("未找到FFmpeg，请确保已安装FFmpeg");
+    if (!grabberSession->start()) {
+        emit extractionError("无法启动屏幕抓取会话");
         return;
     }
     
-    outputDirectory = outputDir;
     frameCounter = 0;
+    skippedTicks = 0;
+    {
+        std::lock_guard<std::mutex> lock(samplerMutex);
+        sampler.reset();
+        extractionTimer->setInterval(qRound(sampler.config().probeIntervalSeconds * 1000));
+    }
     extracting = true;
+    paused = false;
     
-    qDebug() << "开始实时帧提取，输出目录:" << outputDir;
+    qDebug() << "开始实时帧提取" << (debugDumpDirectory.isEmpty()
+                                       ? QString("(仅内存)")
+                                       : QString("(调试转储到 %1)").arg(debugDumpDirectory));
     
     // 立即提取第一帧
     extractCurrentFrame();
@@ -84,19 +77,61 @@ void RealTimeFrameExtractor::stopExtraction() {
     }
     
     extractionTimer->stop();
+    grabberSession->stop();
     extracting = false;
+    paused = false;
     frameCounter = 0;
     
-    qDebug() << "停止实时帧提取";
+    const AdaptiveFrameSampler::Stats stats = samplerStats();
+    qDebug() << QString("停止实时帧提取: 探测 %1 帧，采样 %2 帧 (场景变化 %3, 最大间隔 %4, 语音起点 %5, 受预算限制 %6 次)")
+                .arg(stats.probes).arg(stats.samples).arg(stats.sceneChanges)
+                .arg(stats.forcedSamples).arg(stats.speechSamples).arg(stats.budgetLimited);
+}
+
+void RealTimeFrameExtractor::setDebugDumpDirectory(const QString &directory) {
+    debugDumpDirectory = directory;
 }
 
 bool RealTimeFrameExtractor::isExtracting() const {
     return extracting;
 }
 
+void RealTimeFrameExtractor::pauseExtraction() {
+    if (!extracting || paused) {
+        return;
+    }
+    paused = true;
+    extractionTimer->stop();
+    qDebug() << "暂停实时帧提取";
+}
+
+void RealTimeFrameExtractor::resumeExtraction() {
+    if (!extracting || !paused) {
+        return;
+    }
+    paused = false;
+    qDebug() << "恢复实时帧提取";
+    extractCurrentFrame();
+    extractionTimer->start();
+}
+
+bool RealTimeFrameExtractor::isPaused() const {
+    return paused;
+}
+
 void RealTimeFrameExtractor::setRecordingStartTime(qint64 startTime) {
     recordingStartTime = startTime;
-    updateExtractionInterval();
+}
+
+void RealTimeFrameExtractor::setSamplerConfig(const AdaptiveFrameSampler::Config &config) {
+    std::lock_guard<std::mutex> lock(samplerMutex);
+    sampler.setConfig(config);
+    extractionTimer->setInterval(qRound(config.probeIntervalSeconds * 1000));
+}
+
+AdaptiveFrameSampler::Stats RealTimeFrameExtractor::samplerStats() const {
+    std::lock_guard<std::mutex> lock(samplerMutex);
+    return sampler.stats();
 }
 
 void RealTimeFrameExtractor::setCaptureRegion(int x, int y, int width, int height) {
@@ -110,178 +145,96 @@ void RealTimeFrameExtractor::setCaptureRegion(int x, int y, int width, int heigh
                 .arg(x).arg(y).arg(width).arg(height);
 }
 
+bool RealTimeFrameExtractor::setFrameTapSource(SimpleCapture *capture) {
+    bool supported = grabberSession->setFrameTapSource(capture);
+    if (capture && !supported) {
+        qDebug() << "录制器不支持帧旁路，实时帧提取将单独抓屏";
+    }
+    return supported;
+}
+
+void RealTimeFrameExtractor::notifySpeechOnset() {
+    QMetaObject::invokeMethod(this, [this]() {
+        handleSpeechOnset();
+    }, Qt::QueuedConnection);
+}
+
+void RealTimeFrameExtractor::handleSpeechOnset() {
+    if (!extracting || paused) {
+        return;
+    }
+    const double timestamp = (QDateTime::currentMSecsSinceEpoch() - recordingStartTime) / 1000.0;
+    {
+        std::lock_guard<std::mutex> lock(samplerMutex);
+        sampler.markSpeechOnset(timestamp);
+    }
+    qDebug() << QString("检测到语音起点 (%1s)，立即补取一帧").arg(timestamp, 0, 'f', 1);
+    extractCurrentFrame();
+}
+
 void RealTimeFrameExtractor::extractCurrentFrame() {
-    if (!extracting) {
+    if (!extracting || paused) {
         return;
     }
     
-    // 更新提取间隔（根据录制时长智能调整）
-    updateExtractionInterval();
-    
-    QString ffmpegPath = findFFmpegPath();
-    if (ffmpegPath.isEmpty()) {
-        emit extractionError("FFmpeg不可用");
+    // 同一时刻最多只有一个取样在进行，定时器超前时直接跳过本次
+    if (!grabberSession->requestFrame()) {
+        skippedTicks++;
+        qDebug() << QString("上一帧仍在抓取，跳过本次取样 (累计跳过 %1 次)").arg(skippedTicks);
+    }
+}
+
+void RealTimeFrameExtractor::onFrameGrabbed(const QByteArray &jpegData, qint64 captureTimeMs, int latencyMs) {
+    if (!extracting) {
         return;
     }
     
-    frameCounter++;
-    double currentTimestamp = (QDateTime::currentMSecsSinceEpoch() - recordingStartTime) / 1000.0;
-    
-    // 生成输出文件名
-    QString frameName = QString("realtime_frame_%1_%2.jpg")
-                       .arg(frameCounter, 4, 10, QChar('0'))
-                       .arg(qint64(currentTimestamp * 1000));
-    QString outputPath = outputDirectory + "/" + frameName;
-    
-    // 创建FFmpeg进程进行屏幕截图
-    QProcess *ffmpegProcess = new QProcess(this);
-    
-    // 连接完成信号
-    connect(ffmpegProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            [this, ffmpegProcess, outputPath, currentTimestamp](int exitCode, QProcess::ExitStatus exitStatus) {
-        ffmpegProcess->deleteLater();
-        
-        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-            if (QFileInfo::exists(outputPath)) {
-                qDebug() << QString("实时提取帧成功: %1 (时间戳: %2s)").arg(outputPath).arg(currentTimestamp, 0, 'f', 1);
-                emit frameExtracted(outputPath, currentTimestamp);
-            } else {
-                qWarning() << "FFmpeg执行成功但文件未生成:" << outputPath;
-            }
-        } else {
-            QString errorOutput = ffmpegProcess->readAllStandardError();
-            qWarning() << "实时帧提取失败:" << errorOutput;
-            // 注意：实时提取失败不应停止整个过程，只记录警告
-        }
-    });
-    
-    connect(ffmpegProcess, &QProcess::errorOccurred,
-            [this, ffmpegProcess](QProcess::ProcessError error) {
-        ffmpegProcess->deleteLater();
-        qWarning() << "FFmpeg进程错误:" << error;
-        // 实时提取的单个失败不应停止整个流程
-    });
-    
-    // 构建FFmpeg命令 - 截取当前屏幕
-    QStringList arguments;
-    
-#ifdef Q_OS_WIN
-    // Windows: 使用gdigrab捕获桌面
-    arguments << "-f" << "gdigrab";
-    
-    if (captureRegionSet) {
-        // 使用指定的区域
-        arguments << "-offset_x" << QString::number(regionX)
-                 << "-offset_y" << QString::number(regionY)
-                 << "-video_size" << QString::number(regionWidth) + "x" + QString::number(regionHeight);
+    // jpegData 与抓取会话共享同一份数据，不复制也不落盘
+    EncodedFrame frame;
+    frame.jpegData = jpegData;
+    frame.index = frameCounter + 1;
+    frame.timestamp = (captureTimeMs - recordingStartTime) / 1000.0;
+    
+    // 只有画面变化（或到达最大间隔）的帧才交给分析器
+    AdaptiveFrameSampler::Decision decision;
+    if (grabberSession->appliesFrameFilter()) {
+        // 抓取线程已用原始帧判断过，未选中的帧不会编码、也不会到这里
+        std::lock_guard<std::mutex> lock(samplerMutex);
+        decision = rawDecision;
+    } else {
+        // 流模式：探测帧按 1/8 尺寸解码后交给采样器
+        const QImage preview = frame.decodePreview(8);
+        std::lock_guard<std::mutex> lock(samplerMutex);
+        decision = sampler.offer(EncodedFrame::frameView(preview), frame.timestamp);
     }
-    
-    arguments << "-i" << "desktop"
-             << "-vframes" << "1"  // 只捕获一帧
-             << "-q:v" << "2"      // 高质量JPEG
-             << "-y"               // 覆盖已存在文件
-             << outputPath;
-#elif defined(Q_OS_MACOS)
-    // macOS: 使用avfoundation捕获屏幕
-    arguments << "-f" << "avfoundation"
-             << "-i" << "1";        // 屏幕输入
-    
-    if (captureRegionSet) {
-        // macOS上使用filter来裁剪区域
-        QString cropFilter = QString("crop=%1:%2:%3:%4")
-                           .arg(regionWidth).arg(regionHeight).arg(regionX).arg(regionY);
-        arguments << "-vf" << cropFilter;
+    if (!decision.sample) {
+        return;
     }
+    frameCounter++;
     
-    arguments << "-vframes" << "1"  // 只捕获一帧  
-             << "-q:v" << "2"      // 高质量JPEG
-             << "-y"               // 覆盖已存在文件
-             << outputPath;
-#else
-    // Linux: 使用x11grab捕获屏幕
-    if (captureRegionSet) {
-        arguments << "-f" << "x11grab"
-                 << "-video_size" << QString::number(regionWidth) + "x" + QString::number(regionHeight)
-                 << "-i" << QString(":0.0+%1,%2").arg(regionX).arg(regionY)
-                 << "-vframes" << "1"  // 只捕获一帧
-                 << "-q:v" << "2"      // 高质量JPEG  
-                 << "-y"               // 覆盖已存在文件
-                 << outputPath;
-    } else {
-        arguments << "-f" << "x11grab"
-                 << "-i" << ":0.0"     // 显示器
-                 << "-vframes" << "1"  // 只捕获一帧
-                 << "-q:v" << "2"      // 高质量JPEG  
-                 << "-y"               // 覆盖已存在文件
-                 << outputPath;
+    if (!debugDumpDirectory.isEmpty()) {
+        frame.dumpTo(debugDumpDirectory, "realtime_frame");
     }
-#endif
     
-    // 启动FFmpeg进程
-    ffmpegProcess->start(ffmpegPath, arguments);
+    qDebug() << QString("实时提取帧成功: %1 (%2KB, 抓取耗时: %3ms, 采样原因: %4, 变化 %5%)")
+                .arg(frame.name()).arg(jpegData.size() / 1024).arg(latencyMs)
+                .arg(AdaptiveFrameSampler::reasonName(decision.reason))
+                .arg(decision.change * 100.0, 0, 'f', 1);
+    emit frameExtracted(frame);
 }
 
-void RealTimeFrameExtractor::updateExtractionInterval() {
-    if (recordingStartTime == 0) {
-        return; // 还未设置录制开始时间
-    }
-    
-    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    qint64 recordingDuration = currentTime - recordingStartTime;
-    double recordingSeconds = recordingDuration / 1000.0;
-    
-    // 智能间隔调整逻辑
-    if (recordingSeconds >= INTERVAL_SWITCH_THRESHOLD) {
-        // 录制超过10秒，使用长间隔（10秒）
-        int newInterval = LONG_INTERVAL_SECONDS * 1000;
-        if (extractionTimer->interval() != newInterval) {
-            extractionTimer->setInterval(newInterval);
-            qDebug() << QString("切换到长间隔模式: %1秒 (录制时长: %2秒)")
-                        .arg(LONG_INTERVAL_SECONDS)
-                        .arg(recordingSeconds, 0, 'f', 1);
-        }
-    } else {
-        // 录制不足10秒，使用短间隔（2.0秒）
-        int newInterval = SHORT_INTERVAL_SECONDS * 1000;
-        if (extractionTimer->interval() != newInterval) {
-            extractionTimer->setInterval(newInterval);
-            qDebug() << QString("使用短间隔模式: %1秒 (录制时长: %2秒)")
-                        .arg(SHORT_INTERVAL_SECONDS)
-                        .arg(recordingSeconds, 0, 'f', 1);
-        }
-    }
+bool RealTimeFrameExtractor::sampleRawFrame(const FrameData &frame, qint64 captureTimeMs) {
+    // 抓取线程调用：采样器直接从原始帧生成代理图，省去未选中帧的 JPEG 编码与解码
+    const double timestamp = (captureTimeMs - recordingStartTime) / 1000.0;
+    std::lock_guard<std::mutex> lock(samplerMutex);
+    rawDecision = sampler.offer(frame, timestamp);
+    return rawDecision.sample;
 }
 
-QString RealTimeFrameExtractor::findFFmpegPath() const {
-    // 查找FFmpeg可执行文件路径
-    QStringList possiblePaths;
-    
-#ifdef Q_OS_WIN
-    possiblePaths << "ffmpeg.exe"
-                  << "C:/ffmpeg/bin/ffmpeg.exe"
-                  << QCoreApplication::applicationDirPath() + "/ffmpeg.exe"
-                  << QCoreApplication::applicationDirPath() + "/bin/ffmpeg.exe";
-#else
-    possiblePaths << "ffmpeg"
-                  << "/usr/bin/ffmpeg"
-                  << "/usr/local/bin/ffmpeg"
-                  << "/opt/homebrew/bin/ffmpeg"
-                  << QCoreApplication::applicationDirPath() + "/ffmpeg";
-#endif
-    
-    for (const QString &path : possiblePaths) {
-        QFileInfo fileInfo(path);
-        if (fileInfo.exists() && fileInfo.isExecutable()) {
-            return path;
-        }
-        
-        // 尝试在PATH中查找
-        QProcess process;
-        process.start(path, QStringList() << "-version");
-        if (process.waitForFinished(3000) && process.exitCode() == 0) {
-            return path;
-        }
+void RealTimeFrameExtractor::onGrabFailed(const QString &error) {
+    // 单次抓取失败不停止整个流程，只记录警告；会话本身退出时上报错误
+    qWarning() << "实时帧抓取失败:" << error;
+    if (extracting && !grabberSession->isRunning()) {
+        emit extractionError(error);
     }
-    
-    return QString();
 }
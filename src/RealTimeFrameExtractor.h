@@ -3,14 +3,22 @@
 
 #include <QObject>
 #include <QTimer>
-#include <QTemporaryDir>
-#include <QProcess>
 #include <QDateTime>
 #include <QString>
+#include <QByteArray>
+#include <mutex>
+#include "ScreenGrabberSession.h"
+#include "EncodedFrame.h"
+#include "AdaptiveFrameSampler.h"
 
 /**
- * 实时帧提取器 - 在录制过程中定期提取当前屏幕帧
- * 支持智能间隔调整：录制时长>=10s时使用10s间隔，否则使用0.5s间隔
+ * 实时帧提取器 - 在录制过程中按探测间隔抓取屏幕帧，由 AdaptiveFrameSampler 按画面变化决定是否交给分析器
+ * 画面频繁变化时在最小间隔与帧预算内密集采样，画面静止时退到最大间隔
+ * 语音起点（notifySpeechOnset）会立即补一次探测并作为额外的采样触发，讲解时刻无需等到下一个探测周期
+ * 取样通过常驻的 ScreenGrabberSession 完成，上一次取样未完成时本次定时跳过
+ * 进程内 X11 与录制帧旁路模式在抓取线程上直接用原始帧做采样判断，只有选中的帧才编码 JPEG；
+ * ffmpeg 流模式只能拿到 JPEG，按 1/8 尺寸解码后再判断
+ * 提取的帧以内存 JPEG 交给分析器，只有设置了调试转储目录时才写文件
  */
 class RealTimeFrameExtractor : public QObject {
     Q_OBJECT
@@ -20,7 +28,10 @@ public:
     ~RealTimeFrameExtractor();
     
     // 开始实时帧提取
-    void startExtraction(const QString &outputDir);
+    void startExtraction();
+    
+    // 调试用：把每个取样帧额外写入该目录（空字符串关闭，默认关闭）
+    void setDebugDumpDirectory(const QString &directory);
     
     // 停止实时帧提取
     void stopExtraction();
@@ -28,15 +39,30 @@ public:
     // 是否正在提取
     bool isExtracting() const;
     
-    // 设置录制开始时间（用于计算智能间隔）
+    // 暂停/恢复定时取样（用户空闲期间不取样），恢复时立即补取一帧
+    void pauseExtraction();
+    void resumeExtraction();
+    bool isPaused() const;
+    
+    // 设置录制开始时间（帧时间戳的零点）
     void setRecordingStartTime(qint64 startTime);
     
+    // 采样参数（探测间隔、最小/最大间隔、变化阈值、帧预算），需在开始提取前设置
+    void setSamplerConfig(const AdaptiveFrameSampler::Config &config);
+    AdaptiveFrameSampler::Stats samplerStats() const;
+    
     // 设置捕获区域（与录制时保持一致）
     void setCaptureRegion(int x, int y, int width, int height);
+    
+    // 使用录制器的帧旁路取样（需在录制开始前设置，传 nullptr 恢复独立抓屏）
+    bool setFrameTapSource(SimpleCapture *capture);
+    
+    // 语音检测到起点（可在音频线程调用，实际处理排队到本对象所在线程）
+    void notifySpeechOnset();
 
 signals:
-    // 新帧已提取 - 发送帧文件路径和时间戳
-    void frameExtracted(const QString &framePath, double timestamp);
+    // 新帧已提取 - 内存中的 JPEG 与时间戳
+    void frameExtracted(const EncodedFrame &frame);
     
     // 提取错误
     void extractionError(const QString &error);
@@ -44,27 +70,35 @@ signals:
 private slots:
     // 定时提取当前帧
     void extractCurrentFrame();
+    
+    // 抓取会话返回一帧
+    void onFrameGrabbed(const QByteArray &jpegData, qint64 captureTimeMs, int latencyMs);
+    
+    // 抓取会话出错
+    void onGrabFailed(const QString &error);
+    
+    // 标记语音起点并立即补一次探测
+    void handleSpeechOnset();
 
 private:
-    void setupTempDirectory();
-    QString findFFmpegPath() const;
-    void updateExtractionInterval();
-    
+    // 抓取线程上用原始帧做采样判断，结果留给 onFrameGrabbed
+    bool sampleRawFrame(const FrameData &frame, qint64 captureTimeMs);
+
     QTimer *extractionTimer;
-    QTemporaryDir *tempDir;
-    QString outputDirectory;
+    ScreenGrabberSession *grabberSession;
+    QString debugDumpDirectory;
     bool extracting;
+    bool paused;
     int frameCounter;
+    int skippedTicks; // 因上一帧仍在抓取而跳过的定时次数
+    AdaptiveFrameSampler sampler;
+    AdaptiveFrameSampler::Decision rawDecision; // 最近一次原始帧采样判断的结果
+    mutable std::mutex samplerMutex;            // 保护 sampler 与 rawDecision（原始帧判断在抓取线程上进行）
     qint64 recordingStartTime;
     
     // 捕获区域设置
     bool captureRegionSet;
     int regionX, regionY, regionWidth, regionHeight;
-    
-    // 智能间隔参数
-    static const int LONG_INTERVAL_SECONDS = 10;  // 长间隔：10秒
-    static const double SHORT_INTERVAL_SECONDS;   // 短间隔：0.5秒
-    static const int INTERVAL_SWITCH_THRESHOLD = 10; // 10秒阈值
 };
 
 #endif // REALTIMEFRAMEEXTRACTOR_H
@@ -4,12 +4,18 @@
 #include <QDir>
 #include <QDateTime>
 
+#ifdef PLATFORM_LINUX
+#include "LinuxAudioCapture.h"
+#endif
+
 RealTimeVideoSummaryManager::RealTimeVideoSummaryManager(QObject *parent)
     : QObject(parent)
     , frameExtractor(std::make_unique<RealTimeFrameExtractor>(this))
     , visionAnalyzer(std::make_unique<RealTimeAIVisionAnalyzer>(this))
     , realTimeAnalyzing(false)
     , realTimeFrameCount(0)
+    , recordingStartMs(0)
+    , idleLocked(false)
 {
     // 连接帧提取器信号
     connect(frameExtractor.get(), &RealTimeFrameExtractor::frameExtracted,
@@ -41,6 +47,14 @@ void RealTimeVideoSummaryManager::setCaptureRegion(int x, int y, int width, int
                 .arg(x).arg(y).arg(width).arg(height);
 }
 
+void RealTimeVideoSummaryManager::setRecordingTapSource(SimpleCapture *capture) {
+    frameExtractor->setFrameTapSource(capture);
+}
+
+void RealTimeVideoSummaryManager::setFrameDumpDirectory(const QString &directory) {
+    frameExtractor->setDebugDumpDirectory(directory);
+}
+
 void RealTimeVideoSummaryManager::startRecording(const QString &videoPath) {
     if (realTimeAnalyzing) {
         qWarning() << "实时视频分析已在进行中";
@@ -53,12 +67,7 @@ void RealTimeVideoSummaryManager::startRecording(const QString &videoPath) {
         return;
     }
     
-    // 从视频路径获取目录
-    QFileInfo videoInfo(videoPath);
-    currentVideoDirectory = videoInfo.absolutePath();
-    
     qDebug() << "开始实时视频总结分析:" << videoPath;
-    qDebug() << "帧保存目录:" << currentVideoDirectory;
     
     realTimeAnalyzing = true;
     realTimeFrameCount = 0;
@@ -66,10 +75,13 @@ void RealTimeVideoSummaryManager::startRecording(const QString &videoPath) {
     updateProgress("启动实时分析...", 5);
     
     // 设置录制开始时间
-    frameExtractor->setRecordingStartTime(QDateTime::currentMSecsSinceEpoch());
+    recordingStartMs = QDateTime::currentMSecsSinceEpoch();
+    frameExtractor->setRecordingStartTime(recordingStartMs);
     
     // 启动实时帧提取
-    frameExtractor->startExtraction(currentVideoDirectory);
+    frameExtractor->startExtraction();
+    
+    startSpeechMonitor();
     
     // 启动实时AI分析
     visionAnalyzer->startRealTimeAnalysis();
@@ -89,6 +101,7 @@ void RealTimeVideoSummaryManager::stopRecording() {
     updateProgress("停止实时分析，开始生成总结...", 80);
     
     // 停止帧提取
+    stopSpeechMonitor();
     frameExtractor->stopExtraction();
     
     // 停止AI分析并生成最终总结
@@ -113,6 +126,7 @@ void RealTimeVideoSummaryManager::cancelAnalysis() {
     realTimeAnalyzing = false;
     realTimeFrameCount = 0;
     
+    stopSpeechMonitor();
     frameExtractor->stopExtraction();
     visionAnalyzer->cancelAnalysis();
     
@@ -120,7 +134,60 @@ void RealTimeVideoSummaryManager::cancelAnalysis() {
     emit summaryCompleted(false, "", "用户取消了实时视频分析");
 }
 
-void RealTimeVideoSummaryManager::onFrameExtracted(const QString &framePath, double timestamp) {
+void RealTimeVideoSummaryManager::setUserIdle(bool idle, qint64 idleSinceMs, qint64 nowMs, bool locked) {
+    if (!realTimeAnalyzing) {
+        return;
+    }
+    
+    if (idle) {
+        idleLocked = locked;
+        frameExtractor->pauseExtraction();
+        visionAnalyzer->pauseAnalysis();
+        updateProgress(locked ? "已锁屏，暂停实时分析" : "用户空闲，暂停实时分析", -1);
+        return;
+    }
+    
+    frameExtractor->resumeExtraction();
+    visionAnalyzer->resumeAnalysis();
+    const double startTimestamp = qMax<qint64>(0, idleSinceMs - recordingStartMs) / 1000.0;
+    const double endTimestamp = qMax<qint64>(0, nowMs - recordingStartMs) / 1000.0;
+    visionAnalyzer->markIdleGap(startTimestamp, endTimestamp, idleLocked);
+    updateProgress("用户恢复活动，继续实时分析", -1);
+}
+
+void RealTimeVideoSummaryManager::closeIdleGap(qint64 idleSinceMs, qint64 endMs) {
+    if (!realTimeAnalyzing) {
+        return;
+    }
+    
+    const double startTimestamp = qMax<qint64>(0, idleSinceMs - recordingStartMs) / 1000.0;
+    const double endTimestamp = qMax<qint64>(0, endMs - recordingStartMs) / 1000.0;
+    visionAnalyzer->markIdleGap(startTimestamp, endTimestamp, idleLocked);
+}
+
+void RealTimeVideoSummaryManager::notifySpeechOnset() {
+    // 提取器在自己的线程上检查是否正在提取，这里不读取分析状态
+    frameExtractor->notifySpeechOnset();
+}
+
+void RealTimeVideoSummaryManager::startSpeechMonitor() {
+#ifdef PLATFORM_LINUX
+    speechMonitor = std::make_unique<SpeechOnsetMonitor>(std::make_unique<LinuxAudioCapture>());
+    if (!speechMonitor->start([this](double) { notifySpeechOnset(); })) {
+        qDebug() << "无法打开录音设备，语音起点不作为取样触发";
+        speechMonitor.reset();
+    }
+#endif
+}
+
+void RealTimeVideoSummaryManager::stopSpeechMonitor() {
+    if (speechMonitor) {
+        speechMonitor->stop();
+        speechMonitor.reset();
+    }
+}
+
+void RealTimeVideoSummaryManager::onFrameExtracted(const EncodedFrame &frame) {
     if (!realTimeAnalyzing) {
         return;
     }
@@ -129,11 +196,11 @@ void RealTimeVideoSummaryManager::onFrameExtracted(const QString &framePath, dou
     
     qDebug() << QString("提取到第 %1 帧: %2 (时间戳: %3s)")
                 .arg(realTimeFrameCount)
-                .arg(QFileInfo(framePath).fileName())
-                .arg(timestamp, 0, 'f', 1);
+                .arg(frame.name())
+                .arg(frame.timestamp, 0, 'f', 1);
     
     // 将帧添加到AI分析队列
-    visionAnalyzer->addFrameForAnalysis(framePath, timestamp);
+    visionAnalyzer->addFrameForAnalysis(frame);
     
     // 更新状态 - 实时分析阶段，不显示具体进度
     QString progressText = QString("正在分析屏幕内容...");
@@ -148,7 +215,7 @@ void RealTimeVideoSummaryManager::onFrameExtractionError(const QString &error) {
     updateProgress("帧提取遇到问题，继续分析...", -1); // -1表示不改变进度
 }
 
-void RealTimeVideoSummaryManager::onRealTimeFrameAnalyzed(const QString &framePath, const QString &analysis, double timestamp) {
+void RealTimeVideoSummaryManager::onRealTimeFrameAnalyzed(const QString &frameName, const QString &analysis, double timestamp) {
     if (!realTimeAnalyzing) {
         return;
     }
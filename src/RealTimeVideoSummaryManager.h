@@ -6,10 +6,12 @@
 #include "RealTimeFrameExtractor.h"
 #include "RealTimeAIVisionAnalyzer.h"
 #include "AISummaryConfigDialog.h"
+#include "SpeechOnsetMonitor.h"
 
 /**
  * 实时视频总结管理器 - 管理录制期间的实时帧提取和AI分析
  * 协调RealTimeFrameExtractor和RealTimeAIVisionAnalyzer的工作
+ * Linux 下录制期间同时监听麦克风，检测到语音起点时额外取样（音频只用于检测，不保存）
  */
 class RealTimeVideoSummaryManager : public QObject {
     Q_OBJECT
@@ -24,6 +26,12 @@ public:
     // 设置捕获区域（与录制保持一致）
     void setCaptureRegion(int x, int y, int width, int height);
     
+    // 设置录制器帧旁路：实时取样直接复用录制画面（需在录制器 startCapture 前调用）
+    void setRecordingTapSource(SimpleCapture *capture);
+    
+    // 调试用：把实时取样帧另存到该目录（默认不写文件）
+    void setFrameDumpDirectory(const QString &directory);
+    
     // 开始录制时调用 - 启动实时分析
     void startRecording(const QString &videoPath);
     
@@ -35,6 +43,15 @@ public:
     
     // 取消所有分析
     void cancelAnalysis();
+    
+    // 用户空闲/恢复：空闲时暂停取样与分析，恢复时继续并在时间线上记录空闲区间（毫秒时间戳）
+    void setUserIdle(bool idle, qint64 idleSinceMs, qint64 nowMs, bool locked = false);
+    
+    // 录制在空闲期间结束：记录空闲区间但保持暂停，由随后的 stopRecording/cancelAnalysis 收尾
+    void closeIdleGap(qint64 idleSinceMs, qint64 endMs);
+    
+    // 音频语音检测到起点时调用（可在音频线程调用），作为额外的取样触发
+    void notifySpeechOnset();
 
 signals:
     // 实时帧分析完成
@@ -48,13 +65,13 @@ signals:
 
 private slots:
     // 帧提取完成
-    void onFrameExtracted(const QString &framePath, double timestamp);
+    void onFrameExtracted(const EncodedFrame &frame);
     
     // 帧提取错误
     void onFrameExtractionError(const QString &error);
     
     // 实时帧分析完成
-    void onRealTimeFrameAnalyzed(const QString &framePath, const QString &analysis, double timestamp);
+    void onRealTimeFrameAnalyzed(const QString &frameName, const QString &analysis, double timestamp);
     
     // 录制后处理进度
     void onPostRecordingProgress(int current, int total);
@@ -65,13 +82,20 @@ private slots:
 private:
     void updateProgress(const QString &status, int percentage);
     
+    // 启动/停止麦克风语音起点监听（仅 Linux；设备不可用时静默跳过）
+    void startSpeechMonitor();
+    void stopSpeechMonitor();
+    
     std::unique_ptr<RealTimeFrameExtractor> frameExtractor;
     std::unique_ptr<RealTimeAIVisionAnalyzer> visionAnalyzer;
+    // 声明在提取器之后：析构时先停监听线程，回调不会落到已销毁的提取器上
+    std::unique_ptr<SpeechOnsetMonitor> speechMonitor;
     
     AISummaryConfig config;
-    QString currentVideoDirectory; // 当前录制视频的目录
     bool realTimeAnalyzing;
     int realTimeFrameCount; // 实时分析的帧数计数
+    qint64 recordingStartMs; // 录制开始时间，用于把空闲区间换算为视频时间
+    bool idleLocked; // 当前空闲是否由锁屏触发
 };
 
 #endif // REALTIMEVIDEOSUMMARYMANAGER_H
@@ -0,0 +1,463 @@
+#include "ScreenGrabberSession.h"
+#include "FFmpegLocator.h"
+#include "FramePacer.h"
+#include "FrameScaler.h"
+#include "SimpleCapture.h"
+#include <QBuffer>
+#include <QDateTime>
+#include <QDebug>
+#include <QImage>
+#include <QTimer>
+
+#ifdef PLATFORM_LINUX
+#include "X11ShmCapture.h"
+#endif
+
+namespace {
+
+// 流缓冲上限：超过时说明数据无法解析，丢弃重新同步
+const int MAX_STREAM_BUFFER = 32 * 1024 * 1024;
+
+// 请求超过该时长仍未完成（如录制器已停止送帧）视为丢失，允许重新请求
+const qint64 REQUEST_TIMEOUT_MS = 5000;
+
+// 进程内模式的 JPEG 质量（接近 ffmpeg -q:v 2）
+const int JPEG_QUALITY = 90;
+
+// 送给 AI 的取样帧上限；4K/HiDPI 画面先面积平均缩小，减少编码耗时和上传体积
+const int MAX_SAMPLE_WIDTH = 1920;
+const int MAX_SAMPLE_HEIGHT = 1080;
+
+// BGRA32 帧编码为 JPEG（BGRA 小端内存布局即 QImage::Format_RGB32）
+QByteArray encodeFrameJpeg(const FrameData &source) {
+    QByteArray jpegData;
+    if (!source.data || source.format != PixelFormat::BGRA32) {
+        return jpegData;
+    }
+    const FrameData frame = FrameScaler::fitWithin(source, MAX_SAMPLE_WIDTH, MAX_SAMPLE_HEIGHT, ScaleFilter::Box);
+    if (!frame.data) {
+        return jpegData;
+    }
+    const int stride = frame.stride > 0 ? frame.stride : frame.width * 4;
+    QImage image(frame.data, frame.width, frame.height, stride, QImage::Format_RGB32);
+    QBuffer buffer(&jpegData);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "JPEG", JPEG_QUALITY)) {
+        jpegData.clear();
+    }
+    return jpegData;
+}
+
+} // namespace
+
+ScreenGrabberSession::ScreenGrabberSession(QObject *parent)
+    : QObject(parent)
+    , captureRegionSet(false)
+    , regionX(0), regionY(0), regionWidth(0), regionHeight(0)
+    , streamFrameRate(2)
+    , running(false)
+    , busy(false)
+    , requestStartMs(0)
+    , streamProcess(nullptr)
+    , latestCaptureMs(0)
+    , stopping(false)
+    , workerRequest(false)
+    , workerRunning(false)
+    , tapSource(nullptr)
+    , tapAvailable(false)
+    , tapMode(false)
+    , pendingTapCaptureMs(0)
+    , tapFrameReady(false)
+{
+}
+
+ScreenGrabberSession::~ScreenGrabberSession() {
+    setFrameTapSource(nullptr);
+    stop();
+}
+
+bool ScreenGrabberSession::setFrameTapSource(SimpleCapture *capture) {
+    if (tapSource && tapSource != capture) {
+        tapSource->setFrameTap(nullptr);
+    }
+    tapSource = capture;
+    tapAvailable = false;
+    if (tapSource) {
+        tapAvailable = tapSource->setFrameTap([this](const FrameData &frame) {
+            onTapFrame(frame);
+        });
+        if (!tapAvailable) {
+            tapSource = nullptr;
+        }
+    }
+    return tapAvailable;
+}
+
+void ScreenGrabberSession::setCaptureRegion(int x, int y, int width, int height) {
+    regionX = x;
+    regionY = y;
+    regionWidth = width;
+    regionHeight = height;
+    captureRegionSet = true;
+}
+
+void ScreenGrabberSession::setFrameFilter(FrameFilter filter) {
+    frameFilter = std::move(filter);
+}
+
+bool ScreenGrabberSession::appliesFrameFilter() const {
+    return workerRunning && static_cast<bool>(frameFilter);
+}
+
+void ScreenGrabberSession::setStreamFrameRate(int fps) {
+    streamFrameRate = qMax(1, fps);
+}
+
+bool ScreenGrabberSession::start(const QString &ffmpegPath) {
+    if (running) {
+        return true;
+    }
+    busy = false;
+    latestJpeg.clear();
+    streamBuffer.clear();
+
+    if (tapAvailable) {
+        // 旁路模式：后台线程只负责把录制帧编码为 JPEG
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            tapMode = true;
+            tapFrameReady = false;
+            workerRequest = false;
+            workerRunning = true;
+        }
+        worker = std::thread(&ScreenGrabberSession::workerLoop, this);
+        running = true;
+        qDebug() << "屏幕抓取会话已启动（录制帧旁路）";
+        return true;
+    }
+    if (startInProcess()) {
+        running = true;
+        qDebug() << "屏幕抓取会话已启动（进程内 X11 SHM）";
+        return true;
+    }
+    if (startStream(ffmpegPath)) {
+        running = true;
+        qDebug() << "屏幕抓取会话已启动（常驻 ffmpeg MJPEG 流）";
+        return true;
+    }
+    return false;
+}
+
+void ScreenGrabberSession::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    busy = false;
+
+    if (workerRunning) {
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            workerRunning = false;
+            tapMode = false;
+            tapFrameReady = false;
+            pendingTapFrame = FrameData();
+        }
+        workerCondition.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+#ifdef PLATFORM_LINUX
+    shmCapture.reset();
+#endif
+
+    if (streamProcess) {
+        stopping = true;
+        streamProcess->disconnect(this);
+        if (streamProcess->state() != QProcess::NotRunning) {
+            streamProcess->write("q");
+            streamProcess->closeWriteChannel();
+            if (!streamProcess->waitForFinished(2000)) {
+                streamProcess->kill();
+                streamProcess->waitForFinished(1000);
+            }
+        }
+        streamProcess->deleteLater();
+        streamProcess = nullptr;
+        stopping = false;
+    }
+    streamBuffer.clear();
+    latestJpeg.clear();
+    qDebug() << "屏幕抓取会话已停止";
+}
+
+bool ScreenGrabberSession::isRunning() const {
+    return running;
+}
+
+bool ScreenGrabberSession::isBusy() const {
+    return busy;
+}
+
+bool ScreenGrabberSession::requestFrame() {
+    if (busy && QDateTime::currentMSecsSinceEpoch() - requestStartMs > REQUEST_TIMEOUT_MS) {
+        qWarning() << "上一次取样超时未完成，重新请求";
+        busy = false;
+    }
+    if (!running || busy) {
+        return false;
+    }
+    busy = true;
+    requestStartMs = QDateTime::currentMSecsSinceEpoch();
+
+    if (tapMode) {
+        // 回调可能同步触发（录制器已缓存最新帧），因此放在状态设置之后
+        tapSource->requestTapFrame();
+        return true;
+    }
+    if (workerRunning) {
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            workerRequest = true;
+        }
+        workerCondition.notify_one();
+        return true;
+    }
+
+    // 流模式：已有最新帧时异步交付（保持与进程内模式相同的信号时序），否则等待下一帧到达
+    if (!latestJpeg.isEmpty()) {
+        QTimer::singleShot(0, this, &ScreenGrabberSession::deliverLatestStreamFrame);
+    }
+    return true;
+}
+
+bool ScreenGrabberSession::startInProcess() {
+#ifdef PLATFORM_LINUX
+    shmCapture = std::make_unique<X11ShmCapture>();
+    if (captureRegionSet) {
+        shmCapture->setCaptureRegion(regionX, regionY, regionWidth, regionHeight);
+    }
+    if (!shmCapture->init()) {
+        shmCapture.reset();
+        qWarning() << "进程内 X11 抓屏不可用，改用 ffmpeg 流";
+        return false;
+    }
+    workerRequest = false;
+    workerRunning = true;
+    worker = std::thread(&ScreenGrabberSession::workerLoop, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ScreenGrabberSession::onTapFrame(const FrameData &frame) {
+    // 录制器线程调用：只拷贝帧并唤醒后台线程，不在录制线程上编码
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        if (!workerRunning || !tapMode) {
+            return;
+        }
+        pendingTapFrame = frame;
+        // 按帧自带的抓屏时刻换算为墙钟时间，不用交付时刻（旁路帧可能已滞后）
+        pendingTapCaptureMs = QDateTime::currentMSecsSinceEpoch();
+        const uint64_t nowMicros = FramePacer::nowMicros();
+        if (frame.timestamp > 0 && frame.timestamp <= nowMicros) {
+            pendingTapCaptureMs -= static_cast<qint64>((nowMicros - frame.timestamp) / 1000);
+        }
+        tapFrameReady = true;
+    }
+    workerCondition.notify_one();
+}
+
+void ScreenGrabberSession::workerLoop() {
+    while (true) {
+        FrameData frame;
+        qint64 captureTimeMs = 0;
+        bool fromTap = false;
+        {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            workerCondition.wait(lock, [this] { return workerRequest || tapFrameReady || !workerRunning; });
+            if (!workerRunning) {
+                return;
+            }
+            if (tapFrameReady) {
+                frame = pendingTapFrame;
+                captureTimeMs = pendingTapCaptureMs;
+                tapFrameReady = false;
+                fromTap = true;
+            }
+            workerRequest = false;
+        }
+
+#ifdef PLATFORM_LINUX
+        if (!fromTap && shmCapture) {
+            captureTimeMs = QDateTime::currentMSecsSinceEpoch();
+            frame = shmCapture->captureFrame();
+        }
+#else
+        (void)fromTap;
+#endif
+        if (frameFilter && frame.data && !frameFilter(frame, captureTimeMs)) {
+            // 未被选中的帧不缩放也不编码，只结束本次请求
+            QMetaObject::invokeMethod(this, [this]() {
+                skipRequest();
+            }, Qt::QueuedConnection);
+            continue;
+        }
+        const QByteArray jpegData = encodeFrameJpeg(frame);
+
+        QMetaObject::invokeMethod(this, [this, jpegData, captureTimeMs]() {
+            finishRequest(jpegData, captureTimeMs);
+        }, Qt::QueuedConnection);
+    }
+}
+
+bool ScreenGrabberSession::startStream(const QString &preferredPath) {
+    const QString ffmpegPath = preferredPath.isEmpty() ? FFmpegLocator::instance().ffmpegPath() : preferredPath;
+    if (ffmpegPath.isEmpty()) {
+        emit grabFailed("未找到FFmpeg，无法启动屏幕抓取会话");
+        return false;
+    }
+
+    streamProcess = new QProcess(this);
+    connect(streamProcess, &QProcess::readyReadStandardOutput,
+            this, &ScreenGrabberSession::onStreamOutput);
+    connect(streamProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ScreenGrabberSession::onStreamFinished);
+    // ffmpeg 日志不需要，避免 stderr 管道写满阻塞进程
+    streamProcess->setStandardErrorFile(QProcess::nullDevice());
+
+    streamProcess->start(ffmpegPath, buildStreamArguments());
+    if (!streamProcess->waitForStarted(5000)) {
+        qWarning() << "启动 ffmpeg 抓取流失败:" << streamProcess->errorString();
+        streamProcess->deleteLater();
+        streamProcess = nullptr;
+        emit grabFailed("无法启动FFmpeg屏幕抓取");
+        return false;
+    }
+    return true;
+}
+
+QStringList ScreenGrabberSession::buildStreamArguments() const {
+    QStringList arguments;
+    arguments << "-hide_banner" << "-loglevel" << "error";
+
+#ifdef Q_OS_WIN
+    arguments << "-f" << "gdigrab"
+              << "-framerate" << QString::number(streamFrameRate);
+    if (captureRegionSet) {
+        arguments << "-offset_x" << QString::number(regionX)
+                  << "-offset_y" << QString::number(regionY)
+                  << "-video_size" << QString::number(regionWidth) + "x" + QString::number(regionHeight);
+    }
+    arguments << "-i" << "desktop";
+    arguments << "-vf" << QString("fps=%1").arg(streamFrameRate);
+#elif defined(Q_OS_MACOS)
+    // avfoundation 只接受设备支持的帧率，输入保持默认，输出端再降帧
+    arguments << "-f" << "avfoundation"
+              << "-i" << "1";
+    QString filter = QString("fps=%1").arg(streamFrameRate);
+    if (captureRegionSet) {
+        filter = QString("crop=%1:%2:%3:%4,")
+                 .arg(regionWidth).arg(regionHeight).arg(regionX).arg(regionY) + filter;
+    }
+    arguments << "-vf" << filter;
+#else
+    QString display = qEnvironmentVariable("DISPLAY", ":0.0");
+    arguments << "-f" << "x11grab"
+              << "-framerate" << QString::number(streamFrameRate);
+    if (captureRegionSet) {
+        arguments << "-video_size" << QString::number(regionWidth) + "x" + QString::number(regionHeight)
+                  << "-i" << QString("%1+%2,%3").arg(display).arg(regionX).arg(regionY);
+    } else {
+        arguments << "-i" << display;
+    }
+#endif
+
+    // 每帧立即写出，便于会话随时拿到最新完整帧
+    arguments << "-c:v" << "mjpeg"
+              << "-q:v" << "2"
+              << "-f" << "image2pipe"
+              << "-flush_packets" << "1"
+              << "pipe:1";
+    return arguments;
+}
+
+void ScreenGrabberSession::onStreamOutput() {
+    if (!streamProcess) {
+        return;
+    }
+    streamBuffer.append(streamProcess->readAllStandardOutput());
+
+    // 按 SOI(FFD8)/EOI(FFD9) 切分 JPEG；熵编码段内的 0xFF 都会被填充为 FF00，不会误判
+    static const QByteArray soi("\xFF\xD8", 2);
+    static const QByteArray eoi("\xFF\xD9", 2);
+    bool gotFrame = false;
+    while (true) {
+        int start = streamBuffer.indexOf(soi);
+        if (start < 0) {
+            streamBuffer.clear();
+            break;
+        }
+        int end = streamBuffer.indexOf(eoi, start + 2);
+        if (end < 0) {
+            if (start > 0) {
+                streamBuffer.remove(0, start);
+            }
+            break;
+        }
+        latestJpeg = streamBuffer.mid(start, end + 2 - start);
+        latestCaptureMs = QDateTime::currentMSecsSinceEpoch();
+        streamBuffer.remove(0, end + 2);
+        gotFrame = true;
+    }
+    if (streamBuffer.size() > MAX_STREAM_BUFFER) {
+        qWarning() << "ffmpeg 抓取流数据异常，重新同步";
+        streamBuffer.clear();
+    }
+
+    // 请求发出时还没有可用帧，第一帧到达后立即交付
+    if (gotFrame && busy) {
+        deliverLatestStreamFrame();
+    }
+}
+
+void ScreenGrabberSession::deliverLatestStreamFrame() {
+    if (!busy || latestJpeg.isEmpty()) {
+        return;
+    }
+    finishRequest(latestJpeg, latestCaptureMs);
+}
+
+void ScreenGrabberSession::onStreamFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+    if (stopping || !running) {
+        return;
+    }
+    qWarning() << "ffmpeg 抓取流意外退出:" << exitCode << exitStatus;
+    running = false;
+    busy = false;
+    if (streamProcess) {
+        streamProcess->deleteLater();
+        streamProcess = nullptr;
+    }
+    emit grabFailed("FFmpeg屏幕抓取进程已退出");
+}
+
+void ScreenGrabberSession::finishRequest(const QByteArray &jpegData, qint64 captureTimeMs) {
+    if (!busy) {
+        return; // 会话已停止，丢弃迟到的结果
+    }
+    busy = false;
+    if (jpegData.isEmpty()) {
+        emit grabFailed("屏幕抓取失败");
+        return;
+    }
+    const int latencyMs = static_cast<int>(QDateTime::currentMSecsSinceEpoch() - requestStartMs);
+    emit frameGrabbed(jpegData, captureTimeMs, latencyMs);
+}
+
+void ScreenGrabberSession::skipRequest() {
+    busy = false;
+}
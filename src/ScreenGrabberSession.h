@@ -0,0 +1,120 @@
+#ifndef SCREENGRABBERSESSION_H
+#define SCREENGRABBERSESSION_H
+
+#include <QObject>
+#include <QProcess>
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "DataTypes.h"
+
+class SimpleCapture;
+
+#ifdef PLATFORM_LINUX
+class X11ShmCapture;
+#endif
+
+/**
+ * 常驻屏幕抓取会话 - 整个录制期间只启动一次，按需取样当前画面
+ * Linux 优先使用进程内 X11 MIT-SHM 抓屏（后台线程抓取并编码 JPEG）；
+ * 其他平台或 X11 不可用时，启动一个常驻 ffmpeg 以 MJPEG 流输出到 stdout，
+ * 会话只保留最新一帧。任意时刻最多只有一个取样请求在处理中
+ * 设置了录制帧旁路且平台支持时，直接取录制管线中的帧，不再单独抓屏
+ * 进程内与旁路模式可设置原始帧筛选，在后台线程先用原始帧判断，未通过的帧不做 JPEG 编码
+ */
+class ScreenGrabberSession : public QObject {
+    Q_OBJECT
+
+public:
+    // 原始帧筛选（后台线程调用）：返回 false 时不编码，本次请求直接结束，不发出 frameGrabbed
+    using FrameFilter = std::function<bool(const FrameData &frame, qint64 captureTimeMs)>;
+
+    explicit ScreenGrabberSession(QObject *parent = nullptr);
+    ~ScreenGrabberSession();
+
+    // 设置捕获区域（需在 start 前调用）
+    void setCaptureRegion(int x, int y, int width, int height);
+
+    // 使用录制器的帧旁路作为帧来源（需在录制器 startCapture 前设置）；传 nullptr 取消
+    // 返回录制器是否支持旁路
+    bool setFrameTapSource(SimpleCapture *capture);
+
+    // 设置原始帧筛选（需在 start 前调用）；ffmpeg 流模式只有 JPEG，不调用筛选
+    void setFrameFilter(FrameFilter filter);
+
+    // 当前模式是否在编码前调用原始帧筛选（进程内或旁路模式）
+    bool appliesFrameFilter() const;
+
+    // ffmpeg 流模式的输出帧率（取样间隔远大于帧间隔即可，默认 2 帧/秒）
+    void setStreamFrameRate(int fps);
+
+    // 启动会话；ffmpegPath 仅在需要 ffmpeg 流模式时使用，为空时届时向 FFmpegLocator 查询
+    bool start(const QString &ffmpegPath = QString());
+    void stop();
+    bool isRunning() const;
+
+    // 请求一帧；已有请求在处理中或会话未运行时返回 false
+    bool requestFrame();
+    bool isBusy() const;
+
+signals:
+    // 取样完成：JPEG 数据、抓取时刻（毫秒时间戳）、请求到完成的耗时
+    void frameGrabbed(const QByteArray &jpegData, qint64 captureTimeMs, int latencyMs);
+
+    // 取样失败或会话异常退出
+    void grabFailed(const QString &error);
+
+private slots:
+    void onStreamOutput();
+    void onStreamFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    bool startInProcess();
+    bool startStream(const QString &preferredPath);
+    QStringList buildStreamArguments() const;
+    void deliverLatestStreamFrame();
+    void finishRequest(const QByteArray &jpegData, qint64 captureTimeMs);
+    void skipRequest();
+    void onTapFrame(const FrameData &frame);
+    void workerLoop();
+
+    bool captureRegionSet;
+    int regionX, regionY, regionWidth, regionHeight;
+    int streamFrameRate;
+    bool running;
+    bool busy;
+    qint64 requestStartMs;
+
+    // ffmpeg 流模式
+    QProcess *streamProcess;
+    QByteArray streamBuffer;
+    QByteArray latestJpeg;
+    qint64 latestCaptureMs;
+    bool stopping;
+
+    // 进程内模式（后台线程）
+#ifdef PLATFORM_LINUX
+    std::unique_ptr<X11ShmCapture> shmCapture;
+#endif
+    std::thread worker;
+    std::mutex workerMutex;
+    std::condition_variable workerCondition;
+    bool workerRequest;
+    std::atomic<bool> workerRunning;
+    FrameFilter frameFilter;
+
+    // 录制帧旁路模式（pendingTapFrame 由 workerMutex 保护）
+    SimpleCapture *tapSource;
+    bool tapAvailable;
+    bool tapMode;
+    FrameData pendingTapFrame;
+    qint64 pendingTapCaptureMs;
+    bool tapFrameReady;
+};
+
+#endif // SCREENGRABBERSESSION_H
@@ -2,6 +2,25 @@
 
 #include <string>
 #include <memory>
+#include <functional>
+#include <vector>
+#include "DataTypes.h"
+
+// 录制节拍统计：实际帧率明显低于目标帧率时说明捕获或编码跟不上
+struct CaptureStats {
+    uint64_t framesCaptured = 0;   // 已处理的帧位数
+    uint64_t framesLate = 0;       // 晚于截止时间超过半个周期的帧数
+    uint64_t framesDropped = 0;    // 因跟不上而跳过的帧位数
+    double targetFps = 0.0;
+    double achievedFps = 0.0;      // 0 表示当前平台不提供统计
+};
+
+// 可单独捕获的顶层窗口
+struct CaptureWindowInfo {
+    uint64_t id = 0;                     // 平台窗口 ID（X11 为 Window）
+    std::string title;
+    CaptureRect geometry{0, 0, 0, 0};    // 屏幕物理像素坐标
+};
 
 // 简化的屏幕捕获接口
 class SimpleCapture {
@@ -14,6 +33,32 @@ public:
     virtual bool isCapturing() const = 0;
     virtual void setFrameRate(int fps) = 0;
     virtual void setCaptureRegion(int x, int y, int width, int height) = 0;
+    // 窗口捕获：只录制指定窗口，窗口移动/缩放时无需重新开始录制（仅部分平台支持）
+    // 需在 startCapture 前设置，设置后优先于捕获区域；传 0 取消。返回 false 表示当前平台不支持
+    virtual bool setCaptureWindow(uint64_t windowId) { (void)windowId; return false; }
+    // 多屏捕获：同时录制多块屏幕（屏幕物理像素坐标），拼成一张按外接矩形排布的画布
+    // 需在 startCapture 前设置，传空列表取消。返回 false 表示当前平台不支持，可改用外接矩形作为捕获区域
+    virtual bool setCaptureScreens(const std::vector<CaptureRect>& screens) { (void)screens; return false; }
+    // 列出可捕获的窗口，最上层在前；不支持窗口捕获的平台返回空列表
+    virtual std::vector<CaptureWindowInfo> listCaptureWindows() const { return {}; }
+    // 脏矩形捕获：只处理变化区域，静态画面不再重复编码（仅部分平台支持，默认关闭）
+    virtual void setDirtyRegionCapture(bool enabled) { (void)enabled; }
+
+    // 录制帧旁路：把录制管线中的帧（BGRA32）交给回调，供 AI 取样复用同一次抓屏
+    // 需在 startCapture 前设置；回调可能在任意线程触发，传入空回调即关闭并保证之后不再回调
+    // 帧的 timestamp 为该帧的抓屏时刻（FramePacer::nowMicros 时钟），而不是交付时刻
+    // 返回 false 表示当前平台不支持
+    using FrameTapCallback = std::function<void(const FrameData& frame)>;
+    virtual bool setFrameTap(FrameTapCallback callback) { (void)callback; return false; }
+    // 请求一帧旁路画面，每次请求最多触发一次回调
+    virtual void requestTapFrame() {}
+
+    // 空闲低功耗模式：用户离开/锁屏期间降低抓屏与编码频率，恢复后立即回到正常帧率
+    // 可在录制中随时切换；返回 false 表示当前平台不支持
+    virtual bool setIdleMode(bool idle) { (void)idle; return false; }
+
+    // 录制过程中的节拍统计，可在任意线程调用
+    virtual CaptureStats captureStats() const { return CaptureStats(); }
 };
 
 // 创建工厂函数
@@ -0,0 +1,405 @@
+// SimpleCapture_linux.cpp
+// Linux 真实录屏实现：X11 MIT-SHM 进程内抓屏 + ffmpeg 管道编码
+#include "SimpleCapture.h"
+#include "X11ShmCapture.h"
+#include "FFmpegPipeEncoder.h"
+#include "X11CursorSource.h"
+#include "VideoPreprocessor.h"
+#include "FFmpegLocator.h"
+#include "FramePacer.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <QString>
+
+class LinuxSimpleCapture : public SimpleCapture {
+public:
+    LinuxSimpleCapture() = default;
+    ~LinuxSimpleCapture() override {
+        if (capturing) {
+            stopCapture();
+        }
+    }
+
+    bool init() override {
+        // 在 GUI 线程上调用，不能等待 ffmpeg 定位或探测；ffmpeg 留到开始录制时再检查
+        FFmpegLocator::instance().resolveAsync();
+
+        // 验证 X 服务器可用且支持 MIT-SHM
+        X11ShmCapture probe;
+        if (!probe.init()) {
+            return false;
+        }
+        probe.release();
+        return true;
+    }
+
+    bool startCapture(const std::string& outputPath) override {
+        if (isCapturing()) {
+            std::cerr << "已在录制中" << std::endl;
+            return false;
+        }
+        if (!resolveFFmpeg()) {
+            return false;
+        }
+
+        capture = std::make_unique<X11ShmCapture>();
+        if (captureWindow) {
+            // 窗口模式下区域与脏矩形均不适用，编码尺寸取窗口初始尺寸
+            capture->setCaptureWindow(static_cast<unsigned long>(captureWindow));
+        } else if (captureScreens.size() > 1) {
+            // 多屏并行抓取拼接成一张画布，脏矩形不适用
+            capture->setCaptureScreens(captureScreens);
+        } else if (captureRegionSet) {
+            capture->setCaptureRegion(regionX, regionY, regionW, regionH);
+            std::cout << "X11 捕获区域=" << regionX << "," << regionY << " 尺寸=" << regionW << "x" << regionH << std::endl;
+        }
+        capture->setDamageTracking(dirtyRegionCapture);
+        if (!capture->init()) {
+            capture.reset();
+            return false;
+        }
+
+        // 光标不在 XShmGetImage 的结果中，单独获取后叠加；失败时仅录制无光标画面
+        cursorSource = std::make_unique<X11CursorSource>();
+        if (!cursorSource->init()) {
+            cursorSource.reset();
+        }
+        lastCursorRect = {0, 0, 0, 0};
+
+        EncoderConfig config;
+        config.width = capture->width();
+        config.height = capture->height();
+        config.fps = frameRate > 0 ? frameRate : 30;
+        // 抓到的 BGRA 帧在编码线程内用 SIMD 转成 YUV420P 再写管道，管道带宽降到 3/8；
+        // 取 BT.601 limited，与原先 ffmpeg 内部转换的结果一致
+        config.inputFormat = PixelFormat::YUV420P;
+        config.outputPath = outputPath;
+
+        encoder = std::make_unique<FFmpegPipeEncoder>(ffmpegPath.toStdString());
+        if (!encoder->setup(config)) {
+            encoder.reset();
+            capture->release();
+            capture.reset();
+            std::cerr << "启动 ffmpeg 编码失败" << std::endl;
+            return false;
+        }
+        // 叠加到 YUV 帧的光标颜色与编码器的转换使用同一色彩规格
+        preprocessor.setColorSpec(config.colorMatrix, config.colorRange);
+
+        running = true;
+        idleMode = false;
+        capturing = true;
+        captureThread = std::thread(&LinuxSimpleCapture::captureLoop, this, config.fps);
+        return true;
+    }
+
+    bool stopCapture() override {
+        if (!isCapturing()) return false;
+
+        running = false;
+        if (captureThread.joinable()) {
+            captureThread.join();
+        }
+        if (encoder && capture && capture->isDamageTrackingActive()) {
+            // 静态结尾没有新帧进入编码器，补一帧完整画面让视频时长覆盖到停止时刻
+            capture->requestFullFrame();
+            FrameData lastFrame = capture->captureFrame();
+            if (lastFrame.data) {
+                drawCursor(lastFrame, pollCursor());
+                encoder->encode(lastFrame);
+                restoreCursorBackground(lastFrame);
+            }
+        }
+        if (encoder) {
+            encoder->finalize(std::string());
+            encoder.reset();
+        }
+        if (capture) {
+            capture->release();
+            capture.reset();
+        }
+        cursorSource.reset();
+        const FramePacer::Stats pacing = pacer.stats();
+        std::cout << "Linux 录制结束: 捕获 " << capturedFrames << " 帧, 丢帧 " << pacing.droppedFrames
+                  << " 帧, 迟到 " << pacing.lateFrames << " 帧, 无变化 " << unchangedFrames
+                  << " 帧, 实际 " << pacing.achievedFps << "/" << pacing.targetFps << " fps"
+                  << ", 最大延迟 " << pacing.maxLatenessUs << "us" << std::endl;
+        if (maxScreenSkewUs > 0) {
+            std::cout << "多屏抓取最大时间差 " << maxScreenSkewUs << "us" << std::endl;
+        }
+        capturing = false;
+        return true;
+    }
+
+    bool isCapturing() const override { return capturing; }
+
+    CaptureStats captureStats() const override {
+        const FramePacer::Stats pacing = pacer.stats();
+        CaptureStats stats;
+        stats.framesCaptured = pacing.frames;
+        stats.framesLate = pacing.lateFrames;
+        stats.framesDropped = pacing.droppedFrames;
+        stats.targetFps = pacing.targetFps;
+        stats.achievedFps = pacing.achievedFps;
+        return stats;
+    }
+
+    void setFrameRate(int fps) override { frameRate = fps; }
+
+    void setCaptureRegion(int x, int y, int width, int height) override {
+        regionX = x; regionY = y; regionW = width; regionH = height; captureRegionSet = true;
+    }
+
+    bool setCaptureWindow(uint64_t windowId) override {
+        captureWindow = windowId;
+        return true;
+    }
+
+    bool setCaptureScreens(const std::vector<CaptureRect>& screens) override {
+        captureScreens = screens;
+        return true;
+    }
+
+    std::vector<CaptureWindowInfo> listCaptureWindows() const override {
+        std::vector<CaptureWindowInfo> result;
+        for (const X11ShmCapture::WindowInfo &window : X11ShmCapture::listWindows()) {
+            CaptureWindowInfo info;
+            info.id = window.id;
+            info.title = window.title;
+            info.geometry = window.geometry;
+            result.push_back(info);
+        }
+        return result;
+    }
+
+    void setDirtyRegionCapture(bool enabled) override { dirtyRegionCapture = enabled; }
+
+    bool setFrameTap(FrameTapCallback callback) override {
+        // 持锁替换：返回后捕获线程不会再调用旧回调
+        std::lock_guard<std::mutex> lock(tapMutex);
+        frameTap = std::move(callback);
+        tapRequested = false;
+        return true;
+    }
+
+    void requestTapFrame() override { tapRequested = true; }
+
+    bool setIdleMode(bool idle) override {
+        idleMode = idle;
+        return true;
+    }
+
+private:
+    // 开始录制时才取 ffmpeg 路径与能力：路径解析只查文件系统，能力首次探测后缓存到磁盘
+    bool resolveFFmpeg() {
+        ffmpegPath = FFmpegLocator::instance().ffmpegPath();
+        if (ffmpegPath.isEmpty()) {
+            std::cerr << "无法找到可用的 ffmpeg，可执行文件应放在程序目录或加入 PATH" << std::endl;
+            return false;
+        }
+        const FFmpegLocator::Capabilities caps = FFmpegLocator::instance().capabilities();
+        if (!caps.encoders.isEmpty() && !caps.hasEncoder("libx264")) {
+            std::cerr << "当前 ffmpeg 不包含 libx264 编码器" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    struct CursorSample {
+        CapturePoint position{0, 0}; // 捕获区域坐标
+        bool pressed = false;
+        bool visible = false;
+        bool changed = false;        // 与上一帧相比位置、按键或图像发生变化
+    };
+
+    CursorSample pollCursor() {
+        CursorSample sample;
+        if (!cursorSource) {
+            return sample;
+        }
+        X11CursorSource::State state = cursorSource->poll();
+        if (state.imageChanged) {
+            preprocessor.setCursorImage(cursorSource->image());
+        }
+        // 窗口模式下捕获原点随窗口移动，按最近一帧的位置换算
+        const CapturePoint origin = capture ? capture->captureOrigin() : CapturePoint{0, 0};
+        sample.position = {state.position.x - origin.x, state.position.y - origin.y};
+        sample.pressed = state.pressed;
+        sample.visible = state.visible;
+        sample.changed = state.imageChanged || state.visible != lastCursorVisible ||
+                         sample.position.x != lastCursorPos.x || sample.position.y != lastCursorPos.y ||
+                         sample.pressed != lastCursorPressed;
+        lastCursorPos = sample.position;
+        lastCursorPressed = sample.pressed;
+        lastCursorVisible = sample.visible;
+        return sample;
+    }
+
+    // 把光标画进帧里，并把新旧光标区域并入脏矩形（dirtyRects 为空表示整帧，无需追加）
+    // cursorOnly 表示帧内容来自常驻缓冲，只有光标区域发生了变化
+    void drawCursor(FrameData &frame, const CursorSample &sample, bool cursorOnly = false) {
+        CaptureRect touched{0, 0, 0, 0};
+        if (sample.visible) {
+            const CaptureRect rect = preprocessor.mouseEffectRect(frame, sample.position, sample.pressed);
+            if (rect.width > 0 && rect.height > 0) {
+                if (frame.bufferUseCount() == 2 && capture->isDamageTrackingActive() &&
+                    frame.format == PixelFormat::BGRA32) {
+                    // 帧只与捕获器的常驻缓冲共享：保存光标下的像素后直接画进缓冲，编码后再恢复，不整帧复制
+                    saveCursorBackground(frame, rect);
+                } else {
+                    // 其余情况按写时复制：独占缓冲直接画，缓冲还被旁路等其他阶段持有时先复制出独占副本
+                    frame.makeWritable();
+                }
+                touched = preprocessor.overlayMouseEffectInPlace(frame, sample.position, sample.pressed);
+            }
+        }
+        if (!frame.dirtyRects.empty() || cursorOnly) {
+            if (lastCursorRect.width > 0 && lastCursorRect.height > 0) {
+                frame.dirtyRects.push_back(lastCursorRect);
+            }
+            if (touched.width > 0 && touched.height > 0) {
+                frame.dirtyRects.push_back(touched);
+            }
+        }
+        lastCursorRect = touched;
+    }
+
+    void saveCursorBackground(const FrameData &frame, const CaptureRect &rect) {
+        const size_t rowBytes = static_cast<size_t>(rect.width) * 4;
+        cursorBackground.resize(rowBytes * rect.height);
+        for (int y = 0; y < rect.height; ++y) {
+            memcpy(cursorBackground.data() + rowBytes * y,
+                   frame.data + static_cast<size_t>(rect.y + y) * frame.stride + rect.x * 4, rowBytes);
+        }
+        cursorBackgroundRect = rect;
+    }
+
+    // 把画进常驻缓冲的光标擦掉，缓冲恢复为纯屏幕内容（下一帧只拷脏矩形，光标残影不会留下）
+    void restoreCursorBackground(FrameData &frame) {
+        const CaptureRect rect = cursorBackgroundRect;
+        if (rect.width <= 0 || rect.height <= 0) {
+            return;
+        }
+        const size_t rowBytes = static_cast<size_t>(rect.width) * 4;
+        for (int y = 0; y < rect.height; ++y) {
+            memcpy(frame.data + static_cast<size_t>(rect.y + y) * frame.stride + rect.x * 4,
+                   cursorBackground.data() + rowBytes * y, rowBytes);
+        }
+        cursorBackgroundRect = {0, 0, 0, 0};
+    }
+
+    // 把刚送入编码器的帧交给旁路，AI 取样与录制内容逐帧一致
+    void deliverTapFrame(const FrameData &frame) {
+        if (!tapRequested) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(tapMutex);
+        if (frameTap && tapRequested.exchange(false)) {
+            if (cursorBackgroundRect.width > 0) {
+                // 光标画在常驻缓冲里，交付后会被擦掉；旁路可能异步读取，交给它一份独占副本
+                FrameData copy = frame;
+                copy.makeWritable();
+                frameTap(copy);
+            } else {
+                frameTap(frame);
+            }
+        }
+    }
+
+    void captureLoop(int fps) {
+        capturedFrames = 0;
+        unchangedFrames = 0;
+        maxScreenSkewUs = 0;
+        pacer.setFrameRate(fps);
+        uint64_t slotTimestamp = pacer.start();
+
+        uint64_t slotIndex = 0;
+
+        while (running) {
+            // 空闲模式每秒只抓一帧，其余帧位直接等待；跳过的帧位由 ffmpeg 按 pts 补齐，视频时长不受影响
+            if (idleMode && (slotIndex++ % static_cast<uint64_t>(fps)) != 0) {
+                slotTimestamp = pacer.waitNextFrame();
+                continue;
+            }
+
+            FrameData frame = capture->captureFrame();
+            const CursorSample cursorSample = pollCursor();
+            bool cursorOnly = false;
+            if (frame.unchanged && cursorSample.changed) {
+                // 画面静止但光标移动/按下：从常驻缓冲重绘，只有新旧光标区域是脏的
+                frame = capture->snapshotFrame();
+                cursorOnly = true;
+            }
+            maxScreenSkewUs = std::max(maxScreenSkewUs, capture->lastScreenSkewMicros());
+            if (frame.data && !frame.unchanged) {
+                // 时间戳取帧位的理想时刻而非抓屏返回时刻，不受 XShmGetImage 耗时抖动影响
+                frame.timestamp = slotTimestamp;
+                drawCursor(frame, cursorSample, cursorOnly);
+            }
+
+            if (frame.unchanged) {
+                // 画面无变化时跳过转换和写管道；下一帧带着自己的帧位 pts 写入，空缺由 ffmpeg 复制上一帧补齐
+                ++unchangedFrames;
+            } else if (frame.data) {
+                const bool encoded = encoder->encode(frame).ok;
+                if (encoded) {
+                    ++capturedFrames;
+                    deliverTapFrame(frame);
+                }
+                restoreCursorBackground(frame);
+                if (!encoded) {
+                    std::cerr << "编码进程已停止，结束捕获" << std::endl;
+                    break;
+                }
+            }
+            if (frame.unchanged && tapRequested) {
+                // 静止画面没有可交付的帧，下一帧抓完整画面后再交付
+                capture->requestFullFrame();
+            }
+
+            // 截止时间由起点 + n*周期 计算，错过的帧位计入丢帧，后续帧仍对齐原始时间轴
+            slotTimestamp = pacer.waitNextFrame();
+        }
+    }
+
+    std::unique_ptr<X11ShmCapture> capture;
+    std::unique_ptr<FFmpegPipeEncoder> encoder;
+    std::unique_ptr<X11CursorSource> cursorSource;
+    VideoPreprocessor preprocessor;
+    CapturePoint lastCursorPos{0, 0};
+    CaptureRect lastCursorRect{0, 0, 0, 0};
+    // 直接画进常驻缓冲的光标区域及其原像素（宽高为 0 表示没有待恢复的区域）
+    CaptureRect cursorBackgroundRect{0, 0, 0, 0};
+    std::vector<uint8_t> cursorBackground;
+    bool lastCursorPressed = false;
+    bool lastCursorVisible = false;
+    std::mutex tapMutex;
+    FrameTapCallback frameTap;
+    std::atomic<bool> tapRequested{false};
+    std::thread captureThread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> idleMode{false};
+    QString ffmpegPath;
+    bool capturing = false;
+    int frameRate = 30;
+    int regionX = 0, regionY = 0, regionW = 0, regionH = 0;
+    bool captureRegionSet = false;
+    uint64_t captureWindow = 0;
+    std::vector<CaptureRect> captureScreens;
+    bool dirtyRegionCapture = false;
+    FramePacer pacer;
+    uint64_t capturedFrames = 0;
+    uint64_t unchangedFrames = 0;
+    int64_t maxScreenSkewUs = 0;
+};
+
+std::unique_ptr<SimpleCapture> createSimpleCapture() {
+    return std::make_unique<LinuxSimpleCapture>();
+}
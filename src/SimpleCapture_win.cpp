@@ -1,6 +1,8 @@
 // SimpleCapture_win.cpp
 // Windows 真实录屏实现：通过 FFmpeg (gdigrab) 进行屏幕捕获与 H.264 编码
 #include "SimpleCapture.h"
+#include "FFmpegLocator.h"
+#include "FramePacer.h"
 #include <iostream>
 #include <memory>
 
@@ -9,6 +11,12 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QStringList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+
+// 录制帧旁路输出帧率：AI 取样间隔为秒级，1 帧/秒足够且管道带宽可控
+static const int TAP_FRAME_RATE = 1;
 
 class WindowsSimpleCapture : public SimpleCapture {
 public:
@@ -22,17 +30,8 @@ public:
     }
 
     bool init() override {
-        // 优先从应用目录查找 ffmpeg.exe，其次使用 PATH 中的 ffmpeg
-        ffmpegPath = QDir(QCoreApplication::applicationDirPath()).filePath("ffmpeg.exe");
-        if (!QFileInfo::exists(ffmpegPath)) {
-            ffmpegPath = "ffmpeg"; // 走 PATH
-        }
-        // 验证 ffmpeg 可用
-        int code = QProcess::execute(ffmpegPath, {"-version"});
-        if (code != 0) {
-            std::cerr << "无法找到可用的 ffmpeg，可执行文件应放在程序目录或加入 PATH" << std::endl;
-            return false;
-        }
+        // 在 GUI 线程上调用，不能等待 ffmpeg 定位或探测；ffmpeg 留到开始录制时再检查
+        FFmpegLocator::instance().resolveAsync();
         return true;
     }
 
@@ -41,6 +40,9 @@ public:
             std::cerr << "已在录制中" << std::endl;
             return false;
         }
+        if (!resolveFFmpeg()) {
+            return false;
+        }
 
         // 准备参数
         QStringList args;
@@ -58,20 +60,46 @@ public:
         // 若未设置区域，gdigrab 默认为主屏整体
         args << "-framerate" << QString::number(frameRate > 0 ? frameRate : 30);
         args << "-i" << "desktop";
+        // 帧旁路：同一次 gdigrab 抓屏分成两路，录制路编码到文件，旁路降帧后以 BGRA 原始帧写到 stdout
+        // 旁路帧大小必须已知，因此只在设置了捕获区域时启用
+        tapActive = frameTap && captureRegionSet;
+        if (tapActive) {
+            args << "-filter_complex"
+                 << QString("[0:v]split=2[rec][tap];[tap]fps=%1,format=bgra[tapout]").arg(TAP_FRAME_RATE);
+            args << "-map" << "[rec]";
+        }
         // 编码参数：H.264 + yuv420p 保证广泛兼容
         args << "-pix_fmt" << "yuv420p";
         args << "-c:v" << "libx264";
         args << "-preset" << "veryfast";
         args << "-crf" << "23";
         args << QString::fromStdString(outputPath);
+        if (tapActive) {
+            args << "-map" << "[tapout]" << "-f" << "rawvideo" << "pipe:1";
+        }
+        tapBuffer.clear();
+        latestTapFrame.clear();
+        tapPending = false;
+        tapFramesReceived = 0;
+        latestTapIndex = 0;
+        tapStartMicros = 0;
+        progressBuffer.clear();
+        progress = CaptureStats();
+        progress.targetFps = frameRate > 0 ? frameRate : 30;
 
-        if (!ffmpeg) ffmpeg = new QProcess();
-        ffmpeg->setProcessChannelMode(QProcess::MergedChannels);
+        if (!ffmpeg) {
+            ffmpeg = new QProcess();
+            QObject::connect(ffmpeg, &QProcess::readyReadStandardOutput, [this]() { onTapOutput(); });
+            QObject::connect(ffmpeg, &QProcess::readyReadStandardError, [this]() { onProgressOutput(); });
+        }
+        // stdout 专用于旁路帧，stderr 上的进度行（frame=/dup=/drop=）用于节拍统计
+        ffmpeg->setProcessChannelMode(QProcess::SeparateChannels);
         ffmpeg->setProgram(ffmpegPath);
         ffmpeg->setArguments(args);
         ffmpeg->setWorkingDirectory(QCoreApplication::applicationDirPath());
         ffmpeg->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
         ffmpeg->start();
+        captureClock.start();
         // 打开标准输入以便优雅停止（发送 'q'）
         ffmpeg->waitForStarted(3000);
         if (ffmpeg->state() != QProcess::Running) {
@@ -102,24 +130,157 @@ public:
             }
         }
         capturing = false;
+        tapActive = false;
+        tapPending = false;
+        tapBuffer.clear();
+        latestTapFrame.clear();
+        std::cout << "Windows 录制结束: 捕获 " << progress.framesCaptured << " 帧, 丢帧 " << progress.framesDropped
+                  << " 帧, 实际 " << progress.achievedFps << "/" << progress.targetFps << " fps" << std::endl;
         return true;
     }
 
     bool isCapturing() const override { return capturing; }
 
+    CaptureStats captureStats() const override { return progress; }
+
     void setFrameRate(int fps) override { frameRate = fps; }
 
     void setCaptureRegion(int x, int y, int width, int height) override {
         regionX = x; regionY = y; regionW = width; regionH = height; captureRegionSet = true;
     }
 
+    bool setFrameTap(FrameTapCallback callback) override {
+        // 回调在 GUI 线程（QProcess 所在线程）触发；旁路帧尺寸取自捕获区域，未设置区域时不支持
+        frameTap = std::move(callback);
+        if (!frameTap) {
+            tapPending = false;
+            return true;
+        }
+        return captureRegionSet;
+    }
+
+    void requestTapFrame() override {
+        if (!tapActive) {
+            return;
+        }
+        // 已有最近一帧时立即交付（至多落后 1/TAP_FRAME_RATE 秒），否则等下一帧到达
+        if (!latestTapFrame.isEmpty()) {
+            deliverTapFrame();
+        } else {
+            tapPending = true;
+        }
+    }
+
 private:
+    // 开始录制时才取 ffmpeg 路径与能力：路径解析只查文件系统，能力首次探测后缓存到磁盘
+    bool resolveFFmpeg() {
+        ffmpegPath = FFmpegLocator::instance().ffmpegPath();
+        if (ffmpegPath.isEmpty()) {
+            std::cerr << "无法找到可用的 ffmpeg，可执行文件应放在程序目录或加入 PATH" << std::endl;
+            return false;
+        }
+        const FFmpegLocator::Capabilities caps = FFmpegLocator::instance().capabilities();
+        if (!caps.inputDevices.isEmpty() && !caps.hasInputDevice("gdigrab")) {
+            std::cerr << "当前 ffmpeg 不支持 gdigrab 屏幕捕获" << std::endl;
+            return false;
+        }
+        if (!caps.encoders.isEmpty() && !caps.hasEncoder("libx264")) {
+            std::cerr << "当前 ffmpeg 不包含 libx264 编码器" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void onTapOutput() {
+        if (!ffmpeg) return;
+        if (!tapActive) {
+            ffmpeg->readAllStandardOutput();
+            return;
+        }
+        tapBuffer.append(ffmpeg->readAllStandardOutput());
+        const int frameBytes = regionW * regionH * 4;
+        if (frameBytes <= 0 || tapBuffer.size() < frameBytes) return;
+        // 只保留最新的完整帧，其余直接丢弃
+        const int completeFrames = tapBuffer.size() / frameBytes;
+        latestTapFrame = tapBuffer.mid((completeFrames - 1) * frameBytes, frameBytes);
+        tapBuffer.remove(0, completeFrames * frameBytes);
+        tapFramesReceived += completeFrames;
+        latestTapIndex = tapFramesReceived - 1;
+
+        // 旁路流经 fps 滤镜后第 n 帧的 pts 为 n / TAP_FRAME_RATE，抓屏时刻 = 起点 + n 个帧间隔。
+        // 起点取各帧“到达时刻 - n 个帧间隔”的最小值：管道延迟最小的那一帧最接近真实抓屏时刻，
+        // ffmpeg 积压时到达得晚的帧不会把时间轴往后推
+        const uint64_t periodMicros = 1000000 / TAP_FRAME_RATE;
+        const uint64_t now = FramePacer::nowMicros();
+        const uint64_t offset = latestTapIndex * periodMicros;
+        if (now > offset && (tapStartMicros == 0 || now - offset < tapStartMicros)) {
+            tapStartMicros = now - offset;
+        }
+        if (tapPending) {
+            tapPending = false;
+            deliverTapFrame();
+        }
+    }
+
+    void onProgressOutput() {
+        if (!ffmpeg) return;
+        progressBuffer.append(ffmpeg->readAllStandardError());
+        // 进度行以 \r 刷新，只解析最后一个完整的进度行
+        const int end = qMax(progressBuffer.lastIndexOf('\r'), progressBuffer.lastIndexOf('\n'));
+        if (end < 0) return;
+        const QString text = QString::fromLocal8Bit(progressBuffer.left(end));
+        progressBuffer.remove(0, end + 1);
+
+        static const QRegularExpression progressPattern(
+            "frame=\\s*(\\d+).*?(?:dup=\\s*(\\d+)\\s+drop=\\s*(\\d+))?\\s+speed=");
+        QRegularExpressionMatchIterator it = progressPattern.globalMatch(text);
+        QRegularExpressionMatch match;
+        while (it.hasNext()) {
+            match = it.next();
+        }
+        if (!match.hasMatch()) return;
+
+        // gdigrab 跟不上时 ffmpeg 按恒定帧率复制上一帧补位（dup），这些帧位没有真正抓屏
+        const quint64 outputFrames = match.captured(1).toULongLong();
+        const quint64 duplicated = match.captured(2).toULongLong();
+        const quint64 dropped = match.captured(3).toULongLong();
+        progress.framesCaptured = outputFrames > duplicated ? outputFrames - duplicated : 0;
+        progress.framesDropped = duplicated + dropped;
+        const double elapsed = captureClock.elapsed() / 1000.0;
+        progress.achievedFps = elapsed > 0.0 ? progress.framesCaptured / elapsed : 0.0;
+    }
+
+    void deliverTapFrame() {
+        if (!frameTap || latestTapFrame.isEmpty()) return;
+        FrameData frame;
+        frame.width = regionW;
+        frame.height = regionH;
+        frame.stride = regionW * 4;
+        frame.format = PixelFormat::BGRA32;
+        // 按帧序号推算抓屏时刻，与 Linux 按帧位时刻打时间戳一致；交付时刻可能落后一个帧间隔以上
+        frame.timestamp = tapStartMicros + latestTapIndex * (1000000 / TAP_FRAME_RATE);
+        if (!frame.allocate(static_cast<size_t>(latestTapFrame.size()))) return;
+        memcpy(frame.data, latestTapFrame.constData(), frame.size);
+        frameTap(frame);
+    }
+
     QProcess* ffmpeg = nullptr;
     QString ffmpegPath;
     bool capturing = false;
     int frameRate = 30;
     int regionX = 0, regionY = 0, regionW = 0, regionH = 0; 
     bool captureRegionSet = false;
+    FrameTapCallback frameTap;
+    bool tapActive = false;
+    bool tapPending = false;
+    QByteArray tapBuffer;
+    QByteArray latestTapFrame;
+    uint64_t tapFramesReceived = 0;     // 旁路流累计收到的完整帧数
+    uint64_t latestTapIndex = 0;        // latestTapFrame 在旁路流中的帧序号
+    uint64_t tapStartMicros = 0;        // 旁路流第 0 帧的估计抓屏时刻
+    QByteArray progressBuffer;
+    QElapsedTimer captureClock;
+    CaptureStats progress;
 };
 
 std::unique_ptr<SimpleCapture> createSimpleCapture() {
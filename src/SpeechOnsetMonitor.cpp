@@ -0,0 +1,59 @@
+// SpeechOnsetMonitor.cpp
+// 语音起点监听实现：捕获线程 -> 语音检测 -> 起点回调
+#include "SpeechOnsetMonitor.h"
+#include "AudioPreprocessor.h"
+#include "IAudioCapture.h"
+#include <chrono>
+
+namespace {
+
+// 捕获队列暂时没有数据时的等待时长（捕获块为 10ms）
+const std::chrono::milliseconds IDLE_POLL(5);
+
+} // namespace
+
+SpeechOnsetMonitor::SpeechOnsetMonitor(std::unique_ptr<IAudioCapture> audioCapture)
+    : capture(std::move(audioCapture))
+    , running(false)
+{
+}
+
+SpeechOnsetMonitor::~SpeechOnsetMonitor() {
+    stop();
+}
+
+bool SpeechOnsetMonitor::start(OnsetCallback callback) {
+    stop();
+    if (!capture || !capture->init()) {
+        return false;
+    }
+    // 新的检测器从零开始计时，起点时间相对本次 start
+    preprocessor = std::make_unique<AudioPreprocessor>();
+    preprocessor->setSpeechOnsetCallback(std::move(callback));
+    running = true;
+    thread = std::thread(&SpeechOnsetMonitor::monitorLoop, this);
+    return true;
+}
+
+void SpeechOnsetMonitor::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+        capture->release();
+    }
+}
+
+bool SpeechOnsetMonitor::isRunning() const {
+    return running;
+}
+
+void SpeechOnsetMonitor::monitorLoop() {
+    while (running) {
+        AudioData audio = capture->captureAudio();
+        if (!audio.data) {
+            std::this_thread::sleep_for(IDLE_POLL);
+            continue;
+        }
+        preprocessor->detectVoice(audio);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef SPEECHONSETMONITOR_H
+#define SPEECHONSETMONITOR_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+class AudioPreprocessor;
+class IAudioCapture;
+
+/**
+ * 语音起点监听 - 常驻线程从音频捕获器取块，经 AudioPreprocessor::detectVoice 检测语音起点并回调
+ * 只做检测，不保存也不输出音频；用于把讲解开始的时刻作为实时取样的额外触发
+ * 捕获器的 captureAudio 须为非阻塞（无数据时返回空块），线程在无数据时短暂休眠
+ */
+class SpeechOnsetMonitor {
+public:
+    // 参数为起点时间（秒，从 start 开始计）；在监听线程上调用
+    using OnsetCallback = std::function<void(double)>;
+
+    explicit SpeechOnsetMonitor(std::unique_ptr<IAudioCapture> capture);
+    ~SpeechOnsetMonitor();
+
+    // 初始化捕获器并启动监听线程；捕获器不可用时返回 false
+    bool start(OnsetCallback callback);
+
+    // 停止监听线程并释放捕获器
+    void stop();
+
+    bool isRunning() const;
+
+private:
+    void monitorLoop();
+
+    std::unique_ptr<IAudioCapture> capture;
+    std::unique_ptr<AudioPreprocessor> preprocessor;
+    std::thread thread;
+    std::atomic<bool> running;
+};
+
+#endif // SPEECHONSETMONITOR_H
@@ -0,0 +1,107 @@
+#include "TileChangeMap.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const uint64_t HASH_SEED = 0x9E3779B97F4A7C15ULL;
+const uint64_t HASH_MULTIPLIER = 0xFF51AFD7ED558CCDULL;
+
+inline uint64_t mix(uint64_t hash, uint64_t value) {
+    hash ^= value;
+    hash *= HASH_MULTIPLIER;
+    return hash ^ (hash >> 32);
+}
+
+} // namespace
+
+double TileChangeMap::Result::boundsFraction(int frameWidth, int frameHeight) const {
+    if (!valid || frameWidth <= 0 || frameHeight <= 0) {
+        return 1.0;
+    }
+    return static_cast<double>(bounds.width) * bounds.height / (static_cast<double>(frameWidth) * frameHeight);
+}
+
+uint64_t TileChangeMap::hashTile(const FrameData& frame, int x0, int y0, int tileWidth, int tileHeight) {
+    // 每次取 8 字节混入哈希，图块行尾不足 8 字节的部分补零
+    const int bytesPerPixel = pixelFormatBytesPerPixel(frame.format);
+    const size_t rowBytes = static_cast<size_t>(tileWidth) * bytesPerPixel;
+    uint64_t hash = HASH_SEED;
+    for (int y = 0; y < tileHeight; ++y) {
+        const uint8_t* row = frame.data + static_cast<size_t>(y0 + y) * frame.stride
+                           + static_cast<size_t>(x0) * bytesPerPixel;
+        size_t i = 0;
+        for (; i + 8 <= rowBytes; i += 8) {
+            uint64_t word;
+            memcpy(&word, row + i, sizeof(word));
+            hash = mix(hash, word);
+        }
+        if (i < rowBytes) {
+            uint64_t word = 0;
+            memcpy(&word, row + i, rowBytes - i);
+            hash = mix(hash, word);
+        }
+    }
+    return hash;
+}
+
+TileChangeMap::Result TileChangeMap::update(const FrameData& frame) {
+    Result result;
+    if (!frame.data || frame.width <= 0 || frame.height <= 0 || pixelFormatIsYuv(frame.format)) {
+        return result;
+    }
+
+    const int columns = (frame.width + TILE_SIZE - 1) / TILE_SIZE;
+    const int rows = (frame.height + TILE_SIZE - 1) / TILE_SIZE;
+    std::vector<uint64_t> current(static_cast<size_t>(columns) * rows);
+    for (int ty = 0; ty < rows; ++ty) {
+        const int y0 = ty * TILE_SIZE;
+        const int tileHeight = std::min(TILE_SIZE, frame.height - y0);
+        for (int tx = 0; tx < columns; ++tx) {
+            const int x0 = tx * TILE_SIZE;
+            current[static_cast<size_t>(ty) * columns + tx] =
+                hashTile(frame, x0, y0, std::min(TILE_SIZE, frame.width - x0), tileHeight);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    result.totalTiles = columns * rows;
+    result.valid = !hashes.empty() && width == frame.width && height == frame.height && format == frame.format;
+    if (result.valid) {
+        int minX = columns, minY = rows, maxX = -1, maxY = -1;
+        for (int ty = 0; ty < rows; ++ty) {
+            for (int tx = 0; tx < columns; ++tx) {
+                const size_t index = static_cast<size_t>(ty) * columns + tx;
+                if (current[index] != hashes[index]) {
+                    result.changedTiles++;
+                    minX = std::min(minX, tx);
+                    minY = std::min(minY, ty);
+                    maxX = std::max(maxX, tx);
+                    maxY = std::max(maxY, ty);
+                }
+            }
+        }
+        if (result.changedTiles > 0) {
+            result.bounds.x = minX * TILE_SIZE;
+            result.bounds.y = minY * TILE_SIZE;
+            result.bounds.width = std::min(frame.width, (maxX + 1) * TILE_SIZE) - result.bounds.x;
+            result.bounds.height = std::min(frame.height, (maxY + 1) * TILE_SIZE) - result.bounds.y;
+        }
+    } else {
+        result.changedTiles = result.totalTiles;
+        result.bounds = {0, 0, frame.width, frame.height};
+    }
+
+    hashes.swap(current);
+    width = frame.width;
+    height = frame.height;
+    format = frame.format;
+    return result;
+}
+
+void TileChangeMap::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    hashes.clear();
+    width = 0;
+    height = 0;
+}
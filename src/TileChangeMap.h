@@ -0,0 +1,49 @@
+#ifndef TILECHANGEMAP_H
+#define TILECHANGEMAP_H
+
+#include "DataTypes.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * 分块变化图 - 按固定大小的图块计算内容哈希，与上一次提交的帧逐块比较
+ * 得到变化图块数与变化区域的外接矩形；每次 update 后当前帧成为新的参考帧
+ * 只适用于打包 RGB 格式（AI 上传路径解码得到的 BGRA32），可跨线程调用
+ */
+class TileChangeMap {
+public:
+    static const int TILE_SIZE = 64;
+
+    struct Result {
+        bool valid = false;         // 有参考帧且尺寸一致时为 true（否则视为整帧变化）
+        int changedTiles = 0;
+        int totalTiles = 0;
+        CaptureRect bounds = {0, 0, 0, 0};  // 变化图块的外接矩形（像素，已裁到帧内）
+
+        double changedFraction() const {
+            return totalTiles > 0 ? static_cast<double>(changedTiles) / totalTiles : 1.0;
+        }
+        // 外接矩形面积占整帧的比例
+        double boundsFraction(int frameWidth, int frameHeight) const;
+    };
+
+    TileChangeMap() = default;
+
+    // 与参考帧比较并把 frame 设为新的参考帧
+    Result update(const FrameData& frame);
+
+    // 丢弃参考帧，下一次 update 视为整帧变化
+    void reset();
+
+private:
+    static uint64_t hashTile(const FrameData& frame, int x0, int y0, int width, int height);
+
+    std::mutex mutex;
+    std::vector<uint64_t> hashes;
+    int width = 0;
+    int height = 0;
+    PixelFormat format = PixelFormat::BGRA32;
+};
+
+#endif // TILECHANGEMAP_H
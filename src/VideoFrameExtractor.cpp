@@ -1,42 +1,90 @@
 #include "VideoFrameExtractor.h"
+#include "FFmpegLocator.h"
 #include <QStandardPaths>
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QDebug>
 #include <QRegularExpression>
+#include <QBuffer>
+#include <QImage>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// 采样帧的 JPEG 质量（接近 ffmpeg -q:v 2）
+const int JPEG_QUALITY = 90;
+
+// PPM 头最长字节数（"P6\n<宽> <高>\n255\n"），超过仍未解析出来视为数据错乱
+const int MAX_PPM_HEADER = 64;
+
+// 解析 PPM（P6）头：返回头部字节数，数据不足时返回 0，格式不符时返回 -1
+int parsePpmHeader(const QByteArray &data, int &width, int &height) {
+    if (data.size() < 2) {
+        return 0;
+    }
+    if (data[0] != 'P' || data[1] != '6') {
+        return -1;
+    }
+    // 依次读取宽、高、最大值三个十进制字段，字段间为空白；最大值后紧跟一个空白字节
+    int fields[3] = {0, 0, 0};
+    int pos = 2;
+    for (int &field : fields) {
+        while (pos < data.size() && isspace(static_cast<unsigned char>(data[pos]))) {
+            ++pos;
+        }
+        const int begin = pos;
+        while (pos < data.size() && isdigit(static_cast<unsigned char>(data[pos]))) {
+            field = field * 10 + (data[pos] - '0');
+            ++pos;
+        }
+        if (pos >= data.size()) {
+            return data.size() >= MAX_PPM_HEADER ? -1 : 0;
+        }
+        if (pos == begin) {
+            return -1;
+        }
+    }
+    if (fields[0] <= 0 || fields[1] <= 0 || fields[2] != 255) {
+        return -1;
+    }
+    width = fields[0];
+    height = fields[1];
+    return pos + 1;
+}
+
+// 采样帧编码为 JPEG（RGB24 内存布局即 QImage::Format_RGB888）
+QByteArray encodeFrameJpeg(const FrameData &frame) {
+    QByteArray jpegData;
+    const QImage image(frame.data, frame.width, frame.height, frame.stride, QImage::Format_RGB888);
+    QBuffer buffer(&jpegData);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "JPEG", JPEG_QUALITY)) {
+        jpegData.clear();
+    }
+    return jpegData;
+}
+
+} // namespace
 
 VideoFrameExtractor::VideoFrameExtractor(QObject *parent)
     : QObject(parent)
     , ffmpegProcess(nullptr)
-    , tempDir(nullptr)
+    , probedFrames(0)
     , targetFrameRate(30)
     , isExtracting(false)
 {
-    setupTempDirectory();
 }
 
 VideoFrameExtractor::~VideoFrameExtractor() {
     cleanup();
 }
 
-void VideoFrameExtractor::setupTempDirectory() {
-    if (tempDir) {
-        delete tempDir;
-    }
-    
-    tempDir = new QTemporaryDir();
-    if (!tempDir->isValid()) {
-        qWarning() << "Failed to create temporary directory";
-    }
-}
-
 void VideoFrameExtractor::extractFrames(const QString &videoPath, int frameRate) {
-    // 默认使用智能间隔：10秒间隔，但对于短视频使用2.0秒
-    // 这里我们暂时使用2.0秒，具体的智能判断在实时提取器中实现
-    extractFrames(videoPath, 2.0, frameRate);
+    extractFrames(videoPath, AdaptiveFrameSampler::Config(), frameRate);
 }
 
-void VideoFrameExtractor::extractFrames(const QString &videoPath, double intervalSeconds, int frameRate) {
+void VideoFrameExtractor::extractFrames(const QString &videoPath, const AdaptiveFrameSampler::Config &samplerConfig, int frameRate) {
     if (isExtracting) {
         emit frameExtractionFinished(false, "正在提取其他视频的帧，请等待完成");
         return;
@@ -47,33 +95,30 @@ void VideoFrameExtractor::extractFrames(const QString &videoPath, double interva
         return;
     }
     
-    QString ffmpegPath = findFFmpegPath();
+    QString ffmpegPath = FFmpegLocator::instance().ffmpegPath();
     if (ffmpegPath.isEmpty()) {
         emit frameExtractionFinished(false, "未找到FFmpeg，请确保已安装FFmpeg");
         return;
     }
     
-    if (!tempDir || !tempDir->isValid()) {
-        setupTempDirectory();
-        if (!tempDir || !tempDir->isValid()) {
-            emit frameExtractionFinished(false, "无法创建临时目录");
-            return;
-        }
-    }
-    
     // 清理之前的结果
     extractedFrames.clear();
+    pendingOutput.clear();
+    probedFrames = 0;
+    sampler.setConfig(samplerConfig);
+    sampler.reset();
     currentVideoPath = videoPath;
     targetFrameRate = frameRate;
     isExtracting = true;
     
-    // 计算帧提取间隔
-    // 使用传入的间隔参数
-    double interval = intervalSeconds;
-    
-    qDebug() << QString("使用帧提取间隔: %1秒").arg(interval);
+    // FFmpeg 按探测间隔输出帧，是否保留由采样器决定
+    const double interval = samplerConfig.probeIntervalSeconds;
     
-    QString outputPattern = tempDir->path() + "/frame_%04d.jpg";
+    qDebug() << QString("帧探测间隔: %1秒, 采样间隔: %2~%3秒, 帧预算: %4")
+                .arg(interval)
+                .arg(samplerConfig.minIntervalSeconds)
+                .arg(samplerConfig.maxIntervalSeconds)
+                .arg(samplerConfig.totalFrameBudget);
     
     // 创建FFmpeg进程
     if (ffmpegProcess) {
@@ -85,14 +130,17 @@ void VideoFrameExtractor::extractFrames(const QString &videoPath, double interva
             this, &VideoFrameExtractor::onProcessFinished);
     connect(ffmpegProcess, &QProcess::errorOccurred,
             this, &VideoFrameExtractor::onProcessError);
+    connect(ffmpegProcess, &QProcess::readyReadStandardOutput,
+            this, &VideoFrameExtractor::onReadyReadOutput);
     
     // 构建FFmpeg命令
     QStringList arguments;
+    // 探测帧以未压缩的 PPM 输出：采样器直接取像素，只有采样帧才编码 JPEG，探测帧不再逐帧压缩再解码
     arguments << "-i" << videoPath
-             << "-vf" << QString("fps=1/%1").arg(interval) // 每2.0秒提取一帧
-             << "-q:v" << "2" // 高质量JPEG
-             << "-f" << "image2"
-             << outputPattern;
+             << "-vf" << QString("fps=1/%1").arg(interval)
+             << "-c:v" << "ppm"
+             << "-f" << "image2pipe" // 逐帧写到标准输出，不落盘
+             << "pipe:1";
     
     qDebug() << "Starting FFmpeg with command:" << ffmpegPath << arguments.join(" ");
     
@@ -113,17 +161,19 @@ void VideoFrameExtractor::onProcessFinished(int exitCode, QProcess::ExitStatus e
         return;
     }
     
-    // 扫描生成的图片文件
-    QDir dir(tempDir->path());
-    QStringList filters;
-    filters << "frame_*.jpg";
-    QStringList frameFiles = dir.entryList(filters, QDir::Files, QDir::Name);
-    
-    extractedFrames.clear();
-    for (const QString &fileName : frameFiles) {
-        extractedFrames.append(dir.absoluteFilePath(fileName));
+    // 取走管道中剩余的数据
+    pendingOutput.append(ffmpegProcess->readAllStandardOutput());
+    takeCompleteFrames();
+    if (!pendingOutput.isEmpty()) {
+        qWarning() << "FFmpeg 输出末尾有不完整的帧数据:" << pendingOutput.size() << "字节";
+        pendingOutput.clear();
     }
     
+    const AdaptiveFrameSampler::Stats stats = sampler.stats();
+    qDebug() << QString("探测 %1 帧，采样 %2 帧 (场景变化 %3, 最大间隔 %4, 受预算限制 %5 次)")
+                .arg(stats.probes).arg(stats.samples).arg(stats.sceneChanges)
+                .arg(stats.forcedSamples).arg(stats.budgetLimited);
+    
     if (extractedFrames.isEmpty()) {
         emit frameExtractionFinished(false, "未能提取到任何视频帧");
     } else {
@@ -159,29 +209,67 @@ void VideoFrameExtractor::onProcessError(QProcess::ProcessError error) {
     emit frameExtractionFinished(false, errorMessage);
 }
 
-QString VideoFrameExtractor::findFFmpegPath() const {
-    // 常见的FFmpeg安装路径
-    QStringList possiblePaths = {
-        "ffmpeg", // 系统PATH中
-        "C:/ffmpeg/bin/ffmpeg.exe",
-        "C:/Program Files/ffmpeg/bin/ffmpeg.exe",
-        "C:/Program Files (x86)/ffmpeg/bin/ffmpeg.exe",
-        QCoreApplication::applicationDirPath() + "/ffmpeg.exe",
-        QCoreApplication::applicationDirPath() + "/tools/ffmpeg.exe"
-    };
-    
-    for (const QString &path : possiblePaths) {
-        QProcess testProcess;
-        testProcess.start(path, QStringList() << "-version");
-        if (testProcess.waitForFinished(3000) && testProcess.exitCode() == 0) {
-            return path;
+void VideoFrameExtractor::onReadyReadOutput() {
+    if (!ffmpegProcess) {
+        return;
+    }
+    pendingOutput.append(ffmpegProcess->readAllStandardOutput());
+    takeCompleteFrames();
+}
+
+void VideoFrameExtractor::takeCompleteFrames() {
+    int offset = 0;
+    while (true) {
+        int width = 0;
+        int height = 0;
+        const int headerBytes = parsePpmHeader(pendingOutput.mid(offset, MAX_PPM_HEADER), width, height);
+        if (headerBytes < 0) {
+            // 管道数据不是预期的 PPM 帧，无法重新同步：结束进程，由 onProcessFinished 报告失败
+            qWarning() << "FFmpeg 输出的帧数据无法解析，丢弃" << pendingOutput.size() - offset << "字节";
+            pendingOutput.clear();
+            if (ffmpegProcess && ffmpegProcess->state() != QProcess::NotRunning) {
+                ffmpegProcess->kill();
+            }
+            return;
+        }
+        const qint64 frameBytes = static_cast<qint64>(width) * height * 3;
+        if (headerBytes == 0 || pendingOutput.size() - offset < headerBytes + frameBytes) {
+            break;
+        }
+        
+        // 不持有缓冲的视图：直接借用管道数据
+        FrameData pixels;
+        pixels.data = reinterpret_cast<uint8_t *>(pendingOutput.data()) + offset + headerBytes;
+        pixels.size = static_cast<size_t>(frameBytes);
+        pixels.width = width;
+        pixels.height = height;
+        pixels.stride = width * 3;
+        pixels.format = PixelFormat::RGB24;
+        offset += headerBytes + static_cast<int>(frameBytes);
+        
+        const double timestamp = probedFrames * sampler.config().probeIntervalSeconds;
+        probedFrames++;
+        if (!sampler.offer(pixels, timestamp).sample) {
+            continue;
         }
+        
+        EncodedFrame frame;
+        frame.jpegData = encodeFrameJpeg(pixels);
+        frame.timestamp = timestamp;
+        if (frame.jpegData.isEmpty()) {
+            qWarning() << QString("第 %1 秒的采样帧编码 JPEG 失败").arg(timestamp);
+            continue;
+        }
+        frame.index = extractedFrames.size() + 1;
+        if (!debugDumpDirectory.isEmpty()) {
+            frame.dumpTo(debugDumpDirectory, "frame");
+        }
+        extractedFrames.append(frame);
     }
-    
-    return QString(); // 未找到
+    pendingOutput.remove(0, offset);
 }
 
-QStringList VideoFrameExtractor::getExtractedFrames() const {
+QList<EncodedFrame> VideoFrameExtractor::getExtractedFrames() const {
     return extractedFrames;
 }
 
@@ -192,13 +280,9 @@ void VideoFrameExtractor::cleanup() {
     }
     
     extractedFrames.clear();
-    
-    if (tempDir) {
-        delete tempDir;
-        tempDir = nullptr;
-    }
+    pendingOutput.clear();
 }
 
-QString VideoFrameExtractor::getTempDir() const {
-    return tempDir ? tempDir->path() : QString();
+void VideoFrameExtractor::setDebugDumpDirectory(const QString &directory) {
+    debugDumpDirectory = directory;
 }
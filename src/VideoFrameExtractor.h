@@ -6,9 +6,14 @@
 #include <QStringList>
 #include <QProcess>
 #include <QTimer>
-#include <QDir>
-#include <QTemporaryDir>
+#include "EncodedFrame.h"
+#include "AdaptiveFrameSampler.h"
 
+/**
+ * 视频帧提取器 - 用 FFmpeg 按探测间隔解码已录制的视频，由 AdaptiveFrameSampler 按画面变化挑选帧
+ * FFmpeg 以 image2pipe 把未压缩的 PPM（RGB24）写到标准输出，采样器直接在原始像素上生成亮度代理图，
+ * 只有被采样的帧才在进程内编码为 JPEG；未被采样的探测帧不编码、随即释放，不使用临时目录
+ */
 class VideoFrameExtractor : public QObject {
     Q_OBJECT
     
@@ -16,20 +21,20 @@ public:
     explicit VideoFrameExtractor(QObject *parent = nullptr);
     ~VideoFrameExtractor();
     
-    // 提取视频帧
+    // 提取视频帧（默认采样参数）
     void extractFrames(const QString &videoPath, int frameRate = 30);
     
-    // 提取视频帧（支持自定义间隔）
-    void extractFrames(const QString &videoPath, double intervalSeconds, int frameRate = 30);
+    // 提取视频帧（自定义采样参数）
+    void extractFrames(const QString &videoPath, const AdaptiveFrameSampler::Config &samplerConfig, int frameRate = 30);
     
-    // 获取提取的帧图片路径列表
-    QStringList getExtractedFrames() const;
+    // 获取提取的帧（内存 JPEG）
+    QList<EncodedFrame> getExtractedFrames() const;
     
-    // 清理临时文件
+    // 停止进程并释放已提取的帧
     void cleanup();
     
-    // 获取临时目录路径
-    QString getTempDir() const;
+    // 调试用：把提取的帧另存到该目录（空字符串关闭，默认关闭）
+    void setDebugDumpDirectory(const QString &directory);
 
 signals:
     void frameExtractionFinished(bool success, const QString &message);
@@ -38,15 +43,19 @@ signals:
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onProcessError(QProcess::ProcessError error);
+    void onReadyReadOutput();
     
 private:
-    QString findFFmpegPath() const;
-    void setupTempDirectory();
+    // 从 pendingOutput 中切出完整的 PPM 帧交给采样器
+    void takeCompleteFrames();
     
     QProcess *ffmpegProcess;
-    QTemporaryDir *tempDir;
-    QStringList extractedFrames;
+    QList<EncodedFrame> extractedFrames;
+    QByteArray pendingOutput;   // 尚未组成完整 PPM 帧的标准输出数据
     QString currentVideoPath;
+    QString debugDumpDirectory;
+    AdaptiveFrameSampler sampler;
+    int probedFrames;
     int targetFrameRate;
     bool isExtracting;
 };
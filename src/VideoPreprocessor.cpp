@@ -0,0 +1,376 @@
+// VideoPreprocessor.cpp
+// 视频预处理实现：色彩空间转换、缩放、鼠标光标/点击高亮叠加
+#include "VideoPreprocessor.h"
+#include "CpuFeatures.h"
+#include "FrameScaler.h"
+#include "PixelConverter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 精确的 x/255 四舍五入（x <= 255*255 时与 (x + 127) / 255 结果一致）
+inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// 预乘 alpha 的 over 混合：dst = src + dst * (255 - srcA) / 255
+// 所有实现使用同一套整数公式，SIMD 与标量结果逐字节一致
+void blendRowScalar(uint8_t *dst, const uint8_t *src, int count) {
+    for (int i = 0; i < count; ++i, dst += 4, src += 4) {
+        const uint32_t inv = 255 - src[3];
+        for (int c = 0; c < 4; ++c) {
+            uint32_t v = src[c] + div255(dst[c] * inv);
+            dst[c] = static_cast<uint8_t>(v > 255 ? 255 : v);
+        }
+    }
+}
+
+#if defined(AICP_X86)
+void blendRowSSE2(uint8_t *dst, const uint8_t *src, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i bias = _mm_set1_epi16(128);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i * 4));
+        // 把每个像素的 alpha 广播到 4 个通道，再取 255 - alpha
+        __m128i a = _mm_srli_epi32(s, 24);
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+        __m128i inv = _mm_xor_si128(a, ones);
+
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(inv, zero));
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(inv, zero));
+        lo = _mm_add_epi16(lo, bias);
+        hi = _mm_add_epi16(hi, bias);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+        __m128i out = _mm_adds_epu8(_mm_packus_epi16(lo, hi), s);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), out);
+    }
+    blendRowScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+AICP_TARGET_AVX2
+void blendRowAVX2(uint8_t *dst, const uint8_t *src, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(-1);
+    const __m256i bias = _mm256_set1_epi16(128);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i * 4));
+        __m256i a = _mm256_srli_epi32(s, 24);
+        a = _mm256_or_si256(a, _mm256_slli_epi32(a, 8));
+        a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+        __m256i inv = _mm256_xor_si256(a, ones);
+
+        // unpack/pack 都按 128 位通道进行，顺序互相抵消，无需额外重排
+        __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(inv, zero));
+        __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(inv, zero));
+        lo = _mm256_add_epi16(lo, bias);
+        hi = _mm256_add_epi16(hi, bias);
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+
+        __m256i out = _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), s);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), out);
+    }
+    blendRowSSE2(dst + i * 4, src + i * 4, count - i);
+}
+#endif
+
+using BlendRowFn = void (*)(uint8_t *, const uint8_t *, int);
+
+BlendRowFn selectBlendRow() {
+#if defined(AICP_X86)
+    if (CpuFeatures::hasAVX2()) {
+        return blendRowAVX2;
+    }
+    return blendRowSSE2;
+#else
+    return blendRowScalar;
+#endif
+}
+
+const BlendRowFn blendRow = selectBlendRow();
+
+// 预乘颜色叠加到叠加图像素上（叠加图内部合成用，非热路径）
+inline uint32_t overPremultiplied(uint32_t dst, uint32_t src) {
+    uint8_t d[4], s[4];
+    memcpy(d, &dst, 4);
+    memcpy(s, &src, 4);
+    blendRowScalar(d, s, 1);
+    uint32_t out;
+    memcpy(&out, d, 4);
+    return out;
+}
+
+// 预乘叠加图像素 -> 非预乘 RGB 对应的 YUV（按转换器的矩阵与范围，与录制画面的转换一致）
+inline void spritePixelToYuv(const PixelConverter &converter, uint32_t px, int &y, int &u, int &v) {
+    const uint32_t a = px >> 24;
+    int b = px & 0xFF;
+    int g = (px >> 8) & 0xFF;
+    int r = (px >> 16) & 0xFF;
+    if (a > 0 && a < 255) {
+        b = std::min<int>(255, (b * 255 + a / 2) / a);
+        g = std::min<int>(255, (g * 255 + a / 2) / a);
+        r = std::min<int>(255, (r * 255 + a / 2) / a);
+    }
+    converter.convertPixel(r, g, b, y, u, v);
+}
+
+inline uint8_t blendChannel(int base, int over, uint32_t alpha) {
+    return static_cast<uint8_t>(div255(over * alpha + base * (255 - alpha)));
+}
+
+} // namespace
+
+FrameData VideoPreprocessor::convertColorSpace(const FrameData& frame, PixelFormat targetFormat) {
+    return PixelConverter(colorMatrix, colorRange).convert(frame, targetFormat);
+}
+
+void VideoPreprocessor::setColorSpec(YuvMatrix matrix, YuvRange range) {
+    colorMatrix = matrix;
+    colorRange = range;
+}
+
+FrameData VideoPreprocessor::scaleFrame(const FrameData& frame, int width, int height) {
+    return FrameScaler::scale(frame, width, height, scaleFilter);
+}
+
+FrameData VideoPreprocessor::preprocess(const FrameData& frame, const CaptureRect& crop, int width, int height,
+                                        PixelFormat targetFormat) {
+    // 裁剪只是零拷贝视图，真正的读写都在 scaleConvert 的一趟里完成
+    const FrameData source = crop.width > 0 && crop.height > 0 ? frame.cropView(crop) : frame;
+    FrameData result;
+    result.timestamp = frame.timestamp;
+    result.unchanged = source.unchanged;
+    if (source.unchanged || !source.data || source.width <= 0 || source.height <= 0) {
+        return result;
+    }
+    width = width > 0 ? width : source.width;
+    height = height > 0 ? height : source.height;
+    if (width == source.width && height == source.height && targetFormat == source.format) {
+        return source;
+    }
+    if (!result.allocateImage(width, height, targetFormat)) {
+        return result;
+    }
+    FrameScaler::scaleConvert(source, result, scaleFilter, PixelConverter(colorMatrix, colorRange));
+    return result;
+}
+
+void VideoPreprocessor::setScaleFilter(ScaleFilter filter) {
+    scaleFilter = filter;
+}
+
+FrameData VideoPreprocessor::overlayMouseEffect(const FrameData& frame, const CapturePoint& mousePos) {
+    FrameData result = frame;
+    result.makeWritable();
+    overlayMouseEffectInPlace(result, mousePos, false);
+    return result;
+}
+
+void VideoPreprocessor::setCursorImage(const CursorImage& newCursor) {
+    if (newCursor.serial == cursor.serial && newCursor.width == cursor.width &&
+        newCursor.height == cursor.height && spriteValid) {
+        return;
+    }
+    cursor = newCursor;
+    spriteValid = false;
+}
+
+void VideoPreprocessor::setClickHighlight(bool enabled, uint32_t color, int radius) {
+    highlightEnabled = enabled;
+    highlightColor = color;
+    highlightRadius = std::max(1, radius);
+    spriteValid = false;
+}
+
+void VideoPreprocessor::rebuildOverlaySprite(bool pressed) {
+    const bool drawHighlight = highlightEnabled && pressed;
+    const bool hasCursor = cursor.width > 0 && cursor.height > 0 &&
+                           cursor.pixels.size() >= static_cast<size_t>(cursor.width) * cursor.height;
+
+    spritePressed = pressed;
+    spriteValid = true;
+    overlaySprite.clear();
+    spriteWidth = spriteHeight = 0;
+    if (!hasCursor && !drawHighlight) {
+        return;
+    }
+
+    // 叠加图包围盒（相对热点）：光标矩形与高亮圆的并集
+    int left = 0, top = 0, right = 0, bottom = 0;
+    bool empty = true;
+    auto unite = [&](int l, int t, int r, int b) {
+        if (empty) {
+            left = l; top = t; right = r; bottom = b;
+            empty = false;
+        } else {
+            left = std::min(left, l); top = std::min(top, t);
+            right = std::max(right, r); bottom = std::max(bottom, b);
+        }
+    };
+    if (drawHighlight) {
+        unite(-highlightRadius - 1, -highlightRadius - 1, highlightRadius + 2, highlightRadius + 2);
+    }
+    if (hasCursor) {
+        unite(-cursor.xhot, -cursor.yhot, cursor.width - cursor.xhot, cursor.height - cursor.yhot);
+    }
+
+    spriteOriginX = left;
+    spriteOriginY = top;
+    spriteWidth = right - left;
+    spriteHeight = bottom - top;
+    overlaySprite.assign(static_cast<size_t>(spriteWidth) * spriteHeight, 0);
+
+    if (drawHighlight) {
+        // 抗锯齿实心圆，先转为预乘颜色
+        const uint32_t ca = highlightColor >> 24;
+        const uint32_t cr = (highlightColor >> 16) & 0xFF;
+        const uint32_t cg = (highlightColor >> 8) & 0xFF;
+        const uint32_t cb = highlightColor & 0xFF;
+        for (int y = 0; y < spriteHeight; ++y) {
+            for (int x = 0; x < spriteWidth; ++x) {
+                const double dx = x + spriteOriginX + 0.5;
+                const double dy = y + spriteOriginY + 0.5;
+                const double coverage = std::clamp(highlightRadius - std::sqrt(dx * dx + dy * dy) + 0.5, 0.0, 1.0);
+                if (coverage <= 0.0) {
+                    continue;
+                }
+                const uint32_t a = static_cast<uint32_t>(ca * coverage + 0.5);
+                overlaySprite[static_cast<size_t>(y) * spriteWidth + x] =
+                    (a << 24) | (div255(cr * a) << 16) | (div255(cg * a) << 8) | div255(cb * a);
+            }
+        }
+    }
+
+    if (hasCursor) {
+        const int offsetX = -cursor.xhot - spriteOriginX;
+        const int offsetY = -cursor.yhot - spriteOriginY;
+        for (int y = 0; y < cursor.height; ++y) {
+            for (int x = 0; x < cursor.width; ++x) {
+                uint32_t &dst = overlaySprite[static_cast<size_t>(y + offsetY) * spriteWidth + x + offsetX];
+                dst = overPremultiplied(dst, cursor.pixels[static_cast<size_t>(y) * cursor.width + x]);
+            }
+        }
+    }
+}
+
+CaptureRect VideoPreprocessor::mouseEffectRect(const FrameData& frame, const CapturePoint& mousePos, bool pressed) {
+    CaptureRect rect{0, 0, 0, 0};
+    if (!frame.data || frame.width <= 0 || frame.height <= 0) {
+        return rect;
+    }
+    if (frame.format != PixelFormat::BGRA32 && frame.format != PixelFormat::YUV420P) {
+        return rect;
+    }
+
+    if (!spriteValid || (highlightEnabled && pressed != spritePressed)) {
+        rebuildOverlaySprite(pressed);
+    }
+    if (overlaySprite.empty()) {
+        return rect;
+    }
+
+    // 叠加图裁剪到帧范围内
+    const int dstX = mousePos.x + spriteOriginX;
+    const int dstY = mousePos.y + spriteOriginY;
+    const int x0 = std::max(0, dstX);
+    const int y0 = std::max(0, dstY);
+    const int x1 = std::min(frame.width, dstX + spriteWidth);
+    const int y1 = std::min(frame.height, dstY + spriteHeight);
+    if (x1 > x0 && y1 > y0) {
+        rect = {x0, y0, x1 - x0, y1 - y0};
+    }
+    return rect;
+}
+
+CaptureRect VideoPreprocessor::overlayMouseEffectInPlace(FrameData& frame, const CapturePoint& mousePos, bool pressed) {
+    const CaptureRect touched = mouseEffectRect(frame, mousePos, pressed);
+    if (touched.width <= 0 || touched.height <= 0) {
+        return touched;
+    }
+    const int dstX = mousePos.x + spriteOriginX;
+    const int dstY = mousePos.y + spriteOriginY;
+    const int x0 = touched.x;
+    const int y0 = touched.y;
+    const int x1 = touched.x + touched.width;
+    const int y1 = touched.y + touched.height;
+
+    const uint32_t *sprite = overlaySprite.data();
+    if (frame.format == PixelFormat::BGRA32) {
+        const int stride = frame.planeStride(0);
+        for (int y = y0; y < y1; ++y) {
+            uint8_t *dstRow = frame.data + static_cast<size_t>(y) * stride + x0 * 4;
+            const uint32_t *srcRow = sprite + static_cast<size_t>(y - dstY) * spriteWidth + (x0 - dstX);
+            blendRow(dstRow, reinterpret_cast<const uint8_t *>(srcRow), x1 - x0);
+        }
+        return touched;
+    }
+
+    // YUV420P：亮度逐像素混合，色度按 2x2 块平均 alpha 混合；颜色按 setColorSpec 设置的色彩规格换算
+    const PixelConverter converter(colorMatrix, colorRange);
+    const int yStride = frame.planeStride(0);
+    uint8_t *yPlane = frame.plane(0);
+    uint8_t *uPlane = frame.plane(1);
+    uint8_t *vPlane = frame.plane(2);
+    const int uStride = frame.planeStride(1);
+    const int vStride = frame.planeStride(2);
+
+    for (int y = y0; y < y1; ++y) {
+        uint8_t *row = yPlane + static_cast<size_t>(y) * yStride;
+        const uint32_t *srcRow = sprite + static_cast<size_t>(y - dstY) * spriteWidth - dstX;
+        for (int x = x0; x < x1; ++x) {
+            const uint32_t px = srcRow[x];
+            const uint32_t a = px >> 24;
+            if (a == 0) {
+                continue;
+            }
+            int sy, su, sv;
+            spritePixelToYuv(converter, px, sy, su, sv);
+            row[x] = blendChannel(row[x], sy, a);
+        }
+    }
+
+    for (int cy = y0 / 2; cy <= (y1 - 1) / 2; ++cy) {
+        for (int cx = x0 / 2; cx <= (x1 - 1) / 2; ++cx) {
+            uint32_t alphaSum = 0;
+            int uSum = 0, vSum = 0;
+            for (int sy = cy * 2; sy < cy * 2 + 2; ++sy) {
+                for (int sx = cx * 2; sx < cx * 2 + 2; ++sx) {
+                    if (sx < x0 || sx >= x1 || sy < y0 || sy >= y1) {
+                        continue;
+                    }
+                    const uint32_t px = sprite[static_cast<size_t>(sy - dstY) * spriteWidth + (sx - dstX)];
+                    const uint32_t a = px >> 24;
+                    if (a == 0) {
+                        continue;
+                    }
+                    int py, pu, pv;
+                    spritePixelToYuv(converter, px, py, pu, pv);
+                    alphaSum += a;
+                    uSum += pu * static_cast<int>(a);
+                    vSum += pv * static_cast<int>(a);
+                }
+            }
+            if (alphaSum == 0) {
+                continue;
+            }
+            const int meanU = (uSum + static_cast<int>(alphaSum) / 2) / static_cast<int>(alphaSum);
+            const int meanV = (vSum + static_cast<int>(alphaSum) / 2) / static_cast<int>(alphaSum);
+            const uint32_t meanAlpha = (alphaSum + 2) / 4;
+            uint8_t &u = uPlane[static_cast<size_t>(cy) * uStride + cx];
+            uint8_t &v = vPlane[static_cast<size_t>(cy) * vStride + cx];
+            u = blendChannel(u, meanU, meanAlpha);
+            v = blendChannel(v, meanV, meanAlpha);
+        }
+    }
+    return touched;
+}
@@ -1,9 +1,20 @@
 #include "VideoSummaryManager.h"
+#include "FFmpegLocator.h"
 #include <QDebug>
 #include <QFileInfo>
 #include <QProcess>
 #include <QCoreApplication>
 
+namespace {
+
+// 录制后提取的变化驱动帧预算上限（相当于原固定 10 秒间隔下 1 小时的帧数）
+const int MAX_FRAME_BUDGET = 360;
+
+// 最大采样间隔取 时长 * 该系数 / 预算，即画面全程静止时定期采样约占预算的 1/该系数
+const double FORCED_INTERVAL_BUDGET_FACTOR = 4.0;
+
+} // namespace
+
 VideoSummaryManager::VideoSummaryManager(QObject *parent)
     : QObject(parent)
     , frameExtractor(std::make_unique<VideoFrameExtractor>(this))
@@ -60,12 +71,10 @@ void VideoSummaryManager::startVideoSummary(const QString &videoPath, int frameR
     
     updateProgress("正在提取视频帧...", 10);
     
-    // 智能选择帧提取间隔
-    double extractionInterval = calculateSmartInterval(videoPath);
-    qDebug() << QString("选择帧提取间隔: %1秒").arg(extractionInterval);
+    // 按视频时长确定采样参数，具体取哪些帧由画面变化决定
+    const AdaptiveFrameSampler::Config samplerConfig = samplerConfigFor(probeVideoDuration(videoPath));
     
-    // 开始提取视频帧（使用智能间隔）
-    frameExtractor->extractFrames(videoPath, extractionInterval, frameRate);
+    frameExtractor->extractFrames(videoPath, samplerConfig, frameRate);
 }
 
 void VideoSummaryManager::onFrameExtractionFinished(bool success, const QString &message) {
@@ -78,7 +87,7 @@ void VideoSummaryManager::onFrameExtractionFinished(bool success, const QString
         return;
     }
     
-    QStringList frames = frameExtractor->getExtractedFrames();
+    QList<EncodedFrame> frames = frameExtractor->getExtractedFrames();
     if (frames.isEmpty()) {
         finishWithError("未能提取到任何视频帧");
         return;
@@ -91,7 +100,7 @@ void VideoSummaryManager::onFrameExtractionFinished(bool success, const QString
     updateProgress(QString("开始分析 %1 帧图片...").arg(totalFrames), 20);
     
     // 开始分析图片
-    visionAnalyzer->analyzeImages(frames);
+    visionAnalyzer->analyzeFrames(frames);
 }
 
 void VideoSummaryManager::onImageAnalysisProgress(int current, int total) {
@@ -140,7 +149,7 @@ void VideoSummaryManager::onFinalSummaryGenerated(bool success, const QString &s
         finishWithError(QString("总结生成失败: %1").arg(message));
     }
     
-    // 清理临时文件
+    // 释放已提取的帧
     frameExtractor->cleanup();
 }
 
@@ -182,12 +191,12 @@ void VideoSummaryManager::finishWithError(const QString &message) {
     emit summaryCompleted(false, "", message);
 }
 
-double VideoSummaryManager::calculateSmartInterval(const QString &videoPath) {
-    // 使用FFmpeg获取视频时长
-    QString ffmpegPath = findFFmpegPath();
-    if (ffmpegPath.isEmpty()) {
-        qWarning() << "无法找到FFmpeg，使用默认间隔";
-        return 10.0; // 默认10秒间隔
+double VideoSummaryManager::probeVideoDuration(const QString &videoPath) {
+    // 使用ffprobe获取视频时长
+    QString ffprobePath = FFmpegLocator::instance().ffprobePath();
+    if (ffprobePath.isEmpty()) {
+        qWarning() << "无法找到ffprobe，使用默认采样参数";
+        return 0.0;
     }
     
     QProcess ffprobe;
@@ -197,11 +206,11 @@ double VideoSummaryManager::calculateSmartInterval(const QString &videoPath) {
               << "-of" << "csv=p=0"
               << videoPath;
     
-    ffprobe.start(ffmpegPath.replace("ffmpeg", "ffprobe"), arguments);
+    ffprobe.start(ffprobePath, arguments);
     
     if (!ffprobe.waitForFinished(5000)) {
-        qWarning() << "获取视频时长超时，使用默认间隔";
-        return 10.0;
+        qWarning() << "获取视频时长超时，使用默认采样参数";
+        return 0.0;
     }
     
     QString output = ffprobe.readAllStandardOutput().trimmed();
@@ -209,54 +218,35 @@ double VideoSummaryManager::calculateSmartInterval(const QString &videoPath) {
     double duration = output.toDouble(&ok);
     
     if (!ok || duration <= 0) {
-        qWarning() << "无法解析视频时长，使用默认间隔";
-        return 10.0;
+        qWarning() << "无法解析视频时长，使用默认采样参数";
+        return 0.0;
     }
     
     qDebug() << QString("视频时长: %1秒").arg(duration);
-    
-    // 智能间隔选择逻辑
-    if (duration < 10.0) {
-        // 视频时长小于10秒，使用2秒间隔
-        qDebug() << "视频时长小于10秒，使用2秒间隔";
-        return 2.0;
-    } else {
-        // 视频时长大于等于10秒，使用10秒间隔
-        qDebug() << "视频时长大于等于10秒，使用10秒间隔";
-        return 10.0;
-    }
+    return duration;
 }
 
-QString VideoSummaryManager::findFFmpegPath() const {
-    // 查找FFmpeg可执行文件路径
-    QStringList possiblePaths;
-    
-#ifdef Q_OS_WIN
-    possiblePaths << "ffmpeg.exe"
-                  << "C:/ffmpeg/bin/ffmpeg.exe"
-                  << QCoreApplication::applicationDirPath() + "/ffmpeg.exe"
-                  << QCoreApplication::applicationDirPath() + "/bin/ffmpeg.exe";
-#else
-    possiblePaths << "ffmpeg"
-                  << "/usr/bin/ffmpeg"
-                  << "/usr/local/bin/ffmpeg"
-                  << "/opt/homebrew/bin/ffmpeg"
-                  << QCoreApplication::applicationDirPath() + "/ffmpeg";
-#endif
-    
-    for (const QString &path : possiblePaths) {
-        QFileInfo fileInfo(path);
-        if (fileInfo.exists() && fileInfo.isExecutable()) {
-            return path;
-        }
-        
-        // 尝试在PATH中查找
-        QProcess process;
-        process.start(path, QStringList() << "-version");
-        if (process.waitForFinished(3000) && process.exitCode() == 0) {
-            return path;
-        }
-    }
-    
-    return QString();
+AdaptiveFrameSampler::Config VideoSummaryManager::samplerConfigFor(double durationSeconds) {
+    AdaptiveFrameSampler::Config config;
+    if (durationSeconds <= 0.0) {
+        return config;
+    }
+    
+    if (durationSeconds < 10.0) {
+        // 短视频：每秒探测，变化时最快每秒采样一帧
+        config.probeIntervalSeconds = 1.0;
+        config.minIntervalSeconds = 1.0;
+        config.maxIntervalSeconds = 4.0;
+        config.maxFramesPerMinute = 30.0;
+        config.burstFrames = 5;
+        return config;
+    }
+    
+    // 变化驱动的帧预算：平均每 10 秒一帧（最少 6 帧，最多 MAX_FRAME_BUDGET 帧），按时长均摊到各时段
+    // 最大间隔的定期采样另计，间隔放宽到静止画面的定期采样最多约占预算的 1/4
+    config.totalFrameBudget = qBound(6, static_cast<int>(durationSeconds / 10.0), MAX_FRAME_BUDGET);
+    config.durationSeconds = durationSeconds;
+    config.maxIntervalSeconds = qMax(config.maxIntervalSeconds,
+                                     durationSeconds * FORCED_INTERVAL_BUDGET_FACTOR / config.totalFrameBudget);
+    return config;
 }
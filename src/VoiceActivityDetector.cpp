@@ -0,0 +1,209 @@
+#include "VoiceActivityDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// 语音频带边界：下限低于电话带宽的 300Hz，使男声浊音基频附近的能量也计入，同时仍排除 50/60Hz 工频及其二次谐波
+const double SPEECH_BAND_LOW_HZ = 200.0;
+const double SPEECH_BAND_HIGH_HZ = 3400.0;
+
+// 双二阶滤波器品质因数（巴特沃斯）
+const double BUTTERWORTH_Q = 0.70710678118654752;
+
+// 频带占比的帧间平滑系数：浊音基频与 10ms 帧不同步，单帧占比会在相邻帧间大幅跳动
+const double BAND_RATIO_SMOOTHING = 0.5;
+
+// 防止静音帧取对数时溢出
+const double ENERGY_EPSILON = 1e-12;
+
+} // namespace
+
+VoiceActivityDetector::Biquad VoiceActivityDetector::highPass(double frequency, double sampleRate) {
+    const double w0 = 2.0 * PI * frequency / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * BUTTERWORTH_Q);
+    const double a0 = 1.0 + alpha;
+    Biquad filter;
+    filter.b0 = static_cast<float>((1.0 + cosw) / 2.0 / a0);
+    filter.b1 = static_cast<float>(-(1.0 + cosw) / a0);
+    filter.b2 = filter.b0;
+    filter.a1 = static_cast<float>(-2.0 * cosw / a0);
+    filter.a2 = static_cast<float>((1.0 - alpha) / a0);
+    return filter;
+}
+
+VoiceActivityDetector::Biquad VoiceActivityDetector::lowPass(double frequency, double sampleRate) {
+    const double w0 = 2.0 * PI * frequency / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * BUTTERWORTH_Q);
+    const double a0 = 1.0 + alpha;
+    Biquad filter;
+    filter.b0 = static_cast<float>((1.0 - cosw) / 2.0 / a0);
+    filter.b1 = static_cast<float>((1.0 - cosw) / a0);
+    filter.b2 = filter.b0;
+    filter.a1 = static_cast<float>(-2.0 * cosw / a0);
+    filter.a2 = static_cast<float>((1.0 - alpha) / a0);
+    return filter;
+}
+
+VoiceActivityDetector::VoiceActivityDetector()
+    : rate(0)
+    , channels(0)
+    , frameSize(0)
+    , noiseRise(0.0f)
+    , frameFill(0)
+    , frameEnergy(0.0)
+    , bandEnergy(0.0)
+    , smoothedEnergy(0.0)
+    , smoothedBandEnergy(0.0)
+    , zeroCrossings(0)
+    , lastSample(0.0f)
+    , noiseDb(-120.0f)
+    , noiseInitialized(false)
+    , speaking(false)
+    , candidateRun(0)
+    , hangover(0)
+    , processedFrames(0)
+    , analysisFrames(0)
+    , configured(false)
+{
+}
+
+bool VoiceActivityDetector::configure(int sampleRate, int channelCount) {
+    return configure(sampleRate, channelCount, Config());
+}
+
+bool VoiceActivityDetector::configure(int sampleRate, int channelCount, const Config& config) {
+    configured = false;
+    if (sampleRate < 8000 || channelCount <= 0 || config.frameSeconds <= 0.0) {
+        std::cerr << "语音检测参数无效: " << sampleRate << "Hz, 声道数 " << channelCount << std::endl;
+        return false;
+    }
+    cfg = config;
+    cfg.onsetFrames = std::max(1, cfg.onsetFrames);
+    cfg.hangoverFrames = std::max(0, cfg.hangoverFrames);
+    rate = sampleRate;
+    channels = channelCount;
+    frameSize = std::max(1, static_cast<int>(rate * cfg.frameSeconds));
+    noiseRise = static_cast<float>(cfg.noiseRiseDbPerSecond * frameSize / rate);
+    configured = true;
+    reset();
+    return true;
+}
+
+void VoiceActivityDetector::reset() {
+    if (!configured) {
+        return;
+    }
+    bandHigh = highPass(SPEECH_BAND_LOW_HZ, rate);
+    bandLow = lowPass(std::min(SPEECH_BAND_HIGH_HZ, rate * 0.45), rate);
+    frameFill = 0;
+    frameEnergy = 0.0;
+    bandEnergy = 0.0;
+    smoothedEnergy = 0.0;
+    smoothedBandEnergy = 0.0;
+    zeroCrossings = 0;
+    lastSample = 0.0f;
+    noiseDb = -120.0f;
+    noiseInitialized = false;
+    speaking = false;
+    candidateRun = 0;
+    hangover = 0;
+    processedFrames = 0;
+    analysisFrames = 0;
+    counters = Stats();
+}
+
+double VoiceActivityDetector::streamTime() const {
+    return rate > 0 ? static_cast<double>(processedFrames) / rate : 0.0;
+}
+
+void VoiceActivityDetector::finishFrame(Result& result) {
+    const float energyDb = static_cast<float>(10.0 * std::log10(frameEnergy / frameSize + ENERGY_EPSILON));
+    smoothedEnergy = BAND_RATIO_SMOOTHING * smoothedEnergy + (1.0 - BAND_RATIO_SMOOTHING) * frameEnergy;
+    smoothedBandEnergy = BAND_RATIO_SMOOTHING * smoothedBandEnergy + (1.0 - BAND_RATIO_SMOOTHING) * bandEnergy;
+    const double bandRatio = smoothedBandEnergy / (smoothedEnergy + ENERGY_EPSILON);
+    const double zeroCrossingRate = static_cast<double>(zeroCrossings) / frameSize;
+
+    // 噪声底：跟踪帧能量的最小值，下降立即跟随，上升按固定速度，避免把持续的语音当成噪声
+    if (!noiseInitialized || energyDb < noiseDb) {
+        noiseDb = energyDb;
+        noiseInitialized = true;
+    } else {
+        noiseDb += noiseRise;
+    }
+
+    const bool candidate = energyDb >= std::max(noiseDb + cfg.energyMarginDb, cfg.minFrameEnergyDb) &&
+                           bandRatio >= cfg.minSpeechBandRatio &&
+                           zeroCrossingRate <= cfg.maxZeroCrossingRate;
+
+    if (candidate) {
+        candidateRun++;
+        hangover = cfg.hangoverFrames;
+        result.speech = true;
+        if (!speaking && candidateRun >= cfg.onsetFrames) {
+            speaking = true;
+            const uint64_t firstFrame = analysisFrames + 1 - static_cast<uint64_t>(cfg.onsetFrames);
+            result.onset = true;
+            result.onsetTime = static_cast<double>(firstFrame) * frameSize / rate;
+            counters.onsets++;
+        }
+    } else {
+        candidateRun = 0;
+        if (speaking && --hangover <= 0) {
+            speaking = false;
+            result.offset = true;
+        }
+    }
+
+    if (speaking) {
+        result.speech = true;
+        counters.speechFrames++;
+    }
+    counters.frames++;
+    analysisFrames++;
+    result.energyDb = energyDb;
+    result.noiseDb = noiseDb;
+
+    frameFill = 0;
+    frameEnergy = 0.0;
+    bandEnergy = 0.0;
+    zeroCrossings = 0;
+}
+
+VoiceActivityDetector::Result VoiceActivityDetector::process(const float* samples, int frames) {
+    Result result;
+    result.noiseDb = noiseDb;
+    if (!configured || !samples || frames <= 0) {
+        return result;
+    }
+
+    const float downmix = 1.0f / channels;
+    for (int i = 0; i < frames; ++i) {
+        const float* frame = samples + static_cast<size_t>(i) * channels;
+        float mono = frame[0];
+        for (int c = 1; c < channels; ++c) {
+            mono += frame[c];
+        }
+        mono *= downmix;
+
+        const float band = bandLow.run(bandHigh.run(mono));
+        frameEnergy += static_cast<double>(mono) * mono;
+        bandEnergy += static_cast<double>(band) * band;
+        zeroCrossings += (mono >= 0.0f) != (lastSample >= 0.0f);
+        lastSample = mono;
+
+        if (++frameFill == frameSize) {
+            finishFrame(result);
+        }
+    }
+    processedFrames += frames;
+    if (speaking) {
+        result.speech = true;
+    }
+    return result;
+}
@@ -0,0 +1,109 @@
+#ifndef VOICEACTIVITYDETECTOR_H
+#define VOICEACTIVITYDETECTOR_H
+
+#include <cstdint>
+
+/**
+ * 语音活动检测 - 按 10ms 分析帧计算能量、语音频带（200~3400Hz）能量占比与过零率
+ * 能量高于自适应噪声底一定余量、能量集中在语音频带且过零率不像嘶声的帧记为候选语音帧；
+ * 连续 onsetFrames 个候选帧判为语音起点，语音段在 hangoverFrames 帧内无候选帧后结束
+ * 只用两个双二阶滤波器和逐样本累加，不做 FFT；输入为交错 float，可按任意块大小送入，不分配内存
+ * 时间以送入的样本数计（秒，从 configure/reset 开始）
+ */
+class VoiceActivityDetector {
+public:
+    struct Config {
+        double frameSeconds = 0.01;         // 分析帧长度
+        float energyMarginDb = 9.0f;        // 高于噪声底多少 dB 才可能是语音
+        float minFrameEnergyDb = -55.0f;    // 绝对静音门限（dBFS），低于此值的帧不是语音
+        float minSpeechBandRatio = 0.4f;    // 语音频带能量占比下限（按帧间平滑后的能量计算）
+        float maxZeroCrossingRate = 0.35f;  // 过零率上限（白噪声与齿音约 0.5）
+        float noiseRiseDbPerSecond = 3.0f;  // 噪声底上升速度（下降立即跟随）
+        int onsetFrames = 3;                // 连续候选帧数达到该值判为语音起点
+        int hangoverFrames = 30;            // 语音段结束前保持的帧数
+    };
+
+    struct Result {
+        bool speech = false;        // 本块内有语音（含语音段中的帧与候选语音帧）
+        bool onset = false;         // 本块内出现语音起点
+        bool offset = false;        // 本块内语音段结束
+        double onsetTime = 0.0;     // 起点时刻（第一个候选帧的起始时间）
+        float energyDb = -120.0f;   // 本块最后一个完整分析帧的能量
+        float noiseDb = -120.0f;    // 当前噪声底
+    };
+
+    struct Stats {
+        uint64_t frames = 0;        // 已分析的帧数
+        uint64_t speechFrames = 0;  // 处于语音段内的帧数
+        uint64_t onsets = 0;        // 语音起点次数
+    };
+
+    VoiceActivityDetector();
+
+    // 配置采样率与声道数并清空状态；参数无效时返回 false
+    bool configure(int sampleRate, int channels);
+    bool configure(int sampleRate, int channels, const Config& config);
+
+    bool isConfigured() const { return configured; }
+    int sampleRate() const { return rate; }
+    int channelCount() const { return channels; }
+
+    // 清空滤波器、噪声底与语音状态
+    void reset();
+
+    // 分析一块交错样本
+    Result process(const float* samples, int frames);
+
+    bool inSpeech() const { return speaking; }
+    double streamTime() const;
+    Stats stats() const { return counters; }
+
+private:
+    struct Biquad {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+        float z1 = 0.0f, z2 = 0.0f;
+
+        float run(float x) {
+            const float y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    static Biquad highPass(double frequency, double sampleRate);
+    static Biquad lowPass(double frequency, double sampleRate);
+
+    // 一个分析帧结束：更新噪声底与语音状态
+    void finishFrame(Result& result);
+
+    Config cfg;
+    Biquad bandHigh;
+    Biquad bandLow;
+    int rate;
+    int channels;
+    int frameSize;
+    float noiseRise;        // 每帧噪声底上升的 dB 数
+
+    // 当前分析帧的累加量
+    int frameFill;
+    double frameEnergy;
+    double bandEnergy;
+    double smoothedEnergy;      // 帧间平滑后的能量，用于计算语音频带占比
+    double smoothedBandEnergy;
+    int zeroCrossings;
+    float lastSample;
+
+    // 语音状态
+    float noiseDb;
+    bool noiseInitialized;
+    bool speaking;
+    int candidateRun;
+    int hangover;
+    uint64_t processedFrames;   // 已送入的样本帧数
+    uint64_t analysisFrames;    // 已完成的分析帧数
+    Stats counters;
+    bool configured;
+};
+
+#endif // VOICEACTIVITYDETECTOR_H
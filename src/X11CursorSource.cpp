@@ -0,0 +1,133 @@
+// X11CursorSource.cpp
+// Linux 光标来源实现：XFixes 光标图像 + XQueryPointer 位置
+#include "X11CursorSource.h"
+#include <iostream>
+
+#include <X11/Xlib.h>
+#ifdef HAVE_XFIXES
+#include <X11/extensions/Xfixes.h>
+#endif
+
+struct X11CursorSource::Impl {
+    Display *display = nullptr;
+    Window root = 0;
+    bool xfixesActive = false;
+    int xfixesEventBase = 0;
+    bool imageDirty = true;
+    CursorImage image;
+
+    // 拉取当前光标图像；XFixes 返回 unsigned long 数组，低 32 位为预乘 ARGB
+    bool fetchImage() {
+#ifdef HAVE_XFIXES
+        XFixesCursorImage *cursorImage = XFixesGetCursorImage(display);
+        if (!cursorImage) {
+            return false;
+        }
+        if (cursorImage->cursor_serial != image.serial || image.pixels.empty()) {
+            image.width = cursorImage->width;
+            image.height = cursorImage->height;
+            image.xhot = cursorImage->xhot;
+            image.yhot = cursorImage->yhot;
+            image.serial = cursorImage->cursor_serial;
+            const size_t count = static_cast<size_t>(image.width) * image.height;
+            image.pixels.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                image.pixels[i] = static_cast<uint32_t>(cursorImage->pixels[i]);
+            }
+        }
+        XFree(cursorImage);
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+X11CursorSource::X11CursorSource()
+    : d(std::make_unique<Impl>())
+{
+}
+
+X11CursorSource::~X11CursorSource() {
+    release();
+}
+
+bool X11CursorSource::init(const std::string &displayName) {
+    release();
+
+    d->display = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
+    if (!d->display) {
+        std::cerr << "光标来源无法连接 X 显示服务器" << std::endl;
+        return false;
+    }
+    d->root = DefaultRootWindow(d->display);
+
+#ifdef HAVE_XFIXES
+    int errorBase = 0;
+    if (XFixesQueryExtension(d->display, &d->xfixesEventBase, &errorBase)) {
+        XFixesSelectCursorInput(d->display, d->root, XFixesDisplayCursorNotifyMask);
+        d->xfixesActive = true;
+        d->imageDirty = true;
+    } else {
+        std::cerr << "X 服务器不支持 XFIXES 扩展，录制画面中不绘制光标" << std::endl;
+    }
+#else
+    std::cerr << "编译时未启用 XFixes 支持，录制画面中不绘制光标" << std::endl;
+#endif
+    return true;
+}
+
+void X11CursorSource::release() {
+    if (d->display) {
+        XCloseDisplay(d->display);
+        d->display = nullptr;
+    }
+    d->root = 0;
+    d->xfixesActive = false;
+    d->imageDirty = true;
+    d->image = CursorImage();
+}
+
+X11CursorSource::State X11CursorSource::poll() {
+    State state;
+    if (!d->display) {
+        return state;
+    }
+
+#ifdef HAVE_XFIXES
+    // 只关心光标形状变化通知，其余事件直接丢弃
+    while (XPending(d->display) > 0) {
+        XEvent event;
+        XNextEvent(d->display, &event);
+        if (d->xfixesActive && event.type == d->xfixesEventBase + XFixesCursorNotify) {
+            const XFixesCursorNotifyEvent *notify = reinterpret_cast<const XFixesCursorNotifyEvent *>(&event);
+            if (notify->cursor_serial != d->image.serial) {
+                d->imageDirty = true;
+            }
+        }
+    }
+    if (d->xfixesActive && d->imageDirty) {
+        if (d->fetchImage()) {
+            state.imageChanged = true;
+        }
+        d->imageDirty = false;
+    }
+#endif
+
+    Window rootReturn = 0, childReturn = 0;
+    int rootX = 0, rootY = 0, winX = 0, winY = 0;
+    unsigned int mask = 0;
+    state.visible = XQueryPointer(d->display, d->root, &rootReturn, &childReturn,
+                                  &rootX, &rootY, &winX, &winY, &mask);
+    state.position = {rootX, rootY};
+    state.pressed = (mask & (Button1Mask | Button3Mask)) != 0;
+    return state;
+}
+
+const CursorImage &X11CursorSource::image() const {
+    return d->image;
+}
+
+bool X11CursorSource::hasCursorImages() const {
+    return d->xfixesActive;
+}
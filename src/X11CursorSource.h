@@ -0,0 +1,40 @@
+#ifndef X11CURSORSOURCE_H
+#define X11CURSORSOURCE_H
+
+#include "DataTypes.h"
+#include <memory>
+#include <string>
+
+/**
+ * X11 光标来源 - 通过 XFixes 获取当前光标图像与位置
+ * 光标图像只在 XFixesCursorNotify 事件到达（序列号变化）时重新拉取，
+ * 每帧只做一次 XQueryPointer 查询位置和按键状态
+ */
+class X11CursorSource {
+public:
+    struct State {
+        CapturePoint position{0, 0}; // 根窗口坐标（热点位置）
+        bool pressed = false;        // 左键或右键按下
+        bool visible = false;        // 指针位于本屏幕
+        bool imageChanged = false;   // 本次查询拉取了新的光标图像
+    };
+
+    X11CursorSource();
+    ~X11CursorSource();
+
+    bool init(const std::string &displayName = std::string());
+    void release();
+
+    // 查询光标状态；图像有更新时 imageChanged 为 true，可通过 image() 取得
+    State poll();
+    const CursorImage &image() const;
+
+    // 编译或运行时不支持 XFixes 时只有位置信息，没有光标图像
+    bool hasCursorImages() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
+
+#endif // X11CURSORSOURCE_H
@@ -0,0 +1,1026 @@
+// X11ShmCapture.cpp
+// Linux 屏幕捕获实现：X11 MIT-SHM 扩展，进程内抓屏
+#include "X11ShmCapture.h"
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#ifdef HAVE_XCOMPOSITE
+#include <X11/extensions/Xcomposite.h>
+#endif
+#ifdef HAVE_XDAMAGE
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xdamage.h>
+#endif
+
+namespace {
+
+// 脏矩形超过该数量或面积比例时，直接整帧抓取更划算
+const size_t MAX_DIRTY_RECTS = 64;
+const double FULL_GRAB_AREA_RATIO = 0.5;
+
+uint64_t monotonicMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 目标窗口随时可能被关闭或取消映射，相关请求的 X 错误需要捕获而不是走默认处理（直接退出进程）。
+// 错误处理函数是进程级的：第一个登记的连接安装一次，最后一个注销时恢复原处理函数，登记与注销互斥；
+// 错误按连接记录，未登记连接（其他线程、其他模块的 X 连接）的错误仍交给原处理函数
+std::mutex trapMutex;
+std::map<Display *, int> trappedErrors;
+XErrorHandler previousErrorHandler = nullptr;
+
+int trapXError(Display *display, XErrorEvent *event) {
+    XErrorHandler fallback = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(trapMutex);
+        auto it = trappedErrors.find(display);
+        if (it != trappedErrors.end()) {
+            it->second = event->error_code;
+            return 0;
+        }
+        fallback = previousErrorHandler;
+    }
+    return fallback ? fallback(display, event) : 0;
+}
+
+// 在一个连接上捕获 X 错误；窗口模式下整个捕获会话只登记一次，不在每帧安装处理函数
+class XErrorTrap {
+public:
+    explicit XErrorTrap(Display *display)
+        : display(display)
+    {
+        std::lock_guard<std::mutex> lock(trapMutex);
+        if (trappedErrors.empty()) {
+            previousErrorHandler = XSetErrorHandler(trapXError);
+        }
+        trappedErrors[display] = 0;
+    }
+    ~XErrorTrap() {
+        // 无回复请求的错误可能还在途中，注销前处理完，否则会落到原处理函数
+        XSync(display, False);
+        std::lock_guard<std::mutex> lock(trapMutex);
+        trappedErrors.erase(display);
+        if (trappedErrors.empty()) {
+            XSetErrorHandler(previousErrorHandler);
+            previousErrorHandler = nullptr;
+        }
+    }
+
+    // 取出并清除已记录的错误：有回复的请求（XGetWindowAttributes、XShmGetImage 等）返回时错误已处理，无需同步
+    bool failed() {
+        std::lock_guard<std::mutex> lock(trapMutex);
+        int &code = trappedErrors[display];
+        const bool hadError = code != 0;
+        code = 0;
+        return hadError;
+    }
+
+    // 无回复的请求（如 XCompositeNameWindowPixmap）要同步一次才能知道是否出错，只在这类请求后调用
+    bool syncFailed() {
+        XSync(display, False);
+        return failed();
+    }
+
+private:
+    Display *display;
+};
+
+std::string windowTitle(Display *display, Window window) {
+    Atom utf8 = XInternAtom(display, "UTF8_STRING", False);
+    Atom netName = XInternAtom(display, "_NET_WM_NAME", False);
+    Atom type = None;
+    int format = 0;
+    unsigned long count = 0, remaining = 0;
+    unsigned char *data = nullptr;
+    std::string title;
+    if (XGetWindowProperty(display, window, netName, 0, 1024, False, utf8, &type, &format,
+                           &count, &remaining, &data) == Success && data) {
+        title.assign(reinterpret_cast<char *>(data), count);
+        XFree(data);
+    }
+    if (title.empty()) {
+        char *name = nullptr;
+        if (XFetchName(display, window, &name) && name) {
+            title = name;
+            XFree(name);
+        }
+    }
+    return title;
+}
+
+} // namespace
+
+struct X11ShmCapture::Impl {
+    std::string displayName;
+    Display *display = nullptr;
+    Window root = 0;
+    Visual *visual = nullptr;
+    int depth = 0;
+    XImage *image = nullptr;
+    XShmSegmentInfo shmInfo{};
+    bool shmAttached = false;
+
+    bool regionSet = false;
+    int regionX = 0, regionY = 0, regionW = 0, regionH = 0;
+    int captureX = 0, captureY = 0, captureW = 0, captureH = 0;
+    int rootW = 0, rootH = 0;
+
+    // 窗口模式状态
+    Window targetWindow = 0;
+    bool compositeActive = false;
+    Pixmap windowPixmap = 0;
+    bool pixmapStale = true;
+    bool windowMapped = false;
+    std::unique_ptr<XErrorTrap> windowTrap; // 窗口会话期间登记的错误捕获
+    bool windowGone = false;
+    int windowW = 0, windowH = 0;
+
+    // 多屏模式状态：每块屏幕一个子捕获器（独立 X 连接）和一个常驻工作线程
+    struct ScreenWorker {
+        std::unique_ptr<X11ShmCapture> capture;
+        CaptureRect canvasRect{0, 0, 0, 0}; // 在画布中的位置
+        std::thread thread;
+        uint64_t grabStart = 0;
+        bool ok = false;
+    };
+    std::vector<CaptureRect> screenRects;
+    std::vector<std::unique_ptr<ScreenWorker>> screenWorkers;
+    std::mutex screenMutex;
+    std::condition_variable screenWake;
+    std::condition_variable screenDone;
+    uint64_t screenGeneration = 0;
+    size_t screensPending = 0;
+    bool screenWorkersStopping = false;
+    uint8_t *canvasData = nullptr;
+    int canvasStride = 0;
+    bool canvasHasGaps = false;
+    int64_t screenSkew = 0;
+
+    // 脏矩形模式状态
+    bool damageRequested = false;
+    bool damageActive = false;
+#ifdef HAVE_XDAMAGE
+    Damage damage = 0;
+#endif
+    // 常驻帧缓冲（池化 BGRA）：captureFrame/snapshotFrame 直接返回它的共享引用，不整帧拷贝；
+    // 调用方仍持有上一帧时，写入前才复制出独占副本（写时复制）
+    FrameData frameBuffer;
+    bool frameBufferValid = false;
+    bool forceFullFrame = false;
+
+    Impl() { shmInfo.shmid = -1; }
+
+    int bufferStride() const { return captureW * 4; }
+
+    void destroySegment() {
+        if (shmAttached && display) {
+            XShmDetach(display, &shmInfo);
+            XSync(display, False);
+            shmAttached = false;
+        }
+        if (image) {
+            // 数据指向共享内存，不能交给 XDestroyImage 释放
+            image->data = nullptr;
+            XDestroyImage(image);
+            image = nullptr;
+        }
+        if (shmInfo.shmaddr && shmInfo.shmaddr != reinterpret_cast<char *>(-1)) {
+            shmdt(shmInfo.shmaddr);
+        }
+        if (shmInfo.shmid >= 0) {
+            shmctl(shmInfo.shmid, IPC_RMID, nullptr);
+        }
+        shmInfo = XShmSegmentInfo{};
+        shmInfo.shmid = -1;
+    }
+
+    void destroyDamage() {
+#ifdef HAVE_XDAMAGE
+        if (damage && display) {
+            XDamageDestroy(display, damage);
+        }
+        damage = 0;
+#endif
+        damageActive = false;
+        frameBuffer = FrameData();
+        frameBufferValid = false;
+    }
+
+    void setupDamage() {
+#ifdef HAVE_XDAMAGE
+        int eventBase = 0, errorBase = 0;
+        if (!XDamageQueryExtension(display, &eventBase, &errorBase) ||
+            !XFixesQueryExtension(display, &eventBase, &errorBase)) {
+            std::cerr << "X 服务器不支持 DAMAGE/XFIXES 扩展，使用整帧捕获" << std::endl;
+            return;
+        }
+        // NonEmpty 级别：只在“由空变为非空”时发一次事件，区域本身每帧主动取回
+        damage = XDamageCreate(display, root, XDamageReportNonEmpty);
+        if (!damage) {
+            std::cerr << "XDamageCreate 失败，使用整帧捕获" << std::endl;
+            return;
+        }
+        if (!frameBuffer.allocateImage(captureW, captureH, PixelFormat::BGRA32)) {
+            std::cerr << "常驻帧缓冲分配失败，使用整帧捕获" << std::endl;
+            XDamageDestroy(display, damage);
+            damage = 0;
+            return;
+        }
+        frameBufferValid = false;
+        damageActive = true;
+#else
+        std::cerr << "编译时未启用 XDamage 支持，使用整帧捕获" << std::endl;
+#endif
+    }
+
+    // 多屏模式初始化：画布为所有屏幕的外接矩形，镜像（完全重合）的屏幕只抓一次
+    bool setupScreens() {
+        std::vector<CaptureRect> unique;
+        for (const CaptureRect &rect : screenRects) {
+            bool duplicate = false;
+            for (const CaptureRect &seen : unique) {
+                duplicate = duplicate || (seen.x == rect.x && seen.y == rect.y &&
+                                          seen.width == rect.width && seen.height == rect.height);
+            }
+            if (!duplicate) {
+                unique.push_back(rect);
+            }
+        }
+
+        int x0 = rootW, y0 = rootH, x1 = 0, y1 = 0;
+        size_t coveredArea = 0;
+        for (const CaptureRect &rect : unique) {
+            if (rect.width <= 0 || rect.height <= 0 || rect.x < 0 || rect.y < 0 ||
+                rect.x + rect.width > rootW || rect.y + rect.height > rootH) {
+                std::cerr << "屏幕区域超出根窗口范围: " << rect.x << "," << rect.y
+                          << " " << rect.width << "x" << rect.height << std::endl;
+                return false;
+            }
+            x0 = std::min(x0, rect.x);
+            y0 = std::min(y0, rect.y);
+            x1 = std::max(x1, rect.x + rect.width);
+            y1 = std::max(y1, rect.y + rect.height);
+            coveredArea += static_cast<size_t>(rect.width) * rect.height;
+        }
+        captureX = x0;
+        captureY = y0;
+        captureW = x1 - x0;
+        captureH = y1 - y0;
+        // 屏幕互不重叠时面积之和小于外接矩形即存在空隙；有重叠时保守地按有空隙处理
+        canvasHasGaps = coveredArea != static_cast<size_t>(captureW) * captureH;
+
+        for (const CaptureRect &rect : unique) {
+            auto worker = std::make_unique<ScreenWorker>();
+            worker->capture = std::make_unique<X11ShmCapture>();
+            worker->capture->setDisplayName(displayName);
+            worker->capture->setCaptureRegion(rect.x, rect.y, rect.width, rect.height);
+            if (!worker->capture->init()) {
+                return false;
+            }
+            worker->canvasRect = {rect.x - x0, rect.y - y0, rect.width, rect.height};
+            screenWorkers.push_back(std::move(worker));
+        }
+        screenWorkersStopping = false;
+        screenGeneration = 0;
+        for (auto &worker : screenWorkers) {
+            worker->thread = std::thread(&Impl::screenWorkerLoop, this, worker.get());
+        }
+        return true;
+    }
+
+    void screenWorkerLoop(ScreenWorker *worker) {
+        uint64_t seenGeneration = 0;
+        while (true) {
+            uint8_t *dst = nullptr;
+            int stride = 0;
+            {
+                std::unique_lock<std::mutex> lock(screenMutex);
+                screenWake.wait(lock, [&] { return screenWorkersStopping || screenGeneration != seenGeneration; });
+                if (screenWorkersStopping) {
+                    return;
+                }
+                seenGeneration = screenGeneration;
+                dst = canvasData;
+                stride = canvasStride;
+            }
+            worker->grabStart = monotonicMicros();
+            const CaptureRect &rect = worker->canvasRect;
+            worker->ok = worker->capture->captureInto(
+                dst + static_cast<size_t>(rect.y) * stride + static_cast<size_t>(rect.x) * 4, stride);
+            {
+                std::lock_guard<std::mutex> lock(screenMutex);
+                --screensPending;
+            }
+            screenDone.notify_one();
+        }
+    }
+
+    // 唤醒全部工作线程并行抓取到画布，所有屏幕完成后返回
+    bool grabScreens(uint8_t *canvas, int stride) {
+        {
+            std::lock_guard<std::mutex> lock(screenMutex);
+            canvasData = canvas;
+            canvasStride = stride;
+            screensPending = screenWorkers.size();
+            ++screenGeneration;
+        }
+        screenWake.notify_all();
+        std::unique_lock<std::mutex> lock(screenMutex);
+        screenDone.wait(lock, [this] { return screensPending == 0; });
+
+        bool ok = true;
+        uint64_t earliest = UINT64_MAX, latest = 0;
+        for (const auto &worker : screenWorkers) {
+            ok = ok && worker->ok;
+            earliest = std::min(earliest, worker->grabStart);
+            latest = std::max(latest, worker->grabStart);
+        }
+        screenSkew = static_cast<int64_t>(latest - earliest);
+        return ok;
+    }
+
+    void releaseScreens() {
+        {
+            std::lock_guard<std::mutex> lock(screenMutex);
+            screenWorkersStopping = true;
+        }
+        screenWake.notify_all();
+        for (auto &worker : screenWorkers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+            worker->capture->release();
+        }
+        screenWorkers.clear();
+        screenSkew = 0;
+    }
+
+    // 窗口模式初始化：尺寸取窗口当前大小，优先重定向到离屏像素图
+    bool setupWindow() {
+        XWindowAttributes attrs;
+        windowTrap = std::make_unique<XErrorTrap>(display);
+        if (!XGetWindowAttributes(display, targetWindow, &attrs) || windowTrap->failed()) {
+            std::cerr << "目标窗口不存在: 0x" << std::hex << targetWindow << std::dec << std::endl;
+            return false;
+        }
+        windowW = attrs.width;
+        windowH = attrs.height;
+        windowMapped = attrs.map_state == IsViewable;
+        windowGone = false;
+        captureX = 0;
+        captureY = 0;
+        captureW = windowW;
+        captureH = windowH;
+        XSelectInput(display, targetWindow, StructureNotifyMask);
+
+#ifdef HAVE_XCOMPOSITE
+        int eventBase = 0, errorBase = 0, major = 0, minor = 0;
+        if (XCompositeQueryExtension(display, &eventBase, &errorBase) &&
+            XCompositeQueryVersion(display, &major, &minor) && (major > 0 || minor >= 2)) {
+            // Automatic 重定向：窗口照常显示，同时保留一份完整的离屏内容
+            XCompositeRedirectWindow(display, targetWindow, CompositeRedirectAutomatic);
+            if (!windowTrap->syncFailed()) {
+                compositeActive = true;
+                // 离屏像素图使用窗口自己的视觉类型（可能是 32 位 ARGB）
+                visual = attrs.visual;
+                depth = attrs.depth;
+            }
+        }
+#endif
+        if (!compositeActive) {
+            std::cerr << "X 服务器不支持 Composite 扩展，按窗口位置从屏幕抓取（被遮挡部分会拍到遮挡物）" << std::endl;
+        }
+        pixmapStale = true;
+        return true;
+    }
+
+    void releaseWindow() {
+        if (!targetWindow || !display || !windowTrap) {
+            return;
+        }
+        if (windowPixmap) {
+            XFreePixmap(display, windowPixmap);
+            windowPixmap = 0;
+        }
+#ifdef HAVE_XCOMPOSITE
+        if (compositeActive && !windowGone) {
+            XCompositeUnredirectWindow(display, targetWindow, CompositeRedirectAutomatic);
+        }
+#endif
+        if (!windowGone) {
+            XSelectInput(display, targetWindow, NoEventMask);
+        }
+        compositeActive = false;
+        windowTrap.reset();
+    }
+
+    // 处理目标窗口的结构事件：尺寸变化或重新映射后离屏像素图需要重新获取
+    void processWindowEvents() {
+        while (XPending(display) > 0) {
+            XEvent event;
+            XNextEvent(display, &event);
+            switch (event.type) {
+            case ConfigureNotify:
+                if (event.xconfigure.window == targetWindow &&
+                    (event.xconfigure.width != windowW || event.xconfigure.height != windowH)) {
+                    windowW = event.xconfigure.width;
+                    windowH = event.xconfigure.height;
+                    pixmapStale = true;
+                }
+                break;
+            case MapNotify:
+                windowMapped = true;
+                pixmapStale = true;
+                break;
+            case UnmapNotify:
+                windowMapped = false;
+                break;
+            case DestroyNotify:
+                if (event.xdestroywindow.window == targetWindow) {
+                    windowGone = true;
+                    std::cerr << "目标窗口已关闭，停止输出新画面" << std::endl;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // 抓取窗口内容到 frame（紧凑 BGRA，尺寸固定为 captureW x captureH）
+    bool grabWindow(FrameData &frame) {
+        processWindowEvents();
+        if (windowGone || !windowMapped) {
+            return false;
+        }
+
+        XErrorTrap &trap = *windowTrap;
+        int windowX = 0, windowY = 0;
+        Window child = 0;
+        XTranslateCoordinates(display, targetWindow, root, 0, 0, &windowX, &windowY, &child);
+        if (trap.failed()) {
+            return false;
+        }
+        captureX = windowX;
+        captureY = windowY;
+
+        Drawable source = root;
+        int srcX = 0, srcY = 0, dstX = 0, dstY = 0;
+        int grabW = std::min(windowW, captureW);
+        int grabH = std::min(windowH, captureH);
+#ifdef HAVE_XCOMPOSITE
+        if (compositeActive) {
+            if (pixmapStale) {
+                if (windowPixmap) {
+                    XFreePixmap(display, windowPixmap);
+                }
+                // 只在窗口重新配置后取一次像素图，同步开销不落在每一帧上
+                windowPixmap = XCompositeNameWindowPixmap(display, targetWindow);
+                if (trap.syncFailed()) {
+                    windowPixmap = 0;
+                    return false;
+                }
+                pixmapStale = false;
+            }
+            source = windowPixmap;
+        }
+#endif
+        if (source == root) {
+            // 裁剪到屏幕内，移出屏幕的部分补黑
+            const int x0 = std::max(windowX, 0);
+            const int y0 = std::max(windowY, 0);
+            const int x1 = std::min(windowX + grabW, rootW);
+            const int y1 = std::min(windowY + grabH, rootH);
+            srcX = x0;
+            srcY = y0;
+            dstX = x0 - windowX;
+            dstY = y0 - windowY;
+            grabW = x1 - x0;
+            grabH = y1 - y0;
+        }
+
+        frame.stride = bufferStride();
+        if (!frame.allocate(static_cast<size_t>(frame.stride) * captureH)) {
+            return false;
+        }
+        if (grabW < captureW || grabH < captureH) {
+            memset(frame.data, 0, frame.size);
+        }
+        if (grabW <= 0 || grabH <= 0) {
+            return true;
+        }
+
+        XImage *rectImage = XShmCreateImage(display, visual, depth, ZPixmap, shmInfo.shmaddr,
+                                            &shmInfo, grabW, grabH);
+        if (!rectImage) {
+            return false;
+        }
+        bool ok = XShmGetImage(display, source, rectImage, srcX, srcY, AllPlanes) && !trap.failed();
+        if (ok) {
+            const size_t rowBytes = static_cast<size_t>(grabW) * 4;
+            const uint8_t *src = reinterpret_cast<const uint8_t *>(rectImage->data);
+            uint8_t *dst = frame.data + static_cast<size_t>(dstY) * frame.stride + dstX * 4;
+            for (int row = 0; row < grabH; ++row) {
+                memcpy(dst, src, rowBytes);
+                src += rectImage->bytes_per_line;
+                dst += frame.stride;
+            }
+        } else {
+            // 多为窗口刚缩放、像素图尚未更新，下一帧重新获取
+            pixmapStale = true;
+        }
+        rectImage->data = nullptr;
+        XDestroyImage(rectImage);
+        return ok;
+    }
+
+    bool grabFull() {
+        return XShmGetImage(display, root, image, captureX, captureY, AllPlanes);
+    }
+
+    // 写入常驻缓冲前确保独占；preserve 为 false（整帧刷新）时不必复制旧内容，直接换一块新缓冲
+    bool makeBufferWritable(bool preserve) {
+        if (frameBuffer.bufferUseCount() <= 1) {
+            return frameBuffer.data != nullptr;
+        }
+        if (preserve) {
+            frameBuffer.makeWritable();
+        } else {
+            frameBuffer.allocateImage(captureW, captureH, PixelFormat::BGRA32);
+        }
+        return frameBuffer.data != nullptr;
+    }
+
+    // 把 rect（相对捕获区域）抓到共享内存开头，再逐行拷进常驻帧缓冲（调用前已 makeBufferWritable）
+    bool grabRect(const CaptureRect &rect) {
+        XImage *rectImage = XShmCreateImage(display, visual, depth, ZPixmap, shmInfo.shmaddr,
+                                            &shmInfo, rect.width, rect.height);
+        if (!rectImage) {
+            return false;
+        }
+        bool ok = XShmGetImage(display, root, rectImage,
+                               captureX + rect.x, captureY + rect.y, AllPlanes);
+        if (ok) {
+            const size_t rowBytes = static_cast<size_t>(rect.width) * 4;
+            const uint8_t *src = reinterpret_cast<const uint8_t *>(rectImage->data);
+            uint8_t *dst = frameBuffer.data + static_cast<size_t>(rect.y) * frameBuffer.stride + rect.x * 4;
+            for (int row = 0; row < rect.height; ++row) {
+                memcpy(dst, src, rowBytes);
+                src += rectImage->bytes_per_line;
+                dst += frameBuffer.stride;
+            }
+        }
+        rectImage->data = nullptr;
+        XDestroyImage(rectImage);
+        return ok;
+    }
+
+    bool refreshWholeBuffer() {
+        if (!grabFull() || !makeBufferWritable(false)) {
+            return false;
+        }
+        const size_t rowBytes = static_cast<size_t>(bufferStride());
+        const uint8_t *src = reinterpret_cast<const uint8_t *>(image->data);
+        uint8_t *dst = frameBuffer.data;
+        for (int row = 0; row < captureH; ++row) {
+            memcpy(dst, src, rowBytes);
+            src += image->bytes_per_line;
+            dst += frameBuffer.stride;
+        }
+        frameBufferValid = true;
+        return true;
+    }
+
+    // 取出并清空自上次调用以来的损坏区域，裁剪到捕获区域内
+    std::vector<CaptureRect> takeDamage() {
+        std::vector<CaptureRect> rects;
+#ifdef HAVE_XDAMAGE
+        // DamageNotify 事件只用于唤醒，丢弃即可，避免事件队列增长
+        while (XPending(display) > 0) {
+            XEvent event;
+            XNextEvent(display, &event);
+        }
+
+        XserverRegion region = XFixesCreateRegion(display, nullptr, 0);
+        XDamageSubtract(display, damage, None, region);
+        int count = 0;
+        XRectangle *damaged = XFixesFetchRegion(display, region, &count);
+        XFixesDestroyRegion(display, region);
+
+        for (int i = 0; i < count; ++i) {
+            int x0 = std::max<int>(damaged[i].x, captureX);
+            int y0 = std::max<int>(damaged[i].y, captureY);
+            int x1 = std::min<int>(damaged[i].x + damaged[i].width, captureX + captureW);
+            int y1 = std::min<int>(damaged[i].y + damaged[i].height, captureY + captureH);
+            if (x1 > x0 && y1 > y0) {
+                rects.push_back({x0 - captureX, y0 - captureY, x1 - x0, y1 - y0});
+            }
+        }
+        if (damaged) {
+            XFree(damaged);
+        }
+#endif
+        return rects;
+    }
+
+    void clearDamage() {
+#ifdef HAVE_XDAMAGE
+        XDamageSubtract(display, damage, None, None);
+#endif
+    }
+};
+
+X11ShmCapture::X11ShmCapture()
+    : d(std::make_unique<Impl>())
+{
+}
+
+X11ShmCapture::~X11ShmCapture() {
+    release();
+}
+
+void X11ShmCapture::setDisplayName(const std::string &name) {
+    d->displayName = name;
+}
+
+void X11ShmCapture::setCaptureRegion(int x, int y, int width, int height) {
+    d->regionX = x;
+    d->regionY = y;
+    d->regionW = width;
+    d->regionH = height;
+    d->regionSet = true;
+}
+
+void X11ShmCapture::setCaptureWindow(unsigned long windowId) {
+    d->targetWindow = windowId;
+}
+
+std::vector<X11ShmCapture::WindowInfo> X11ShmCapture::listWindows(const std::string &displayName) {
+    std::vector<WindowInfo> windows;
+    Display *display = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
+    if (!display) {
+        return windows;
+    }
+    Window root = DefaultRootWindow(display);
+    Atom clientList = XInternAtom(display, "_NET_CLIENT_LIST_STACKING", False);
+    Atom type = None;
+    int format = 0;
+    unsigned long count = 0, remaining = 0;
+    unsigned char *data = nullptr;
+    if (XGetWindowProperty(display, root, clientList, 0, 4096, False, XA_WINDOW, &type, &format,
+                           &count, &remaining, &data) != Success || !data) {
+        clientList = XInternAtom(display, "_NET_CLIENT_LIST", False);
+        XGetWindowProperty(display, root, clientList, 0, 4096, False, XA_WINDOW, &type, &format,
+                           &count, &remaining, &data);
+    }
+
+    if (data && format == 32) {
+        XErrorTrap trap(display);
+        const Window *ids = reinterpret_cast<const Window *>(data);
+        // 堆叠顺序由下到上，倒序使最上层窗口排在前面
+        for (unsigned long i = count; i-- > 0;) {
+            XWindowAttributes attrs;
+            if (!XGetWindowAttributes(display, ids[i], &attrs) || attrs.map_state != IsViewable) {
+                continue;
+            }
+            int x = 0, y = 0;
+            Window child = 0;
+            XTranslateCoordinates(display, ids[i], root, 0, 0, &x, &y, &child);
+            WindowInfo info;
+            info.id = ids[i];
+            info.title = windowTitle(display, ids[i]);
+            info.geometry = {x, y, attrs.width, attrs.height};
+            if (!info.title.empty() && attrs.width > 1 && attrs.height > 1) {
+                windows.push_back(info);
+            }
+        }
+    }
+    if (data) {
+        XFree(data);
+    }
+    XCloseDisplay(display);
+    return windows;
+}
+
+void X11ShmCapture::setCaptureScreens(const std::vector<CaptureRect> &screens) {
+    d->screenRects = screens;
+    if (screens.size() == 1) {
+        setCaptureRegion(screens[0].x, screens[0].y, screens[0].width, screens[0].height);
+    }
+}
+
+int64_t X11ShmCapture::lastScreenSkewMicros() const {
+    return d->screenSkew;
+}
+
+void X11ShmCapture::setDamageTracking(bool enabled) {
+    d->damageRequested = enabled;
+}
+
+bool X11ShmCapture::isDamageTrackingActive() const {
+    return d->damageActive;
+}
+
+void X11ShmCapture::requestFullFrame() {
+    d->forceFullFrame = true;
+}
+
+bool X11ShmCapture::init() {
+    release();
+
+    d->display = XOpenDisplay(d->displayName.empty() ? nullptr : d->displayName.c_str());
+    if (!d->display) {
+        std::cerr << "无法连接 X 显示服务器" << std::endl;
+        return false;
+    }
+
+    if (!XShmQueryExtension(d->display)) {
+        std::cerr << "X 服务器不支持 MIT-SHM 扩展" << std::endl;
+        release();
+        return false;
+    }
+
+    int screen = DefaultScreen(d->display);
+    d->root = RootWindow(d->display, screen);
+
+    XWindowAttributes rootAttrs;
+    if (!XGetWindowAttributes(d->display, d->root, &rootAttrs)) {
+        std::cerr << "无法获取根窗口属性" << std::endl;
+        release();
+        return false;
+    }
+
+    d->rootW = rootAttrs.width;
+    d->rootH = rootAttrs.height;
+    d->visual = DefaultVisual(d->display, screen);
+    d->depth = DefaultDepth(d->display, screen);
+
+    if (d->screenRects.size() > 1 && !d->targetWindow) {
+        // 多屏模式：像素由各子捕获器抓取，本实例只负责调度和拼接
+        if (!d->setupScreens()) {
+            release();
+            return false;
+        }
+        std::cout << "X11 SHM 多屏捕获已初始化: " << d->screenWorkers.size() << " 块屏幕, 画布 "
+                  << d->captureW << "x" << d->captureH << std::endl;
+        return true;
+    }
+
+    if (d->targetWindow) {
+        if (!d->setupWindow()) {
+            release();
+            return false;
+        }
+    } else if (d->regionSet) {
+        // 区域必须完整落在根窗口内，否则 XShmGetImage 会返回 BadMatch
+        if (d->regionW <= 0 || d->regionH <= 0 ||
+            d->regionX < 0 || d->regionY < 0 ||
+            d->regionX + d->regionW > rootAttrs.width ||
+            d->regionY + d->regionH > rootAttrs.height) {
+            std::cerr << "捕获区域超出屏幕范围: " << d->regionX << "," << d->regionY
+                      << " " << d->regionW << "x" << d->regionH
+                      << " (屏幕 " << rootAttrs.width << "x" << rootAttrs.height << ")" << std::endl;
+            release();
+            return false;
+        }
+        d->captureX = d->regionX;
+        d->captureY = d->regionY;
+        d->captureW = d->regionW;
+        d->captureH = d->regionH;
+    } else {
+        d->captureX = 0;
+        d->captureY = 0;
+        d->captureW = rootAttrs.width;
+        d->captureH = rootAttrs.height;
+    }
+
+    d->image = XShmCreateImage(d->display, d->visual, d->depth, ZPixmap, nullptr,
+                               &d->shmInfo, d->captureW, d->captureH);
+    if (!d->image) {
+        std::cerr << "XShmCreateImage 失败" << std::endl;
+        release();
+        return false;
+    }
+    if (d->image->bits_per_pixel != 32) {
+        std::cerr << "不支持的显示位深: " << d->image->bits_per_pixel << " bpp（需要 32 bpp）" << std::endl;
+        release();
+        return false;
+    }
+
+    size_t segmentSize = static_cast<size_t>(d->image->bytes_per_line) * d->image->height;
+    d->shmInfo.shmid = shmget(IPC_PRIVATE, segmentSize, IPC_CREAT | 0600);
+    if (d->shmInfo.shmid < 0) {
+        std::cerr << "shmget 失败，共享内存大小: " << segmentSize << std::endl;
+        release();
+        return false;
+    }
+    d->shmInfo.shmaddr = static_cast<char *>(shmat(d->shmInfo.shmid, nullptr, 0));
+    if (d->shmInfo.shmaddr == reinterpret_cast<char *>(-1)) {
+        std::cerr << "shmat 失败" << std::endl;
+        release();
+        return false;
+    }
+    d->image->data = d->shmInfo.shmaddr;
+    d->shmInfo.readOnly = False;
+
+    if (!XShmAttach(d->display, &d->shmInfo)) {
+        std::cerr << "XShmAttach 失败" << std::endl;
+        release();
+        return false;
+    }
+    XSync(d->display, False);
+    d->shmAttached = true;
+
+    // 服务器已挂载段，提前标记删除，进程异常退出时也不会泄漏
+    shmctl(d->shmInfo.shmid, IPC_RMID, nullptr);
+
+    if (d->damageRequested && !d->targetWindow) {
+        d->setupDamage();
+    }
+
+    if (d->targetWindow) {
+        std::cout << "X11 SHM 窗口捕获已初始化: 0x" << std::hex << d->targetWindow << std::dec
+                  << " " << d->captureW << "x" << d->captureH
+                  << (d->compositeActive ? " (Composite 离屏)" : " (屏幕区域)") << std::endl;
+        return true;
+    }
+    std::cout << "X11 SHM 捕获已初始化: " << d->captureX << "," << d->captureY
+              << " " << d->captureW << "x" << d->captureH
+              << (d->damageActive ? " (脏矩形模式)" : "") << std::endl;
+    return true;
+}
+
+FrameData X11ShmCapture::captureFrame() {
+    FrameData frame;
+    if (!d->screenWorkers.empty()) {
+        frame.width = d->captureW;
+        frame.height = d->captureH;
+        frame.format = PixelFormat::BGRA32;
+        frame.timestamp = monotonicMicros();
+        frame.stride = d->bufferStride();
+        if (!frame.allocate(static_cast<size_t>(frame.stride) * frame.height)) {
+            return FrameData();
+        }
+        if (d->canvasHasGaps) {
+            memset(frame.data, 0, frame.size);
+        }
+        if (!d->grabScreens(frame.data, frame.stride)) {
+            std::cerr << "多屏抓取失败" << std::endl;
+            return FrameData();
+        }
+        return frame;
+    }
+    if (!d->image) {
+        return frame;
+    }
+
+    frame.width = d->captureW;
+    frame.height = d->captureH;
+    frame.format = PixelFormat::BGRA32;
+    frame.timestamp = monotonicMicros();
+
+    if (d->targetWindow) {
+        if (!d->grabWindow(frame)) {
+            return FrameData();
+        }
+        return frame;
+    }
+
+    if (!d->damageActive) {
+        if (!d->grabFull()) {
+            std::cerr << "XShmGetImage 失败" << std::endl;
+            return FrameData();
+        }
+        frame.stride = d->image->bytes_per_line;
+        frame.allocate(static_cast<size_t>(frame.stride) * frame.height);
+        if (!frame.data) {
+            return FrameData();
+        }
+        memcpy(frame.data, d->image->data, frame.size);
+        return frame;
+    }
+
+    if (!d->frameBufferValid || d->forceFullFrame) {
+        const bool firstFrame = !d->frameBufferValid;
+        // 先清空累计的损坏区域再抓整帧，之后的变化留给下一帧
+        d->clearDamage();
+        if (!d->refreshWholeBuffer()) {
+            std::cerr << "XShmGetImage 失败" << std::endl;
+            return FrameData();
+        }
+        d->forceFullFrame = false;
+        if (firstFrame) {
+            frame.dirtyRects.push_back({0, 0, d->captureW, d->captureH});
+        }
+    } else {
+        std::vector<CaptureRect> rects = d->takeDamage();
+        if (rects.empty()) {
+            // 无变化：不拷贝任何像素，只返回标记
+            frame.stride = 0;
+            frame.unchanged = true;
+            return frame;
+        }
+
+        size_t dirtyArea = 0;
+        for (const CaptureRect &rect : rects) {
+            dirtyArea += static_cast<size_t>(rect.width) * rect.height;
+        }
+        const size_t totalArea = static_cast<size_t>(d->captureW) * d->captureH;
+        if (rects.size() > MAX_DIRTY_RECTS || dirtyArea > totalArea * FULL_GRAB_AREA_RATIO) {
+            if (!d->refreshWholeBuffer()) {
+                std::cerr << "XShmGetImage 失败" << std::endl;
+                return FrameData();
+            }
+        } else {
+            if (!d->makeBufferWritable(true)) {
+                return FrameData();
+            }
+            for (const CaptureRect &rect : rects) {
+                if (!d->grabRect(rect)) {
+                    // 单个矩形失败时退回整帧，保证常驻缓冲不残留旧内容
+                    if (!d->refreshWholeBuffer()) {
+                        std::cerr << "XShmGetImage 失败" << std::endl;
+                        return FrameData();
+                    }
+                    break;
+                }
+            }
+        }
+        frame.dirtyRects = std::move(rects);
+    }
+
+    // 只拷贝了变化区域，返回常驻缓冲的共享引用
+    FrameData shared = d->frameBuffer;
+    shared.timestamp = frame.timestamp;
+    shared.dirtyRects = std::move(frame.dirtyRects);
+    return shared;
+}
+
+FrameData X11ShmCapture::snapshotFrame() const {
+    FrameData frame;
+    if (!d->damageActive || !d->frameBufferValid) {
+        return frame;
+    }
+    frame = d->frameBuffer;
+    frame.timestamp = monotonicMicros();
+    return frame;
+}
+
+bool X11ShmCapture::captureInto(uint8_t *dst, int dstStride) {
+    if (!d->image || d->targetWindow || !dst) {
+        return false;
+    }
+    if (!d->grabFull()) {
+        return false;
+    }
+    const size_t rowBytes = static_cast<size_t>(d->captureW) * 4;
+    const uint8_t *src = reinterpret_cast<const uint8_t *>(d->image->data);
+    for (int row = 0; row < d->captureH; ++row) {
+        memcpy(dst, src, rowBytes);
+        src += d->image->bytes_per_line;
+        dst += dstStride;
+    }
+    return true;
+}
+
+void X11ShmCapture::release() {
+    d->releaseScreens();
+    d->releaseWindow();
+    d->destroyDamage();
+    d->destroySegment();
+    if (d->display) {
+        XCloseDisplay(d->display);
+        d->display = nullptr;
+    }
+    d->root = 0;
+}
+
+bool X11ShmCapture::isInitialized() const {
+    return d->image != nullptr || !d->screenWorkers.empty();
+}
+
+int X11ShmCapture::width() const {
+    return d->captureW;
+}
+
+int X11ShmCapture::height() const {
+    return d->captureH;
+}
+
+CapturePoint X11ShmCapture::captureOrigin() const {
+    return {d->captureX, d->captureY};
+}
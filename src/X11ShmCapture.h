@@ -0,0 +1,82 @@
+#ifndef X11SHMCAPTURE_H
+#define X11SHMCAPTURE_H
+
+#include "ILocalCapture.h"
+#include "DataTypes.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * X11 MIT-SHM 屏幕捕获器 - 进程内通过 XShmGetImage 抓取屏幕
+ * 像素直接落入共享内存段，无需经过 X 连接传输，也不依赖外部 ffmpeg 进程
+ * 输出格式固定为 BGRA32（24/32 位 TrueColor 显示）
+ */
+class X11ShmCapture : public ILocalCapture {
+public:
+    X11ShmCapture();
+    ~X11ShmCapture() override;
+
+    // 设置 X 显示名（为空时使用 DISPLAY 环境变量）
+    void setDisplayName(const std::string &name);
+
+    // 设置捕获区域（根窗口坐标）；未设置时捕获整个根窗口
+    void setCaptureRegion(int x, int y, int width, int height);
+
+    // 窗口捕获：按窗口 ID 只捕获该窗口，优先读取 XComposite 离屏像素图，窗口被遮挡时内容仍完整
+    // 输出尺寸固定为 init 时的窗口尺寸；窗口移动不影响画面，缩放后内容贴左上角，超出裁掉、不足补黑
+    // 服务器不支持 Composite 时退回按窗口当前位置从根窗口抓取（跟随移动，但会拍到遮挡物）
+    // 需在 init 前设置，设置后忽略捕获区域与脏矩形模式；传 0 取消
+    void setCaptureWindow(unsigned long windowId);
+
+    // 多屏捕获：同时抓取多块屏幕（根窗口坐标），每块屏幕一个工作线程并行抓取，
+    // 各自直接写入同一张按外接矩形排布的画布（单次拷贝，屏幕间空隙补黑）
+    // 需在 init 前设置，少于两块屏幕时按普通区域捕获处理；不使用脏矩形模式
+    void setCaptureScreens(const std::vector<CaptureRect> &screens);
+
+    // 多屏模式下最近一帧各屏幕抓取开始时刻的最大差值（微秒），用于衡量屏幕间同步程度
+    int64_t lastScreenSkewMicros() const;
+
+    struct WindowInfo {
+        unsigned long id = 0;
+        std::string title;
+        CaptureRect geometry{0, 0, 0, 0}; // 根窗口坐标
+    };
+    // 列出窗口管理器登记的顶层窗口（_NET_CLIENT_LIST），按堆叠顺序
+    static std::vector<WindowInfo> listWindows(const std::string &displayName = std::string());
+
+    // 脏矩形模式（XDamage）：只把变化区域拷入常驻帧缓冲，返回的帧与该缓冲共享像素（调用方修改前须 makeWritable），
+    // 无变化时返回 unchanged 标记
+    // 需在 init 前设置；服务器不支持 DAMAGE/XFIXES 时自动退回整帧模式
+    void setDamageTracking(bool enabled);
+    bool isDamageTrackingActive() const;
+
+    // 下一次 captureFrame 返回完整帧内容（即使没有变化），用于心跳帧/结束帧
+    void requestFullFrame();
+
+    // 脏矩形模式下返回常驻帧缓冲的共享引用（不访问 X 服务器、不拷贝像素），用于画面静止但需要重绘叠加层的帧
+    // 非脏矩形模式或缓冲尚未就绪时返回空帧
+    FrameData snapshotFrame() const;
+
+    bool init() override;
+    FrameData captureFrame() override;
+
+    // 把整帧直接抓进调用方缓冲（区域模式，BGRA，dst 至少 height 行 x dstStride 字节），不经过中间帧
+    bool captureInto(uint8_t *dst, int dstStride);
+    void release() override;
+
+    bool isInitialized() const;
+
+    // 实际捕获尺寸（init 成功后有效）
+    int width() const;
+    int height() const;
+
+    // 最近一帧左上角对应的根窗口坐标（窗口模式下随窗口移动）
+    CapturePoint captureOrigin() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
+
+#endif // X11SHMCAPTURE_H
@@ -3,6 +3,7 @@
 #include <QDir>
 #include <QCoreApplication>
 #include "MainWindow.h"
+#include "FFmpegLocator.h"
 
 int main(int argc, char *argv[]) {
     // 设置高DPI支持，确保获取真实的屏幕分辨率
@@ -15,6 +16,9 @@ int main(int argc, char *argv[]) {
     app.setApplicationVersion("1.0.0");
     app.setOrganizationName("AIcp Project");
     
+    // 后台定位 FFmpeg（只查文件系统，不启动进程），避免录制/分析时再同步查找
+    FFmpegLocator::instance().resolveAsync();
+    
     // 设置应用程序图标 - 使用嵌入的资源
     QIcon appIcon(":/app.ico");
     if (!appIcon.isNull()) {
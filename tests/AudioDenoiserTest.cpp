@@ -0,0 +1,77 @@
+// AudioDenoiserTest.cpp
+// 无语音时跳过 FFT 的帧与分析帧交替，输出电平不应出现按分析周期的调制
+#include "AudioDenoiser.h"
+#include "TestSupport.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int SAMPLE_RATE = 48000;
+const int BLOCK_FRAMES = 480;
+const double SIGNAL_SECONDS = 6.0;
+const double VOICE_SECONDS = 2.0;    // 前 2 秒按有语音处理，之后切换为无语音
+const double MEASURE_SECONDS = 3.0;  // 统计从第 3 秒开始（噪声底已收敛）
+
+// 跳过帧与分析帧交替时，相邻 hop 电平变化的均值与全部分析时相比允许的余量
+const double MAX_EXTRA_STEP_DB = 0.3;
+
+struct HopLevels {
+    double meanStepDb = 0.0;    // 相邻 hop 电平差的均值
+    double meanLevelDb = 0.0;   // hop 电平的均值
+};
+
+HopLevels denoiseNoise(bool gateVoice) {
+    AudioDenoiser denoiser;
+    HopLevels result;
+    if (!CHECK(denoiser.configure(SAMPLE_RATE, 1))) {
+        return result;
+    }
+    const int total = static_cast<int>(SAMPLE_RATE * SIGNAL_SECONDS);
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    std::vector<float> input(total);
+    std::vector<float> output(total);
+    for (float &v : input) {
+        v = noise(rng);
+    }
+    for (int offset = 0; offset + BLOCK_FRAMES <= total; offset += BLOCK_FRAMES) {
+        denoiser.setVoiceActive(!gateVoice || offset < SAMPLE_RATE * VOICE_SECONDS);
+        CHECK(denoiser.process(input.data() + offset, output.data() + offset, BLOCK_FRAMES));
+    }
+
+    const int hop = denoiser.fftSize() / 2;
+    double previous = 0.0;
+    double stepSum = 0.0;
+    double levelSum = 0.0;
+    int hops = 0;
+    for (int start = static_cast<int>(SAMPLE_RATE * MEASURE_SECONDS); start + hop <= total; start += hop) {
+        double energy = 0.0;
+        for (int i = 0; i < hop; ++i) {
+            energy += static_cast<double>(output[start + i]) * output[start + i];
+        }
+        const double level = 10.0 * std::log10(energy / hop + 1e-20);
+        if (hops > 0) {
+            stepSum += std::fabs(level - previous);
+        }
+        levelSum += level;
+        previous = level;
+        ++hops;
+    }
+    result.meanStepDb = hops > 1 ? stepSum / (hops - 1) : 0.0;
+    result.meanLevelDb = hops > 0 ? levelSum / hops : 0.0;
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const HopLevels analysed = denoiseNoise(false);
+    const HopLevels gated = denoiseNoise(true);
+    std::cout << "全部分析: 相邻 hop 电平差 " << analysed.meanStepDb << "dB, 平均电平 " << analysed.meanLevelDb << "dB" << std::endl;
+    std::cout << "无语音跳帧: 相邻 hop 电平差 " << gated.meanStepDb << "dB, 平均电平 " << gated.meanLevelDb << "dB" << std::endl;
+    CHECK(gated.meanStepDb <= analysed.meanStepDb + MAX_EXTRA_STEP_DB);
+    return TestSupport::failureCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+// AudioResamplerBench.cpp
+// 重采样吞吐基准：立体声 44.1k <-> 48k，按 10ms 块流式处理，报告相对实时的倍数
+#include "AudioResampler.h"
+#include "TestSupport.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// 处理的音频时长（秒）与目标倍数（单核相对实时）
+const double AUDIO_SECONDS = 120.0;
+const double TARGET_REALTIME_FACTOR = 200.0;
+
+double benchmark(int inRate, int outRate) {
+    const int blockFrames = inRate / 100;
+    const int totalBlocks = static_cast<int>(AUDIO_SECONDS * 100);
+    std::vector<float> block(static_cast<size_t>(blockFrames) * 2);
+    for (int i = 0; i < blockFrames; ++i) {
+        block[i * 2] = static_cast<float>(0.5 * std::sin(2.0 * PI * 1000.0 * i / inRate));
+        block[i * 2 + 1] = static_cast<float>(0.5 * std::sin(2.0 * PI * 3000.0 * i / inRate));
+    }
+
+    AudioResampler resampler;
+    if (!CHECK(resampler.configure(inRate, outRate, 2))) {
+        return 0.0;
+    }
+    const int capacity = resampler.maxOutputFrames(blockFrames);
+    std::vector<float> out(static_cast<size_t>(capacity) * 2);
+    long long producedFrames = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < totalBlocks; ++n) {
+        producedFrames += resampler.process(block.data(), blockFrames, out.data(), capacity);
+    }
+    const double seconds = TestSupport::secondsSince(start);
+    CHECK(std::llabs(producedFrames - static_cast<long long>(AUDIO_SECONDS * outRate)) <= 64);
+
+    const double factor = AUDIO_SECONDS / seconds;
+    std::cout << inRate << " -> " << outRate << " 立体声: " << AUDIO_SECONDS << "s 音频耗时 " << seconds * 1000.0
+              << "ms, " << factor << "x 实时" << std::endl;
+    return factor;
+}
+
+} // namespace
+
+int main() {
+    const double up = benchmark(44100, 48000);
+    const double down = benchmark(48000, 44100);
+#ifdef NDEBUG
+    // 只在优化构建中要求达到目标倍数，调试构建只报告
+    CHECK(up >= TARGET_REALTIME_FACTOR);
+    CHECK(down >= TARGET_REALTIME_FACTOR);
+#else
+    std::cout << "调试构建，不检查 " << TARGET_REALTIME_FACTOR << "x 实时目标" << std::endl;
+    (void)up;
+    (void)down;
+#endif
+    return TestSupport::failureCount() == 0 ? 0 : 1;
+}
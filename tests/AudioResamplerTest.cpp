@@ -0,0 +1,166 @@
+// AudioResamplerTest.cpp
+// 44.1k <-> 48k 立体声正弦的通带信噪比、阻带衰减，以及分块处理与整段处理结果一致
+#include "AudioResampler.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// 测试信号时长（秒）与两端不参与统计的帧数（滤波器从零历史启动、flush 补零）
+const double SIGNAL_SECONDS = 1.0;
+const int EDGE_FRAMES = 256;
+
+// 通带正弦的最低信噪比与阻带正弦输出的最高电平（相对输入幅度，dB）
+const double MIN_PASSBAND_SNR_DB = 85.0;
+const double MAX_STOPBAND_LEVEL_DB = -80.0;
+
+// 左右声道各一个正弦，幅度 0.5
+std::vector<float> makeStereoSine(int rate, double leftHz, double rightHz, int frames) {
+    std::vector<float> signal(static_cast<size_t>(frames) * 2);
+    for (int i = 0; i < frames; ++i) {
+        signal[i * 2] = static_cast<float>(0.5 * std::sin(2.0 * PI * leftHz * i / rate));
+        signal[i * 2 + 1] = static_cast<float>(0.5 * std::sin(2.0 * PI * rightHz * i / rate));
+    }
+    return signal;
+}
+
+// 整段一次送入后 flush
+std::vector<float> resampleOneShot(int inRate, int outRate, const std::vector<float> &input) {
+    AudioResampler resampler;
+    std::vector<float> output;
+    if (!CHECK(resampler.configure(inRate, outRate, 2))) {
+        return output;
+    }
+    const int frames = static_cast<int>(input.size() / 2);
+    output.resize(static_cast<size_t>(resampler.maxOutputFrames(frames)) * 2);
+    const int produced = resampler.process(input.data(), frames, output.data(), resampler.maxOutputFrames(frames));
+    CHECK(produced >= 0);
+    std::vector<float> tail(static_cast<size_t>(resampler.maxOutputFrames(0)) * 2);
+    const int flushed = resampler.flush(tail.data(), resampler.maxOutputFrames(0));
+    CHECK(flushed >= 0);
+    output.resize(static_cast<size_t>(std::max(produced, 0)) * 2);
+    output.insert(output.end(), tail.begin(), tail.begin() + std::max(flushed, 0) * 2);
+    return output;
+}
+
+// 按轮换的块大小（含 1 帧与超过内部工作区的块）送入后 flush
+std::vector<float> resampleChunked(int inRate, int outRate, const std::vector<float> &input) {
+    static const int CHUNK_SIZES[] = {1, 7, 480, 441, 1023, 1024, 1025, 4096, 13};
+    AudioResampler resampler;
+    std::vector<float> output;
+    if (!CHECK(resampler.configure(inRate, outRate, 2))) {
+        return output;
+    }
+    const int frames = static_cast<int>(input.size() / 2);
+    std::vector<float> block;
+    int offset = 0;
+    for (size_t n = 0; offset < frames; ++n) {
+        const int count = std::min(CHUNK_SIZES[n % (sizeof(CHUNK_SIZES) / sizeof(CHUNK_SIZES[0]))], frames - offset);
+        const int capacity = resampler.maxOutputFrames(count);
+        block.resize(static_cast<size_t>(capacity) * 2);
+        const int produced = resampler.process(input.data() + static_cast<size_t>(offset) * 2, count, block.data(), capacity);
+        if (!CHECK(produced >= 0)) {
+            return output;
+        }
+        output.insert(output.end(), block.begin(), block.begin() + produced * 2);
+        offset += count;
+    }
+    block.resize(static_cast<size_t>(resampler.maxOutputFrames(0)) * 2);
+    const int flushed = resampler.flush(block.data(), resampler.maxOutputFrames(0));
+    CHECK(flushed >= 0);
+    output.insert(output.end(), block.begin(), block.begin() + std::max(flushed, 0) * 2);
+    return output;
+}
+
+// 单声道输出与理想正弦（输出与输入时间对齐，无群延迟）比较，返回信噪比 dB
+double passbandSnrDb(const std::vector<float> &output, int channel, int outRate, double hz) {
+    const int frames = static_cast<int>(output.size() / 2);
+    double signalEnergy = 0.0;
+    double noiseEnergy = 0.0;
+    for (int i = EDGE_FRAMES; i < frames - EDGE_FRAMES; ++i) {
+        const double ideal = 0.5 * std::sin(2.0 * PI * hz * i / outRate);
+        const double error = output[static_cast<size_t>(i) * 2 + channel] - ideal;
+        signalEnergy += ideal * ideal;
+        noiseEnergy += error * error;
+    }
+    return 10.0 * std::log10(signalEnergy / std::max(noiseEnergy, 1e-30));
+}
+
+// 单声道输出电平相对输入正弦（幅度 0.5）的 dB
+double levelDb(const std::vector<float> &output, int channel) {
+    const int frames = static_cast<int>(output.size() / 2);
+    double energy = 0.0;
+    int count = 0;
+    for (int i = EDGE_FRAMES; i < frames - EDGE_FRAMES; ++i) {
+        const double v = output[static_cast<size_t>(i) * 2 + channel];
+        energy += v * v;
+        ++count;
+    }
+    const double inputPower = 0.5 * 0.5 / 2.0;
+    return 10.0 * std::log10(std::max(energy / std::max(count, 1), 1e-30) / inputPower);
+}
+
+void testPassband(int inRate, int outRate) {
+    const double leftHz = 1000.0;
+    const double rightHz = 15000.0;
+    const std::vector<float> input = makeStereoSine(inRate, leftHz, rightHz, static_cast<int>(inRate * SIGNAL_SECONDS));
+    const std::vector<float> output = resampleOneShot(inRate, outRate, input);
+
+    // 输出帧数应为输入时长 * 输出采样率
+    const int expectedFrames = static_cast<int>(std::lround(input.size() / 2 * static_cast<double>(outRate) / inRate));
+    CHECK(std::abs(static_cast<int>(output.size() / 2) - expectedFrames) <= 1);
+
+    const double leftSnr = passbandSnrDb(output, 0, outRate, leftHz);
+    const double rightSnr = passbandSnrDb(output, 1, outRate, rightHz);
+    std::cout << inRate << " -> " << outRate << " 通带信噪比: " << leftHz << "Hz " << leftSnr << "dB, "
+              << rightHz << "Hz " << rightSnr << "dB" << std::endl;
+    CHECK(leftSnr >= MIN_PASSBAND_SNR_DB);
+    CHECK(rightSnr >= MIN_PASSBAND_SNR_DB);
+}
+
+void testStopband() {
+    // 48k -> 44.1k：高于输出奈奎斯特频率（22.05k）的分量必须被滤除，否则混叠回可听频段
+    const int inRate = 48000;
+    const int outRate = 44100;
+    const std::vector<float> input = makeStereoSine(inRate, 22500.0, 23500.0, static_cast<int>(inRate * SIGNAL_SECONDS));
+    const std::vector<float> output = resampleOneShot(inRate, outRate, input);
+    const double left = levelDb(output, 0);
+    const double right = levelDb(output, 1);
+    std::cout << inRate << " -> " << outRate << " 阻带电平: 22500Hz " << left << "dB, 23500Hz " << right << "dB" << std::endl;
+    CHECK(left <= MAX_STOPBAND_LEVEL_DB);
+    CHECK(right <= MAX_STOPBAND_LEVEL_DB);
+}
+
+void testChunkedMatchesOneShot(int inRate, int outRate) {
+    const std::vector<float> input = makeStereoSine(inRate, 440.0, 9000.0, static_cast<int>(inRate * SIGNAL_SECONDS));
+    const std::vector<float> oneShot = resampleOneShot(inRate, outRate, input);
+    const std::vector<float> chunked = resampleChunked(inRate, outRate, input);
+    if (!CHECK(oneShot.size() == chunked.size())) {
+        std::cerr << "  " << inRate << " -> " << outRate << ": 整段 " << oneShot.size() / 2 << " 帧, 分块 "
+                  << chunked.size() / 2 << " 帧" << std::endl;
+        return;
+    }
+    // 每个输出都是同一窗口与同一相位系数的点积，分块方式不应改变任何一个样本
+    size_t mismatches = 0;
+    for (size_t i = 0; i < oneShot.size(); ++i) {
+        mismatches += oneShot[i] != chunked[i] ? 1 : 0;
+    }
+    CHECK(mismatches == 0);
+}
+
+} // namespace
+
+int main() {
+    testPassband(44100, 48000);
+    testPassband(48000, 44100);
+    testStopband();
+    testChunkedMatchesOneShot(44100, 48000);
+    testChunkedMatchesOneShot(48000, 44100);
+    std::cout << "失败 " << TestSupport::failureCount() << " 项" << std::endl;
+    return TestSupport::failureCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+// PixelConverterTest.cpp
+// 校验运行时选择的 SSE4.1/AVX2 转换内核与标量参考实现逐字节一致
+#include "PixelConverter.h"
+#include "TestSupport.h"
+#include <iostream>
+
+namespace {
+
+const PixelFormat ALL_FORMATS[] = {
+    PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+    PixelFormat::YUV420P, PixelFormat::YUV422P, PixelFormat::YUV444P, PixelFormat::NV12
+};
+
+// 覆盖 1 像素、奇数宽高，以及超过 AVX2 一次处理宽度（16 像素）并带余量的尺寸
+const int SIZES[][2] = {
+    {1, 1}, {2, 2}, {3, 1}, {7, 5}, {16, 2}, {17, 3}, {33, 17}, {64, 4}, {67, 31}
+};
+
+// 源帧的裁剪区域：起点与宽高都取奇数，色度下采样格式的起点会被对齐到色度网格
+const CaptureRect CROPS[] = {
+    {0, 0, 40, 24}, {3, 5, 37, 19}, {17, 1, 1, 1}, {9, 7, 45, 30}
+};
+
+const PixelConverter::KernelSet KERNEL_SETS[] = {
+    PixelConverter::KernelSet::Auto, PixelConverter::KernelSet::Scalar,
+    PixelConverter::KernelSet::SSE41, PixelConverter::KernelSet::AVX2
+};
+
+const char *kernelName(PixelConverter::KernelSet kernels) {
+    switch (kernels) {
+    case PixelConverter::KernelSet::Auto:   return "auto";
+    case PixelConverter::KernelSet::Scalar: return "scalar";
+    case PixelConverter::KernelSet::SSE41:  return "sse4.1";
+    case PixelConverter::KernelSet::AVX2:   return "avx2";
+    }
+    return "?";
+}
+
+int comparisons = 0;
+
+// 同一源帧分别用标量参考与指定内核转换，目标帧的行填充预先填成不同内容，只比较可见像素
+void compareKernels(const PixelConverter &converter, const FrameData &src, PixelFormat dstFormat,
+                    PixelConverter::KernelSet kernels, TestSupport::ByteGenerator &gen) {
+    FrameData expected;
+    FrameData actual;
+    if (!CHECK(TestSupport::makeRandomImage(expected, src.width, src.height, dstFormat, gen)) ||
+        !CHECK(TestSupport::makeRandomImage(actual, src.width, src.height, dstFormat, gen))) {
+        return;
+    }
+    CHECK(converter.convertReference(src, expected));
+    CHECK(converter.convertWithKernels(src, actual, kernels));
+    const int diff = TestSupport::maxPlaneDifference(expected, actual);
+    if (!CHECK(diff == 0)) {
+        std::cerr << "  内核 " << kernelName(kernels) << ", " << static_cast<int>(src.format) << " -> "
+                  << static_cast<int>(dstFormat) << ", " << src.width << "x" << src.height
+                  << ", 矩阵 " << static_cast<int>(converter.matrix()) << ", 范围 " << static_cast<int>(converter.range())
+                  << ", 最大差 " << diff << std::endl;
+    }
+    ++comparisons;
+}
+
+void testAllPairs(PixelConverter::KernelSet kernels) {
+    TestSupport::ByteGenerator gen(0x1234);
+    for (YuvMatrix matrix : {YuvMatrix::BT601, YuvMatrix::BT709}) {
+        for (YuvRange range : {YuvRange::Limited, YuvRange::Full}) {
+            const PixelConverter converter(matrix, range);
+            for (PixelFormat srcFormat : ALL_FORMATS) {
+                for (PixelFormat dstFormat : ALL_FORMATS) {
+                    for (const auto &size : SIZES) {
+                        FrameData src;
+                        if (CHECK(TestSupport::makeRandomImage(src, size[0], size[1], srcFormat, gen))) {
+                            compareKernels(converter, src, dstFormat, kernels, gen);
+                        }
+                    }
+
+                    // 源帧为裁剪视图：行起点不对齐、步长大于行宽
+                    FrameData parent;
+                    if (!CHECK(TestSupport::makeRandomImage(parent, 71, 43, srcFormat, gen))) {
+                        continue;
+                    }
+                    for (const CaptureRect &crop : CROPS) {
+                        const FrameData view = parent.cropView(crop);
+                        if (CHECK(view.data != nullptr)) {
+                            compareKernels(converter, view, dstFormat, kernels, gen);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 脏矩形全在裁剪区域外时视图标记为无变化但仍指向父帧像素，转换只传递标记、不读像素
+void testUnchangedView() {
+    TestSupport::ByteGenerator gen(0x5678);
+    FrameData parent;
+    if (!CHECK(TestSupport::makeRandomImage(parent, 64, 32, PixelFormat::BGRA32, gen))) {
+        return;
+    }
+    parent.dirtyRects.push_back({0, 0, 8, 8});
+    const FrameData view = parent.cropView({16, 8, 32, 16});
+    CHECK(view.unchanged);
+    CHECK(view.data != nullptr);
+    const FrameData converted = PixelConverter().convert(view, PixelFormat::YUV420P);
+    CHECK(converted.unchanged);
+    CHECK(converted.data == nullptr);
+}
+
+} // namespace
+
+int main() {
+    for (PixelConverter::KernelSet kernels : KERNEL_SETS) {
+        if (!PixelConverter::kernelSetSupported(kernels)) {
+            std::cout << "跳过 " << kernelName(kernels) << "：当前 CPU 不支持" << std::endl;
+            continue;
+        }
+        const int before = TestSupport::failureCount();
+        testAllPairs(kernels);
+        std::cout << kernelName(kernels) << ": " << (TestSupport::failureCount() == before ? "通过" : "失败") << std::endl;
+    }
+    testUnchangedView();
+    std::cout << "共比较 " << comparisons << " 次转换, 失败 " << TestSupport::failureCount() << " 项" << std::endl;
+    return TestSupport::failureCount() == 0 ? 0 : 1;
+}
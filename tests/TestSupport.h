@@ -0,0 +1,80 @@
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include "DataTypes.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+/**
+ * 测试公用工具 - 不依赖测试框架，失败时打印位置并计数，main 以失败数作为退出码
+ */
+namespace TestSupport {
+
+inline int &failureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+inline bool check(bool condition, const char *expression, const char *file, int line) {
+    if (!condition) {
+        ++failureCount();
+        std::cerr << file << ":" << line << ": 检查失败: " << expression << std::endl;
+    }
+    return condition;
+}
+
+// 确定性伪随机字节（线性同余），保证每次运行的输入相同
+class ByteGenerator {
+public:
+    explicit ByteGenerator(uint32_t seed = 1) : state(seed) {}
+
+    uint8_t next() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<uint8_t>(state >> 24);
+    }
+
+private:
+    uint32_t state;
+};
+
+// 按格式分配并以伪随机内容填满所有平面（含行填充）
+inline bool makeRandomImage(FrameData &frame, int width, int height, PixelFormat format, ByteGenerator &gen) {
+    if (!frame.allocateImage(width, height, format)) {
+        return false;
+    }
+    for (size_t i = 0; i < frame.size; ++i) {
+        frame.data[i] = gen.next();
+    }
+    return true;
+}
+
+// 比较两帧的可见像素（不比较行填充），返回最大逐字节差
+inline int maxPlaneDifference(const FrameData &a, const FrameData &b) {
+    int maxDiff = 0;
+    for (int p = 0; p < a.planeCount(); ++p) {
+        const int rowBytes = a.planeWidth(p) * pixelFormatPlaneBytesPerPixel(a.format, p);
+        for (int y = 0; y < a.planeHeight(p); ++y) {
+            const uint8_t *rowA = a.plane(p) + static_cast<size_t>(y) * a.planeStride(p);
+            const uint8_t *rowB = b.plane(p) + static_cast<size_t>(y) * b.planeStride(p);
+            for (int x = 0; x < rowBytes; ++x) {
+                const int diff = rowA[x] > rowB[x] ? rowA[x] - rowB[x] : rowB[x] - rowA[x];
+                if (diff > maxDiff) {
+                    maxDiff = diff;
+                }
+            }
+        }
+    }
+    return maxDiff;
+}
+
+// 基准计时（秒）
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace TestSupport
+
+#define CHECK(expr) TestSupport::check((expr), #expr, __FILE__, __LINE__)
+
+#endif // TESTSUPPORT_H
@@ -0,0 +1,68 @@
+// VideoPreprocessorTest.cpp
+// 校验叠加到 YUV420P 帧上的光标颜色与 PixelConverter 在各色彩规格下的转换结果一致
+#include "VideoPreprocessor.h"
+#include "PixelConverter.h"
+#include "TestSupport.h"
+#include <iostream>
+
+namespace {
+
+// 不透明纯色光标（非预乘 ARGB 与预乘相同），4x4 且热点在左上角，覆盖帧内完整的 2x2 色度块
+const int CURSOR_SIZE = 4;
+const uint32_t CURSOR_COLORS[] = {0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0xFFFFFFFF, 0xFF20A0E0};
+
+void testCursorColor(YuvMatrix matrix, YuvRange range, uint32_t color, TestSupport::ByteGenerator &gen) {
+    FrameData frame;
+    if (!CHECK(TestSupport::makeRandomImage(frame, 16, 16, PixelFormat::YUV420P, gen))) {
+        return;
+    }
+    CursorImage cursor;
+    cursor.width = CURSOR_SIZE;
+    cursor.height = CURSOR_SIZE;
+    cursor.serial = 1;
+    cursor.pixels.assign(CURSOR_SIZE * CURSOR_SIZE, color);
+
+    VideoPreprocessor preprocessor;
+    preprocessor.setColorSpec(matrix, range);
+    preprocessor.setClickHighlight(false);
+    preprocessor.setCursorImage(cursor);
+    const CaptureRect expected = preprocessor.mouseEffectRect(frame, {4, 6}, false);
+    const CaptureRect touched = preprocessor.overlayMouseEffectInPlace(frame, {4, 6}, false);
+    CHECK(touched.width == CURSOR_SIZE && touched.height == CURSOR_SIZE);
+    CHECK(expected.x == touched.x && expected.y == touched.y &&
+          expected.width == touched.width && expected.height == touched.height);
+
+    int y, u, v;
+    PixelConverter(matrix, range).convertPixel((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, y, u, v);
+    for (int row = 6; row < 6 + CURSOR_SIZE; ++row) {
+        for (int col = 4; col < 4 + CURSOR_SIZE; ++col) {
+            CHECK(frame.plane(0)[row * frame.planeStride(0) + col] == y);
+        }
+    }
+    for (int row = 3; row < 3 + CURSOR_SIZE / 2; ++row) {
+        for (int col = 2; col < 2 + CURSOR_SIZE / 2; ++col) {
+            const int actualU = frame.plane(1)[row * frame.planeStride(1) + col];
+            const int actualV = frame.plane(2)[row * frame.planeStride(2) + col];
+            if (!CHECK(actualU == u && actualV == v)) {
+                std::cerr << "  矩阵 " << static_cast<int>(matrix) << ", 范围 " << static_cast<int>(range)
+                          << ", 颜色 " << std::hex << color << std::dec << ": UV " << actualU << "," << actualV
+                          << " 期望 " << u << "," << v << std::endl;
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    TestSupport::ByteGenerator gen(0x9abc);
+    for (YuvMatrix matrix : {YuvMatrix::BT601, YuvMatrix::BT709}) {
+        for (YuvRange range : {YuvRange::Limited, YuvRange::Full}) {
+            for (uint32_t color : CURSOR_COLORS) {
+                testCursorColor(matrix, range, color, gen);
+            }
+        }
+    }
+    std::cout << "光标叠加色彩规格: " << (TestSupport::failureCount() == 0 ? "通过" : "失败") << std::endl;
+    return TestSupport::failureCount() == 0 ? 0 : 1;
+}